@@ -20,6 +20,8 @@ Item {
     property bool showMarkers
     property bool showTimecode
     property bool showFps
+    property bool showStats
+    property string stats
     property bool showSafezone
     property bool showAudiothumb
     property bool showToolbar: false
@@ -156,6 +158,23 @@ Item {
             rightMargin: 4
         }
     }
+    Text {
+        id: playbackstats
+        objectName: "playbackstats"
+        color: "white"
+        style: Text.Outline;
+        styleColor: "black"
+        text: root.stats
+        visible: root.showStats
+        font.pixelSize: root.displayFontSize * 0.8
+        horizontalAlignment: Text.AlignRight
+        anchors {
+            right: root.right
+            top: root.top
+            rightMargin: 4
+            topMargin: 4
+        }
+    }
     Text {
         id: fpsdropped
         objectName: "fpsdropped"
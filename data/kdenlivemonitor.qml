@@ -19,6 +19,8 @@ Item {
     property bool showMarkers
     property bool showTimecode
     property bool showFps
+    property bool showStats
+    property string stats
     property bool showSafezone
     property bool showAudiothumb
     property bool showToolbar: false
@@ -124,6 +126,24 @@ Item {
         }
     }
 
+    Text {
+        id: playbackstats
+        objectName: "playbackstats"
+        color: "white"
+        style: Text.Outline;
+        styleColor: "black"
+        text: root.stats
+        visible: root.showStats
+        font.pixelSize: root.displayFontSize * 0.8
+        horizontalAlignment: Text.AlignRight
+        anchors {
+            right: root.right
+            top: root.top
+            rightMargin: 4
+            topMargin: 4
+        }
+    }
+
     Text {
         id: fpsdropped
         objectName: "fpsdropped"
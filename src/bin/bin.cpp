@@ -33,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "project/clipmanager.h"
 #include "project/dialogs/slideshowclip.h"
 #include "project/jobs/jobmanager.h"
+#include "project/jobs/proxyclipjob.h"
 #include "monitor/monitor.h"
 #include "doc/kdenlivedoc.h"
 #include "dialogs/clipcreationdialog.h"
@@ -548,6 +549,9 @@ Bin::Bin(QWidget *parent) :
     , m_processedAudio(0)
 {
     m_layout = new QVBoxLayout(this);
+    m_partialProxyTimer.setSingleShot(true);
+    m_partialProxyTimer.setInterval(2000);
+    connect(&m_partialProxyTimer, &QTimer::timeout, this, &Bin::slotApplyPartialProxies);
 
     // Create toolbar for buttons
     m_toolbar = new QToolBar(this);
@@ -2171,6 +2175,15 @@ void Bin::slotProducerReady(const requestClipInfo &info, ClipController *control
 {
     ProjectClip *clip = m_rootFolder->clip(info.clipId);
     if (clip) {
+        if (info.replaceProducer) {
+            m_segmentsMutex.lock();
+            const QString loadedProxy = ProjectClip::getXmlProperty(info.xml, QStringLiteral("kdenlive:proxy"));
+            if (m_segmentedProxies.contains(info.clipId) && !loadedProxy.endsWith(ProxyJob::progressivePlaylist(QString()))) {
+                // Bin and timeline now use the final proxy or the original clip
+                ProxyJob::removeSegments(m_segmentedProxies.take(info.clipId));
+            }
+            m_segmentsMutex.unlock();
+        }
         if (clip->setProducer(controller, info.replaceProducer) && !clip->hasProxy()) {
             emit producerReady(info.clipId);
             // Check for file modifications
@@ -2466,9 +2479,43 @@ void Bin::slotShowJobLog()
 }
 
 void Bin::gotProxy(const QString &id, const QString &path)
+{
+    if (path.endsWith(ProxyJob::progressivePlaylist(QString()))) {
+        // Reloading the clip interrupts playback, so partial proxies wait for it to stop
+        m_pendingPartialProxies.insert(id, path);
+        slotApplyPartialProxies();
+        return;
+    }
+    // The final proxy or the original clip replaces any partial proxy
+    m_pendingPartialProxies.remove(id);
+    applyProxy(id, path);
+}
+
+void Bin::slotApplyPartialProxies()
+{
+    if (m_pendingPartialProxies.isEmpty()) {
+        return;
+    }
+    if (m_monitor->render->isPlaying() || pCore->monitorManager()->projectMonitor()->render->isPlaying()) {
+        m_partialProxyTimer.start();
+        return;
+    }
+    QMapIterator<QString, QString> i(m_pendingPartialProxies);
+    while (i.hasNext()) {
+        i.next();
+        applyProxy(i.key(), i.value());
+    }
+    m_pendingPartialProxies.clear();
+}
+
+void Bin::applyProxy(const QString &id, const QString &path)
 {
     ProjectClip *clip = m_rootFolder->clip(id);
     if (clip) {
+        if (path.endsWith(ProxyJob::progressivePlaylist(QString()))) {
+            QMutexLocker lock(&m_segmentsMutex);
+            m_segmentedProxies.insert(id, path.left(path.length() - ProxyJob::progressivePlaylist(QString()).length()));
+        }
         QDomDocument doc;
         clip->setProducerProperty(QStringLiteral("kdenlive:proxy"), path);
         QDomElement xml = clip->toXml(doc, true);
@@ -3066,7 +3113,25 @@ void Bin::startClipJob(const QStringList &params)
     }
     AbstractClipJob::JOBTYPE jobType = (AbstractClipJob::JOBTYPE) data.takeFirst().toInt();
     QList<ProjectClip *>clips = selectedClips();
-    m_jobManager->prepareJobs(clips, m_doc->fps(), jobType, data);
+    QHash<QString, int> dependencies;
+    if (jobType == AbstractClipJob::ANALYSECLIPJOB || jobType == AbstractClipJob::FILTERCLIPJOB) {
+        // Analysis decodes the same source as a pending proxy job, wait for it instead of competing with it
+        foreach (ProjectClip *clip, clips) {
+            const int proxyJob = m_jobManager->pendingJobId(clip->clipId(), AbstractClipJob::PROXYJOB);
+            if (proxyJob >= 0) {
+                dependencies.insert(clip->clipId(), proxyJob);
+            }
+        }
+    }
+    const QHash<QString, int> jobIds = m_jobManager->prepareJobs(clips, m_doc->fps(), jobType, data, dependencies);
+    if (jobType == AbstractClipJob::TRANSCODEJOB && m_doc->useProxy()) {
+        // A transcoded clip added to the project gets a proxy like its source
+        foreach (ProjectClip *clip, clips) {
+            if (clip->hasProxy() && jobIds.contains(clip->clipId())) {
+                m_jobManager->prepareOutputJob(jobIds.value(clip->clipId()), m_doc->fps(), AbstractClipJob::PROXYJOB);
+            }
+        }
+    }
 }
 
 void Bin::slotCancelRunningJob(const QString &id, const QMap<QString, QString> &newProps)
@@ -3991,6 +4056,11 @@ bool Bin::addClip(QDomElement elem, const QString &clipId)
     return true;
 }
 
+void Bin::requestProxy(ProjectClip *clip)
+{
+    m_doc->slotProxyCurrentItem(true, QList<ProjectClip *>() << clip);
+}
+
 void Bin::rebuildProxies()
 {
     QList<ProjectClip *> clipList = m_rootFolder->childClips();
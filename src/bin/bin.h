@@ -38,6 +38,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QListView>
 #include <QFuture>
 #include <QMutex>
+#include <QTimer>
 #include <QLineEdit>
 #include <QDir>
 
@@ -240,9 +241,13 @@ public:
 
     const QString getDocumentProperty(const QString &key);
 
-    /** @brief A proxy clip was just created, pass it to the responsible item  */
+    /** @brief A proxy clip was just created, pass it to the responsible item
+     *  Partial proxies of a clip still being encoded are only applied when no monitor is playing */
     void gotProxy(const QString &id, const QString &path);
 
+    /** @brief Creates a proxy for the clip if it does not have one */
+    void requestProxy(ProjectClip *clip);
+
     /** @brief Get the document's renderer frame size  */
     const QSize getRenderSize();
 
@@ -349,6 +354,8 @@ public:
     void saveZone(const QStringList &info, const QDir &dir);
 
 private slots:
+    /** @brief Applies the partial proxies received during playback, once playback stopped */
+    void slotApplyPartialProxies();
     void slotAddClip();
     void slotReloadClip();
     /** @brief Set sorting column */
@@ -539,6 +546,14 @@ private:
     QStringList m_audioThumbsList;
     QString m_processingAudioThumb;
     QMutex m_audioThumbMutex;
+    /** @brief Partial proxies waiting for the playback to stop, by clip id */
+    QMap<QString, QString> m_pendingPartialProxies;
+    QTimer m_partialProxyTimer;
+    /** @brief Proxy destination of the clips that used a partial proxy, the segments are deleted once the clip was reloaded without it */
+    QMap<QString, QString> m_segmentedProxies;
+    QMutex m_segmentsMutex;
+    /** @brief Sets the proxy of a clip and reloads it */
+    void applyProxy(const QString &id, const QString &path);
     /** @brief Total number of milliseconds to process for audio thumbnails */
     long m_audioDuration;
     /** @brief Total number of milliseconds already processed for audio thumbnails */
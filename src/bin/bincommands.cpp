@@ -159,7 +159,7 @@ UpdateBinEffectCommand::UpdateBinEffectCommand(Bin *bin, const QString &clipId,
     m_bin(bin),
     m_clipId(clipId),
     m_oldEffect(oldEffect),
-    m_newEffect(newEffect),
+    m_newEffect(oldEffect, newEffect),
     m_ix(ix),
     m_refreshStack(refreshStack),
     m_updateClip(updateClip)
@@ -169,14 +169,27 @@ UpdateBinEffectCommand::UpdateBinEffectCommand(Bin *bin, const QString &clipId,
 // virtual
 void UpdateBinEffectCommand::undo()
 {
-    m_bin->updateEffect(m_clipId, m_oldEffect, m_ix, m_refreshStack, m_updateClip);
+    QDomElement effect = m_oldEffect.element();
+    m_bin->updateEffect(m_clipId, effect, m_ix, m_refreshStack, m_updateClip);
 }
 // virtual
 void UpdateBinEffectCommand::redo()
 {
-    m_bin->updateEffect(m_clipId, m_newEffect, m_ix, m_refreshStack, m_updateClip);
+    QDomElement effect = m_newEffect.apply(m_oldEffect.element());
+    m_bin->updateEffect(m_clipId, effect, m_ix, m_refreshStack, m_updateClip);
     m_refreshStack = true;
 }
+// virtual
+int UpdateBinEffectCommand::memoryCost() const
+{
+    return m_oldEffect.memoryCost() + m_newEffect.memoryCost();
+}
+// virtual
+void UpdateBinEffectCommand::spill(UndoSpillFile *file)
+{
+    m_oldEffect.spill(file);
+    m_newEffect.spill(file);
+}
 
 ChangeMasterEffectStateCommand::ChangeMasterEffectStateCommand(Bin *bin, const QString &clipId, const QList<int> &effectIndexes, bool disable, QUndoCommand *parent) :
     QUndoCommand(parent),
@@ -24,6 +24,8 @@
 #include <QDomElement>
 #include <QMap>
 
+#include "doc/undopayload.h"
+
 class Bin;
 
 class AddBinFolderCommand : public QUndoCommand
@@ -103,17 +105,21 @@ private:
     QDomElement m_effect;
 };
 
-class UpdateBinEffectCommand : public QUndoCommand
+class UpdateBinEffectCommand : public QUndoCommand, public CompactUndoCommand
 {
 public:
     explicit UpdateBinEffectCommand(Bin *bin, const QString &clipId, QDomElement &oldEffect, QDomElement &newEffect, int ix, bool refreshStack, bool updateClip, QUndoCommand *parent = nullptr);
     void undo() Q_DECL_OVERRIDE;
     void redo() Q_DECL_OVERRIDE;
+    int memoryCost() const Q_DECL_OVERRIDE;
+    void spill(UndoSpillFile *file) Q_DECL_OVERRIDE;
 private:
     Bin *m_bin;
     QString m_clipId;
-    QDomElement m_oldEffect;
-    QDomElement m_newEffect;
+    /** Effect before the edit, compressed */
+    UndoPayload m_oldEffect;
+    /** Changed parameters of the effect */
+    UndoXmlDelta m_newEffect;
     int m_ix;
     bool m_refreshStack;
     bool m_updateClip;
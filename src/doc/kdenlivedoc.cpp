@@ -20,6 +20,7 @@
 #include "kdenlivedoc.h"
 #include "documentchecker.h"
 #include "documentvalidator.h"
+#include "undopayload.h"
 #include "mltcontroller/clipcontroller.h"
 #include "mltcontroller/producerqueue.h"
 #include <config-kdenlive.h>
@@ -67,8 +68,50 @@
 #include <xlocale.h>
 #endif
 
-DocUndoStack::DocUndoStack(QUndoGroup *parent) : QUndoStack(parent)
+namespace {
+// Rough size of a command without payload
+const int UNDO_COMMAND_COST = 256;
+// Most recent commands that always stay in memory
+const int UNDO_KEEP_IN_MEMORY = 20;
+
+int commandCost(const QUndoCommand *cmd)
+{
+    int cost = UNDO_COMMAND_COST;
+    const CompactUndoCommand *compact = dynamic_cast<const CompactUndoCommand *>(cmd);
+    if (compact) {
+        cost += compact->memoryCost();
+    }
+    for (int i = 0; i < cmd->childCount(); ++i) {
+        cost += commandCost(cmd->child(i));
+    }
+    return cost;
+}
+
+void spillCommand(QUndoCommand *cmd, UndoSpillFile *file)
+{
+    CompactUndoCommand *compact = dynamic_cast<CompactUndoCommand *>(cmd);
+    if (compact) {
+        compact->spill(file);
+    }
+    for (int i = 0; i < cmd->childCount(); ++i) {
+        spillCommand(const_cast<QUndoCommand *>(cmd->child(i)), file);
+    }
+}
+}
+
+DocUndoStack::DocUndoStack(QUndoGroup *parent) : QUndoStack(parent),
+    m_memoryUsage(0),
+    m_spilledCount(0),
+    m_spillFile(new UndoSpillFile)
 {
+    // QUndoStack::push, endMacro and clear are not virtual, the accounting follows the index instead
+    connect(this, &QUndoStack::indexChanged, this, &DocUndoStack::slotUpdateCosts);
+}
+
+DocUndoStack::~DocUndoStack()
+{
+    // Commands keep a pointer to the spill file but never read it when deleted
+    delete m_spillFile;
 }
 
 //TODO: custom undostack everywhere do that
@@ -80,6 +123,91 @@ void DocUndoStack::push(QUndoCommand *cmd)
     QUndoStack::push(cmd);
 }
 
+void DocUndoStack::slotUpdateCosts(int index)
+{
+    if (count() == 0) {
+        // The stack was cleared, nothing references the spilled payloads anymore
+        m_costs.clear();
+        m_memoryUsage = 0;
+        m_spilledCount = 0;
+        if (m_spillFile->size() > 0) {
+            delete m_spillFile;
+            m_spillFile = new UndoSpillFile;
+        }
+        return;
+    }
+    if (index < count() && m_costs.count() == count()) {
+        // Undo or redo inside the history, the commands did not change
+        return;
+    }
+    // Commands above the index were dropped, and a command or macro was appended or merged into the top command
+    m_costs.resize(count());
+    m_spilledCount = qMin(m_spilledCount, count());
+    m_costs[count() - 1] = commandCost(command(count() - 1));
+    m_memoryUsage = 0;
+    for (int i = 0; i < m_costs.count(); ++i) {
+        m_memoryUsage += m_costs.at(i);
+    }
+    checkMemoryBudget();
+}
+
+void DocUndoStack::compactSpillFile()
+{
+    if (m_spillFile->size() == 0) {
+        return;
+    }
+    // Payloads of dropped commands are never read again
+    UndoSpillFile *file = new UndoSpillFile;
+    for (int i = 0; i < m_spilledCount && i < count(); ++i) {
+        spillCommand(const_cast<QUndoCommand *>(command(i)), file);
+    }
+    qCDebug(KDENLIVE_LOG) << "// Undo spill file compacted from" << m_spillFile->size() / 1024 << "kB to" << file->size() / 1024 << "kB";
+    delete m_spillFile;
+    m_spillFile = file;
+    // Payloads that could not be moved are back in memory
+    updateCosts();
+}
+
+void DocUndoStack::updateCosts()
+{
+    m_costs.resize(count());
+    m_memoryUsage = 0;
+    for (int i = 0; i < count(); ++i) {
+        m_costs[i] = commandCost(command(i));
+        m_memoryUsage += m_costs.at(i);
+    }
+}
+
+void DocUndoStack::checkMemoryBudget()
+{
+    const qint64 budget = (qint64) KdenliveSettings::undomemorylimit() * 1024 * 1024;
+    if (budget <= 0 || m_memoryUsage <= budget) {
+        return;
+    }
+    // Spill down to 3/4 of the budget so that we don't hit disk on every push
+    const qint64 target = budget * 3 / 4;
+    const int last = count() - UNDO_KEEP_IN_MEMORY;
+    while (m_spilledCount < last && m_memoryUsage > target) {
+        QUndoCommand *cmd = const_cast<QUndoCommand *>(command(m_spilledCount));
+        spillCommand(cmd, m_spillFile);
+        const int cost = commandCost(cmd);
+        m_memoryUsage += cost - m_costs.at(m_spilledCount);
+        m_costs[m_spilledCount] = cost;
+        ++m_spilledCount;
+    }
+    qCDebug(KDENLIVE_LOG) << "// Undo history uses" << m_memoryUsage / 1024 << "kB in memory," << m_spillFile->size() / 1024 << "kB on disk";
+}
+
+qint64 DocUndoStack::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+qint64 DocUndoStack::spilledSize() const
+{
+    return m_spillFile->size();
+}
+
 const double DOCUMENTVERSION = 0.96;
 
 KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGroup *undoGroup, const QString &profileName, const QMap<QString, QString> &properties, const QMap<QString, QString> &metadata, const QPoint &tracks, Render *render, NotesPlugin *notes, bool *openBackup, MainWindow *parent) :
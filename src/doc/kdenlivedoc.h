@@ -28,6 +28,7 @@
 #include <qdom.h>
 #include <QMap>
 #include <QList>
+#include <QVector>
 #include <QDir>
 #include <QObject>
 #include <QTimer>
@@ -61,14 +62,37 @@ namespace Mlt
 class Profile;
 }
 
+class UndoSpillFile;
+
 class DocUndoStack: public QUndoStack
 {
     Q_OBJECT
 public:
     explicit DocUndoStack(QUndoGroup *parent = nullptr);
+    ~DocUndoStack();
     void push(QUndoCommand *cmd);
+    /** @brief Rewrites the spill file with only the data of the remaining commands */
+    void compactSpillFile();
+    /** @brief Returns the approximate memory used by the undo history, in bytes */
+    qint64 memoryUsage() const;
+    /** @brief Returns the number of bytes of history moved to disk */
+    qint64 spilledSize() const;
 signals:
     void invalidate();
+private slots:
+    /** @brief Accounts for commands pushed, merged or closed by endMacro, and drops the spill file when the stack was cleared */
+    void slotUpdateCosts(int index);
+private:
+    /** Memory cost of each command, in stack order */
+    QVector<int> m_costs;
+    qint64 m_memoryUsage;
+    /** Number of commands at the bottom of the stack whose payload is on disk */
+    int m_spilledCount;
+    UndoSpillFile *m_spillFile;
+    /** @brief Moves the oldest history to disk until the memory budget is met */
+    void checkMemoryBudget();
+    /** @brief Recomputes the memory cost of all commands */
+    void updateCosts();
 };
 
 class KdenliveDoc: public QObject
@@ -0,0 +1,310 @@
+/*
+ * Kdenlive compact undo command payloads
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "undopayload.h"
+#include "kdenlive_debug.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QDomDocument>
+#include <QDomNamedNodeMap>
+
+UndoSpillFile::UndoSpillFile() :
+    m_file(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-undo-XXXXXX"))),
+    m_size(0)
+{
+}
+
+qint64 UndoSpillFile::append(const QByteArray &data)
+{
+    if (!m_file.isOpen() && !m_file.open()) {
+        qCDebug(KDENLIVE_LOG) << "// Cannot open undo spill file: " << m_file.errorString();
+        return -1;
+    }
+    if (!m_file.seek(m_size) || m_file.write(data) != data.size()) {
+        qCDebug(KDENLIVE_LOG) << "// Cannot write undo spill file: " << m_file.errorString();
+        return -1;
+    }
+    qint64 offset = m_size;
+    m_size += data.size();
+    return offset;
+}
+
+QByteArray UndoSpillFile::read(qint64 offset, int size)
+{
+    if (!m_file.isOpen() || !m_file.seek(offset)) {
+        return QByteArray();
+    }
+    return m_file.read(size);
+}
+
+qint64 UndoSpillFile::size() const
+{
+    return m_size;
+}
+
+UndoPayload::UndoPayload() :
+    m_file(nullptr),
+    m_offset(-1),
+    m_size(0)
+{
+}
+
+UndoPayload::UndoPayload(const QDomElement &element) :
+    m_file(nullptr),
+    m_offset(-1),
+    m_size(0)
+{
+    if (element.isNull()) {
+        return;
+    }
+    QDomDocument doc;
+    doc.appendChild(doc.importNode(element, true));
+    m_data = qCompress(doc.toByteArray(0));
+    m_size = m_data.size();
+}
+
+UndoPayload::UndoPayload(const QByteArray &data) :
+    m_file(nullptr),
+    m_offset(-1),
+    m_size(0)
+{
+    if (!data.isEmpty()) {
+        m_data = qCompress(data);
+        m_size = m_data.size();
+    }
+}
+
+bool UndoPayload::isNull() const
+{
+    return m_size == 0;
+}
+
+QByteArray UndoPayload::data() const
+{
+    if (m_size == 0) {
+        return QByteArray();
+    }
+    return qUncompress(m_file ? m_file->read(m_offset, m_size) : m_data);
+}
+
+QDomElement UndoPayload::element() const
+{
+    if (m_size == 0) {
+        return QDomElement();
+    }
+    const QByteArray xml = data();
+    QDomDocument doc;
+    if (xml.isEmpty() || !doc.setContent(xml)) {
+        qCDebug(KDENLIVE_LOG) << "// Cannot restore undo data";
+        return QDomElement();
+    }
+    return doc.documentElement();
+}
+
+int UndoPayload::memoryCost() const
+{
+    return m_data.size();
+}
+
+void UndoPayload::spill(UndoSpillFile *file)
+{
+    if (m_size == 0 || file == nullptr || m_file == file) {
+        return;
+    }
+    // Data may move from an older spill file that is being compacted
+    const QByteArray data = m_file ? m_file->read(m_offset, m_size) : m_data;
+    qint64 offset = data.size() == m_size ? file->append(data) : -1;
+    if (offset < 0) {
+        // Keep the data in memory
+        if (m_file) {
+            m_data = data;
+            m_file = nullptr;
+            m_offset = -1;
+        }
+        return;
+    }
+    m_file = file;
+    m_offset = offset;
+    m_data.clear();
+}
+
+namespace {
+// Elements of a tree in depth first order
+QVector<QDomElement> flattenElements(const QDomElement &root)
+{
+    QVector<QDomElement> result;
+    QVector<QDomElement> stack;
+    stack << root;
+    while (!stack.isEmpty()) {
+        QDomElement e = stack.takeLast();
+        result << e;
+        QVector<QDomElement> children;
+        for (QDomElement child = e.firstChildElement(); !child.isNull(); child = child.nextSiblingElement()) {
+            children << child;
+        }
+        for (int i = children.count() - 1; i >= 0; --i) {
+            stack << children.at(i);
+        }
+    }
+    return result;
+}
+
+bool isLeaf(const QDomElement &e)
+{
+    return e.firstChildElement().isNull();
+}
+}
+
+UndoXmlDelta::UndoXmlDelta()
+{
+}
+
+UndoXmlDelta::UndoXmlDelta(const QDomElement &base, const QDomElement &target)
+{
+    const QVector<QDomElement> from = flattenElements(base);
+    const QVector<QDomElement> to = flattenElements(target);
+    bool sameStructure = from.count() == to.count();
+    for (int i = 0; sameStructure && i < to.count(); ++i) {
+        const QDomElement &a = from.at(i);
+        const QDomElement &b = to.at(i);
+        if (a.tagName() != b.tagName()) {
+            sameStructure = false;
+            break;
+        }
+        const QDomNamedNodeMap newAttributes = b.attributes();
+        for (int j = 0; j < newAttributes.count(); ++j) {
+            const QDomAttr attr = newAttributes.item(j).toAttr();
+            if (!a.hasAttribute(attr.name()) || a.attribute(attr.name()) != attr.value()) {
+                Change change;
+                change.node = i;
+                change.attribute = attr.name();
+                change.value = attr.value();
+                change.removed = false;
+                m_changes << change;
+            }
+        }
+        const QDomNamedNodeMap oldAttributes = a.attributes();
+        for (int j = 0; j < oldAttributes.count(); ++j) {
+            const QString name = oldAttributes.item(j).toAttr().name();
+            if (!b.hasAttribute(name)) {
+                Change change;
+                change.node = i;
+                change.attribute = name;
+                change.removed = true;
+                m_changes << change;
+            }
+        }
+        if (isLeaf(a) != isLeaf(b)) {
+            sameStructure = false;
+        } else if (isLeaf(b) && a.text() != b.text()) {
+            Change change;
+            change.node = i;
+            change.value = b.text();
+            change.removed = false;
+            m_changes << change;
+        }
+    }
+    if (!sameStructure) {
+        m_changes.clear();
+        m_full = UndoPayload(target);
+    }
+}
+
+QDomElement UndoXmlDelta::apply(const QDomElement &base) const
+{
+    if (!m_full.isNull()) {
+        return m_full.element();
+    }
+    QDomElement result = base.cloneNode(true).toElement();
+    const QVector<Change> allChanges = changes();
+    if (allChanges.isEmpty()) {
+        return result;
+    }
+    const QVector<QDomElement> nodes = flattenElements(result);
+    for (int i = 0; i < allChanges.count(); ++i) {
+        const Change &change = allChanges.at(i);
+        if (change.node >= nodes.count()) {
+            continue;
+        }
+        QDomElement e = nodes.at(change.node);
+        if (change.attribute.isEmpty()) {
+            while (!e.firstChild().isNull()) {
+                e.removeChild(e.firstChild());
+            }
+            if (!change.value.isEmpty()) {
+                e.appendChild(e.ownerDocument().createTextNode(change.value));
+            }
+        } else if (change.removed) {
+            e.removeAttribute(change.attribute);
+        } else {
+            e.setAttribute(change.attribute, change.value);
+        }
+    }
+    return result;
+}
+
+int UndoXmlDelta::memoryCost() const
+{
+    int cost = m_full.memoryCost() + m_spilledChanges.memoryCost();
+    for (int i = 0; i < m_changes.count(); ++i) {
+        cost += sizeof(Change) + (m_changes.at(i).attribute.size() + m_changes.at(i).value.size()) * (int) sizeof(QChar);
+    }
+    return cost;
+}
+
+void UndoXmlDelta::spill(UndoSpillFile *file)
+{
+    m_full.spill(file);
+    if (m_changes.isEmpty()) {
+        m_spilledChanges.spill(file);
+        return;
+    }
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << m_changes.count();
+    for (int i = 0; i < m_changes.count(); ++i) {
+        const Change &change = m_changes.at(i);
+        stream << change.node << change.attribute << change.value << change.removed;
+    }
+    m_spilledChanges = UndoPayload(data);
+    m_spilledChanges.spill(file);
+    m_changes.clear();
+}
+
+QVector<UndoXmlDelta::Change> UndoXmlDelta::changes() const
+{
+    if (m_spilledChanges.isNull()) {
+        return m_changes;
+    }
+    QVector<Change> result;
+    QByteArray data = m_spilledChanges.data();
+    QDataStream stream(&data, QIODevice::ReadOnly);
+    int count = 0;
+    stream >> count;
+    for (int i = 0; i < count && !stream.atEnd(); ++i) {
+        Change change;
+        stream >> change.node >> change.attribute >> change.value >> change.removed;
+        result << change;
+    }
+    return result;
+}
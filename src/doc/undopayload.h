@@ -0,0 +1,117 @@
+/*
+ * Kdenlive compact undo command payloads
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef UNDOPAYLOAD_H
+#define UNDOPAYLOAD_H
+
+#include <QByteArray>
+#include <QDomElement>
+#include <QString>
+#include <QTemporaryFile>
+#include <QVector>
+
+/** @brief Append only temporary file receiving the undo history that exceeds the memory budget */
+class UndoSpillFile
+{
+public:
+    UndoSpillFile();
+    /** @brief Writes data at the end of the file
+     * @return the offset of the data, or -1 on failure */
+    qint64 append(const QByteArray &data);
+    /** @brief Reads back data previously written with append() */
+    QByteArray read(qint64 offset, int size);
+    /** @brief Returns the number of bytes written to disk */
+    qint64 size() const;
+
+private:
+    QTemporaryFile m_file;
+    qint64 m_size;
+};
+
+/** @brief A compressed XML element, kept in memory or in the undo spill file */
+class UndoPayload
+{
+public:
+    UndoPayload();
+    explicit UndoPayload(const QDomElement &element);
+    explicit UndoPayload(const QByteArray &data);
+    bool isNull() const;
+    /** @brief Returns a new copy of the stored element */
+    QDomElement element() const;
+    /** @brief Returns the uncompressed stored data */
+    QByteArray data() const;
+    /** @brief Returns the number of bytes held in memory */
+    int memoryCost() const;
+    /** @brief Moves the compressed data to the spill file, or from an older spill file to file */
+    void spill(UndoSpillFile *file);
+
+private:
+    QByteArray m_data;
+    UndoSpillFile *m_file;
+    qint64 m_offset;
+    int m_size;
+};
+
+/** @brief Difference between two versions of an XML element
+ * When both versions have the same element structure, which is the case for
+ * effect and transition parameter edits, only the changed attributes and
+ * texts are stored. Otherwise, the full target element is kept as a payload.
+ */
+class UndoXmlDelta
+{
+public:
+    UndoXmlDelta();
+    UndoXmlDelta(const QDomElement &base, const QDomElement &target);
+    /** @brief Rebuilds the target element from the base element */
+    QDomElement apply(const QDomElement &base) const;
+    int memoryCost() const;
+    void spill(UndoSpillFile *file);
+
+private:
+    struct Change {
+        /** Position of the element in a depth first walk of the tree */
+        int node;
+        /** Changed attribute, or empty for the element text */
+        QString attribute;
+        QString value;
+        bool removed;
+    };
+    QVector<Change> m_changes;
+    /** Serialized changes, once moved to the spill file */
+    UndoPayload m_spilledChanges;
+    /** Full target element, used when the structure changed */
+    UndoPayload m_full;
+    QVector<Change> changes() const;
+};
+
+/** @brief Interface for undo commands able to report and reduce their memory use */
+class CompactUndoCommand
+{
+public:
+    virtual ~CompactUndoCommand() {}
+    /** @brief Returns the approximate number of bytes held in memory by the command payload */
+    virtual int memoryCost() const = 0;
+    /** @brief Moves the command payload to the spill file */
+    virtual void spill(UndoSpillFile *file) = 0;
+};
+
+#endif
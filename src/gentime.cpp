@@ -49,6 +49,11 @@ double GenTime::frames(double framesPerSecond) const
     return floor(m_time * framesPerSecond + 0.5);
 }
 
+int GenTime::frame(double framesPerSecond) const
+{
+    return (int) frames(framesPerSecond);
+}
+
 QString GenTime::toString() const
 {
     return QStringLiteral("%1 s").arg(m_time, 0, 'f', 2);
@@ -49,6 +49,10 @@ public:
     * @param framesPerSecond Number of frames per second */
     double frames(double framesPerSecond) const;
 
+    /** @brief Gets the time as a frame number, as used by the timeline tracks.
+    * @param framesPerSecond Number of frames per second */
+    int frame(double framesPerSecond) const;
+
     QString toString() const;
 
     /*
@@ -13,23 +13,178 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include "klocalizedstring.h"
 #include "kdenlive_debug.h"
+#include <QScopedPointer>
 #include <QTime>
+#include <QtConcurrent>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <vector>
+
+namespace {
+// Envelope entries summed into one entry of the coarse correlation
+const int CoarseDecimation = 8;
+// Shorter children are correlated at full resolution
+const int MinCoarseSize = 64 * CoarseDecimation;
+// Best offsets of the coarse correlation that are refined at frame resolution
+const int CoarseCandidates = 3;
+// Frames of the child whose samples are compared to find the offset below one frame
+const int SampleWindowFrames = 8;
+// Keeps the fraction of the normalized sums once stored in the correlation vector
+const double FineScale = 1000;
+// Alignments found on audio thumbnail envelopes with a lower confidence are computed again on decoded envelopes
+const double MinThumbnailConfidence = 0.1;
+
+QVector<qint64> decimate(const qint64 *envelope, int size, int factor)
+{
+    QVector<qint64> result((size + factor - 1) / factor, 0);
+    for (int i = 0; i < size; ++i) {
+        result[i / factor] += envelope[i];
+    }
+    return result;
+}
+
+// Indexes of the largest positive values, at least minDistance entries apart
+QVector<int> bestPeaks(const qint64 *values, int size, int count, int minDistance)
+{
+    QVector<int> peaks;
+    while (peaks.count() < count) {
+        int best = -1;
+        for (int i = 0; i < size; ++i) {
+            bool taken = false;
+            for (int j = 0; j < peaks.count() && !taken; ++j) {
+                taken = qAbs(i - peaks.at(j)) < minDistance;
+            }
+            if (!taken && (best < 0 || values[i] > values[best])) {
+                best = i;
+            }
+        }
+        if (best < 0 || values[best] <= 0) {
+            break;
+        }
+        peaks << best;
+    }
+    return peaks;
+}
+
+// Correlates the normalized envelopes for the shifts [firstShift, lastShift],
+// with the layout of AudioCorrelation::correlate()
+void correlateShifts(const float *main, int sizeMain, const float *sub, int sizeSub,
+                     int firstShift, int lastShift, qint64 *correlation)
+{
+    firstShift = qMax(firstShift, -sizeSub);
+    lastShift = qMin(lastShift, sizeMain);
+    for (int shift = firstShift; shift <= lastShift; ++shift) {
+        const int begin = qMax(0, -shift);
+        const int end = qMin(sizeSub, sizeMain - shift);
+        double sum = 0;
+        for (int i = begin; i < end; ++i) {
+            sum += sub[i] * main[i + shift];
+        }
+        correlation[sizeSub + shift] = qRound64(sum * FineScale);
+    }
+}
+
+// Finds the candidate offsets on the decimated envelopes, then computes the
+// full resolution correlation only around them. Other entries are 0.
+bool correlateCoarseToFine(const FFTCorrelationReference &coarseReference, int coarseMainSize,
+                           const float *main, int sizeMain,
+                           const qint64 *envSub, int sizeSub, qint64 *correlation)
+{
+    const QVector<qint64> coarseSub = decimate(envSub, sizeSub, CoarseDecimation);
+    const int coarseSize = coarseMainSize + coarseSub.count() + 1;
+    std::vector<qint64> coarse(coarseSize);
+    if (!coarseReference.correlate(coarseSub.constData(), coarseSub.count(), &coarse[0])) {
+        return false;
+    }
+    // Keep the windows of the candidates apart so that confidence() compares them
+    const int minDistance = AudioCorrelationInfo::MinPeakDistance / CoarseDecimation + 2;
+    const QVector<int> candidates = bestPeaks(&coarse[0], coarseSize, CoarseCandidates, minDistance);
+
+    std::vector<float> sub(sizeSub);
+    FFTCorrelation::normalize(envSub, sizeSub, &sub[0]);
+    std::fill(correlation, correlation + sizeMain + sizeSub + 1, 0);
+    for (int i = 0; i < candidates.count(); ++i) {
+        const int shift = (candidates.at(i) - coarseSub.count()) * CoarseDecimation;
+        correlateShifts(main, sizeMain, &sub[0], sizeSub,
+                        shift - CoarseDecimation, shift + CoarseDecimation, correlation);
+    }
+    return true;
+}
+
+// Fraction of a frame to add to shift, found by correlating the samples of
+// the loudest frames of sub with the matching samples of main
+double subFrameShift(const AudioEnvelope *main, const AudioEnvelope *sub, const qint64 *envSub, int shift)
+{
+    const int samplingRate = main->samplingRate();
+    const int sizeMain = main->envelopeSize();
+    const int sizeSub = sub->envelopeSize();
+    // Frames of sub overlapping main with one more frame of main on each side
+    const int first = qMax(0, 1 - shift);
+    const int end = qMin(sizeSub, sizeMain - shift - 1);
+    if (end - first < SampleWindowFrames || samplingRate <= 0 || main->fps() <= 0) {
+        return 0;
+    }
+    int window = first;
+    qint64 sum = 0;
+    for (int i = first; i < first + SampleWindowFrames; ++i) {
+        sum += envSub[i];
+    }
+    qint64 best = sum;
+    for (int i = first + SampleWindowFrames; i < end; ++i) {
+        sum += envSub[i] - envSub[i - SampleWindowFrames];
+        if (sum > best) {
+            best = sum;
+            window = i - SampleWindowFrames + 1;
+        }
+    }
+
+    int lead = 0;
+    const QVector<qint64> subSamples = sub->loadSamples(window, SampleWindowFrames, samplingRate);
+    const QVector<qint64> mainSamples = main->loadSamples(window + shift - 1, SampleWindowFrames + 2, samplingRate, &lead);
+    if (subSamples.isEmpty() || mainSamples.isEmpty()) {
+        return 0;
+    }
+    std::vector<float> correlation(mainSamples.count() + subSamples.count() + 1);
+    if (!FFTCorrelation::correlate(mainSamples.constData(), mainSamples.count(),
+                                   subSamples.constData(), subSamples.count(),
+                                   &correlation[0])) {
+        return 0;
+    }
+    // Without sub-frame offset, the first sample of sub matches the sample lead of main.
+    // The polarity of the two recordings may differ.
+    const int samplesPerFrame = qRound(samplingRate / main->fps());
+    int bestLag = 0;
+    float bestValue = -1;
+    for (int lag = -samplesPerFrame; lag <= samplesPerFrame; ++lag) {
+        const int index = subSamples.count() + lead + lag;
+        if (index >= 0 && index < (int) correlation.size() && qAbs(correlation[index]) > bestValue) {
+            bestValue = qAbs(correlation[index]);
+            bestLag = lag;
+        }
+    }
+    return double(bestLag) / samplesPerFrame;
+}
+}
 
 AudioCorrelation::AudioCorrelation(AudioEnvelope *mainTrackEnvelope) :
     m_mainTrackEnvelope(mainTrackEnvelope)
 {
     m_mainTrackEnvelope->normalizeEnvelope();
     connect(m_mainTrackEnvelope, &AudioEnvelope::envelopeReady, this, &AudioCorrelation::slotAnnounceEnvelope);
+    connect(&m_batchWatcher, &QFutureWatcherBase::finished, this, &AudioCorrelation::slotBatchFinished);
 }
 
 AudioCorrelation::~AudioCorrelation()
 {
+    // The batch reads the envelopes
+    m_batchWatcher.waitForFinished();
     delete m_mainTrackEnvelope;
     foreach (AudioEnvelope *envelope, m_children) {
         delete envelope;
     }
+    qDeleteAll(m_pendingChildren);
+    qDeleteAll(m_batchChildren);
     foreach (AudioCorrelationInfo *info, m_correlations) {
         delete info;
     }
@@ -40,45 +195,173 @@ AudioCorrelation::~AudioCorrelation()
 void AudioCorrelation::slotAnnounceEnvelope()
 {
     emit displayMessage(i18n("Audio analysis finished"), OperationCompletedMessage);
+    startBatch();
 }
 
 void AudioCorrelation::addChild(AudioEnvelope *envelope)
 {
-    envelope->normalizeEnvelope();
-    connect(envelope, &AudioEnvelope::envelopeReady, this, &AudioCorrelation::slotProcessChild);
+    addChildren(QList<AudioEnvelope *>() << envelope);
 }
 
-void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
+void AudioCorrelation::addChildren(const QList<AudioEnvelope *> &envelopes)
 {
-    const int sizeMain = m_mainTrackEnvelope->envelopeSize();
-    const int sizeSub = envelope->envelopeSize();
+    foreach (AudioEnvelope *envelope, envelopes) {
+        m_pendingChildren << envelope;
+        connect(envelope, &AudioEnvelope::envelopeReady, this, &AudioCorrelation::slotChildReady);
+        envelope->normalizeEnvelope();
+    }
+}
 
-    AudioCorrelationInfo *info = new AudioCorrelationInfo(sizeMain, sizeSub);
-    qint64 *correlation = info->correlationVector();
+void AudioCorrelation::slotChildReady()
+{
+    startBatch();
+}
 
-    const qint64 *envMain = m_mainTrackEnvelope->envelope();
-    const qint64 *envSub = envelope->envelope();
-    qint64 max = 0;
+void AudioCorrelation::startBatch()
+{
+    if (m_batchWatcher.isRunning() || m_pendingChildren.isEmpty() || !m_mainTrackEnvelope->isReady()) {
+        return;
+    }
+    foreach (AudioEnvelope *envelope, m_pendingChildren) {
+        if (!envelope->isReady()) {
+            // Report all offsets together
+            return;
+        }
+    }
+    // Thumbnail levels are not on the same scale as decoded sample sums, never correlate one with the other
+    bool mixed = false;
+    foreach (AudioEnvelope *envelope, m_pendingChildren) {
+        if (envelope->usesThumbnail() != m_mainTrackEnvelope->usesThumbnail()) {
+            mixed = true;
+            if (envelope->usesThumbnail()) {
+                envelope->decodeEnvelope();
+            }
+        }
+    }
+    if (mixed) {
+        // Batch starts again when the decoded envelopes are ready
+        m_mainTrackEnvelope->decodeEnvelope();
+        return;
+    }
+    m_batchChildren = m_pendingChildren;
+    m_pendingChildren.clear();
+    AudioEnvelope *main = m_mainTrackEnvelope;
+    const QList<AudioEnvelope *> children = m_batchChildren;
+    m_batchWatcher.setFuture(QtConcurrent::run([main, children]() {
+        return correlateBatch(main, children);
+    }));
+}
+
+QVector<AudioCorrelationInfo *> AudioCorrelation::correlateBatch(AudioEnvelope *main, const QList<AudioEnvelope *> &children)
+{
+    QTime t;
+    t.start();
+
+    const int sizeMain = main->envelopeSize();
+    const qint64 *envMain = main->envelope();
+    int maxSizeSub = 0;
+    int maxCoarseSize = 0;
+    foreach (AudioEnvelope *envelope, children) {
+        const int sizeSub = envelope->envelopeSize();
+        if (sizeSub >= MinCoarseSize) {
+            maxCoarseSize = qMax(maxCoarseSize, (sizeSub + CoarseDecimation - 1) / CoarseDecimation);
+        } else if (sizeSub > 200) {
+            maxSizeSub = qMax(maxSizeSub, sizeSub);
+        }
+    }
+    // The spectra of the main envelope are shared by all children
+    QScopedPointer<FFTCorrelationReference> reference;
+    if (maxSizeSub > 0) {
+        reference.reset(new FFTCorrelationReference(envMain, sizeMain, maxSizeSub));
+    }
+    QVector<qint64> coarseMain;
+    QScopedPointer<FFTCorrelationReference> coarseReference;
+    std::vector<float> normalizedMain;
+    if (maxCoarseSize > 0) {
+        coarseMain = decimate(envMain, sizeMain, CoarseDecimation);
+        coarseReference.reset(new FFTCorrelationReference(coarseMain.constData(), coarseMain.count(), maxCoarseSize));
+        normalizedMain.resize(sizeMain);
+        FFTCorrelation::normalize(envMain, sizeMain, &normalizedMain[0]);
+    }
+
+    QVector<AudioCorrelationInfo *> infos(children.count(), nullptr);
+    QVector<int> indexes(children.count());
+    for (int i = 0; i < indexes.count(); ++i) {
+        indexes[i] = i;
+    }
+    QtConcurrent::blockingMap(indexes, [&](const int &i) {
+        AudioEnvelope *envelope = children.at(i);
+        const int sizeSub = envelope->envelopeSize();
+        const qint64 *envSub = envelope->envelope();
+        AudioCorrelationInfo *info = new AudioCorrelationInfo(sizeMain, sizeSub);
+        if (sizeSub >= MinCoarseSize) {
+            if (!correlateCoarseToFine(*coarseReference, coarseMain.count(), &normalizedMain[0], sizeMain,
+                                       envSub, sizeSub, info->correlationVector())) {
+                delete info;
+                return;
+            }
+        } else if (sizeSub > 200) {
+            if (!reference->correlate(envSub, sizeSub, info->correlationVector())) {
+                delete info;
+                return;
+            }
+        } else {
+            qint64 max = 0;
+            correlate(envMain, sizeMain,
+                      envSub, sizeSub,
+                      info->correlationVector(),
+                      &max);
+            info->setMax(max);
+        }
+        info->setSubFrameShift(subFrameShift(main, envelope, envSub, info->maxIndex() - sizeSub));
+        infos[i] = info;
+    });
+
+    qCDebug(KDENLIVE_LOG) << "Correlated" << children.count() << "clips in" << t.elapsed() << "ms.";
+    return infos;
+}
+
+void AudioCorrelation::slotBatchFinished()
+{
+    const QVector<AudioCorrelationInfo *> infos = m_batchWatcher.result();
+    const QList<AudioEnvelope *> children = m_batchChildren;
+    m_batchChildren.clear();
+
+    QList<AudioAlignment> alignments;
+    for (int i = 0; i < children.count(); ++i) {
+        AudioEnvelope *envelope = children.at(i);
+        AudioCorrelationInfo *info = infos.at(i);
+        if (info == nullptr) {
+            emit displayMessage(i18n("Clips are too long for audio alignment."), ErrorMessage);
+            delete envelope;
+            continue;
+        }
+        if (info->confidence() < MinThumbnailConfidence && (envelope->usesThumbnail() || m_mainTrackEnvelope->usesThumbnail())) {
+            // The thumbnail levels are not precise enough, align again with the decoded clips
+            qCDebug(KDENLIVE_LOG) << "Low confidence" << info->confidence() << "with thumbnail envelopes, decoding the clips";
+            delete info;
+            envelope->decodeEnvelope();
+            m_mainTrackEnvelope->decodeEnvelope();
+            m_pendingChildren << envelope;
+            continue;
+        }
+        m_children.append(envelope);
+        m_correlations.append(info);
+
+        Q_ASSERT(m_correlations.size() == m_children.size());
+        AudioAlignment alignment;
+        alignment.track = envelope->track();
+        alignment.startPos = envelope->startPos();
+        alignment.preciseShift = getShift(m_children.count() - 1) + info->subFrameShift();
+        alignment.shift = qRound(alignment.preciseShift);
+        alignment.confidence = info->confidence();
+        alignments << alignment;
+        emit gotAudioAlignData(alignment.track, alignment.startPos, alignment.shift);
+    }
+    emit gotAudioAlignBatch(alignments);
 
-    if (sizeSub > 200) {
-        FFTCorrelation::correlate(envMain, sizeMain,
-                                  envSub, sizeSub,
-                                  correlation);
-    } else {
-        correlate(envMain, sizeMain,
-                  envSub, sizeSub,
-                  correlation,
-                  &max);
-        info->setMax(max);
-    }
-
-    m_children.append(envelope);
-    m_correlations.append(info);
-
-    Q_ASSERT(m_correlations.size() == m_children.size());
-    int index = m_children.indexOf(envelope);
-    int shift = getShift(index);
-    emit gotAudioAlignData(envelope->track(), envelope->startPos(), shift);
+    // Children added while the batch was running
+    startBatch();
 }
 
 int AudioCorrelation::getShift(int childIndex) const
@@ -14,7 +14,21 @@
 #include "audioCorrelationInfo.h"
 #include "audioEnvelope.h"
 #include "definitions.h"
+#include <QFutureWatcher>
 #include <QList>
+#include <QVector>
+
+/** Offset found for a clip by the audio alignment */
+struct AudioAlignment {
+    int track;
+    int startPos;
+    /** Frames to add to the start of the reference to get the start of the clip */
+    int shift;
+    /** Same as shift, with the fraction of a frame found by comparing the samples */
+    double preciseShift;
+    /** See AudioCorrelationInfo::confidence() */
+    double confidence;
+};
 
 /**
   This class does the correlation between two tracks
@@ -22,6 +36,18 @@
 
   It uses one main track (used in the initializer); further tracks will be
   aligned relative to this main track.
+
+  Children are aligned in batches: once the envelopes of the main track and
+  of all added children are loaded, the spectrum of the main track is computed
+  once and all children are correlated with it in parallel.
+
+  Long children are first correlated with decimated envelopes; the full
+  resolution correlation is then only computed around the best candidates.
+  Finally, the samples of a few frames around the best match are compared
+  to find the offset with sample accuracy.
+
+  Envelopes computed from the audio thumbnails are used first; a child is only
+  aligned again on decoded envelopes when the match is uncertain.
   */
 class AudioCorrelation : public QObject
 {
@@ -35,6 +61,11 @@ public:
       This object will take ownership of the passed envelope.
       */
     void addChild(AudioEnvelope *envelope);
+    /**
+      Aligns several children in one batch, reported with gotAudioAlignBatch().
+      This object will take ownership of the passed envelopes.
+      */
+    void addChildren(const QList<AudioEnvelope *> &envelopes);
 
     const AudioCorrelationInfo *info(int childIndex) const;
     int getShift(int childIndex) const;
@@ -53,12 +84,26 @@ private:
     QList<AudioEnvelope *> m_children;
     QList<AudioCorrelationInfo *> m_correlations;
 
+    /** Children waiting for their envelope or for the running batch */
+    QList<AudioEnvelope *> m_pendingChildren;
+    /** Children of the running batch */
+    QList<AudioEnvelope *> m_batchChildren;
+    QFutureWatcher<QVector<AudioCorrelationInfo *> > m_batchWatcher;
+
+    /** Starts correlating the pending children if all envelopes are loaded */
+    void startBatch();
+    /** Correlates the children with the main envelope, in a separate thread */
+    static QVector<AudioCorrelationInfo *> correlateBatch(AudioEnvelope *main, const QList<AudioEnvelope *> &children);
+
 private slots:
-    void slotProcessChild(AudioEnvelope *envelope);
     void slotAnnounceEnvelope();
+    void slotChildReady();
+    void slotBatchFinished();
 
 signals:
     void gotAudioAlignData(int, int, int);
+    /** All offsets of a batch, in the order the children were added */
+    void gotAudioAlignBatch(const QList<AudioAlignment> &alignments);
     void displayMessage(const QString &, MessageType);
 };
 
@@ -13,7 +13,8 @@
 AudioCorrelationInfo::AudioCorrelationInfo(int mainSize, int subSize) :
     m_mainSize(mainSize),
     m_subSize(subSize),
-    m_max(-1)
+    m_max(-1),
+    m_subFrameShift(0)
 {
     m_correlationVector = new qint64[m_mainSize + m_subSize + 1];
 }
@@ -49,6 +50,16 @@ qint64 AudioCorrelationInfo::max() const
     return m_max;
 }
 
+double AudioCorrelationInfo::subFrameShift() const
+{
+    return m_subFrameShift;
+}
+
+void AudioCorrelationInfo::setSubFrameShift(double shift)
+{
+    m_subFrameShift = shift;
+}
+
 int AudioCorrelationInfo::maxIndex() const
 {
     qint64 max = 0;
@@ -65,6 +76,23 @@ int AudioCorrelationInfo::maxIndex() const
     return index;
 }
 
+double AudioCorrelationInfo::confidence() const
+{
+    const int index = maxIndex();
+    const qint64 max = m_correlationVector[index];
+    if (max <= 0) {
+        return 0;
+    }
+    qint64 second = 0;
+    int width = size();
+    for (int i = 0; i < width; ++i) {
+        if (qAbs(i - index) >= MinPeakDistance && m_correlationVector[i] > second) {
+            second = m_correlationVector[i];
+        }
+    }
+    return 1 - double(second) / max;
+}
+
 qint64 *AudioCorrelationInfo::correlationVector()
 {
     return m_correlationVector;
@@ -42,6 +42,22 @@ public:
       */
     int maxIndex() const;
 
+    /**
+      Returns how much the best match stands out, from 0 when another shift
+      matches as well to 1 when no other shift matches at all. The largest value
+      is compared to the largest one at least MinPeakDistance entries away.
+      */
+    double confidence() const;
+
+    static const int MinPeakDistance = 12;
+
+    /**
+      Fraction of a frame to add to the shift given by maxIndex(), found by
+      correlating the samples around the best match. 0 if it was not computed.
+      */
+    double subFrameShift() const;
+    void setSubFrameShift(double shift);
+
     QImage toImage(int height = 400) const;
 
 private:
@@ -50,6 +66,7 @@ private:
 
     qint64 *m_correlationVector;
     qint64 m_max;
+    double m_subFrameShift;
 
 };
 
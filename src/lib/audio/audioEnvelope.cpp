@@ -13,10 +13,25 @@
 #include "audioStreamInfo.h"
 #include "kdenlive_debug.h"
 #include <QImage>
+#include <QScopedPointer>
+#include <QThread>
 #include <QTime>
 #include <QtConcurrent>
 #include <cmath>
 
+namespace {
+// Shorter segments are not worth opening another decoder
+const int MinSegmentFrames = 500;
+const int MaxSegments = 8;
+
+struct Segment {
+    Mlt::Producer *producer;
+    int first;
+    int end;
+    qint64 max;
+};
+}
+
 AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int offset, int length, int track, int startPos) :
     m_envelope(nullptr),
     m_offset(offset),
@@ -28,13 +43,16 @@ AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int of
     m_envelopeMean(0),
     m_envelopeStdDev(0),
     m_envelopeStdDevCalculated(false),
-    m_envelopeIsNormalized(false)
+    m_envelopeIsNormalized(false),
+    m_thumbnailChannels(0),
+    m_usesThumbnail(false)
 {
     // make a copy of the producer to avoid audio playback issues
     QString path = QString::fromUtf8(producer->get("resource"));
     if (path == QLatin1String("<playlist>") || path == QLatin1String("<tractor>") || path == QLatin1String("<producer>")) {
         path = url;
     }
+    m_path = path;
     m_producer = new Mlt::Producer(*(producer->profile()), path.toUtf8().constData());
     connect(&m_watcher, &QFutureWatcherBase::finished, this, &AudioEnvelope::slotProcessEnveloppe);
     if (!m_producer || !m_producer->is_valid()) {
@@ -51,6 +69,8 @@ AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int of
 
 AudioEnvelope::~AudioEnvelope()
 {
+    // The envelope is written by the loading thread
+    m_future.waitForFinished();
     if (m_envelope != nullptr) {
         delete[] m_envelope;
     }
@@ -76,50 +96,115 @@ void AudioEnvelope::loadEnvelope()
 
     qCDebug(KDENLIVE_LOG) << "Loading envelope ...";
 
-    int samplingRate = m_info->info(0)->samplingRate();
-    mlt_audio_format format_s16 = mlt_audio_s16;
-    int channels = 1;
-
     m_envelope = new qint64[m_envelopeSize];
     m_envelopeMax = 0;
     m_envelopeMean = 0;
 
     QTime t;
     t.start();
-    int count = 0;
-    m_producer->seek(m_offset);
-    m_producer->set_speed(1.0); // This is necessary, otherwise we don't get any new frames in the 2nd run.
+
+    if (!m_thumbnailLevels.isEmpty()) {
+        m_usesThumbnail = loadThumbnailLevels();
+        if (m_usesThumbnail) {
+            qCDebug(KDENLIVE_LOG) << "Envelope (" << m_envelopeSize << " frames) read from the audio thumbnail in" << t.elapsed() << " ms.";
+            return;
+        }
+        qCDebug(KDENLIVE_LOG) << "Audio thumbnail too short for the envelope, decoding the clip";
+    }
+
+    // Each segment gets its own decoder, the first one uses m_producer
+    const int segmentCount = qBound(1, qMin(QThread::idealThreadCount(), m_envelopeSize / MinSegmentFrames), MaxSegments);
+    QVector<Segment> segments(segmentCount);
+    QList<Mlt::Producer *> producers;
+    for (int i = 0; i < segmentCount; ++i) {
+        Segment &segment = segments[i];
+        segment.first = (qint64) m_envelopeSize * i / segmentCount;
+        segment.end = (qint64) m_envelopeSize * (i + 1) / segmentCount;
+        segment.max = 0;
+        segment.producer = m_producer;
+        if (i > 0) {
+            Mlt::Producer *producer = new Mlt::Producer(*(m_producer->profile()), m_path.toUtf8().constData());
+            if (producer->is_valid()) {
+                segment.producer = producer;
+                producers << producer;
+            } else {
+                delete producer;
+            }
+        }
+    }
+    if (producers.count() < segmentCount - 1) {
+        // Could not open the clip again, read it in one pass
+        qDeleteAll(producers);
+        producers.clear();
+        segments.resize(1);
+        segments[0].end = m_envelopeSize;
+    }
+    QtConcurrent::blockingMap(segments, [this](Segment &segment) {
+        segment.max = loadSegment(segment.producer, segment.first, segment.end);
+    });
+    qDeleteAll(producers);
+
+    for (int i = 0; i < segments.count(); ++i) {
+        m_envelopeMax = qMax(m_envelopeMax, segments.at(i).max);
+    }
     for (int i = 0; i < m_envelopeSize; ++i) {
-        Mlt::Frame *frame = m_producer->get_frame(i);
+        m_envelopeMean += m_envelope[i];
+    }
+    if (m_envelopeSize > 0) {
+        m_envelopeMean /= m_envelopeSize;
+    }
+    qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames," << segments.count() << "segments) took "
+                          << t.elapsed() << " ms.";
+}
+
+bool AudioEnvelope::loadThumbnailLevels()
+{
+    const int channels = m_thumbnailChannels;
+    if ((qint64)(m_offset + m_envelopeSize) * channels > m_thumbnailLevels.count()) {
+        return false;
+    }
+    for (int i = 0; i < m_envelopeSize; ++i) {
+        double sum = 0;
+        for (int channel = 0; channel < channels; ++channel) {
+            sum += m_thumbnailLevels.at((m_offset + i) * channels + channel).toDouble();
+        }
+        // Levels are 0 to 256, keep their fraction
+        m_envelope[i] = qRound64(sum * 256);
+        m_envelopeMax = qMax(m_envelopeMax, m_envelope[i]);
+        m_envelopeMean += m_envelope[i];
+    }
+    if (m_envelopeSize > 0) {
+        m_envelopeMean /= m_envelopeSize;
+    }
+    return true;
+}
+
+qint64 AudioEnvelope::loadSegment(Mlt::Producer *producer, int first, int end)
+{
+    int samplingRate = m_info->info(0)->samplingRate();
+    mlt_audio_format format_s16 = mlt_audio_s16;
+    int channels = 1;
+    qint64 max = 0;
+
+    producer->seek(m_offset + first);
+    producer->set_speed(1.0); // This is necessary, otherwise we don't get any new frames in the 2nd run.
+    for (int i = first; i < end; ++i) {
+        QScopedPointer<Mlt::Frame> frame(producer->get_frame(i));
         qint64 position = mlt_frame_get_position(frame->get_frame());
-        int samples = mlt_sample_calculator(m_producer->get_fps(), samplingRate, position);
+        int samples = mlt_sample_calculator(producer->get_fps(), samplingRate, position);
 
         qint16 *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
 
         qint64 sum = 0;
-        for (int k = 0; k < samples; ++k) {
+        for (int k = 0; data && k < samples; ++k) {
             sum += abs(data[k]);
         }
         m_envelope[i] = sum;
-
-        m_envelopeMean += sum;
-        if (sum > m_envelopeMax) {
-            m_envelopeMax = sum;
-        }
-
-//        qCDebug(KDENLIVE_LOG) << position << '|' << m_producer->get_playtime()
-//                  << '-' << m_producer->get_in() << '+' << m_producer->get_out() << ' ';
-
-        delete frame;
-
-        count++;
-        if (m_length > 0 && count > m_length) {
-            break;
+        if (sum > max) {
+            max = sum;
         }
     }
-    m_envelopeMean /= m_envelopeSize;
-    qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames) took "
-                          << t.elapsed() << " ms.";
+    return max;
 }
 
 int AudioEnvelope::track() const
@@ -132,6 +217,83 @@ int AudioEnvelope::startPos() const
     return m_startpos;
 }
 
+bool AudioEnvelope::isReady() const
+{
+    return m_envelopeIsNormalized;
+}
+
+void AudioEnvelope::setThumbnailLevels(const QVariantList &levels, int channels)
+{
+    Q_ASSERT(m_envelope == nullptr);
+    // Same default as the audio thumbnail creation
+    m_thumbnailChannels = channels > 0 ? channels : 2;
+    m_thumbnailLevels = levels;
+}
+
+bool AudioEnvelope::usesThumbnail() const
+{
+    return m_usesThumbnail;
+}
+
+void AudioEnvelope::decodeEnvelope()
+{
+    if (!m_usesThumbnail || m_future.isRunning()) {
+        return;
+    }
+    m_thumbnailLevels.clear();
+    m_usesThumbnail = false;
+    delete[] m_envelope;
+    m_envelope = nullptr;
+    m_envelopeIsNormalized = false;
+    normalizeEnvelope();
+}
+
+int AudioEnvelope::samplingRate() const
+{
+    if (m_info->size() == 0) {
+        return 0;
+    }
+    return m_info->info(0)->samplingRate();
+}
+
+double AudioEnvelope::fps() const
+{
+    return m_producer->get_fps();
+}
+
+QVector<qint64> AudioEnvelope::loadSamples(int first, int count, int samplingRate, int *firstFrameSamples) const
+{
+    QVector<qint64> samples;
+    if (first < 0 || count <= 0 || first + count > m_envelopeSize || samplingRate <= 0) {
+        return samples;
+    }
+    // m_producer may be in use by the envelope thread
+    Mlt::Producer producer(*(m_producer->profile()), m_path.toUtf8().constData());
+    if (!producer.is_valid()) {
+        return samples;
+    }
+    mlt_audio_format format_s16 = mlt_audio_s16;
+    int channels = 1;
+
+    producer.seek(m_offset + first);
+    producer.set_speed(1.0);
+    for (int i = first; i < first + count; ++i) {
+        QScopedPointer<Mlt::Frame> frame(producer.get_frame(i));
+        qint64 position = mlt_frame_get_position(frame->get_frame());
+        int frequency = samplingRate;
+        int frameSamples = mlt_sample_calculator(producer.get_fps(), samplingRate, position);
+
+        qint16 *data = static_cast<qint16 *>(frame->get_audio(format_s16, frequency, channels, frameSamples));
+        if (i == first && firstFrameSamples != nullptr) {
+            *firstFrameSamples = frameSamples;
+        }
+        for (int k = 0; k < frameSamples; ++k) {
+            samples << (data ? data[k] : 0);
+        }
+    }
+    return samples;
+}
+
 void AudioEnvelope::normalizeEnvelope(bool /*clampTo0*/)
 {
     if (m_envelope == nullptr && !m_future.isRunning()) {
@@ -16,6 +16,8 @@
 
 #include <QFutureWatcher>
 #include <QObject>
+#include <QVariantList>
+#include <QVector>
 
 class QImage;
 
@@ -24,6 +26,10 @@ class QImage;
   with frame resolution. One entry is calculated by the sum
   of the absolute values of all samples in the current frame.
 
+  Long clips are split in segments that are decoded in parallel,
+  each by its own producer. When the levels of the audio thumbnail
+  are available, they are used instead and the clip is not decoded.
+
   See also: http://bemasc.net/wordpress/2011/07/26/an-auto-aligner-for-pitivi/
   */
 class AudioEnvelope : public QObject
@@ -47,10 +53,40 @@ public:
 
     int track() const;
     int startPos() const;
+    /** Returns true once the envelope was loaded and normalized, see envelopeReady() */
+    bool isReady() const;
+
+    /**
+      Computes the envelope from the per frame levels of the audio thumbnail
+      (see ProjectClip::audioFrameCache) instead of decoding the clip.
+      Must be called before normalizeEnvelope().
+      */
+    void setThumbnailLevels(const QVariantList &levels, int channels);
+    /** Returns true if the envelope was computed from the audio thumbnail */
+    bool usesThumbnail() const;
+    /**
+      Discards an envelope computed from the audio thumbnail and decodes the
+      clip instead, for a more precise envelope. envelopeReady() is emitted again.
+      */
+    void decodeEnvelope();
+
+    /** Sampling rate of the first audio stream, or 0 if there is none */
+    int samplingRate() const;
+    /** Frames per second of the producer */
+    double fps() const;
+    /**
+      Decodes the mono samples of the envelope entries [first, first + count[.
+      A separate producer is used, so it can be called from any thread.
+      \param firstFrameSamples receives the number of samples of the first entry
+      \return the samples, or an empty vector on failure
+      */
+    QVector<qint64> loadSamples(int first, int count, int samplingRate, int *firstFrameSamples = nullptr) const;
 
 private:
     qint64 *m_envelope;
     Mlt::Producer *m_producer;
+    /** Resource of m_producer, opened again for each segment */
+    QString m_path;
     AudioInfo *m_info;
     QFutureWatcher<void> m_watcher;
     QFuture<void> m_future;
@@ -68,6 +104,17 @@ private:
     bool m_envelopeStdDevCalculated;
     bool m_envelopeIsNormalized;
 
+    /** Levels of the audio thumbnail, channels values per frame of the clip */
+    QVariantList m_thumbnailLevels;
+    int m_thumbnailChannels;
+    bool m_usesThumbnail;
+
+    /** Fills the envelope from m_thumbnailLevels, returns false if they do not cover the clip */
+    bool loadThumbnailLevels();
+
+    /** Sums the samples of the envelope entries [first, end[ read with producer, and returns their maximum */
+    qint64 loadSegment(Mlt::Producer *producer, int first, int end);
+
 private slots:
     void slotProcessEnveloppe();
 
@@ -16,16 +16,57 @@ extern "C"
 }
 
 #include "kdenlive_debug.h"
+#include <QMutexLocker>
 #include <QTime>
 #include <algorithm>
-#include <vector>
 
-void FFTCorrelation::correlate(const qint64 *left, const int leftSize,
+void FFTCorrelation::normalize(const qint64 *values, const int size, float *out, bool reverse)
+{
+    // Dividing by the max value is maybe not the best solution, but the
+    // maximum value after correlation should not be larger than the longest
+    // vector since each value should be at most 1
+    qint64 max = 1;
+    for (int i = 0; i < size; ++i) {
+        if (labs(values[i]) > max) {
+            max = labs(values[i]);
+        }
+    }
+    for (int i = 0; i < size; ++i) {
+        out[reverse ? size - 1 - i : i] = double(values[i]) / max;
+    }
+}
+
+int FFTCorrelation::fftSize(const int leftSize, const int rightSize)
+{
+    // To avoid issues with repetition (we are dealing with cosine waves
+    // in the fourier domain) we need to pad the vectors to at least twice their size,
+    // otherwise convolution would convolve with the repeated pattern as well
+    const int largestSize = std::max(leftSize, rightSize);
+
+    // The vectors must have the same size (same frequency resolution!) and should
+    // be a power of 2 (for FFT).
+    int size = 64;
+    while (size / 2 < largestSize && size <= MaxFFTSize) {
+        size = size << 1;
+    }
+    return size;
+}
+
+bool FFTCorrelation::canConvolve(const int leftSize, const int rightSize)
+{
+    return fftSize(leftSize, rightSize) <= MaxFFTSize;
+}
+
+bool FFTCorrelation::correlate(const qint64 *left, const int leftSize,
                                const qint64 *right, const int rightSize,
                                qint64 *out_correlated)
 {
-    float correlatedFloat[leftSize + rightSize + 1];
-    correlate(left, leftSize, right, rightSize, correlatedFloat);
+    if (!canConvolve(leftSize, rightSize)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot correlate vectors of" << leftSize << "and" << rightSize << "entries, the limit is" << MaxFFTSize / 2;
+        return false;
+    }
+    std::vector<float> correlatedFloat(leftSize + rightSize + 1);
+    correlate(left, leftSize, right, rightSize, &correlatedFloat[0]);
 
     // The correlation vector will have entries up to N (number of entries
     // of the vector), so converting to integers will not lose that much
@@ -33,82 +74,58 @@ void FFTCorrelation::correlate(const qint64 *left, const int leftSize,
     for (int i = 0; i < leftSize + rightSize + 1; ++i) {
         out_correlated[i] = correlatedFloat[i];
     }
+    return true;
 }
 
-void FFTCorrelation::correlate(const qint64 *left, const int leftSize,
+bool FFTCorrelation::correlate(const qint64 *left, const int leftSize,
                                const qint64 *right, const int rightSize,
                                float *out_correlated)
 {
+    if (!canConvolve(leftSize, rightSize)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot correlate vectors of" << leftSize << "and" << rightSize << "entries, the limit is" << MaxFFTSize / 2;
+        return false;
+    }
     QTime t;
     t.start();
 
-    float leftF[leftSize];
-    float rightF[rightSize];
-
-    // First the qint64 values need to be normalized to floats
-    // Dividing by the max value is maybe not the best solution, but the
-    // maximum value after correlation should not be larger than the longest
-    // vector since each value should be at most 1
-    qint64 maxLeft = 1;
-    qint64 maxRight = 1;
-    for (int i = 0; i < leftSize; ++i) {
-        if (labs(left[i]) > maxLeft) {
-            maxLeft = labs(left[i]);
-        }
-    }
-    for (int i = 0; i < rightSize; ++i) {
-        if (labs(right[i]) > maxRight) {
-            maxRight = labs(right[i]);
-        }
-    }
+    // Long clips do not fit on the stack
+    std::vector<float> leftF(leftSize);
+    std::vector<float> rightF(rightSize);
 
+    // First the qint64 values need to be normalized to floats.
     // One side needs to be reversed, since multiplication in frequency domain (fourier space)
     // calculates the convolution: \sum l[x]r[N-x] and not the correlation: \sum l[x]r[x]
-    for (int i = 0; i < leftSize; ++i) {
-        leftF[i] = double(left[i]) / maxLeft;
-    }
-    for (int i = 0; i < rightSize; ++i) {
-        rightF[rightSize - 1 - i] = double(right[i]) / maxRight;
-    }
+    normalize(left, leftSize, &leftF[0], false);
+    normalize(right, rightSize, &rightF[0], true);
 
     // Now we can convolve to get the correlation
-    convolve(leftF, leftSize, rightF, rightSize, out_correlated);
+    convolve(&leftF[0], leftSize, &rightF[0], rightSize, out_correlated);
 
     qCDebug(KDENLIVE_LOG) << "Correlation (FFT based) computed in " << t.elapsed() << " ms.";
+    return true;
 }
 
-void FFTCorrelation::convolve(const float *left, const int leftSize,
+bool FFTCorrelation::convolve(const float *left, const int leftSize,
                               const float *right, const int rightSize,
                               float *out_convolved)
 {
+    const int size = fftSize(leftSize, rightSize);
+    if (size > MaxFFTSize) {
+        qCWarning(KDENLIVE_LOG) << "Cannot convolve vectors of" << leftSize << "and" << rightSize << "entries, the limit is" << MaxFFTSize / 2;
+        return false;
+    }
     QTime time;
     time.start();
 
-    // To avoid issues with repetition (we are dealing with cosine waves
-    // in the fourier domain) we need to pad the vectors to at least twice their size,
-    // otherwise convolution would convolve with the repeated pattern as well
-    int largestSize = leftSize;
-    if (rightSize > largestSize) {
-        largestSize = rightSize;
-    }
-
-    // The vectors must have the same size (same frequency resolution!) and should
-    // be a power of 2 (for FFT).
-    int size = 64;
-    while (size / 2 < largestSize) {
-        size = size << 1;
-    }
     const int fft_size = size / 2 + 1;
     kiss_fftr_cfg fftConfig = kiss_fftr_alloc(size, false, nullptr, nullptr);
     kiss_fftr_cfg ifftConfig = kiss_fftr_alloc(size, true, nullptr, nullptr);
     std::vector<kiss_fft_cpx> leftFFT(fft_size);
     std::vector<kiss_fft_cpx> rightFFT(fft_size);
-    std::vector<kiss_fft_cpx> correlatedFFT(fft_size);
 
     // Fill in the data into our new vectors with padding
     std::vector<float> leftData(size, 0);
     std::vector<float> rightData(size, 0);
-    std::vector<float> convolved(size);
 
     std::copy(left, left + leftSize, leftData.begin());
     std::copy(right, right + rightSize, rightData.begin());
@@ -118,9 +135,11 @@ void FFTCorrelation::convolve(const float *left, const int leftSize,
     kiss_fftr(fftConfig, &rightData[0], &rightFFT[0]);
 
     // Convolution in spacial domain is a multiplication in fourier domain. O(n).
-    for (int i = 0; i < correlatedFFT.size(); ++i) {
-        correlatedFFT[i].r = leftFFT[i].r * rightFFT[i].r - leftFFT[i].i * rightFFT[i].i;
-        correlatedFFT[i].i = leftFFT[i].r * rightFFT[i].i + leftFFT[i].i * rightFFT[i].r;
+    // The product replaces the left spectrum to save memory.
+    for (int i = 0; i < fft_size; ++i) {
+        const kiss_fft_cpx l = leftFFT[i];
+        leftFFT[i].r = l.r * rightFFT[i].r - l.i * rightFFT[i].i;
+        leftFFT[i].i = l.r * rightFFT[i].i + l.i * rightFFT[i].r;
     }
 
     // Inverse fourier tranformation to get the convolved data.
@@ -129,12 +148,100 @@ void FFTCorrelation::convolve(const float *left, const int leftSize,
     *out_convolved = 0;
     int out_size = leftSize + rightSize + 1;
 
-    kiss_fftri(ifftConfig, &correlatedFFT[0], &convolved[0]);
-    std::copy(convolved.begin(), convolved.begin() + out_size - 1, out_convolved + 1);
+    // The left data is not needed anymore, it receives the convolution
+    kiss_fftri(ifftConfig, &leftFFT[0], &leftData[0]);
+    std::copy(leftData.begin(), leftData.begin() + out_size - 1, out_convolved + 1);
 
     // Finally some cleanup.
     kiss_fftr_free(fftConfig);
     kiss_fftr_free(ifftConfig);
 
     qCDebug(KDENLIVE_LOG) << "FFT convolution computed. Time taken: " << time.elapsed() << " ms";
+    return true;
+}
+
+FFTCorrelationReference::FFTCorrelationReference(const qint64 *reference, const int size, const int maxOtherSize) :
+    m_size(size),
+    m_maxOtherSize(maxOtherSize),
+    m_fftSize(FFTCorrelation::fftSize(size, maxOtherSize))
+{
+    if (!isValid()) {
+        qCWarning(KDENLIVE_LOG) << "Cannot correlate vectors with" << size << "entries, the limit is" << FFTCorrelation::MaxFFTSize / 2;
+        return;
+    }
+    QTime t;
+    t.start();
+
+    std::vector<float> data(m_fftSize, 0);
+    FFTCorrelation::normalize(reference, size, &data[0]);
+    m_spectrum.resize(m_fftSize / 2 + 1);
+    Configs configs = acquireConfigs();
+    kiss_fftr(configs.forward, &data[0], &m_spectrum[0]);
+    releaseConfigs(configs);
+
+    qCDebug(KDENLIVE_LOG) << "Reference spectrum computed in " << t.elapsed() << " ms.";
+}
+
+FFTCorrelationReference::~FFTCorrelationReference()
+{
+    foreach (const Configs &configs, m_freeConfigs) {
+        kiss_fftr_free(configs.forward);
+        kiss_fftr_free(configs.inverse);
+    }
+}
+
+bool FFTCorrelationReference::isValid() const
+{
+    return m_fftSize <= FFTCorrelation::MaxFFTSize;
+}
+
+FFTCorrelationReference::Configs FFTCorrelationReference::acquireConfigs() const
+{
+    QMutexLocker lock(&m_configsMutex);
+    if (!m_freeConfigs.isEmpty()) {
+        return m_freeConfigs.takeLast();
+    }
+    Configs configs;
+    configs.forward = kiss_fftr_alloc(m_fftSize, false, nullptr, nullptr);
+    configs.inverse = kiss_fftr_alloc(m_fftSize, true, nullptr, nullptr);
+    return configs;
+}
+
+void FFTCorrelationReference::releaseConfigs(const Configs &configs) const
+{
+    QMutexLocker lock(&m_configsMutex);
+    m_freeConfigs << configs;
+}
+
+bool FFTCorrelationReference::correlate(const qint64 *other, const int otherSize, qint64 *out_correlated) const
+{
+    if (!isValid() || otherSize > m_maxOtherSize) {
+        return false;
+    }
+    QTime t;
+    t.start();
+
+    // The other vector is reversed, see FFTCorrelation::correlate()
+    std::vector<float> data(m_fftSize, 0);
+    FFTCorrelation::normalize(other, otherSize, &data[0], true);
+    std::vector<kiss_fft_cpx> spectrum(m_fftSize / 2 + 1);
+
+    Configs configs = acquireConfigs();
+    kiss_fftr(configs.forward, &data[0], &spectrum[0]);
+    for (int i = 0; i < (int) spectrum.size(); ++i) {
+        const kiss_fft_cpx o = spectrum[i];
+        spectrum[i].r = m_spectrum[i].r * o.r - m_spectrum[i].i * o.i;
+        spectrum[i].i = m_spectrum[i].r * o.i + m_spectrum[i].i * o.r;
+    }
+    kiss_fftri(configs.inverse, &spectrum[0], &data[0]);
+    releaseConfigs(configs);
+
+    // Same layout as FFTCorrelation::convolve(), with one element inserted at the beginning
+    out_correlated[0] = 0;
+    for (int i = 0; i < m_size + otherSize; ++i) {
+        out_correlated[i + 1] = data[i];
+    }
+
+    qCDebug(KDENLIVE_LOG) << "Correlation with reference computed in " << t.elapsed() << " ms.";
+    return true;
 }
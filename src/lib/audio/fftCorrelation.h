@@ -11,7 +11,13 @@ the Free Software Foundation, either version 3 of the License, or
 #ifndef FFTCORRELATION_H
 #define FFTCORRELATION_H
 
+#include "../external/kiss_fft/tools/kiss_fftr.h"
+
+#include <QList>
+#include <QMutex>
 #include <QtGlobal>
+#include <vector>
+
 /**
   This class provides methods to calculate convolution
   and correlation of two vectors by means of FFT, which
@@ -21,13 +27,27 @@ the Free Software Foundation, either version 3 of the License, or
 class FFTCorrelation
 {
 public:
+    /**
+      Largest number of entries of the padded vectors. The work buffers
+      hold about 6 floats per entry, so this limits the memory used by a
+      correlation to about 100 MB. It allows to correlate vectors of up to
+      half this size, which is over 20 hours at 25 frames per second.
+      */
+    static const int MaxFFTSize = 1 << 22;
+
+    /**
+      Returns false if vectors of these sizes cannot be convolved,
+      because the FFT would be larger than MaxFFTSize.
+      */
+    static bool canConvolve(const int leftSize, const int rightSize);
 
     /**
       Computes the convolution between \c left and \c right.
       \c out_correlated must be a pre-allocated vector of size
       \c leftSize + \c rightSize + 1.
+      \return false, leaving \c out_convolved untouched, if the vectors are too long
       */
-    static void convolve(const float *left, const int leftSize,
+    static bool convolve(const float *left, const int leftSize,
                          const float *right, const int rightSize,
                          float *out_convolved);
 
@@ -35,14 +55,66 @@ public:
       Computes the correlation between \c left and \c right.
       \c out_correlated must be a pre-allocated vector of size
       \c leftSize + \c rightSize + 1.
+      \return false, leaving \c out_correlated untouched, if the vectors are too long
       */
-    static void correlate(const qint64 *left, const int leftSize,
+    static bool correlate(const qint64 *left, const int leftSize,
                           const qint64 *right, const int rightSize,
                           float *out_correlated);
 
-    static void correlate(const qint64 *left, const int leftSize,
+    static bool correlate(const qint64 *left, const int leftSize,
                           const qint64 *right, const int rightSize,
                           qint64 *out_correlated);
+
+    /** Size of the padded vectors used to convolve vectors of these sizes */
+    static int fftSize(const int leftSize, const int rightSize);
+
+    /**
+      Normalizes the values to [-1, 1] by dividing them by the largest absolute value,
+      as done before correlating them. \c reverse writes them in reverse order.
+      */
+    static void normalize(const qint64 *values, const int size, float *out, bool reverse = false);
+};
+
+/**
+  The spectrum of a vector, computed once to correlate several vectors
+  with it. correlate() can be called from several threads at once.
+  */
+class FFTCorrelationReference
+{
+public:
+    /**
+      \c maxOtherSize is the size of the longest vector that will be
+      correlated with the reference.
+      */
+    FFTCorrelationReference(const qint64 *reference, const int size, const int maxOtherSize);
+    ~FFTCorrelationReference();
+
+    /** False if the vectors are too long, see FFTCorrelation::MaxFFTSize */
+    bool isValid() const;
+
+    /**
+      Same as FFTCorrelation::correlate(reference, size, other, otherSize, out_correlated),
+      without transforming the reference again.
+      \c other must not be longer than the \c maxOtherSize given to the constructor.
+      */
+    bool correlate(const qint64 *other, const int otherSize, qint64 *out_correlated) const;
+
+private:
+    struct Configs {
+        kiss_fftr_cfg forward;
+        kiss_fftr_cfg inverse;
+    };
+
+    int m_size;
+    int m_maxOtherSize;
+    int m_fftSize;
+    std::vector<kiss_fft_cpx> m_spectrum;
+
+    /** kiss_fft configurations are not reentrant, each running correlation takes one */
+    mutable QMutex m_configsMutex;
+    mutable QList<Configs> m_freeConfigs;
+    Configs acquireConfigs() const;
+    void releaseConfigs(const Configs &configs) const;
 };
 
 #endif // FFTCORRELATION_H
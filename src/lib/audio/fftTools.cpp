@@ -11,9 +11,7 @@
 #include "fftTools.h"
 
 #include <math.h>
-#include <iostream>
-
-#include <QString>
+#include <algorithm>
 
 // Uncomment for debugging, like writing a GNU Octave .m file to /tmp
 //#define DEBUG_FFTTOOLS
@@ -21,29 +19,132 @@
 #ifdef DEBUG_FFTTOOLS
 #include "kdenlive_debug.h"
 #include <QTime>
-#include <fstream>
 #endif
 
-FFTTools::FFTTools() :
-    m_fftCfgs(),
-    m_windowFunctions()
+#if (defined(__SSE2__) || defined(_M_X64)) && !defined(FIXED_POINT) && !defined(USE_SIMD)
+#include <emmintrin.h>
+#define FFTTOOLS_SSE2
+#endif
+
+namespace {
+// Converts one channel of interleaved samples to float, multiplied by the window
+void windowScalar(const qint16 *samples, int count, int channel, int numChannels, const float *window, float *data)
 {
+    const qint16 *in = samples + channel;
+    for (int i = 0; i < count; ++i) {
+        data[i] = in[i * numChannels] * window[i];
+    }
 }
-FFTTools::~FFTTools()
+
+// 10 * log10(r² + i²) + offset for each bin
+void logPowerScalar(const kiss_fft_cpx *freq, int count, float offset, float *db)
 {
-    QHash<QString, kiss_fftr_cfg>::iterator i;
-    for (i = m_fftCfgs.begin(); i != m_fftCfgs.end(); ++i) {
-        free(*i);
+    for (int i = 0; i < count; ++i) {
+        db[i] = 10 * log10f(freq[i].r * freq[i].r + freq[i].i * freq[i].i) + offset;
+    }
+}
+
+#ifdef FFTTOOLS_SSE2
+void windowSse2(const qint16 *samples, int count, int channel, int numChannels, const float *window, float *data)
+{
+    int i = 0;
+    if (numChannels == 1) {
+        for (; i + 8 <= count; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+            // Sign extend the samples to 32 bits
+            const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(data + i, _mm_mul_ps(_mm_cvtepi32_ps(low), _mm_loadu_ps(window + i)));
+            _mm_storeu_ps(data + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), _mm_loadu_ps(window + i + 4)));
+        }
+    } else if (numChannels == 2) {
+        for (; i + 4 <= count; i += 4) {
+            // Each 32 bit lane holds a stereo sample, with the first channel in the low half
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + 2 * i));
+            const __m128i values = channel == 0 ? _mm_srai_epi32(_mm_slli_epi32(v, 16), 16) : _mm_srai_epi32(v, 16);
+            _mm_storeu_ps(data + i, _mm_mul_ps(_mm_cvtepi32_ps(values), _mm_loadu_ps(window + i)));
+        }
+    }
+    windowScalar(samples + i * numChannels, count - i, channel, numChannels, window + i, data + i);
+}
+
+// Natural logarithm of positive normal floats
+inline __m128 lnSse2(__m128 x)
+{
+    const __m128i bits = _mm_castps_si128(x);
+    __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+    // Bring the mantissa to [sqrt(1/2), sqrt(2)[ for a fast converging series
+    const __m128 above = _mm_cmpge_ps(m, _mm_set1_ps(1.41421356f));
+    m = _mm_mul_ps(m, _mm_or_ps(_mm_and_ps(above, _mm_set1_ps(.5f)), _mm_andnot_ps(above, _mm_set1_ps(1.f))));
+    exponent = _mm_add_ps(exponent, _mm_and_ps(above, _mm_set1_ps(1.f)));
+    // ln(m) = 2 atanh(z) with z = (m - 1) / (m + 1), |z| < 0.172
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 z = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+    const __m128 z2 = _mm_mul_ps(z, z);
+    __m128 series = _mm_set1_ps(1.f / 9);
+    series = _mm_add_ps(_mm_mul_ps(series, z2), _mm_set1_ps(1.f / 7));
+    series = _mm_add_ps(_mm_mul_ps(series, z2), _mm_set1_ps(1.f / 5));
+    series = _mm_add_ps(_mm_mul_ps(series, z2), _mm_set1_ps(1.f / 3));
+    series = _mm_add_ps(_mm_mul_ps(series, z2), one);
+    series = _mm_mul_ps(_mm_mul_ps(series, z), _mm_set1_ps(2.f));
+    return _mm_add_ps(_mm_mul_ps(exponent, _mm_set1_ps(0.693147181f)), series);
+}
+
+void logPowerSse2(const kiss_fft_cpx *freq, int count, float offset, float *db)
+{
+    const float *values = reinterpret_cast<const float *>(freq);
+    // 10 / ln(10)
+    const __m128 factor = _mm_set1_ps(4.34294482f);
+    const __m128 offsets = _mm_set1_ps(offset);
+    const __m128 minusInfinity = _mm_set1_ps(-INFINITY);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 a = _mm_loadu_ps(values + 2 * i);
+        const __m128 b = _mm_loadu_ps(values + 2 * i + 4);
+        const __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m128 power = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        const __m128 result = _mm_add_ps(_mm_mul_ps(lnSse2(power), factor), offsets);
+        // Silent bins stay at -inf, as with log10f
+        const __m128 silent = _mm_cmpeq_ps(power, _mm_setzero_ps());
+        _mm_storeu_ps(db + i, _mm_or_ps(_mm_and_ps(silent, minusInfinity), _mm_andnot_ps(silent, result)));
     }
+    logPowerScalar(freq + i, count - i, offset, db + i);
 }
+#endif
 
-const QString FFTTools::windowSignature(const WindowType windowType, const int size, const float param)
+inline void applyWindow(const qint16 *samples, int count, int channel, int numChannels, const float *window, float *data)
 {
-    return QStringLiteral("s%1_t%2_p%3").arg(size).arg(windowType).arg(param, 0, 'f', 3);
+#ifdef FFTTOOLS_SSE2
+    windowSse2(samples, count, channel, numChannels, window, data);
+#else
+    windowScalar(samples, count, channel, numChannels, window, data);
+#endif
 }
-const QString FFTTools::cfgSignature(const int size)
+
+inline void logPower(const kiss_fft_cpx *freq, int count, float offset, float *db)
 {
-    return QStringLiteral("s%1").arg(size);
+#ifdef FFTTOOLS_SSE2
+    logPowerSse2(freq, count, offset, db);
+#else
+    logPowerScalar(freq, count, offset, db);
+#endif
+}
+}
+
+FFTTools::FFTTools() :
+    m_fftCfgs(),
+    m_plans(),
+    m_lastPlan(-1)
+{
+}
+FFTTools::~FFTTools()
+{
+    QHash<uint, kiss_fftr_cfg>::iterator i;
+    for (i = m_fftCfgs.begin(); i != m_fftCfgs.end(); ++i) {
+        free(*i);
+    }
 }
 
 // http://cplusplus.syntaxerrors.info/index.php?title=Cannot_declare_member_function_%E2%80%98static_int_Foo::bar%28%29%E2%80%99_to_have_static_linkage
@@ -111,114 +212,96 @@ const QVector<float> FFTTools::window(const WindowType windowType, const int siz
     return QVector<float>();
 }
 
-void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum,
-                             const WindowType windowType, const uint windowSize, const float param)
+const FFTTools::Plan &FFTTools::plan(const WindowType windowType, const uint windowSize, const float param)
 {
+    if (m_lastPlan >= 0) {
+        const Plan &last = m_plans.at(m_lastPlan);
+        if (last.windowType == windowType && last.windowSize == windowSize && last.param == param) {
+            return last;
+        }
+    }
+    for (int i = 0; i < m_plans.count(); ++i) {
+        const Plan &cached = m_plans.at(i);
+        if (cached.windowType == windowType && cached.windowSize == windowSize && cached.param == param) {
+            m_lastPlan = i;
+            return cached;
+        }
+    }
 #ifdef DEBUG_FFTTOOLS
-    QTime start = QTime::currentTime();
+    qCDebug(KDENLIVE_LOG) << "Creating FFT plan with size " << windowSize << " and window " << windowType;
 #endif
 
-    const uint numSamples = audioFrame.size() / numChannels;
-
-    if (windowSize & 1 || windowSize < 2) {
-        return;
-    }
-
-    const QString cfgSig = cfgSignature(windowSize);
-    const QString winSig = windowSignature(windowType, windowSize, param);
+    Plan plan;
+    plan.windowType = windowType;
+    plan.windowSize = windowSize;
+    plan.param = param;
 
     // Get the kiss_fft configuration from the config cache
     // or build a new configuration if the requested one is not available.
-    kiss_fftr_cfg myCfg;
-    if (m_fftCfgs.contains(cfgSig)) {
-#ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Re-using FFT configuration with size " << windowSize;
-#endif
-        myCfg = m_fftCfgs.value(cfgSig);
-    } else {
-#ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Creating FFT configuration with size " << windowSize;
-#endif
-        myCfg = kiss_fftr_alloc(windowSize, false, nullptr, nullptr);
-        m_fftCfgs.insert(cfgSig, myCfg);
+    plan.cfg = m_fftCfgs.value(windowSize, nullptr);
+    if (plan.cfg == nullptr) {
+        plan.cfg = kiss_fftr_alloc(windowSize, false, nullptr, nullptr);
+        m_fftCfgs.insert(windowSize, plan.cfg);
     }
 
-    // Get the window function from the cache
-    // (except for a rectangular window; nothing to do there).
-    QVector<float> window;
     float windowScaleFactor = 1;
     if (windowType != FFTTools::Window_Rect) {
-
-        if (m_windowFunctions.contains(winSig)) {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Re-using window function with signature " << winSig;
-#endif
-            window = m_windowFunctions.value(winSig);
-        } else {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Building new window function with signature " << winSig;
-#endif
-            window = FFTTools::window(windowType, windowSize, 0);
-            m_windowFunctions.insert(winSig, window);
-        }
-        windowScaleFactor = 1.0 / window[windowSize];
+        plan.window = FFTTools::window(windowType, windowSize, param);
+        windowScaleFactor = 1.0 / plan.window[windowSize];
+        plan.window.resize(windowSize);
+    } else {
+        plan.window = QVector<float>(windowSize, 1);
     }
+    // Normalize signals to [0,1] to get correct dB values later on
+    for (uint i = 0; i < windowSize; ++i) {
+        plan.window[i] /= 32767.0f;
+    }
+
+    // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
+    // with N = FFT size (after FFT, 1/2 window size). The window scale factor and N
+    // only add a constant to the dB values.
+    plan.dbOffset = 20 * log10(windowScaleFactor / (windowSize / 2.0));
+
+    m_plans << plan;
+    m_lastPlan = m_plans.count() - 1;
+    return m_plans.at(m_lastPlan);
+}
 
-    // Prepare frequency space vector. The resulting FFT vector is only half as long.
-    kiss_fft_cpx freqData[windowSize / 2];
-    float data[windowSize];
+void FFTTools::transform(const Plan &plan, const qint16 *samples, const uint numSamples, const uint channel, const uint numChannels,
+                         float *freqSpectrum)
+{
+    const uint windowSize = plan.windowSize;
+    const uint count = qMin(numSamples, windowSize);
+    float *data = m_data.data();
 
-    // Copy the first channel's audio into a vector for the FFT display;
+    // Copy the channel's audio into a vector for the FFT display;
     // Fill the data vector indices that cannot be covered with sample data with 0
-    if (numSamples < windowSize) {
-        std::fill(&data[numSamples], &data[windowSize - 1], 0);
-    }
-    // Normalize signals to [0,1] to get correct dB values later on
-    for (uint i = 0; i < numSamples && i < windowSize; ++i) {
-        // Performance note: Benchmarking has shown that using the if/else inside the loop
-        // does not do noticeable worse than keeping it outside (perhaps the branch predictor
-        // is good enough), so it remains in there for better readability.
-        if (windowType != FFTTools::Window_Rect) {
-            data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f * window[i];
-        } else {
-            data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f;
-        }
-    }
+    applyWindow(samples, count, channel, numChannels, plan.window.constData(), data);
+    std::fill(data + count, data + windowSize, 0.0f);
 
     // Calculate the Fast Fourier Transform for the input data
-    kiss_fftr(myCfg, data, freqData);
+    kiss_fftr(plan.cfg, data, m_freqData.data());
 
-    // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-    // with N = FFT size (after FFT, 1/2 window size)
-    for (uint i = 0; i < windowSize / 2; ++i) {
-        // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-        // with N = FFT size (after FFT, 1/2 window size)
-        freqSpectrum[i] = 20 * log(pow(pow(fabs(freqData[i].r * windowScaleFactor), 2) + pow(fabs(freqData[i].i * windowScaleFactor), 2), .5) / ((float)windowSize / 2.0f)) / log(10);;
-    }
+    logPower(m_freqData.constData(), windowSize / 2, plan.dbOffset, freqSpectrum);
+}
 
+void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum,
+                             const WindowType windowType, const uint windowSize, const float param)
+{
 #ifdef DEBUG_FFTTOOLS
-    std::ofstream mFile;
-    mFile.open("/tmp/freq.m");
-    if (!mFile) {
-        qCDebug(KDENLIVE_LOG) << "Opening file failed.";
-    } else {
-        mFile << "val = [ ";
-
-        for (int sample = 0; sample < 256; ++sample) {
-            mFile << data[sample] << ' ';
-        }
-        mFile << " ];\n";
-
-        mFile << "freq = [ ";
-        for (int sample = 0; sample < 256; ++sample) {
-            mFile << freqData[sample].r << '+' << freqData[sample].i << "*i ";
-        }
-        mFile << " ];\n";
+    QTime start = QTime::currentTime();
+#endif
 
-        mFile.close();
-        qCDebug(KDENLIVE_LOG) << "File written.";
+    if (windowSize & 1 || windowSize < 2 || channel >= numChannels) {
+        return;
     }
-#endif
+    const uint numSamples = audioFrame.size() / numChannels;
+
+    const Plan &fftPlan = plan(windowType, windowSize, param);
+    // The real FFT of N samples has N/2+1 bins, the last one is not displayed
+    m_data.resize(windowSize);
+    m_freqData.resize(windowSize / 2 + 1);
+    transform(fftPlan, audioFrame.constData(), numSamples, channel, numChannels, freqSpectrum);
 
 #ifdef DEBUG_FFTTOOLS
     qCDebug(KDENLIVE_LOG) << "Calculated FFT in " << start.elapsed() << " ms.";
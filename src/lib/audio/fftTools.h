@@ -39,12 +39,6 @@ public:
     */
     static const QVector<float> window(const WindowType windowType, const int size, const float param = 0);
 
-    static const QString windowSignature(const WindowType windowType, const int size, const float param = 0);
-
-    /** Returns a signature for a kiss_fft configuration
-        used as a hash in the cache */
-    static const QString cfgSignature(const int size);
-
     /** Calculates the Fourier Tranformation of the input audio frame.
         The resulting values will be given in relative dezibel: The maximum power is 0 dB, lower powers have
         negative dB values.
@@ -74,9 +68,30 @@ public:
     static const QVector<float> interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left = 0, uint right = 0, float fill = 0.0);
 
 private:
-    QHash<QString, kiss_fftr_cfg> m_fftCfgs; // FFT cfg cache
-    QHash<QString, QVector<float> > m_windowFunctions; // Window function cache
+    /** A kiss_fft configuration with its window function, prepared for one window size */
+    struct Plan {
+        WindowType windowType;
+        uint windowSize;
+        float param;
+        kiss_fftr_cfg cfg;
+        /** Window function, including the normalization of samples to [-1,1] */
+        QVector<float> window;
+        /** Added to the dB values to compensate the window area and the FFT size */
+        float dbOffset;
+    };
+
+    QHash<uint, kiss_fftr_cfg> m_fftCfgs; // FFT cfg cache, by window size
+    QVector<Plan> m_plans; // Window function cache
+    /** Last used plan, audio scopes usually keep their settings */
+    int m_lastPlan;
+    // Buffers reused between calls
+    QVector<float> m_data;
+    QVector<kiss_fft_cpx> m_freqData;
 
+    const Plan &plan(const WindowType windowType, const uint windowSize, const float param);
+    /** Transforms one channel of a window of interleaved samples */
+    void transform(const Plan &plan, const qint16 *samples, const uint numSamples, const uint channel, const uint numChannels,
+                   float *freqSpectrum);
 };
 
 #endif // FFTTOOLS_H
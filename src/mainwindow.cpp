@@ -1277,6 +1277,7 @@ void MainWindow::setupActions()
     m_loopClip->setEnabled(false);
 
     addAction(QStringLiteral("dvd_wizard"), i18n("DVD Wizard"), this, SLOT(slotDvdWizard()), KoIconUtils::themedIcon(QStringLiteral("media-optical")));
+    addAction(QStringLiteral("decoder_cache_stats"), i18n("Decoder Cache Statistics"), this, SLOT(slotShowDecoderCache()));
     addAction(QStringLiteral("transcode_clip"), i18n("Transcode Clips"), this, SLOT(slotTranscodeClip()), KoIconUtils::themedIcon(QStringLiteral("edit-copy")));
     addAction(QStringLiteral("archive_project"), i18n("Archive Project"), this, SLOT(slotArchiveProject()), KoIconUtils::themedIcon(QStringLiteral("document-save-all")));
     addAction(QStringLiteral("switch_monitor"), i18n("Switch monitor"), this, SLOT(slotSwitchMonitors()), QIcon(), Qt::Key_T);
@@ -1297,6 +1298,11 @@ void MainWindow::setupActions()
     overlayFpsInfo->setCheckable(true);
     overlayFpsInfo->setData(0x20);
 
+    QAction *overlayStatsInfo =  new QAction(KoIconUtils::themedIcon(QStringLiteral("help-hint")), i18n("Monitor Overlay Playback Statistics"), this);
+    addAction(QStringLiteral("monitor_overlay_stats"), overlayStatsInfo);
+    overlayStatsInfo->setCheckable(true);
+    overlayStatsInfo->setData(0x40);
+
     QAction *overlayMarkerInfo =  new QAction(KoIconUtils::themedIcon(QStringLiteral("help-hint")), i18n("Monitor Overlay Markers"), this);
     addAction(QStringLiteral("monitor_overlay_markers"), overlayMarkerInfo);
     overlayMarkerInfo->setCheckable(true);
@@ -3171,6 +3177,28 @@ void MainWindow::slotDvdWizard(const QString &url)
     pCore->monitorManager()->activateMonitor(Kdenlive::ClipMonitor);
 }
 
+void MainWindow::slotShowDecoderCache()
+{
+    QDialog *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(i18n("Decoder Cache Statistics"));
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    QLabel *label = new QLabel(dialog);
+    label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(label);
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, dialog);
+    connect(buttonBox, &QDialogButtonBox::rejected, dialog, &QDialog::reject);
+    layout->addWidget(buttonBox);
+    // Refresh the counters while the project plays
+    QTimer *timer = new QTimer(dialog);
+    connect(timer, &QTimer::timeout, dialog, [this, label]() {
+        label->setText(m_projectMonitor->render->cacheStatistics());
+    });
+    timer->start(1000);
+    label->setText(m_projectMonitor->render->cacheStatistics());
+    dialog->show();
+}
+
 void MainWindow::slotShowTimeline(bool show)
 {
     if (show == false) {
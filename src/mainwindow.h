@@ -385,6 +385,8 @@ private slots:
     void slotRunWizard();
     void slotZoneMoved(int start, int end);
     void slotDvdWizard(const QString &url = QString());
+    /** @brief Shows the usage counters of the avformat decoder cache */
+    void slotShowDecoderCache();
     void slotGroupClips();
     void slotUnGroupClips();
     void slotEditItemDuration();
@@ -54,6 +54,10 @@ void BinController::destroyBin()
 
     qDeleteAll(m_clipList);
     m_clipList.clear();
+    m_resourceIndex.clear();
+    m_hashIndex.clear();
+    m_indexedPaths.clear();
+    m_indexedHashes.clear();
 }
 
 void BinController::setDocumentRoot(const QString &root)
@@ -83,15 +87,7 @@ void BinController::loadExtraProducer(const QString &id, Mlt::Producer *prod)
 
 QStringList BinController::getProjectHashes()
 {
-    QStringList hashes;
-    QMapIterator<QString, ClipController *> i(m_clipList);
-    hashes.reserve(m_clipList.count());
-    while (i.hasNext()) {
-        i.next();
-        hashes << i.value()->getClipHash();
-    }
-    hashes.removeDuplicates();
-    return hashes;
+    return m_hashIndex.keys();
 }
 
 void BinController::initializeBin(Mlt::Playlist playlist)
@@ -138,6 +134,7 @@ void BinController::initializeBin(Mlt::Playlist playlist)
                 ClipController *master = m_clipList.value(id);
                 if (master) {
                     master->addMasterProducer(producer->parent());
+                    updateClipIndex(id);
                 }
             } else {
                 // Controller has not been created yet
@@ -151,6 +148,7 @@ void BinController::initializeBin(Mlt::Playlist playlist)
                     }
                 }
                 m_clipList.insert(id, controller);
+                updateClipIndex(id);
             }
         }
         emit loadingBin(i + 1);
@@ -248,6 +246,7 @@ void BinController::replaceProducer(const QString &id, Mlt::Producer &producer)
     }
     pasteEffects(id, producer);
     ctrl->updateProducer(id, &producer);
+    updateClipIndex(id);
     replaceBinPlaylistClip(id, producer);
     emit prepareTimelineReplacement(id);
     producer.set("id", id.toUtf8().constData());
@@ -280,6 +279,7 @@ void BinController::addClipToBin(const QString &id, ClipController *controller)
     } else {
         m_clipList.insert(id, controller);
     }
+    updateClipIndex(id);
 }
 
 void BinController::replaceBinPlaylistClip(const QString &id, Mlt::Producer &producer)
@@ -325,6 +325,7 @@ bool BinController::removeBinClip(const QString &id)
         return false;
     }
     removeBinPlaylistClip(id);
+    removeClipIndex(id);
     ClipController *controller = m_clipList.take(id);
     delete controller;
     return true;
@@ -467,17 +468,80 @@ const QList<ClipController *> BinController::getControllerList() const
 const QStringList BinController::getBinIdsByResource(const QFileInfo &url) const
 {
     QStringList controllers;
-    QMapIterator<QString, ClipController *> i(m_clipList);
-    while (i.hasNext()) {
-        i.next();
-        ClipController *ctrl = i.value();
-        if (QFileInfo(ctrl->clipUrl()) == url) {
-            controllers << i.key();
+    const QStringList keys = resourceKeys(url);
+    for (const QString &key : keys) {
+        const QStringList ids = m_resourceIndex.value(key);
+        for (const QString &id : ids) {
+            if (!controllers.contains(id)) {
+                controllers << id;
+            }
         }
     }
     return controllers;
 }
 
+// static
+QStringList BinController::resourceKeys(const QFileInfo &url)
+{
+    QStringList keys;
+    const QString path = QDir::cleanPath(url.absoluteFilePath());
+    if (!path.isEmpty()) {
+        keys << path;
+    }
+    // Also match the clips using the file through a symbolic link
+    const QString canonical = url.canonicalFilePath();
+    if (!canonical.isEmpty() && canonical != path) {
+        keys << canonical;
+    }
+    return keys;
+}
+
+void BinController::updateClipIndex(const QString &id)
+{
+    removeClipIndex(id);
+    ClipController *ctrl = m_clipList.value(id);
+    if (!ctrl) {
+        return;
+    }
+    const QString url = ctrl->clipUrl();
+    if (!url.isEmpty()) {
+        const QStringList keys = resourceKeys(QFileInfo(url));
+        for (const QString &key : keys) {
+            m_resourceIndex[key] << id;
+        }
+        m_indexedPaths.insert(id, keys);
+    }
+    const QString hash = ctrl->getClipHash();
+    if (!hash.isEmpty()) {
+        m_hashIndex[hash] << id;
+        m_indexedHashes.insert(id, hash);
+    }
+}
+
+void BinController::removeClipIndex(const QString &id)
+{
+    const QStringList keys = m_indexedPaths.take(id);
+    for (const QString &key : keys) {
+        QHash<QString, QStringList>::iterator it = m_resourceIndex.find(key);
+        if (it != m_resourceIndex.end()) {
+            it.value().removeAll(id);
+            if (it.value().isEmpty()) {
+                m_resourceIndex.erase(it);
+            }
+        }
+    }
+    const QString hash = m_indexedHashes.take(id);
+    if (!hash.isEmpty()) {
+        QHash<QString, QStringList>::iterator it = m_hashIndex.find(hash);
+        if (it != m_hashIndex.end()) {
+            it.value().removeAll(id);
+            if (it.value().isEmpty()) {
+                m_hashIndex.erase(it);
+            }
+        }
+    }
+}
+
 void BinController::updateTrackProducer(const QString &id)
 {
     emit updateTimelineProducer(id);
@@ -22,6 +22,7 @@
 
 #include <mlt++/Mlt.h>
 
+#include <QHash>
 #include <QString>
 #include <QStringList>
 #include <QDir>
@@ -133,6 +134,8 @@ public:
 
     /** @brief Get the list of ids whose clip have the resource indicated by @param url */
     const QStringList getBinIdsByResource(const QFileInfo &url) const;
+    /** @brief Updates the resource and file hash index entries of a clip after its url or hash changed */
+    void updateClipIndex(const QString &id);
     void replaceProducer(const QString &id, Mlt::Producer &producer);
     void storeMarker(const QString &markerId, const QString &markerHash);
     QMap<double, QString> takeGuidesData();
@@ -187,6 +190,18 @@ private:
     /** @brief This list holds all extra controllers (slowmotion, video only, ... that are in timeline, indexed by id */
     QMap<QString, Mlt::Producer *> m_extraClipList;
 
+    /** @brief Clip ids indexed by absolute and canonical resource path */
+    QHash<QString, QStringList> m_resourceIndex;
+    /** @brief Clip ids indexed by file hash */
+    QHash<QString, QStringList> m_hashIndex;
+    /** @brief Resource paths and file hash under which each clip id is indexed */
+    QHash<QString, QStringList> m_indexedPaths;
+    QHash<QString, QString> m_indexedHashes;
+    /** @brief Returns the index keys of a resource: its absolute path, and its canonical path if different */
+    static QStringList resourceKeys(const QFileInfo &url);
+    /** @brief Removes a clip from the resource and file hash indexes */
+    void removeClipIndex(const QString &id);
+
     /** @brief Stores MLT's xml playlist document root, useful to recover full urls */
     QString m_documentRoot;
 
@@ -457,12 +457,18 @@ void ClipController::setProperty(const QString &name, const QString &value)
     } else {
         m_masterProducer->parent().set(name.toUtf8().constData(), value.toUtf8().constData());
     }
+    if (name == QLatin1String("kdenlive:file_hash")) {
+        m_binController->updateClipIndex(clipId());
+    }
 }
 
 void ClipController::resetProperty(const QString &name)
 {
     //TODO: also set property on all track producers
     m_masterProducer->parent().set(name.toUtf8().constData(), (char *)nullptr);
+    if (name == QLatin1String("kdenlive:file_hash")) {
+        m_binController->updateClipIndex(clipId());
+    }
 }
 
 ClipType ClipController::clipType() const
@@ -0,0 +1,215 @@
+/*
+ * Kdenlive decoder cache statistics
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "producercachemonitor.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <mlt++/MltProducer.h>
+
+namespace
+{
+const char *KeyProperty = "_kdenlive_cache_key";
+// Depth followed for small caches, so that growth can be measured
+const int MinStackDepth = 16;
+}
+
+struct ProducerCacheMonitor::Graveyard
+{
+    QMutex mutex;
+    QVector<quint64> keys;
+};
+
+struct ProducerCacheMonitor::KeyData
+{
+    quint64 key;
+    QSharedPointer<Graveyard> graveyard;
+};
+
+ProducerCacheMonitor::ProducerCacheMonitor() :
+    m_graveyard(new Graveyard),
+    m_nextKey(0),
+    m_cacheSize(0),
+    m_samples(0),
+    m_accesses(0),
+    m_hits(0),
+    m_opens(0),
+    m_evictions(0),
+    m_resident(0)
+{
+}
+
+void ProducerCacheMonitor::reset()
+{
+    m_graveyard->mutex.lock();
+    m_graveyard->keys.clear();
+    m_graveyard->mutex.unlock();
+    m_stack.clear();
+    m_distances.clear();
+    m_samples = 0;
+    m_accesses = 0;
+    m_hits = 0;
+    m_opens = 0;
+    m_evictions = 0;
+    m_resident = 0;
+}
+
+void ProducerCacheMonitor::setCacheSize(int size)
+{
+    m_cacheSize = size;
+    m_resident = qMin(m_resident, size);
+    trimStack();
+}
+
+int ProducerCacheMonitor::cacheSize() const
+{
+    return m_cacheSize;
+}
+
+quint64 ProducerCacheMonitor::producerKey(Mlt::Producer &producer)
+{
+    KeyData *data = static_cast<KeyData *>(producer.get_data(KeyProperty));
+    if (data == nullptr) {
+        // Addresses of closed producers are reused, give each producer its own key
+        data = new KeyData;
+        data->key = ++m_nextKey;
+        data->graveyard = m_graveyard;
+        producer.set(KeyProperty, data, 0, &ProducerCacheMonitor::releaseKey);
+    }
+    return data->key;
+}
+
+void ProducerCacheMonitor::releaseKey(void *data)
+{
+    KeyData *keyData = static_cast<KeyData *>(data);
+    keyData->graveyard->mutex.lock();
+    keyData->graveyard->keys << keyData->key;
+    keyData->graveyard->mutex.unlock();
+    delete keyData;
+}
+
+void ProducerCacheMonitor::removeDestroyed()
+{
+    QVector<quint64> keys;
+    m_graveyard->mutex.lock();
+    keys.swap(m_graveyard->keys);
+    m_graveyard->mutex.unlock();
+    for (int i = 0; i < keys.count(); ++i) {
+        const int index = m_stack.indexOf(keys.at(i));
+        if (index < 0) {
+            continue;
+        }
+        if (index < m_cacheSize && m_resident > 0) {
+            // MLT closed its decoder with the producer
+            m_resident--;
+        }
+        m_stack.removeAt(index);
+    }
+}
+
+void ProducerCacheMonitor::trimStack()
+{
+    const int depth = qMax(MinStackDepth, 2 * m_cacheSize);
+    while (m_stack.count() > depth) {
+        m_stack.removeLast();
+    }
+}
+
+void ProducerCacheMonitor::access(const QVector<quint64> &producers)
+{
+    removeDestroyed();
+    m_samples++;
+    for (int i = 0; i < producers.count(); ++i) {
+        const quint64 id = producers.at(i);
+        m_accesses++;
+        int distance = m_stack.indexOf(id);
+        if (distance >= 0) {
+            if (distance >= m_distances.count()) {
+                m_distances.resize(distance + 1);
+            }
+            m_distances[distance]++;
+            m_stack.removeAt(distance);
+        }
+        if (distance >= 0 && distance < m_cacheSize) {
+            m_hits++;
+        } else {
+            m_opens++;
+            if (m_resident < m_cacheSize) {
+                m_resident++;
+            } else {
+                m_evictions++;
+            }
+        }
+        m_stack.prepend(id);
+    }
+    trimStack();
+}
+
+int ProducerCacheMonitor::samples() const
+{
+    return m_samples;
+}
+
+int ProducerCacheMonitor::recommendedSize(int minimum, int maximum) const
+{
+    qint64 reuses = 0;
+    for (int i = 0; i < m_distances.count(); ++i) {
+        reuses += m_distances.at(i);
+    }
+    if (reuses == 0) {
+        return qMax(minimum, qMin(m_cacheSize, maximum));
+    }
+    // Smallest size serving 98% of the reads that an unlimited cache would serve
+    const qint64 target = reuses - reuses / 50;
+    qint64 served = 0;
+    int size = 0;
+    while (size < m_distances.count() && served < target) {
+        served += m_distances.at(size);
+        size++;
+    }
+    return qBound(minimum, size, qMax(minimum, maximum));
+}
+
+qint64 ProducerCacheMonitor::opens() const
+{
+    return m_opens;
+}
+
+qint64 ProducerCacheMonitor::evictions() const
+{
+    return m_evictions;
+}
+
+double ProducerCacheMonitor::hitRatio() const
+{
+    if (m_accesses == 0) {
+        return 0;
+    }
+    return (double) m_hits / m_accesses;
+}
+
+QString ProducerCacheMonitor::summary() const
+{
+    return QStringLiteral("size: %1, producers: %2, opens: %3, evictions: %4, hit ratio: %5%")
+           .arg(m_cacheSize).arg(m_stack.count()).arg(m_opens).arg(m_evictions).arg(hitRatio() * 100, 0, 'f', 1);
+}
@@ -0,0 +1,101 @@
+/*
+ * Kdenlive decoder cache statistics
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PRODUCERCACHEMONITOR_H
+#define PRODUCERCACHEMONITOR_H
+
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+namespace Mlt
+{
+class Producer;
+}
+
+/** @brief Models the MLT avformat producer cache to measure and size it
+ * MLT keeps a limited number of avformat decoders open and closes the least
+ * recently used one when another producer needs to decode. The cache does not
+ * expose statistics, so the producers read during playback are fed to an
+ * LRU stack. The reuse distances give the hit ratio the cache would reach
+ * for every possible size, which is used to pick the smallest size holding
+ * the working set of the project.
+ * The stack only follows twice the cache size, so that the cache can grow
+ * when the working set is larger. Producers are identified by a key stored
+ * on them, which is dropped from the stack when the producer is destroyed.
+ */
+class ProducerCacheMonitor
+{
+public:
+    ProducerCacheMonitor();
+    /** @brief Forgets all recorded accesses, used when a new project is loaded */
+    void reset();
+    /** @brief Sets the size currently applied to the MLT cache */
+    void setCacheSize(int size);
+    int cacheSize() const;
+    /** @brief Returns the key identifying a producer in access(), assigning one on first use */
+    quint64 producerKey(Mlt::Producer &producer);
+    /** @brief Records the producers read for one frame
+     * @param producers the producerKey() of each decoded producer */
+    void access(const QVector<quint64> &producers);
+    /** @brief Returns the number of frames recorded since the last reset */
+    int samples() const;
+    /** @brief Returns the smallest cache size keeping the reuse hit ratio close to its maximum
+     * @param minimum the size required for the tracks and threads decoding at the same time
+     * @param maximum the size allowed by the memory budget */
+    int recommendedSize(int minimum, int maximum) const;
+    /** @brief Number of decoder opens, measured with the current cache size */
+    qint64 opens() const;
+    /** @brief Number of decoders closed to make room for another producer */
+    qint64 evictions() const;
+    /** @brief Ratio of producer reads served by an open decoder */
+    double hitRatio() const;
+    /** @brief Returns a one line description of the counters, for trace output */
+    QString summary() const;
+
+private:
+    struct Graveyard;
+    struct KeyData;
+    /** Most recently used producer first */
+    QList<quint64> m_stack;
+    /** Keys of the destroyed producers, filled from any thread */
+    QSharedPointer<Graveyard> m_graveyard;
+    quint64 m_nextKey;
+    /** Number of reuses per LRU stack distance */
+    QVector<qint64> m_distances;
+    int m_cacheSize;
+    int m_samples;
+    qint64 m_accesses;
+    qint64 m_hits;
+    qint64 m_opens;
+    qint64 m_evictions;
+    int m_resident;
+    /** @brief Drops the destroyed producers from the stack */
+    void removeDestroyed();
+    /** @brief Drops the producers beyond the followed stack depth */
+    void trimStack();
+    /** @brief Destructor of the key stored on a producer, records its destruction */
+    static void releaseKey(void *data);
+};
+
+#endif
@@ -47,17 +47,21 @@ void ProducerQueue::getFileProperties(const QDomElement &xml, const QString &cli
 {
     // Make sure we don't request the info for same clip twice
     m_infoMutex.lock();
-    if (m_processingClipId.contains(clipId)) {
-        m_infoMutex.unlock();
-        return;
-    }
     for (int i = 0; i < m_requestList.count(); ++i) {
         if (m_requestList.at(i).clipId == clipId) {
-            // Clip is already queued
+            // Clip is already queued, reload it with the latest properties
+            if (replaceProducer && m_requestList.at(i).replaceProducer) {
+                m_requestList[i].xml = xml;
+            }
             m_infoMutex.unlock();
             return;
         }
     }
+    if (m_processingClipId.contains(clipId) && !replaceProducer) {
+        // A reload requested while the clip is loading is queued, so that it uses the latest properties
+        m_infoMutex.unlock();
+        return;
+    }
     requestClipInfo info;
     info.xml = xml;
     info.clipId = clipId;
@@ -21,6 +21,7 @@
 #define ABSTRACTMONITOR_H
 
 #include "definitions.h"
+#include "scopes/sharedframe.h"
 
 #include <stdint.h>
 
@@ -69,6 +70,8 @@ private:
 signals:
     /** @brief The renderer refreshed the current frame. */
     void frameUpdated(const QImage &);
+    /** @brief The renderer displayed a frame whose YUV planes can be analyzed in place. */
+    void sharedFrameUpdated(const SharedFrame &);
 
     /** @brief This signal contains the audio of the current frame. */
     void audioSamplesSignal(const audioShortVector &, int, int, int);
@@ -0,0 +1,267 @@
+/*
+ * Kdenlive monitor decoded frame cache
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "framecache.h"
+#include "kdenlivesettings.h"
+#include "timeline/clip.h"
+
+#include "kdenlive_debug.h"
+#include <QtConcurrent>
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+
+FrameCache::FrameCache(QObject *parent) :
+    QObject(parent),
+    m_memory(0),
+    m_playhead(0),
+    m_width(0),
+    m_height(0),
+    m_format(mlt_image_none),
+    m_producer(nullptr),
+    m_readProducer(nullptr),
+    m_readAhead(false)
+{
+}
+
+FrameCache::~FrameCache()
+{
+    stopReadAhead();
+    delete m_readProducer;
+}
+
+void FrameCache::setProducer(Mlt::Producer *producer)
+{
+    clear();
+    m_producer = producer;
+}
+
+void FrameCache::clear()
+{
+    stopReadAhead();
+    delete m_readProducer;
+    m_readProducer = nullptr;
+    QMutexLocker lock(&m_mutex);
+    // Read ahead is enabled again once a displayed frame tells us the expected image size
+    m_readAhead = false;
+    m_frames.clear();
+    m_memory = 0;
+    m_width = 0;
+    m_height = 0;
+}
+
+void FrameCache::stopReadAhead()
+{
+    m_generation.ref();
+    if (m_future.isRunning()) {
+        m_future.waitForFinished();
+    }
+}
+
+SharedFrame FrameCache::frame(int position)
+{
+    QMutexLocker lock(&m_mutex);
+    m_playhead = position;
+    return m_frames.value(position).frame;
+}
+
+void FrameCache::store(const SharedFrame &frame)
+{
+    if (!frame.is_valid() || frame.get_image() == nullptr) {
+        return;
+    }
+    m_mutex.lock();
+    if (m_width == 0) {
+        m_width = frame.get_image_width();
+        m_height = frame.get_image_height();
+        m_format = frame.get_image_format();
+        m_readAhead = m_producer != nullptr;
+    }
+    m_playhead = frame.get_position();
+    m_mutex.unlock();
+    insert(frame, m_generation.load());
+}
+
+void FrameCache::insert(const SharedFrame &frame, int generation)
+{
+    QMutexLocker lock(&m_mutex);
+    if (generation != m_generation.load() || frame.get_image_width() != m_width || frame.get_image_height() != m_height) {
+        return;
+    }
+    const int position = frame.get_position();
+    if (m_frames.contains(position)) {
+        return;
+    }
+    CachedFrame cached;
+    cached.frame = frame;
+    cached.size = frameSize(frame);
+    m_frames.insert(position, cached);
+    m_memory += cached.size;
+    const qint64 limit = (qint64) KdenliveSettings::monitorframecache() * 1024 * 1024;
+    while (m_memory > limit && m_frames.count() > 1) {
+        // Drop the frame farthest from the playhead
+        QMap<int, CachedFrame>::iterator first = m_frames.begin();
+        QMap<int, CachedFrame>::iterator last = m_frames.end() - 1;
+        QMap<int, CachedFrame>::iterator victim = (m_playhead - first.key() > last.key() - m_playhead) ? first : last;
+        m_memory -= victim->size;
+        m_frames.erase(victim);
+    }
+}
+
+qint64 FrameCache::frameSize(const SharedFrame &frame)
+{
+    // Properties, image and audio descriptors of the mlt frame
+    const qint64 overhead = 4096;
+    qint64 size = overhead + mlt_image_format_size(frame.get_image_format(), frame.get_image_width(), frame.get_image_height(), nullptr);
+    if (frame.get_audio() != nullptr) {
+        size += mlt_audio_format_size(frame.get_audio_format(), frame.get_audio_samples(), frame.get_audio_channels());
+    }
+    return size;
+}
+
+void FrameCache::readAhead(int position, int direction)
+{
+    if (m_producer == nullptr || direction == 0 || m_future.isRunning()) {
+        return;
+    }
+    const int batch = qMax(8, (int) m_producer->get_fps());
+    int start = direction > 0 ? position + 1 : position - batch;
+    int end = direction > 0 ? position + batch : position - 1;
+    start = qMax(0, start);
+    end = qMin(m_producer->get_length() - 1, end);
+    // Skip the frames already cached at the beginning of the range
+    m_mutex.lock();
+    if (!m_readAhead) {
+        m_mutex.unlock();
+        return;
+    }
+    if (direction > 0) {
+        while (start <= end && m_frames.contains(start)) {
+            start++;
+        }
+    } else {
+        while (end >= start && m_frames.contains(end)) {
+            end--;
+        }
+    }
+    m_mutex.unlock();
+    if (start > end) {
+        return;
+    }
+    if (m_readProducer == nullptr) {
+        m_readProducer = createReadProducer();
+        if (m_readProducer == nullptr) {
+            QMutexLocker lock(&m_mutex);
+            m_readAhead = false;
+            return;
+        }
+    }
+    m_future = QtConcurrent::run(this, &FrameCache::decodeRange, start, end, m_generation.load());
+}
+
+Mlt::Producer *FrameCache::createReadProducer()
+{
+    Clip clp(*m_producer);
+    Mlt::Producer *producer = clp.clone();
+    if (producer == nullptr || !producer->is_valid()) {
+        delete producer;
+        return nullptr;
+    }
+    // The monitor producer was created by the loader, which attached these filters to
+    // bring the images to the profile size and colorspace. The first available service is used.
+    static const char *normalizers[][2] = {
+        {"avdeinterlace", "deinterlace"},
+        {"swscale", "rescale"},
+        {"resize", nullptr},
+        {"avcolor_space", "imageconvert"}
+    };
+    for (const auto &services : normalizers) {
+        for (const char *service : services) {
+            if (service == nullptr) {
+                continue;
+            }
+            Mlt::Filter filter(*m_producer->profile(), service);
+            if (filter.is_valid()) {
+                filter.set("_loader", 1);
+                producer->attach(filter);
+                break;
+            }
+        }
+    }
+    // decodeRange relies on each get_frame() call advancing to the next frame
+    producer->set_speed(1.0);
+    return producer;
+}
+
+void FrameCache::prepareFrame(Mlt::Frame *frame)
+{
+    // Properties normally set by the consumer on each frame
+    Mlt::Profile *profile = m_producer->profile();
+    frame->set("rescale.interp", KdenliveSettings::mltinterpolation().toUtf8().constData());
+    frame->set("deinterlace_method", KdenliveSettings::mltdeinterlacer().toUtf8().constData());
+    frame->set("consumer_deinterlace", profile->progressive());
+    frame->set("consumer_aspect_ratio", profile->sar());
+}
+
+void FrameCache::decodeRange(int start, int end, int generation)
+{
+    // Decode forward even when stepping backwards, so that the decoder only seeks once.
+    // The producer then advances by itself, it is only repositioned after skipping cached frames.
+    bool needsSeek = true;
+    for (int position = start; position <= end && generation == m_generation.load(); ++position) {
+        m_mutex.lock();
+        bool cached = m_frames.contains(position);
+        const mlt_image_format expectedFormat = (mlt_image_format) m_format;
+        const int expectedWidth = m_width;
+        const int expectedHeight = m_height;
+        m_mutex.unlock();
+        if (cached) {
+            needsSeek = true;
+            continue;
+        }
+        if (needsSeek) {
+            m_readProducer->seek(position);
+            needsSeek = false;
+        }
+        Mlt::Frame *frame = m_readProducer->get_frame();
+        if (frame == nullptr) {
+            break;
+        }
+        prepareFrame(frame);
+        mlt_image_format format = expectedFormat;
+        int width = expectedWidth;
+        int height = expectedHeight;
+        frame->get_image(format, width, height);
+        if (width != expectedWidth || height != expectedHeight || format != expectedFormat) {
+            // The copy does not produce the same images as the monitor consumer
+            qCDebug(KDENLIVE_LOG) << "// Disabling monitor read ahead, frame size" << width << "x" << height << "does not match" << expectedWidth << "x" << expectedHeight;
+            m_mutex.lock();
+            m_readAhead = false;
+            m_mutex.unlock();
+            delete frame;
+            break;
+        }
+        SharedFrame shared(*frame);
+        insert(shared, generation);
+        delete frame;
+    }
+}
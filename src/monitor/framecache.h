@@ -0,0 +1,105 @@
+/*
+ * Kdenlive monitor decoded frame cache
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include "scopes/sharedframe.h"
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+
+namespace Mlt
+{
+class Frame;
+class Producer;
+}
+
+/** @brief Keeps decoded frames around the clip monitor playhead
+ * Stepping backwards or scrubbing a long GOP clip makes the producer seek to
+ * the previous keyframe and decode up to the requested frame every time.
+ * The cache stores the frames displayed by the monitor, and decodes batches
+ * of frames ahead of the playhead in the stepping direction with a separate
+ * copy of the producer, so that short moves are served from memory.
+ * During reverse playback the batches are decoded behind the playhead, the
+ * playing consumer itself still pulls its frames from MLT.
+ * Frames farthest from the playhead are dropped when the memory limit is
+ * reached.
+ */
+class FrameCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameCache(QObject *parent = nullptr);
+    ~FrameCache();
+    /** @brief Drops all frames and uses @param producer for read ahead */
+    void setProducer(Mlt::Producer *producer);
+    /** @brief Drops all frames, used when the producer output changed (effects, properties) */
+    void clear();
+    /** @brief Returns the frame at position, or an invalid frame if it is not cached */
+    SharedFrame frame(int position);
+    /** @brief Decodes the frames following @param position in the given direction in a background thread */
+    void readAhead(int position, int direction);
+
+public slots:
+    /** @brief Stores a frame displayed by the monitor */
+    void store(const SharedFrame &frame);
+
+private:
+    /** @brief A cached frame and the memory it was accounted for */
+    struct CachedFrame {
+        SharedFrame frame;
+        qint64 size;
+    };
+    QMutex m_mutex;
+    QMap<int, CachedFrame> m_frames;
+    qint64 m_memory;
+    /** Last requested position, frames far from it are dropped first */
+    int m_playhead;
+    /** Image size and format of the displayed frames */
+    int m_width;
+    int m_height;
+    int m_format;
+    Mlt::Producer *m_producer;
+    /** Copy of the producer used by the read ahead thread */
+    Mlt::Producer *m_readProducer;
+    /** Set once the expected image size is known, cleared if the copy cannot produce it. Protected by m_mutex */
+    bool m_readAhead;
+    QFuture<void> m_future;
+    /** Changed every time the cached frames are invalidated, so that pending read ahead results are dropped */
+    QAtomicInt m_generation;
+    void insert(const SharedFrame &frame, int generation);
+    void stopReadAhead();
+    void decodeRange(int start, int end, int generation);
+    /** @brief Creates the read ahead copy, with the normalizing filters that Clip::clone does not copy */
+    Mlt::Producer *createReadProducer();
+    /** @brief Sets the frame properties the monitor consumer uses to scale and deinterlace */
+    void prepareFrame(Mlt::Frame *frame);
+    /** @brief Memory used by a decoded frame: image, audio and frame structure */
+    static qint64 frameSize(const SharedFrame &frame);
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include <QQuickItem>
 #include <QApplication>
 #include <QPainter>
+#include <QElapsedTimer>
 
 #include <mlt++/Mlt.h>
 #include "glwidget.h"
@@ -56,6 +57,7 @@ GLWidget::GLWidget(int id, QObject *parent)
     , m_shader(nullptr)
     , m_glslManager(nullptr)
     , m_consumer(nullptr)
+    , m_previewLevel(0)
     , m_producer(nullptr)
     , m_initSem(0)
     , m_analyseSem(1)
@@ -139,6 +141,18 @@ void GLWidget::updateAudioForAnalysis()
     }
 }
 
+bool GLWidget::showCachedFrame(const SharedFrame &frame)
+{
+    if (!m_frameRenderer || !m_frameRenderer->semaphore()->tryAcquire(1, 0)) {
+        return false;
+    }
+    Mlt::Frame copy = frame.clone(false, true);
+    mlt_frame_set_position(copy.get_frame(), frame.get_position());
+    m_playbackStats.cachedFrameDelivered(m_frameRenderer->queueDepth());
+    QMetaObject::invokeMethod(m_frameRenderer, "showFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, copy));
+    return true;
+}
+
 void GLWidget::initializeGL()
 {
     if (m_isInitialized || !isVisible() || !openglContext()) return;
@@ -189,7 +203,7 @@ void GLWidget::initializeGL()
         m_shareContext->setShareContext(openglContext());
         m_shareContext->create();
     }
-    m_frameRenderer = new FrameRenderer(openglContext(), &m_offscreenSurface);
+    m_frameRenderer = new FrameRenderer(openglContext(), &m_offscreenSurface, &m_playbackStats);
     m_frameRenderer->sendAudioForAnalysis = KdenliveSettings::monitor_audio();
     openglContext()->makeCurrent(this);
     //openglContext()->blockSignals(false);
@@ -199,6 +213,10 @@ void GLWidget::initializeGL()
     } else {
         connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &GLWidget::onFrameDisplayed, Qt::QueuedConnection);
     }
+    if (!m_glslManager) {
+        // Displayed frames are yuv420p images that scopes can read directly
+        connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &GLWidget::sendAnalyseFrame, Qt::QueuedConnection);
+    }
 
     connect(m_frameRenderer, &FrameRenderer::audioSamplesSignal, this, &GLWidget::audioSamplesSignal, Qt::QueuedConnection);
     connect(this, &GLWidget::textureUpdated, this, &GLWidget::update, Qt::QueuedConnection);
@@ -1048,8 +1066,7 @@ int GLWidget::reconfigure(Mlt::Profile *profile)
             m_consumer->set("progressive", property("progressive").toBool());*/
         m_consumer->set("volume", (double)volume / 100);
         //m_consumer->set("progressive", 1);
-        m_consumer->set("rescale", KdenliveSettings::mltinterpolation().toUtf8().constData());
-        m_consumer->set("deinterlace_method", KdenliveSettings::mltdeinterlacer().toUtf8().constData());
+        applyPreviewLevel();
         m_consumer->set("buffer", 25);
         m_consumer->set("prefill", 1);
         m_consumer->set("scrub_audio", 1);
@@ -1065,6 +1082,62 @@ int GLWidget::reconfigure(Mlt::Profile *profile)
     return error;
 }
 
+int GLWidget::previewLevel() const
+{
+    return m_previewLevel;
+}
+
+void GLWidget::setPreviewLevel(int level)
+{
+    level = qBound(0, level, MaxPreviewLevel);
+    if (level == m_previewLevel) {
+        return;
+    }
+    m_previewLevel = level;
+    if (!m_consumer || !m_consumer->is_valid()) {
+        return;
+    }
+    // The consumer reads its frame size when it starts, restart it as on profile changes
+    bool restart = false;
+    if (!m_consumer->is_stopped()) {
+        QSize size = previewSize();
+        restart = size.width() != m_consumer->get_int("width") || size.height() != m_consumer->get_int("height");
+    }
+    if (restart) {
+        m_consumer->stop();
+        m_consumer->purge();
+    }
+    applyPreviewLevel();
+    if (restart) {
+        m_consumer->start();
+    }
+}
+
+QSize GLWidget::previewSize() const
+{
+    if (m_previewLevel < 2) {
+        return QSize(m_monitorProfile->width(), m_monitorProfile->height());
+    }
+    // Next levels halve the processing size, keeping even sizes for yuv420p frames
+    const int divisor = 1 << (m_previewLevel - 1);
+    return QSize(qMax(64, m_monitorProfile->width() / divisor) & ~1, qMax(36, m_monitorProfile->height() / divisor) & ~1);
+}
+
+void GLWidget::applyPreviewLevel()
+{
+    if (m_previewLevel == 0) {
+        m_consumer->set("rescale", KdenliveSettings::mltinterpolation().toUtf8().constData());
+        m_consumer->set("deinterlace_method", KdenliveSettings::mltdeinterlacer().toUtf8().constData());
+    } else {
+        // Scaler and deinterlacer are read for each frame
+        m_consumer->set("rescale", "nearest");
+        m_consumer->set("deinterlace_method", "onefield");
+    }
+    const QSize size = previewSize();
+    m_consumer->set("width", size.width());
+    m_consumer->set("height", size.height());
+}
+
 float GLWidget::zoom() const
 {
     return m_zoom;
@@ -1151,11 +1224,17 @@ void GLWidget::onFrameDisplayed(const SharedFrame &frame)
 {
     m_mutex.lock();
     m_sharedFrame = frame;
-    m_sendFrame = sendFrameForAnalysis;
     m_mutex.unlock();
     update();
 }
 
+void GLWidget::sendAnalyseFrame(const SharedFrame &frame)
+{
+    if (sendFrameForAnalysis && frame.is_valid() && frame.get_image_format() == mlt_image_yuv420p && m_analyseSem.tryAcquire(1)) {
+        emit analyseSharedFrame(frame);
+    }
+}
+
 void GLWidget::mouseReleaseEvent(QMouseEvent *event)
 {
     QQuickView::mouseReleaseEvent(event);
@@ -1225,7 +1304,8 @@ void GLWidget::updateTexture(GLuint yName, GLuint uName, GLuint vName)
     m_texture[0] = yName;
     m_texture[1] = uName;
     m_texture[2] = vName;
-    m_sendFrame = sendFrameForAnalysis;
+    // Only Movit textures need to be read back for analysis
+    m_sendFrame = sendFrameForAnalysis && m_glslManager;
     emit textureUpdated();
     //update();
 }
@@ -1237,8 +1317,11 @@ void GLWidget::on_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr)
     if (frame.get_int("rendered")) {
         GLWidget *widget = static_cast<GLWidget *>(self);
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
+        widget->m_playbackStats.frameDelivered(widget->m_frameRenderer ? widget->m_frameRenderer->queueDepth() : 0, widget->consumer()->get_int("drop_count"));
         if (widget->m_frameRenderer && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
+        } else {
+            widget->m_playbackStats.frameSkipped();
         }
     }
 }
@@ -1249,8 +1332,11 @@ void GLWidget::on_gl_nosync_frame_show(mlt_consumer, void *self, mlt_frame frame
     if (frame.get_int("rendered")) {
         GLWidget *widget = static_cast<GLWidget *>(self);
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
+        widget->m_playbackStats.frameDelivered(widget->m_frameRenderer ? widget->m_frameRenderer->queueDepth() : 0, widget->consumer()->get_int("drop_count"));
         if (widget->m_frameRenderer && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showGLNoSyncFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
+        } else {
+            widget->m_playbackStats.frameSkipped();
         }
     }
 }
@@ -1261,8 +1347,11 @@ void GLWidget::on_gl_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr)
     if (frame.get_int("rendered")) {
         GLWidget *widget = static_cast<GLWidget *>(self);
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
+        widget->m_playbackStats.frameDelivered(widget->m_frameRenderer ? widget->m_frameRenderer->queueDepth() : 0, widget->consumer()->get_int("drop_count"));
         if (widget->m_frameRenderer && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showGLFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
+        } else {
+            widget->m_playbackStats.frameSkipped();
         }
     }
 }
@@ -1300,11 +1389,12 @@ void RenderThread::run()
     }
 }
 
-FrameRenderer::FrameRenderer(QOpenGLContext *shareContext, QSurface *surface)
+FrameRenderer::FrameRenderer(QOpenGLContext *shareContext, QSurface *surface, PlaybackStats *stats)
     : QThread(nullptr)
-    , m_semaphore(3)
+    , m_semaphore(MaxQueuedFrames)
     , m_context(nullptr)
     , m_surface(surface)
+    , m_stats(stats)
     , m_gl32(nullptr)
     , sendAudioForAnalysis(false)
 {
@@ -1331,10 +1421,16 @@ FrameRenderer::~FrameRenderer()
 
 void FrameRenderer::showFrame(Mlt::Frame frame)
 {
+    QElapsedTimer timer;
+    timer.start();
+    qint64 imageTime = 0;
+    qint64 uploadTime = 0;
+    qint64 finishTime = 0;
     int width = 0;
     int height = 0;
     mlt_image_format format = mlt_image_yuv420p;
     frame.get_image(format, width, height);
+    imageTime = timer.nsecsElapsed() / 1000;
     // Save this frame for future use and to keep a reference to the GL Texture.
     m_displayFrame = SharedFrame(frame);
 
@@ -1342,10 +1438,14 @@ void FrameRenderer::showFrame(Mlt::Frame frame)
         m_context->makeCurrent(m_surface);
         // Upload each plane of YUV to a texture.
         QOpenGLFunctions *f = m_context->functions();
+        timer.restart();
         uploadTextures(m_context, m_displayFrame, m_renderTexture);
         f->glBindTexture(GL_TEXTURE_2D, 0);
         check_error(f);
+        uploadTime = timer.nsecsElapsed() / 1000;
+        timer.restart();
         f->glFinish();
+        finishTime = timer.nsecsElapsed() / 1000;
 
         for (int i = 0; i < 3; ++i) {
             std::swap(m_renderTexture[i], m_displayTexture[i]);
@@ -1353,6 +1453,7 @@ void FrameRenderer::showFrame(Mlt::Frame frame)
         emit textureReady(m_displayTexture[0], m_displayTexture[1], m_displayTexture[2]);
         m_context->doneCurrent();
     }
+    m_stats->frameRendered(imageTime, uploadTime, finishTime);
     // The frame is now done being modified and can be shared with the rest
     // of the application.
     emit frameDisplayed(m_displayFrame);
@@ -1361,6 +1462,10 @@ void FrameRenderer::showFrame(Mlt::Frame frame)
 
 void FrameRenderer::showGLFrame(Mlt::Frame frame)
 {
+    QElapsedTimer timer;
+    timer.start();
+    qint64 imageTime = 0;
+    qint64 finishTime = 0;
     if (m_context && m_context->isValid()) {
         int width = 0;
         int height = 0;
@@ -1368,6 +1473,8 @@ void FrameRenderer::showGLFrame(Mlt::Frame frame)
         frame.set("movit.convert.use_texture", 1);
         mlt_image_format format = mlt_image_glsl_texture;
         const GLuint *textureId = (GLuint *) frame.get_image(format, width, height);
+        imageTime = timer.nsecsElapsed() / 1000;
+        timer.restart();
         m_context->makeCurrent(m_surface);
         GLsync sync = (GLsync) frame.get_data("movit.convert.fence");
         if (sync) {
@@ -1390,6 +1497,7 @@ void FrameRenderer::showGLFrame(Mlt::Frame frame)
             }
 #endif // Q_OS_WIN
         }
+        finishTime = timer.nsecsElapsed() / 1000;
 
         emit textureReady(*textureId);
         m_context->doneCurrent();
@@ -1398,6 +1506,8 @@ void FrameRenderer::showGLFrame(Mlt::Frame frame)
         m_frame = SharedFrame(frame);
         qSwap(m_frame, m_displayFrame);
     }
+    // Movit renders directly to a texture, there is no upload step
+    m_stats->frameRendered(imageTime, 0, finishTime);
     // The frame is now done being modified and can be shared with the rest
     // of the application.
     emit frameDisplayed(m_displayFrame);
@@ -1406,6 +1516,10 @@ void FrameRenderer::showGLFrame(Mlt::Frame frame)
 
 void FrameRenderer::showGLNoSyncFrame(Mlt::Frame frame)
 {
+    QElapsedTimer timer;
+    timer.start();
+    qint64 imageTime = 0;
+    qint64 finishTime = 0;
     if (m_context && m_context->isValid()) {
         int width = 0;
         int height = 0;
@@ -1413,8 +1527,11 @@ void FrameRenderer::showGLNoSyncFrame(Mlt::Frame frame)
         frame.set("movit.convert.use_texture", 1);
         mlt_image_format format = mlt_image_glsl_texture;
         const GLuint *textureId = (GLuint *) frame.get_image(format, width, height);
+        imageTime = timer.nsecsElapsed() / 1000;
+        timer.restart();
         m_context->makeCurrent(m_surface);
         m_context->functions()->glFinish();
+        finishTime = timer.nsecsElapsed() / 1000;
 
         emit textureReady(*textureId);
         m_context->doneCurrent();
@@ -1423,6 +1540,7 @@ void FrameRenderer::showGLNoSyncFrame(Mlt::Frame frame)
         m_frame = SharedFrame(frame);
         qSwap(m_frame, m_displayFrame);
     }
+    m_stats->frameRendered(imageTime, 0, finishTime);
 
     // The frame is now done being modified and can be shared with the rest
     // of the application.
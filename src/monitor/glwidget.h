@@ -31,6 +31,7 @@
 #include <QRect>
 
 #include "scopes/sharedframe.h"
+#include "playbackstats.h"
 #include "definitions.h"
 
 class QOpenGLFunctions_3_2_Core;
@@ -67,6 +68,14 @@ public:
     int reconfigureMulti(const QString &params, const QString &path, Mlt::Profile *profile);
     void stopCapture();
     int reconfigure(Mlt::Profile *profile = nullptr);
+    /** @brief Displays an already decoded frame without going through the consumer
+     *  @return false if the frame renderer is busy */
+    bool showCachedFrame(const SharedFrame &frame);
+    /** @brief Returns the playback counters of this monitor */
+    PlaybackStats *playbackStats()
+    {
+        return &m_playbackStats;
+    }
 
     int displayWidth() const
     {
@@ -113,6 +122,13 @@ public:
     void setAudioThumb(int channels = 0, const QVariantList &audioCache = QList<QVariant>());
     int droppedFrames() const;
     void resetDrops();
+    /** @brief Returns the current preview quality reduction, 0 being full quality */
+    int previewLevel() const;
+    /** @brief Lowers the processing quality of the consumer to keep up with realtime playback
+     *  Level 1 uses the fastest scaler and deinterlacer, levels 2 and 3 also process frames
+     *  at half and quarter size, which restarts a running consumer. Level 0 restores the configured quality. */
+    void setPreviewLevel(int level);
+    static const int MaxPreviewLevel = 3;
 
 protected:
     void mouseReleaseEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
@@ -145,6 +161,8 @@ signals:
     void mouseSeek(int eventDelta, int modifiers);
     void startDrag();
     void analyseFrame(const QImage&);
+    /** @brief Frame displayed by the monitor, sent to the scopes without conversion */
+    void analyseSharedFrame(const SharedFrame &frame);
     void audioSamplesSignal(const audioShortVector &, int, int, int);
     void showContextMenu(const QPoint &);
     void lockMonitor(bool);
@@ -161,6 +179,7 @@ private:
     QPoint m_dragStart;
     Mlt::Filter *m_glslManager;
     Mlt::Consumer *m_consumer;
+    int m_previewLevel;
     Mlt::Producer *m_producer;
     QSemaphore m_initSem;
     QSemaphore m_analyseSem;
@@ -172,6 +191,7 @@ private:
     Mlt::Event *m_displayEvent;
     Mlt::Profile *m_monitorProfile;
     FrameRenderer *m_frameRenderer;
+    PlaybackStats m_playbackStats;
     int m_projectionLocation;
     int m_modelViewLocation;
     int m_vertexLocation;
@@ -195,12 +215,18 @@ private:
     void adjustAudioOverlay(bool isAudio);
     QOpenGLFramebufferObject *m_fbo;
     void refreshSceneLayout();
+    /** @brief Sets the consumer scaling and deinterlacing properties for the current preview level */
+    void applyPreviewLevel();
+    /** @brief Returns the consumer frame size for the current preview level */
+    QSize previewSize() const;
 
 private slots:
     void resizeGL(int width, int height);
     void updateTexture(GLuint yName, GLuint uName, GLuint vName);
     void paintGL();
     void onFrameDisplayed(const SharedFrame &frame);
+    /** @brief Sends the displayed frame to the scopes if they are waiting for one */
+    void sendAnalyseFrame(const SharedFrame &frame);
 
 protected:
     void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE;
@@ -231,12 +257,17 @@ class FrameRenderer : public QThread
 {
     Q_OBJECT
 public:
-    explicit FrameRenderer(QOpenGLContext *shareContext, QSurface *surface);
+    explicit FrameRenderer(QOpenGLContext *shareContext, QSurface *surface, PlaybackStats *stats);
     ~FrameRenderer();
     QSemaphore *semaphore()
     {
         return &m_semaphore;
     }
+    /** @brief Returns the number of frames waiting to be displayed */
+    int queueDepth() const
+    {
+        return MaxQueuedFrames - m_semaphore.available();
+    }
     QOpenGLContext *context() const
     {
         return m_context;
@@ -255,11 +286,13 @@ signals:
     void audioSamplesSignal(const audioShortVector &, int, int, int);
 
 private:
+    static const int MaxQueuedFrames = 3;
     QSemaphore m_semaphore;
     SharedFrame m_frame;
     SharedFrame m_displayFrame;
     QOpenGLContext *m_context;
     QSurface *m_surface;
+    PlaybackStats *m_stats;
 
 public:
     GLuint m_renderTexture[3];
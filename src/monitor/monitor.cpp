@@ -139,6 +139,8 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
     , m_editMarker(nullptr)
     , m_forceSizeFactor(0)
     , m_lastMonitorSceneType(MonitorSceneDefault)
+    , m_logStatsAction(nullptr)
+    , m_showStats(false)
 {
     QVBoxLayout *layout = new QVBoxLayout;
     layout->setContentsMargins(0, 0, 0, 0);
@@ -252,7 +254,12 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
         m_configMenu->addAction(m_forceSize);
         m_forceSize->setCurrentAction(freeAction);
         connect(m_forceSize, SIGNAL(triggered(QAction *)), this, SLOT(slotForceSize(QAction *)));
+        m_logStatsAction = m_configMenu->addAction(i18n("Log Playback Statistics..."));
+        m_logStatsAction->setCheckable(true);
+        connect(m_logStatsAction, &QAction::toggled, this, &Monitor::slotLogPlaybackStats);
     }
+    m_statsTimer.setInterval(1000);
+    connect(&m_statsTimer, &QTimer::timeout, this, &Monitor::slotUpdatePlaybackStats);
 
     // Create Volume slider popup
     m_audioSlider = new QSlider(Qt::Vertical);
@@ -295,6 +302,7 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
     connect(render, &Render::rendererStopped, this, &Monitor::rendererStopped);
     connect(render, &AbstractRender::scopesClear, m_glMonitor, &GLWidget::releaseAnalyse, Qt::DirectConnection);
     connect(m_glMonitor, SIGNAL(analyseFrame(QImage)), render, SIGNAL(frameUpdated(QImage)));
+    connect(m_glMonitor, &GLWidget::analyseSharedFrame, render, &AbstractRender::sharedFrameUpdated);
     connect(m_glMonitor, &GLWidget::audioSamplesSignal, render, &AbstractRender::audioSamplesSignal);
 
     if (id != Kdenlive::ClipMonitor) {
@@ -1769,6 +1777,47 @@ void Monitor::checkDrops(int dropped)
     }
 }
 
+void Monitor::updateStatsTimer()
+{
+    if (m_showStats || m_glMonitor->playbackStats()->isLogging()) {
+        m_statsTimer.start();
+    } else {
+        m_statsTimer.stop();
+    }
+}
+
+void Monitor::slotUpdatePlaybackStats()
+{
+    PlaybackStats *stats = m_glMonitor->playbackStats();
+    if (m_showStats) {
+        m_qmlManager->setProperty(QStringLiteral("stats"), stats->summary());
+    }
+    stats->writeLog();
+}
+
+void Monitor::slotLogPlaybackStats(bool enable)
+{
+    PlaybackStats *stats = m_glMonitor->playbackStats();
+    if (!enable) {
+        stats->stopLog();
+        updateStatsTimer();
+        return;
+    }
+    const QString path = QFileDialog::getSaveFileName(this, i18n("Log Playback Statistics"), QString(), i18n("CSV files (*.csv)"));
+    if (!path.isEmpty()) {
+        stats->reset();
+    }
+    if (path.isEmpty() || !stats->startLog(path)) {
+        if (!path.isEmpty()) {
+            warningMessage(i18n("Cannot write to file %1", path));
+        }
+        QSignalBlocker blocker(m_logStatsAction);
+        m_logStatsAction->setChecked(false);
+        return;
+    }
+    updateStatsTimer();
+}
+
 AbstractRender *Monitor::abstractRender()
 {
     return render;
@@ -2182,6 +2231,12 @@ void Monitor::updateQmlDisplay(int currentOverlay)
     m_glMonitor->rootObject()->setVisible(currentOverlay & 0x01);
     m_glMonitor->rootObject()->setProperty("showMarkers", currentOverlay & 0x04);
     m_glMonitor->rootObject()->setProperty("showFps", currentOverlay & 0x20);
+    m_showStats = currentOverlay & 0x40;
+    m_glMonitor->rootObject()->setProperty("showStats", m_showStats);
+    if (m_showStats) {
+        slotUpdatePlaybackStats();
+    }
+    updateStatsTimer();
     m_glMonitor->rootObject()->setProperty("showTimecode", currentOverlay & 0x02);
     bool showTimecodeRelatedInfo = currentOverlay & 0x02 || currentOverlay & 0x20;
     m_timePos->sendTimecode(showTimecodeRelatedInfo);
@@ -31,6 +31,7 @@
 #include <QDomElement>
 #include <QToolBar>
 #include <QElapsedTimer>
+#include <QTimer>
 
 class SmallRuler;
 class ClipController;
@@ -228,6 +229,10 @@ private:
     MonitorAudioLevel *m_audioMeterWidget;
     QElapsedTimer m_droppedTimer;
     double m_displayedFps;
+    /** Refreshes the playback statistics overlay and log */
+    QTimer m_statsTimer;
+    QAction *m_logStatsAction;
+    bool m_showStats;
     void adjustScrollBars(float horizontal, float vertical);
     void loadQmlScene(MonitorSceneType type);
     void updateQmlDisplay(int currentOverlay);
@@ -235,6 +240,8 @@ private:
     void connectQmlToolbar(QQuickItem *root);
     /** @brief Check and display dropped frames */
     void checkDrops(int dropped);
+    /** @brief Starts the playback statistics timer if the overlay or the log needs it */
+    void updateStatsTimer();
     /** @brief Create temporary Mlt::Tractor holding a clip and it's effectless clone */
     void buildSplitEffect(Mlt::Producer *original, int pos);
 
@@ -275,6 +282,10 @@ private slots:
     void slotEnableSceneZoom(bool enable);
     /** @brief Pan monitor view */
     void panView(QPoint diff);
+    /** @brief Refresh the playback statistics overlay and log */
+    void slotUpdatePlaybackStats();
+    /** @brief Start or stop logging playback statistics to a file */
+    void slotLogPlaybackStats(bool enable);
 
 public slots:
     void slotOpenDvdFile(const QString &);
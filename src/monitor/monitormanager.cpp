@@ -446,6 +446,12 @@ void MonitorManager::setupActions()
     pCore->window()->addAction(QStringLiteral("mlt_interpolation"), interpol);
     connect(interpol, static_cast<void (KSelectAction::*)(int)>(&KSelectAction::triggered), this, &MonitorManager::slotSetInterpolation);
 
+    QAction *adaptivePreview = new QAction(i18n("Adaptive Preview Quality"), this);
+    adaptivePreview->setCheckable(true);
+    adaptivePreview->setChecked(KdenliveSettings::adaptivepreview());
+    pCore->window()->addAction(QStringLiteral("mlt_adaptive_preview"), adaptivePreview);
+    connect(adaptivePreview, &QAction::toggled, this, &MonitorManager::slotSetAdaptivePreview);
+
     QAction *zoneStart = new QAction(KoIconUtils::themedIcon(QStringLiteral("media-seek-backward")), i18n("Go to Zone Start"), this);
     zoneStart->setShortcut(Qt::SHIFT + Qt::Key_I);
     pCore->window()->addAction(QStringLiteral("seek_zone_start"), zoneStart);
@@ -528,6 +534,14 @@ void MonitorManager::slotSetInterpolation(int ix)
     setConsumerProperty(QStringLiteral("rescale"), value);
 }
 
+void MonitorManager::slotSetAdaptivePreview(bool enable)
+{
+    KdenliveSettings::setAdaptivepreview(enable);
+    if (m_projectMonitor) {
+        m_projectMonitor->render->setAdaptivePreview(enable);
+    }
+}
+
 void MonitorManager::slotMuteCurrentMonitor(bool active)
 {
     m_activeMonitor->mute(active);
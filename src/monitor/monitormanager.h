@@ -113,6 +113,8 @@ private slots:
     void slotSetDeinterlacer(int ix);
     /** @brief Set MLT's consumer interpolation method */
     void slotSetInterpolation(int ix);
+    /** @brief Enables or disables the automatic preview quality reduction of the project monitor */
+    void slotSetAdaptivePreview(bool enable);
     /** @brief Switch muting on/off */
     void slotMuteCurrentMonitor(bool active);
 
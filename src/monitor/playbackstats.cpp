@@ -0,0 +1,249 @@
+/*
+ * Kdenlive monitor playback statistics
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "playbackstats.h"
+#include "kdenlive_debug.h"
+
+#include <QStringList>
+#include <QTextStream>
+
+PlaybackStats::PlaybackStats() :
+    m_lastDelivery(-1),
+    m_lastDisplay(-1),
+    m_queueDepth(0),
+    m_maxQueueDepth(0),
+    m_consumerDrops(0),
+    m_lastConsumerDrops(0),
+    m_skipped(0),
+    m_cachedFrames(0),
+    m_histogram(BucketCount, 0)
+{
+    for (int i = 0; i < StageCount; ++i) {
+        m_sampleIndex[i] = 0;
+    }
+    m_clock.start();
+}
+
+PlaybackStats::~PlaybackStats()
+{
+    stopLog();
+}
+
+void PlaybackStats::reset()
+{
+    QMutexLocker lock(&m_mutex);
+    for (int i = 0; i < StageCount; ++i) {
+        m_samples[i].clear();
+        m_sampleIndex[i] = 0;
+    }
+    m_displayTimes.clear();
+    m_lastDelivery = -1;
+    m_lastDisplay = -1;
+    m_queueDepth = 0;
+    m_maxQueueDepth = 0;
+    m_consumerDrops = 0;
+    m_skipped = 0;
+    m_cachedFrames = 0;
+    m_histogram.fill(0);
+}
+
+void PlaybackStats::addSample(Stage stage, qint64 value)
+{
+    QVector<qint64> &samples = m_samples[stage];
+    if (samples.count() < WindowSize) {
+        samples.append(value);
+    } else {
+        samples[m_sampleIndex[stage]] = value;
+    }
+    m_sampleIndex[stage] = (m_sampleIndex[stage] + 1) % WindowSize;
+}
+
+double PlaybackStats::average(Stage stage) const
+{
+    const QVector<qint64> &samples = m_samples[stage];
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    qint64 total = 0;
+    for (int i = 0; i < samples.count(); ++i) {
+        total += samples.at(i);
+    }
+    return total / 1000. / samples.count();
+}
+
+double PlaybackStats::maximum(Stage stage) const
+{
+    const QVector<qint64> &samples = m_samples[stage];
+    qint64 result = 0;
+    for (int i = 0; i < samples.count(); ++i) {
+        result = qMax(result, samples.at(i));
+    }
+    return result / 1000.;
+}
+
+void PlaybackStats::pruneDisplayTimes(qint64 now) const
+{
+    while (!m_displayTimes.isEmpty() && m_displayTimes.head() <= now - 1000) {
+        m_displayTimes.dequeue();
+    }
+}
+
+void PlaybackStats::frameDelivered(int queueDepth, int consumerDrops)
+{
+    QMutexLocker lock(&m_mutex);
+    const qint64 now = m_clock.nsecsElapsed() / 1000;
+    // Longer intervals come from pauses and seeks, not from playback
+    if (m_lastDelivery >= 0 && now - m_lastDelivery < 1000000) {
+        addSample(DeliveryIntervalStage, now - m_lastDelivery);
+    }
+    m_lastDelivery = now;
+    m_queueDepth = queueDepth;
+    m_maxQueueDepth = qMax(m_maxQueueDepth, queueDepth);
+    // The consumer counter is reset by the monitor, only count increases
+    if (consumerDrops > m_lastConsumerDrops) {
+        m_consumerDrops += consumerDrops - m_lastConsumerDrops;
+    }
+    m_lastConsumerDrops = consumerDrops;
+}
+
+void PlaybackStats::cachedFrameDelivered(int queueDepth)
+{
+    QMutexLocker lock(&m_mutex);
+    // Cached frames follow the seek requests, their interval says nothing about the consumer
+    ++m_cachedFrames;
+    m_queueDepth = queueDepth;
+    m_maxQueueDepth = qMax(m_maxQueueDepth, queueDepth);
+}
+
+void PlaybackStats::frameSkipped()
+{
+    QMutexLocker lock(&m_mutex);
+    ++m_skipped;
+}
+
+void PlaybackStats::frameRendered(qint64 imageTime, qint64 uploadTime, qint64 finishTime)
+{
+    QMutexLocker lock(&m_mutex);
+    addSample(ImageStage, imageTime);
+    addSample(UploadStage, uploadTime);
+    addSample(FinishStage, finishTime);
+    const qint64 now = m_clock.elapsed();
+    if (m_lastDisplay >= 0 && now - m_lastDisplay < 1000) {
+        const int bucket = qMin((int)(now - m_lastDisplay) / BucketWidth, BucketCount - 1);
+        m_histogram[bucket]++;
+    }
+    m_lastDisplay = now;
+    m_displayTimes.enqueue(now);
+    pruneDisplayTimes(now);
+}
+
+double PlaybackStats::fps() const
+{
+    QMutexLocker lock(&m_mutex);
+    pruneDisplayTimes(m_clock.elapsed());
+    return m_displayTimes.count();
+}
+
+int PlaybackStats::droppedFrames() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_consumerDrops + m_skipped;
+}
+
+QString PlaybackStats::summary() const
+{
+    const double rate = fps();
+    QMutexLocker lock(&m_mutex);
+    return QStringLiteral("%1 fps, %2 dropped, %3 cached, queue %4\nframe interval %5 ms, image %6 ms, upload %7 ms, gpu %8 ms")
+           .arg(rate, 0, 'f', 1)
+           .arg(m_consumerDrops + m_skipped)
+           .arg(m_cachedFrames)
+           .arg(m_queueDepth)
+           .arg(average(DeliveryIntervalStage), 0, 'f', 1)
+           .arg(average(ImageStage), 0, 'f', 1)
+           .arg(average(UploadStage), 0, 'f', 1)
+           .arg(average(FinishStage), 0, 'f', 1);
+}
+
+bool PlaybackStats::startLog(const QString &path)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_log.isOpen()) {
+        m_log.close();
+    }
+    m_log.setFileName(path);
+    if (!m_log.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qCDebug(KDENLIVE_LOG) << "// Cannot open playback statistics log: " << m_log.errorString();
+        return false;
+    }
+    QStringList columns;
+    columns << QStringLiteral("time_ms") << QStringLiteral("fps") << QStringLiteral("dropped") << QStringLiteral("cached") << QStringLiteral("max_queue")
+            << QStringLiteral("delivery_interval_avg_ms") << QStringLiteral("delivery_interval_max_ms") << QStringLiteral("image_avg_ms") << QStringLiteral("image_max_ms")
+            << QStringLiteral("upload_avg_ms") << QStringLiteral("upload_max_ms") << QStringLiteral("gpu_avg_ms") << QStringLiteral("gpu_max_ms");
+    for (int i = 0; i < BucketCount - 1; ++i) {
+        columns << QStringLiteral("interval_%1_%2ms").arg(i * BucketWidth).arg((i + 1) * BucketWidth);
+    }
+    columns << QStringLiteral("interval_over_%1ms").arg((BucketCount - 1) * BucketWidth);
+    QTextStream stream(&m_log);
+    stream << columns.join(QLatin1Char(',')) << '\n';
+    m_histogram.fill(0);
+    m_maxQueueDepth = 0;
+    return true;
+}
+
+void PlaybackStats::stopLog()
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_log.isOpen()) {
+        m_log.close();
+    }
+}
+
+bool PlaybackStats::isLogging() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_log.isOpen();
+}
+
+void PlaybackStats::writeLog()
+{
+    const double rate = fps();
+    QMutexLocker lock(&m_mutex);
+    if (!m_log.isOpen()) {
+        return;
+    }
+    QStringList values;
+    values << QString::number(m_clock.elapsed()) << QString::number(rate, 'f', 1) << QString::number(m_consumerDrops + m_skipped)
+           << QString::number(m_cachedFrames) << QString::number(m_maxQueueDepth);
+    for (int i = 0; i < StageCount; ++i) {
+        values << QString::number(average((Stage) i), 'f', 2) << QString::number(maximum((Stage) i), 'f', 2);
+    }
+    for (int i = 0; i < BucketCount; ++i) {
+        values << QString::number(m_histogram.at(i));
+    }
+    QTextStream stream(&m_log);
+    stream << values.join(QLatin1Char(',')) << '\n';
+    stream.flush();
+    m_histogram.fill(0);
+    m_maxQueueDepth = m_queueDepth;
+}
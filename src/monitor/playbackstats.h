@@ -0,0 +1,118 @@
+/*
+ * Kdenlive monitor playback statistics
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PLAYBACKSTATS_H
+#define PLAYBACKSTATS_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+
+/** @brief Playback counters of a monitor
+ * Collects the time spent in each step of the display pipeline over the last
+ * frames: image conversion, texture upload and waiting for the GPU. The MLT
+ * consumer decodes and applies effects in its own threads, so only the
+ * interval between the frames it delivers is measured for it. It also tracks
+ * the renderer queue depth, dropped frames, frames shown from the monitor
+ * cache and the effective display rate.
+ * Methods are called from the MLT consumer and frame renderer threads, so all
+ * access is serialized.
+ * A log file can be enabled to record a rolling histogram of the frame
+ * intervals during long playback tests.
+ */
+class PlaybackStats
+{
+public:
+    enum Stage {
+        /** Interval between two frames delivered by the consumer, not the time it spent on a frame */
+        DeliveryIntervalStage = 0,
+        /** Conversion of the frame to the display image or texture */
+        ImageStage,
+        /** Upload of the image planes to textures */
+        UploadStage,
+        /** Wait for the GPU to finish rendering */
+        FinishStage,
+        StageCount
+    };
+
+    PlaybackStats();
+    ~PlaybackStats();
+    void reset();
+    /** @brief The consumer delivered a frame for display
+     * @param queueDepth number of frames waiting in the renderer
+     * @param consumerDrops the drop counter of the consumer */
+    void frameDelivered(int queueDepth, int consumerDrops);
+    /** @brief A frame of the monitor cache was sent to the renderer instead of a consumer frame
+     * @param queueDepth number of frames waiting in the renderer */
+    void cachedFrameDelivered(int queueDepth);
+    /** @brief The renderer was busy and a delivered frame was not shown */
+    void frameSkipped();
+    /** @brief A frame was shown, with the time in microseconds spent in the renderer steps */
+    void frameRendered(qint64 imageTime, qint64 uploadTime, qint64 finishTime);
+    /** @brief Returns the number of frames shown during the last second */
+    double fps() const;
+    /** @brief Returns the frames dropped by the consumer or skipped by the renderer since the last reset */
+    int droppedFrames() const;
+    /** @brief Returns a short text describing the current counters, for the monitor overlay */
+    QString summary() const;
+
+    /** @brief Starts writing one line of counters per call to writeLog() in a CSV file */
+    bool startLog(const QString &path);
+    void stopLog();
+    bool isLogging() const;
+    /** @brief Appends the counters and the frame interval histogram collected since the last call to the log */
+    void writeLog();
+
+private:
+    /** Number of frames used to compute the stage averages */
+    static const int WindowSize = 120;
+    /** Width in milliseconds and number of the frame interval histogram buckets */
+    static const int BucketWidth = 5;
+    static const int BucketCount = 21;
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QVector<qint64> m_samples[StageCount];
+    int m_sampleIndex[StageCount];
+    /** Display times of the frames shown in the last second, in milliseconds */
+    mutable QQueue<qint64> m_displayTimes;
+    qint64 m_lastDelivery;
+    qint64 m_lastDisplay;
+    int m_queueDepth;
+    int m_maxQueueDepth;
+    int m_consumerDrops;
+    int m_lastConsumerDrops;
+    int m_skipped;
+    int m_cachedFrames;
+    QVector<int> m_histogram;
+    QFile m_log;
+    void addSample(Stage stage, qint64 value);
+    double average(Stage stage) const;
+    double maximum(Stage stage) const;
+    void pruneDisplayTimes(qint64 now) const;
+};
+
+#endif
@@ -18,7 +18,7 @@
 
 #include "scopewidget.h"
 #include "kdenlive_debug.h"
-#include <QtConcurrent>
+#include "scopes/scopethreadpool.h"
 
 ScopeWidget::ScopeWidget(QWidget *parent)
     : QWidget(parent)
@@ -46,7 +46,9 @@ void ScopeWidget::onNewFrame(const SharedFrame &frame)
 void ScopeWidget::requestRefresh()
 {
     if (m_future.isFinished()) {
-        m_future = QtConcurrent::run(this, &ScopeWidget::refreshInThread);
+        m_future = ScopeThreadPool::run([this]() {
+            refreshInThread();
+        });
     } else {
         m_refreshPending = true;
     }
@@ -87,7 +87,7 @@ public slots:
 
 protected:
     /*!
-      Triggers refreshScope() to be called in a new thread context.
+      Triggers refreshScope() to be called in a ScopeThreadPool thread.
       Typically requestRefresh would be called from the GUI thread
       (e.g. in resizeEvent()). onNewFrame() also calls requestRefresh().
     */
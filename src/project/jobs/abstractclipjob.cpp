@@ -27,6 +27,7 @@ AbstractClipJob::AbstractClipJob(JOBTYPE type, ClipType cType, const QString &id
     clipType(cType),
     jobType(type),
     replaceClip(false),
+    jobId(-1),
     m_jobStatus(NoJob),
     m_clipId(id),
     m_addClipToProject(-100),
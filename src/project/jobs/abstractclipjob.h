@@ -53,6 +53,8 @@ public:
     JOBTYPE jobType;
     QString description;
     bool replaceClip;
+    /** @brief Identifies the job in the JobManager job graph, -1 until the job is queued. */
+    int jobId;
     const QString clipId() const;
     const QString errorMessage() const;
     const QString logDetails() const;
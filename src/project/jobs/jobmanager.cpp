@@ -40,26 +40,36 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <klocalizedstring.h>
 #include "ui_scenecutdialog_ui.h"
 
+namespace {
+// Number of job queues, see JobManager::jobPriority()
+const int PriorityCount = 4;
+}
+
 JobManager::JobManager(Bin *bin): QObject()
     , m_bin(bin)
+    , m_queues(PriorityCount)
+    , m_nextJobId(0)
+    , m_pendingCount(0)
     , m_abortAllJobs(false)
 {
+    qRegisterMetaType<AbstractClipJob *>("AbstractClipJob*");
     connect(this, &JobManager::processLog, this, &JobManager::slotProcessLog);
-    connect(this, &JobManager::checkJobProcess, this, &JobManager::slotCheckJobProcess);
+    connect(this, &JobManager::jobFinished, this, &JobManager::slotJobFinished, Qt::QueuedConnection);
+    connect(this, &JobManager::gotProxy, m_bin, &Bin::gotProxy, Qt::QueuedConnection);
+    // Emitted from the clip loading thread
+    connect(m_bin, &Bin::producerReady, this, &JobManager::slotClipReady);
 }
 
 JobManager::~JobManager()
 {
     m_abortAllJobs = true;
-    for (int i = 0; i < m_jobList.count(); ++i) {
-        m_jobList.at(i)->setStatus(JobAborted);
-    }
-    m_jobThreads.waitForFinished();
-    m_jobThreads.clearFutures();
-    if (!m_jobList.isEmpty()) {
-        qDeleteAll(m_jobList);
+    m_jobMutex.lock();
+    foreach (AbstractClipJob *job, m_runningJobs) {
+        job->setStatus(JobAborted);
     }
-    m_jobList.clear();
+    m_jobMutex.unlock();
+    m_threadPool.waitForDone();
+    deleteAllJobs();
 }
 
 void JobManager::slotProcessLog(const QString &id, int progress, int type, const QString &message)
@@ -72,10 +82,10 @@ QStringList JobManager::getPendingJobs(const QString &id)
 {
     QStringList result;
     QMutexLocker lock(&m_jobMutex);
-    for (int i = 0; i < m_jobList.count(); ++i) {
-        if (m_jobList.at(i)->clipId() == id && (m_jobList.at(i)->status() == JobWaiting || m_jobList.at(i)->status() == JobWorking)) {
-            // discard this job
-            result << m_jobList.at(i)->description;
+    const QList<AbstractClipJob *> jobs = m_clipJobs.value(id);
+    for (int i = 0; i < jobs.count(); ++i) {
+        if (jobs.at(i)->status() == JobWaiting || jobs.at(i)->status() == JobWorking) {
+            result << jobs.at(i)->description;
         }
     }
     return result;
@@ -85,12 +95,15 @@ bool JobManager::discardJobs(const QString &id, AbstractClipJob::JOBTYPE type)
 {
     QMutexLocker lock(&m_jobMutex);
     bool jobFound = false;
-    for (int i = 0; i < m_jobList.count(); ++i) {
-        if (m_jobList.at(i)->clipId() == id && (type == AbstractClipJob::NOJOBTYPE || m_jobList.at(i)->jobType == type)) {
-            // discard this job
-            m_jobList.at(i)->setStatus(JobAborted);
-            jobFound = true;
+    const QList<AbstractClipJob *> jobs = m_clipJobs.value(id);
+    for (int i = 0; i < jobs.count(); ++i) {
+        AbstractClipJob *job = jobs.at(i);
+        if (type != AbstractClipJob::NOJOBTYPE && job->jobType != type) {
+            continue;
         }
+        // discard this job
+        abortJob(job);
+        jobFound = true;
     }
     if (jobFound) {
         emit updateJobStatus(id, type, JobAborted);
@@ -102,140 +115,277 @@ bool JobManager::discardJobs(const QString &id, AbstractClipJob::JOBTYPE type)
 bool JobManager::hasPendingJob(const QString &clipId, AbstractClipJob::JOBTYPE type)
 {
     QMutexLocker lock(&m_jobMutex);
-    for (int i = 0; i < m_jobList.count(); i++) {
-        if (m_abortAllJobs) {
-            break;
-        }
-        AbstractClipJob *job = m_jobList.at(i);
-        if (job->clipId() == clipId && job->jobType == type && (job->status() == JobWaiting || job->status() == JobWorking)) {
+    if (m_abortAllJobs) {
+        return false;
+    }
+    const QList<AbstractClipJob *> jobs = m_clipJobs.value(clipId);
+    for (int i = 0; i < jobs.count(); i++) {
+        AbstractClipJob *job = jobs.at(i);
+        if (job->jobType == type && (job->status() == JobWaiting || job->status() == JobWorking)) {
             return true;
         }
     }
     return false;
 }
 
-void JobManager::slotCheckJobProcess()
+int JobManager::pendingJobId(const QString &clipId, AbstractClipJob::JOBTYPE type)
 {
-    if (!m_jobThreads.futures().isEmpty()) {
-        // Remove inactive threads
-        QList<QFuture<void> > futures = m_jobThreads.futures();
-        m_jobThreads.clearFutures();
-        for (int i = 0; i < futures.count(); ++i)
-            if (!futures.at(i).isFinished()) {
-                m_jobThreads.addFuture(futures.at(i));
-            }
-    }
-    if (m_jobList.isEmpty()) {
-        return;
-    }
-
-    m_jobMutex.lock();
-    int count = 0;
-    for (int i = 0; i < m_jobList.count(); ++i) {
-        if (m_jobList.at(i)->status() == JobWorking || m_jobList.at(i)->status() == JobWaiting) {
-            count ++;
-        } else {
-            // remove finished jobs
-            AbstractClipJob *job = m_jobList.takeAt(i);
-            job->deleteLater();
-            --i;
+    QMutexLocker lock(&m_jobMutex);
+    const QList<AbstractClipJob *> jobs = m_clipJobs.value(clipId);
+    for (int i = 0; i < jobs.count(); i++) {
+        AbstractClipJob *job = jobs.at(i);
+        if (job->jobType == type && (job->status() == JobWaiting || job->status() == JobWorking)) {
+            return job->jobId;
         }
     }
-    m_jobMutex.unlock();
-    emit jobCount(count);
-    if (m_jobThreads.futures().isEmpty() || m_jobThreads.futures().count() < KdenliveSettings::proxythreads()) {
-        m_jobThreads.addFuture(QtConcurrent::run(this, &JobManager::slotProcessJobs));
+    return -1;
+}
+
+int JobManager::jobPriority(AbstractClipJob::JOBTYPE type)
+{
+    switch (type) {
+    case AbstractClipJob::PROXYJOB:
+        // Editing is slow until the proxy is ready
+        return 0;
+    case AbstractClipJob::MLTJOB:
+        // Requested by an effect in the timeline
+        return 1;
+    case AbstractClipJob::FILTERCLIPJOB:
+    case AbstractClipJob::ANALYSECLIPJOB:
+        return 2;
+    default:
+        // Transcoding and cutting
+        return 3;
     }
 }
 
 void JobManager::updateJobCount()
 {
-    int count = 0;
-    for (int i = 0; i < m_jobList.count(); ++i) {
-        if (m_jobList.at(i)->status() == JobWaiting || m_jobList.at(i)->status() == JobWorking) {
-            count ++;
-        }
-    }
     // Set jobs count
-    emit jobCount(count);
+    emit jobCount(m_pendingCount);
 }
 
-void JobManager::slotProcessJobs()
+void JobManager::abortJob(AbstractClipJob *job)
 {
-    bool firstPass = true;
-    while (!m_jobList.isEmpty() && !m_abortAllJobs) {
-        AbstractClipJob *job = nullptr;
-        m_jobMutex.lock();
-        for (int i = 0; i < m_jobList.count(); ++i) {
-            if (m_jobList.at(i)->status() == JobWaiting) {
-                job = m_jobList.at(i);
-                job->setStatus(JobWorking);
-                break;
-            }
+    if (m_runningJobs.contains(job)) {
+        // Removed with its dependents once its thread is done
+        job->setStatus(JobAborted);
+        return;
+    }
+    if (!m_jobs.contains(job->jobId)) {
+        // Already aborted as a dependent of another job
+        return;
+    }
+    job->setStatus(JobAborted);
+    --m_pendingCount;
+    if (m_blockedJobs.remove(job->jobId) == 0) {
+        m_queues[jobPriority(job->jobType)].removeOne(job);
+    }
+    unindexJob(job);
+    releaseDependents(job);
+    job->deleteLater();
+}
+
+void JobManager::releaseDependents(AbstractClipJob *job)
+{
+    const bool done = job->status() == JobDone;
+    m_jobs.remove(job->jobId);
+    if (!done) {
+        m_failedJobs.insert(job->jobId);
+    }
+    const QList<OutputJob> outputJobs = m_outputJobs.take(job->jobId);
+    if (done && job->addClipToProject() > -100 && !outputJobs.isEmpty()) {
+        // Started once the bin loaded the new clip, see slotClipReady()
+        m_createdClipJobs[job->destination()] << outputJobs;
+    }
+    const QList<int> dependents = m_dependents.take(job->jobId);
+    for (int i = 0; i < dependents.count(); ++i) {
+        QHash<int, int>::iterator it = m_blockedJobs.find(dependents.at(i));
+        if (it == m_blockedJobs.end()) {
+            // Aborted by another dependency
+            continue;
         }
-        if (!firstPass) {
-            updateJobCount();
+        AbstractClipJob *dependent = m_jobs.value(dependents.at(i));
+        if (!done) {
+            emit updateJobStatus(dependent->clipId(), dependent->jobType, JobAborted);
+            abortJob(dependent);
+        } else if (--it.value() == 0) {
+            m_blockedJobs.erase(it);
+            m_queues[jobPriority(dependent->jobType)].append(dependent);
         }
-        m_jobMutex.unlock();
+    }
+}
 
-        if (job == nullptr) {
+void JobManager::unindexJob(AbstractClipJob *job)
+{
+    QHash<QString, QList<AbstractClipJob *> >::iterator it = m_clipJobs.find(job->clipId());
+    if (it == m_clipJobs.end()) {
+        return;
+    }
+    it.value().removeOne(job);
+    if (it.value().isEmpty()) {
+        m_clipJobs.erase(it);
+    }
+}
+
+void JobManager::dispatchJobs()
+{
+    QMutexLocker lock(&m_jobMutex);
+    m_threadPool.setMaxThreadCount(qMax(1, KdenliveSettings::proxythreads()));
+    int priority = 0;
+    while (!m_abortAllJobs && m_runningJobs.count() < m_threadPool.maxThreadCount()) {
+        while (priority < m_queues.count() && m_queues.at(priority).isEmpty()) {
+            ++priority;
+        }
+        if (priority == m_queues.count()) {
             break;
         }
-        firstPass = false;
-        QString destination = job->destination();
-        // Check if the clip is still here
-        ProjectClip *currentClip = m_bin->getBinClip(job->clipId());
-        if (currentClip == nullptr) {
-            job->setStatus(JobDone);
+        AbstractClipJob *job = m_queues[priority].takeFirst();
+        if (job->status() != JobWaiting) {
+            unindexJob(job);
+            releaseDependents(job);
+            job->deleteLater();
             continue;
         }
-        // Set clip status to started
-        currentClip->setJobStatus(job->jobType, job->status());
-
-        // Make sure destination path is writable
-        if (!destination.isEmpty()) {
-            QFileInfo file(destination);
-            bool writable = false;
-            if (file.exists()) {
-                if (file.isWritable()) {
-                    writable = true;
-                }
-            } else {
-                QDir dir = file.absoluteDir();
-                if (!dir.exists()) {
-                    writable = dir.mkpath(QStringLiteral("."));
-                } else {
-                    QFileInfo dinfo(dir.absolutePath());
-                    writable = dinfo.isWritable();
-                }
+        job->setStatus(JobWorking);
+        m_runningJobs.insert(job);
+        QtConcurrent::run(&m_threadPool, this, &JobManager::runJob, job);
+    }
+}
+
+void JobManager::runJob(AbstractClipJob *job)
+{
+    QString destination = job->destination();
+    // Check if the clip is still here
+    ProjectClip *currentClip = m_bin->getBinClip(job->clipId());
+    if (currentClip == nullptr) {
+        job->setStatus(JobDone);
+        emit jobFinished(job);
+        return;
+    }
+    // Set clip status to started
+    currentClip->setJobStatus(job->jobType, job->status());
+
+    // Make sure destination path is writable
+    if (!destination.isEmpty()) {
+        QFileInfo file(destination);
+        bool writable = false;
+        if (file.exists()) {
+            if (file.isWritable()) {
+                writable = true;
             }
-            if (!writable) {
-                emit updateJobStatus(job->clipId(), job->jobType, JobCrashed, i18n("Cannot write to path: %1", destination));
-                job->setStatus(JobCrashed);
-                continue;
+        } else {
+            QDir dir = file.absoluteDir();
+            if (!dir.exists()) {
+                writable = dir.mkpath(QStringLiteral("."));
+            } else {
+                QFileInfo dinfo(dir.absolutePath());
+                writable = dinfo.isWritable();
             }
         }
-        connect(job, SIGNAL(jobProgress(QString, int, int)), this, SIGNAL(processLog(QString, int, int)));
-        connect(job, &AbstractClipJob::cancelRunningJob, m_bin, &Bin::slotCancelRunningJob);
+        if (!writable) {
+            emit updateJobStatus(job->clipId(), job->jobType, JobCrashed, i18n("Cannot write to path: %1", destination));
+            job->setStatus(JobCrashed);
+            emit jobFinished(job);
+            return;
+        }
+    }
+    connect(job, SIGNAL(jobProgress(QString, int, int)), this, SIGNAL(processLog(QString, int, int)));
+    connect(job, &AbstractClipJob::cancelRunningJob, m_bin, &Bin::slotCancelRunningJob);
 
-        if (job->jobType == AbstractClipJob::MLTJOB || job->jobType == AbstractClipJob::ANALYSECLIPJOB) {
-            connect(job, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)), this, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)));
+    if (job->jobType == AbstractClipJob::MLTJOB || job->jobType == AbstractClipJob::ANALYSECLIPJOB) {
+        connect(job, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)), this, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)));
+    } else if (job->jobType == AbstractClipJob::PROXYJOB) {
+        connect(static_cast<ProxyJob *>(job), &ProxyJob::gotPartialProxy, this, &JobManager::gotProxy);
+    }
+    job->startJob();
+    if (job->status() == JobDone) {
+        emit updateJobStatus(job->clipId(), job->jobType, JobDone);
+        //TODO: replace with more generic clip replacement framework
+        if (job->jobType == AbstractClipJob::PROXYJOB) {
+            emit gotProxy(job->clipId(), destination);
+        } else if (job->addClipToProject() > -100) {
+            emit addClip(destination, job->addClipToProject());
         }
-        job->startJob();
-        if (job->status() == JobDone) {
-            emit updateJobStatus(job->clipId(), job->jobType, JobDone);
-            //TODO: replace with more generic clip replacement framework
-            if (job->jobType == AbstractClipJob::PROXYJOB) {
-                m_bin->gotProxy(job->clipId(), destination);
-            } else if (job->addClipToProject() > -100) {
-                emit addClip(destination, job->addClipToProject());
-            }
-        } else if (job->status() == JobCrashed || job->status() == JobAborted) {
-            emit updateJobStatus(job->clipId(), job->jobType, job->status(), job->errorMessage(), QString(), job->logDetails());
+    } else if (job->status() == JobCrashed || job->status() == JobAborted) {
+        emit updateJobStatus(job->clipId(), job->jobType, job->status(), job->errorMessage(), QString(), job->logDetails());
+    }
+    emit jobFinished(job);
+}
+
+void JobManager::slotJobFinished(AbstractClipJob *job)
+{
+    m_jobMutex.lock();
+    if (!m_runningJobs.remove(job)) {
+        // All jobs were canceled meanwhile
+        m_jobMutex.unlock();
+        return;
+    }
+    --m_pendingCount;
+    unindexJob(job);
+    releaseDependents(job);
+    m_jobMutex.unlock();
+    job->deleteLater();
+    updateJobCount();
+    dispatchJobs();
+}
+
+void JobManager::slotClipReady(const QString &id)
+{
+    ProjectClip *clip = m_bin->getBinClip(id);
+    if (clip == nullptr) {
+        return;
+    }
+    m_jobMutex.lock();
+    const QList<OutputJob> outputJobs = m_createdClipJobs.take(clip->url());
+    m_jobMutex.unlock();
+    for (int i = 0; i < outputJobs.count(); ++i) {
+        const OutputJob &output = outputJobs.at(i);
+        if (output.type == AbstractClipJob::PROXYJOB) {
+            // The document chooses the proxy path
+            m_bin->requestProxy(clip);
+        } else {
+            prepareJobs(QList<ProjectClip *>() << clip, output.fps, output.type, output.params);
+        }
+    }
+}
+
+void JobManager::prepareOutputJob(int jobId, double fps, AbstractClipJob::JOBTYPE jobType, const QStringList &params)
+{
+    QMutexLocker lock(&m_jobMutex);
+    if (!m_jobs.contains(jobId)) {
+        // Already finished or discarded
+        return;
+    }
+    OutputJob output;
+    output.fps = fps;
+    output.type = jobType;
+    output.params = params;
+    m_outputJobs[jobId] << output;
+}
+
+void JobManager::deleteAllJobs()
+{
+    QMutexLocker lock(&m_jobMutex);
+    QSet<AbstractClipJob *> jobs;
+    QHash<QString, QList<AbstractClipJob *> >::const_iterator it = m_clipJobs.constBegin();
+    for (; it != m_clipJobs.constEnd(); ++it) {
+        for (int i = 0; i < it.value().count(); ++i) {
+            jobs.insert(it.value().at(i));
         }
     }
-    // Thread finished, cleanup & update count
-    QTimer::singleShot(200, this, &JobManager::checkJobProcess);
+    qDeleteAll(jobs);
+    m_clipJobs.clear();
+    for (int i = 0; i < m_queues.count(); ++i) {
+        m_queues[i].clear();
+    }
+    m_runningJobs.clear();
+    m_jobs.clear();
+    m_blockedJobs.clear();
+    m_dependents.clear();
+    m_failedJobs.clear();
+    m_outputJobs.clear();
+    m_pendingCount = 0;
 }
 
 QList<ProjectClip *> JobManager::filterClips(const QList<ProjectClip *> &clips, AbstractClipJob::JOBTYPE jobType, const QStringList &params)
@@ -258,13 +408,14 @@ void JobManager::prepareJobFromTimeline(ProjectClip *clip, const QMap<QString, Q
     launchJob(clip, job);
 }
 
-void JobManager::prepareJobs(const QList<ProjectClip *> &clips, double fps, AbstractClipJob::JOBTYPE jobType, const QStringList &params)
+QHash<QString, int> JobManager::prepareJobs(const QList<ProjectClip *> &clips, double fps, AbstractClipJob::JOBTYPE jobType, const QStringList &params, const QHash<QString, int> &dependencies)
 {
+    QHash<QString, int> jobIds;
     //TODO filter clips
     QList<ProjectClip *> matching = filterClips(clips, jobType, params);
     if (matching.isEmpty()) {
         m_bin->doDisplayMessage(i18n("No valid clip to process"), KMessageWidget::Information);
-        return;
+        return jobIds;
     }
     QHash<ProjectClip *, AbstractClipJob *> jobs;
     if (jobType == AbstractClipJob::TRANSCODEJOB) {
@@ -284,24 +435,76 @@ void JobManager::prepareJobs(const QList<ProjectClip *> &clips, double fps, Abst
         QHashIterator<ProjectClip *, AbstractClipJob *> i(jobs);
         while (i.hasNext()) {
             i.next();
-            launchJob(i.key(), i.value(), false);
+            const QString clipId = i.key()->clipId();
+            QList<int> clipDependencies;
+            if (dependencies.contains(clipId)) {
+                clipDependencies << dependencies.value(clipId);
+            }
+            const int jobId = launchJob(i.key(), i.value(), false, clipDependencies);
+            if (jobId >= 0) {
+                jobIds.insert(clipId, jobId);
+            }
         }
-        slotCheckJobProcess();
+        updateJobCount();
+        dispatchJobs();
     }
+    return jobIds;
 }
 
-void JobManager::launchJob(ProjectClip *clip, AbstractClipJob *job, bool runQueue)
+int JobManager::launchJob(ProjectClip *clip, AbstractClipJob *job, bool runQueue, const QList<int> &dependencies)
 {
     if (job->isExclusive() && hasPendingJob(clip->clipId(), job->jobType)) {
         delete job;
-        return;
+        return -1;
     }
 
-    m_jobList.append(job);
+    QMutexLocker lock(&m_jobMutex);
+    QList<int> blocking;
+    for (int i = 0; i < dependencies.count(); ++i) {
+        const int dependency = dependencies.at(i);
+        if (m_failedJobs.contains(dependency)) {
+            lock.unlock();
+            emit updateJobStatus(clip->clipId(), job->jobType, JobAborted);
+            delete job;
+            return -1;
+        }
+        if (m_jobs.contains(dependency) && !blocking.contains(dependency)) {
+            // Jobs no longer in the graph are done
+            blocking << dependency;
+        }
+    }
+    MeltJob *meltJob = qobject_cast<MeltJob *>(job);
+    if (blocking.isEmpty() && meltJob != nullptr) {
+        // Run analysis filters of the same clip zone in one graph
+        const QList<AbstractClipJob *> clipJobs = m_clipJobs.value(clip->clipId());
+        for (int i = 0; i < clipJobs.count(); ++i) {
+            MeltJob *host = qobject_cast<MeltJob *>(clipJobs.at(i));
+            if (host && !m_runningJobs.contains(host) && !m_blockedJobs.contains(host->jobId) && host->canFuse(meltJob)) {
+                host->fuse(meltJob);
+                return host->jobId;
+            }
+        }
+    }
+    job->jobId = m_nextJobId++;
+    m_jobs.insert(job->jobId, job);
+    if (blocking.isEmpty()) {
+        m_queues[jobPriority(job->jobType)].append(job);
+    } else {
+        m_blockedJobs.insert(job->jobId, blocking.count());
+        for (int i = 0; i < blocking.count(); ++i) {
+            m_dependents[blocking.at(i)].append(job->jobId);
+        }
+    }
+    m_clipJobs[clip->clipId()].append(job);
+    ++m_pendingCount;
+    const int jobId = job->jobId;
+    lock.unlock();
     clip->setJobStatus(job->jobType, JobWaiting, 0, job->statusMessage());
     if (runQueue) {
-        slotCheckJobProcess();
+        updateJobCount();
+        dispatchJobs();
     }
+    return jobId;
 }
 
 void JobManager::slotDiscardClipJobs()
@@ -322,11 +525,20 @@ void JobManager::slotDiscardClipJobs()
 void JobManager::slotCancelPendingJobs()
 {
     QMutexLocker lock(&m_jobMutex);
-    for (int i = 0; i < m_jobList.count(); ++i) {
-        if (m_jobList.at(i)->status() == JobWaiting) {
+    QList<AbstractClipJob *> jobs;
+    QHash<int, int>::const_iterator it = m_blockedJobs.constBegin();
+    for (; it != m_blockedJobs.constEnd(); ++it) {
+        jobs << m_jobs.value(it.key());
+    }
+    for (int i = 0; i < m_queues.count(); ++i) {
+        jobs << m_queues.at(i);
+    }
+    for (int i = 0; i < jobs.count(); ++i) {
+        AbstractClipJob *job = jobs.at(i);
+        if (job->status() == JobWaiting && m_jobs.contains(job->jobId)) {
             // discard this job
-            m_jobList.at(i)->setStatus(JobAborted);
-            emit updateJobStatus(m_jobList.at(i)->clipId(), m_jobList.at(i)->jobType, JobAborted);
+            emit updateJobStatus(job->clipId(), job->jobType, JobAborted);
+            abortJob(job);
         }
     }
     updateJobCount();
@@ -335,11 +547,15 @@ void JobManager::slotCancelPendingJobs()
 void JobManager::slotCancelJobs()
 {
     m_abortAllJobs = true;
-    for (int i = 0; i < m_jobList.count(); ++i) {
-        m_jobList.at(i)->setStatus(JobAborted);
+    m_jobMutex.lock();
+    QHash<QString, QList<AbstractClipJob *> >::const_iterator it = m_clipJobs.constBegin();
+    for (; it != m_clipJobs.constEnd(); ++it) {
+        for (int i = 0; i < it.value().count(); ++i) {
+            it.value().at(i)->setStatus(JobAborted);
+        }
     }
-    m_jobThreads.waitForFinished();
-    m_jobThreads.clearFutures();
+    m_jobMutex.unlock();
+    m_threadPool.waitForDone();
 
     //TODO: undo job cancelation ? not sure it's necessary
     /*QUndoCommand *command = new QUndoCommand();
@@ -360,10 +576,7 @@ void JobManager::slotCancelJobs()
     }
     else delete command;
     */
-    if (!m_jobList.isEmpty()) {
-        qDeleteAll(m_jobList);
-    }
-    m_jobList.clear();
+    deleteAllJobs();
     m_abortAllJobs = false;
     emit jobCount(0);
 }
@@ -25,9 +25,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "definitions.h"
 #include "abstractclipjob.h"
 
+#include <QHash>
 #include <QObject>
 #include <QMutex>
-#include <QFutureSynchronizer>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
 
 class AbstractClipJob;
 class Bin;
@@ -37,6 +40,22 @@ class ProjectClip;
  * @class JobManager
  * @brief This class is responsible for clip jobs management.
  *
+ * Waiting jobs are kept in one queue per priority level, see jobPriority().
+ * Up to proxythreads jobs run at once on the manager's thread pool, and the
+ * next job is started as soon as one finishes. Jobs are also indexed by clip
+ * id, so that status queries do not scan the whole job list.
+ *
+ * Jobs can depend on other jobs, forming a graph such as proxy, then
+ * analysis. Jobs are identified by their jobId, since a finished job is
+ * deleted. A job is only queued once all its dependencies are done, and is
+ * aborted with everything downstream if one of them fails; independent
+ * branches still run in parallel. A job creating a new clip, like
+ * transcoding, cannot be a dependency of jobs on that clip since it does
+ * not exist yet: such jobs are requested with prepareOutputJob() and
+ * started once the new clip is loaded.
+ *
+ * Analysis jobs reading the same clip zone are fused into one MLT graph,
+ * see MeltJob::fuse().
  */
 
 class JobManager : public QObject
@@ -73,8 +92,18 @@ public:
      *  @param clips the list of selected clips
      *  @param jobType the jobtype requested
      *  @param type the parameters for the job
+     *  @param dependencies id of a job that must be done first, by clip id
+     *  @returns the id of the job started for each clip id
      */
-    void prepareJobs(const QList<ProjectClip *> &clips, double fps, AbstractClipJob::JOBTYPE jobType, const QStringList &params = QStringList());
+    QHash<QString, int> prepareJobs(const QList<ProjectClip *> &clips, double fps, AbstractClipJob::JOBTYPE jobType, const QStringList &params = QStringList(), const QHash<QString, int> &dependencies = QHash<QString, int>());
+
+    /** @brief Requests a job on the clip that job jobId adds to the project, see AbstractClipJob::addClipToProject().
+     *  The job is prepared once the new clip is loaded in the bin, and dropped if job jobId fails.
+     */
+    void prepareOutputJob(int jobId, double fps, AbstractClipJob::JOBTYPE jobType, const QStringList &params = QStringList());
+
+    /** @brief Returns the id of a waiting or running job of this type on a clip, or -1. */
+    int pendingJobId(const QString &clipId, AbstractClipJob::JOBTYPE type);
 
     /** @brief Filter a list of selected clips to keep only those that match the job type
      *  @param clips the list of selected clips
@@ -88,16 +117,20 @@ public:
      *  @param clip the clip to whom the job will be applied
      *  @param job the job
      *  @param runQueue If true, try to start the job right now. False waits for a later command to start processing, useful when adding many jobs quickly.
+     *  @param dependencies ids of the jobs that must be done before this one starts
+     *  @returns the id of the job that will process the request, which is another job when job was fused with it, or -1 if the job was discarded
      */
-    void launchJob(ProjectClip *clip, AbstractClipJob *job, bool runQueue = true);
+    int launchJob(ProjectClip *clip, AbstractClipJob *job, bool runQueue = true, const QList<int> &dependencies = QList<int>());
 
     /** @brief Get the list of job names for current clip. */
     QStringList getPendingJobs(const QString &id);
 
 private slots:
-    void slotCheckJobProcess();
-    void slotProcessJobs();
     void slotProcessLog(const QString &id, int progress, int type, const QString &message);
+    /** @brief Forgets a finished job and starts the next waiting ones. */
+    void slotJobFinished(AbstractClipJob *job);
+    /** @brief Prepares the jobs requested on a clip created by another job. */
+    void slotClipReady(const QString &id);
 
 public slots:
     /** @brief Discard jobs running on a clip whose id is in the calling action's data. */
@@ -112,16 +145,55 @@ private:
     Bin *m_bin;
     /** @brief Mutex preventing thread issues. */
     QMutex m_jobMutex;
-    /** @brief Holds a list of active jobs. */
-    QList<AbstractClipJob *> m_jobList;
-    /** @brief Holds the threads running a job. */
-    QFutureSynchronizer<void> m_jobThreads;
+    /** @brief Waiting jobs, one queue per priority level, highest priority first. */
+    QVector<QList<AbstractClipJob *> > m_queues;
+    /** @brief Waiting and running jobs of each clip. */
+    QHash<QString, QList<AbstractClipJob *> > m_clipJobs;
+    /** @brief Jobs started on the thread pool and not yet finished. */
+    QSet<AbstractClipJob *> m_runningJobs;
+    /** @brief A job requested on the clip created by another job. */
+    struct OutputJob {
+        double fps;
+        AbstractClipJob::JOBTYPE type;
+        QStringList params;
+    };
+    int m_nextJobId;
+    /** @brief Waiting, blocked and running jobs by id. */
+    QHash<int, AbstractClipJob *> m_jobs;
+    /** @brief Jobs waiting for their dependencies, with the number of dependencies not done yet. */
+    QHash<int, int> m_blockedJobs;
+    /** @brief Ids of the jobs waiting for each job. */
+    QHash<int, QList<int> > m_dependents;
+    /** @brief Ids of the jobs that crashed or were aborted, so that jobs depending on them are not started. */
+    QSet<int> m_failedJobs;
+    /** @brief Jobs requested on the clip created by a job, by job id. */
+    QHash<int, QList<OutputJob> > m_outputJobs;
+    /** @brief Jobs requested on a created clip that is not loaded yet, by clip url. */
+    QHash<QString, QList<OutputJob> > m_createdClipJobs;
+    /** @brief Number of waiting and running jobs that were not aborted. */
+    int m_pendingCount;
+    /** @brief Runs the jobs, sized by the proxythreads setting. */
+    QThreadPool m_threadPool;
     /** @brief Set to true to trigger abortion of all jobs. */
     bool m_abortAllJobs;
     /** @brief Create a proxy for a clip. */
     void createProxy(const QString &id);
     /** @brief Update job count in info widget. */
     void updateJobCount();
+    /** @brief Returns the queue of a job type, 0 being the most urgent. */
+    static int jobPriority(AbstractClipJob::JOBTYPE type);
+    /** @brief Starts waiting jobs until all threads are busy. */
+    void dispatchJobs();
+    /** @brief Processes a job, in a thread of the pool. */
+    void runJob(AbstractClipJob *job);
+    /** @brief Removes a job from the clip index, m_jobMutex must be locked. */
+    void unindexJob(AbstractClipJob *job);
+    /** @brief Deletes all jobs, none may be running. */
+    void deleteAllJobs();
+    /** @brief Aborts a job and the jobs depending on it, m_jobMutex must be locked. */
+    void abortJob(AbstractClipJob *job);
+    /** @brief Queues or aborts the jobs depending on a finished job, m_jobMutex must be locked. */
+    void releaseDependents(AbstractClipJob *job);
 
 signals:
     void addClip(const QString &, int folderId);
@@ -129,7 +201,10 @@ signals:
     void updateJobStatus(const QString &, int, int, const QString &label = QString(), const QString &actionName = QString(), const QString &details = QString());
     void gotFilterJobResults(const QString &, int, int, stringMap, stringMap);
     void jobCount(int);
-    void checkJobProcess();
+    /** @brief A clip can use path as proxy, emitted from the pool thread so that partial and final proxies arrive in order. */
+    void gotProxy(const QString &id, const QString &path);
+    /** @brief Emitted from the pool thread when a job is done. */
+    void jobFinished(AbstractClipJob *job);
 };
 
 #endif
@@ -76,21 +76,17 @@ void MeltJob::startJob()
     int out = m_producerParams.value(QStringLiteral("out")).toInt();
     QString filterName = m_filterParams.value(QStringLiteral("filter"));
 
-    // optional params
-    int startPos = -1;
-    int track = -1;
-
-    // used when triggering a job from an effect
-    if (m_extra.contains(QStringLiteral("clipStartPos"))) {
-        startPos = m_extra.value(QStringLiteral("clipStartPos")).toInt();
-    }
-    if (m_extra.contains(QStringLiteral("clipTrack"))) {
-        track = m_extra.value(QStringLiteral("clipTrack")).toInt();
-    }
-
     if (!m_extra.contains(QStringLiteral("finalfilter"))) {
         m_extra.insert(QStringLiteral("finalfilter"), filterName);
     }
+    foreach (MeltJob *fused, m_fusedJobs) {
+        if (in > 0 && !fused->m_extra.contains(QStringLiteral("offset"))) {
+            fused->m_extra.insert(QStringLiteral("offset"), QString::number(in));
+        }
+        if (!fused->m_extra.contains(QStringLiteral("finalfilter"))) {
+            fused->m_extra.insert(QStringLiteral("finalfilter"), fused->m_filterParams.value(QStringLiteral("filter")));
+        }
+    }
 
     if (out != -1 && out <= in) {
         m_errorMessage.append(i18n("Clip zone undefined (%1 - %2).", in, out));
@@ -184,26 +180,18 @@ void MeltJob::startJob()
         m_consumer->set("root", QFileInfo(m_dest).absolutePath().toUtf8().constData());
     }
 
-    // Build filter
-    if (!filterName.isEmpty()) {
-        m_filter = new Mlt::Filter(*m_profile, filterName.toUtf8().data());
-        if (!m_filter || !m_filter->is_valid()) {
-            m_errorMessage = i18n("Filter %1 crashed", filterName);
+    // Build filters, fused jobs share our profile
+    QList<MeltJob *> parts;
+    parts << this << m_fusedJobs;
+    foreach (MeltJob *part, parts) {
+        part->m_profile = m_profile;
+        bool created = part->createFilter();
+        part->m_profile = nullptr;
+        if (!created) {
+            m_errorMessage = i18n("Filter %1 crashed", part->m_filterParams.value(QStringLiteral("filter")));
             setStatus(JobCrashed);
             return;
         }
-
-        // Process filter params
-        QMapIterator<QString, QString> k(m_filterParams);
-        ignoredProps.clear();
-        ignoredProps << QStringLiteral("filter");
-        while (k.hasNext()) {
-            k.next();
-            QString key = k.key();
-            if (!ignoredProps.contains(key)) {
-                m_filter->set(k.key().toUtf8().constData(), k.value().toUtf8().constData());
-            }
-        }
     }
     Mlt::Tractor tractor(*m_profile);
     Mlt::Playlist playlist;
@@ -216,28 +204,78 @@ void MeltJob::startJob()
     if (m_length == 0) {
         m_length = m_producer->get_length();
     }
-    if (m_filter) {
-        m_producer->attach(*m_filter);
+    foreach (MeltJob *part, parts) {
+        if (part->m_filter) {
+            m_producer->attach(*part->m_filter);
+        }
     }
     m_showFrameEvent = m_consumer->listen("consumer-frame-render", this, (mlt_listener) consumer_frame_render);
     m_producer->set_speed(1);
     m_consumer->run();
 
-    QMap<QString, QString> jobResults;
-    if (m_jobStatus != JobAborted && m_extra.contains(QStringLiteral("key"))) {
-        QString result = QString::fromLatin1(m_filter->get(m_extra.value(QStringLiteral("key")).toUtf8().constData()));
-        jobResults.insert(m_extra.value(QStringLiteral("key")), result);
-    }
-    if (!jobResults.isEmpty() && m_jobStatus != JobAborted) {
-        emit gotFilterJobResults(m_clipId, startPos, track, jobResults, m_extra);
+    foreach (MeltJob *part, parts) {
+        QMap<QString, QString> jobResults;
+        if (m_jobStatus != JobAborted && part->m_filter && part->m_extra.contains(QStringLiteral("key"))) {
+            QString result = QString::fromLatin1(part->m_filter->get(part->m_extra.value(QStringLiteral("key")).toUtf8().constData()));
+            jobResults.insert(part->m_extra.value(QStringLiteral("key")), result);
+        }
+        if (!jobResults.isEmpty() && m_jobStatus != JobAborted) {
+            // used when triggering a job from an effect
+            int startPos = part->m_extra.value(QStringLiteral("clipStartPos"), QStringLiteral("-1")).toInt();
+            int track = part->m_extra.value(QStringLiteral("clipTrack"), QStringLiteral("-1")).toInt();
+            emit gotFilterJobResults(m_clipId, startPos, track, jobResults, part->m_extra);
+        }
     }
     if (m_jobStatus == JobWorking) {
         m_jobStatus = JobDone;
     }
 }
 
+bool MeltJob::createFilter()
+{
+    QString filterName = m_filterParams.value(QStringLiteral("filter"));
+    if (filterName.isEmpty()) {
+        return true;
+    }
+    m_filter = new Mlt::Filter(*m_profile, filterName.toUtf8().data());
+    if (!m_filter || !m_filter->is_valid()) {
+        return false;
+    }
+
+    // Process filter params
+    QMapIterator<QString, QString> k(m_filterParams);
+    while (k.hasNext()) {
+        k.next();
+        if (k.key() != QLatin1String("filter")) {
+            m_filter->set(k.key().toUtf8().constData(), k.value().toUtf8().constData());
+        }
+    }
+    return true;
+}
+
+bool MeltJob::canFuse(const MeltJob *other) const
+{
+    return other != this && jobType == other->jobType
+           && m_jobStatus == JobWaiting && other->m_jobStatus == JobWaiting
+           && m_dest.isEmpty() && other->m_dest.isEmpty()
+           && !m_filterParams.value(QStringLiteral("filter")).isEmpty()
+           && !other->m_filterParams.value(QStringLiteral("filter")).isEmpty()
+           && m_url == other->m_url
+           && m_producerParams == other->m_producerParams
+           && m_consumerParams == other->m_consumerParams
+           && m_extra.value(QStringLiteral("producer_profile")) == other->m_extra.value(QStringLiteral("producer_profile"))
+           && m_extra.value(QStringLiteral("resize_profile")) == other->m_extra.value(QStringLiteral("resize_profile"));
+}
+
+void MeltJob::fuse(MeltJob *other)
+{
+    m_fusedJobs << other;
+    description = i18np("Processing clip", "Processing clip (%1 filters)", m_fusedJobs.count() + 1);
+}
+
 MeltJob::~MeltJob()
 {
+    qDeleteAll(m_fusedJobs);
     delete m_showFrameEvent;
     delete m_filter;
     delete m_producer;
@@ -69,6 +69,11 @@ public:
     void setStatus(ClipJobStatus status) Q_DECL_OVERRIDE;
     /** @brief Here we will send the current progress info to anyone interested. */
     void emitFrameNumber(int pos);
+    /** @brief Returns true if the filter of other can be run in the same MLT graph as this job.
+     *  Both jobs must be waiting analysis jobs (writing no file) reading the same producer zone. */
+    bool canFuse(const MeltJob *other) const;
+    /** @brief Takes ownership of other and attaches its filter to this job's producer, so that the clip is decoded once for both. */
+    void fuse(MeltJob *other);
 
 private:
     Mlt::Consumer *m_consumer;
@@ -83,6 +88,10 @@ private:
     QString m_url;
     int m_length;
     QMap<QString, QString> m_extra;
+    /** @brief Jobs whose filters are run by this job, see fuse(). */
+    QList<MeltJob *> m_fusedJobs;
+    /** @brief Builds m_filter from m_filterParams, returns false on failure. */
+    bool createFilter();
 
 signals:
     /** @brief When user requested a to process an Mlt::Filter, this will send back all necessary infos. */
@@ -24,15 +24,27 @@
 #include "doc/kdenlivedoc.h"
 #include "bin/projectclip.h"
 #include "bin/bin.h"
+#include <QDomDocument>
 #include <QProcess>
+#include <QSaveFile>
 #include <QTemporaryFile>
 
 #include <klocalizedstring.h>
+#include <mlt++/Mlt.h>
+
+namespace {
+// Duration of the proxy segments, in seconds
+const int SegmentSeconds = 30;
+// Minimum delay between two reloads of the partial proxy, in milliseconds
+const int PublishInterval = 30000;
+}
 
 ProxyJob::ProxyJob(ClipType cType, const QString &id, const QStringList &parameters, QTemporaryFile *playlist)
     : AbstractClipJob(PROXYJOB, cType, id),
       m_jobDuration(0),
-      m_isFfmpegJob(true)
+      m_isFfmpegJob(true),
+      m_progressive(false),
+      m_publishedSegments(0)
 {
     m_jobStatus = JobWaiting;
     description = i18n("proxy");
@@ -194,7 +206,22 @@ void ProxyJob::startJob()
                 }
             }
         }
-        parameters << m_dest;
+        // Encode video in segments, so that the clip can use them before the end
+        m_progressive = (clipType == AV || clipType == Video) && !m_proxyParams.contains(QLatin1String("-f ")) && !m_dest.contains(QLatin1Char('%'));
+        if (m_progressive) {
+            m_segmentPattern = m_dest + QStringLiteral(".part%05d.") + QFileInfo(m_dest).suffix();
+            m_segmentList = m_dest + QStringLiteral(".parts.csv");
+            removeSegments(m_dest);
+            // Segments can only be cut on key frames
+            parameters << QStringLiteral("-force_key_frames") << QStringLiteral("expr:gte(t,n_forced*%1)").arg(SegmentSeconds);
+            parameters << QStringLiteral("-f") << QStringLiteral("segment") << QStringLiteral("-segment_time") << QString::number(SegmentSeconds);
+            parameters << QStringLiteral("-reset_timestamps") << QStringLiteral("1");
+            parameters << QStringLiteral("-segment_list") << m_segmentList << QStringLiteral("-segment_list_type") << QStringLiteral("csv");
+            parameters << m_segmentPattern;
+            m_lastPublish.start();
+        } else {
+            parameters << m_dest;
+        }
         m_jobProcess = new QProcess;
         m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
@@ -202,6 +229,9 @@ void ProxyJob::startJob()
     }
     while (m_jobProcess->state() != QProcess::NotRunning) {
         processLogInfo();
+        if (m_progressive && m_jobStatus != JobAborted) {
+            updateSegments();
+        }
         if (m_jobStatus == JobAborted) {
             emit cancelRunningJob(m_clipId, cancelProperties());
             m_jobProcess->close();
@@ -214,6 +244,10 @@ void ProxyJob::startJob()
     delete m_playlist;
     if (m_jobStatus != JobAborted) {
         int result = m_jobProcess->exitStatus();
+        if (result == QProcess::NormalExit && m_progressive && !joinSegments()) {
+            processLogInfo();
+            QFile::remove(m_dest);
+        }
         if (result == QProcess::NormalExit) {
             if (QFileInfo(m_dest).size() == 0) {
                 // File was not created
@@ -229,9 +263,163 @@ void ProxyJob::startJob()
             setStatus(JobCrashed);
         }
     }
+    if (m_progressive) {
+        if (m_publishedSegments == 0) {
+            removeSegments(m_dest);
+        } else if (m_jobStatus != JobDone) {
+            emit gotPartialProxy(m_clipId, QStringLiteral("-"));
+        }
+        // Otherwise the bin deletes the segments once the clip stopped using them
+    }
     delete m_jobProcess;
 }
 
+// static
+QString ProxyJob::segmentPath(const QString &dest, int index)
+{
+    return dest + QStringLiteral(".part") + QString::number(index).rightJustified(5, QLatin1Char('0')) + QLatin1Char('.') + QFileInfo(dest).suffix();
+}
+
+void ProxyJob::updateSegments()
+{
+    QFile list(m_segmentList);
+    if (!list.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+    QString data = QString::fromUtf8(list.readAll());
+    // Ignore a line that is still being written
+    data.truncate(data.lastIndexOf(QLatin1Char('\n')) + 1);
+    const QStringList lines = data.split(QLatin1Char('\n'), QString::SkipEmptyParts);
+    for (int i = m_segments.count(); i < lines.count(); ++i) {
+        // Lines are: file name,start time,end time
+        bool ok = false;
+        double end = lines.at(i).section(QLatin1Char(','), -1).toDouble(&ok);
+        if (!ok) {
+            break;
+        }
+        m_segments << segmentPath(m_dest, i);
+        m_segmentEnds << end;
+    }
+    if (m_segments.count() > m_publishedSegments && (m_publishedSegments == 0 || m_lastPublish.elapsed() > PublishInterval)) {
+        if (writeProgressivePlaylist()) {
+            m_publishedSegments = m_segments.count();
+            m_lastPublish.restart();
+            emit gotPartialProxy(m_clipId, progressivePlaylist(m_dest));
+        }
+    }
+}
+
+bool ProxyJob::writeProgressivePlaylist()
+{
+    Mlt::Profile profile(KdenliveSettings::current_profile().toUtf8().constData());
+    const double fps = profile.fps();
+    QDomDocument doc;
+    QDomElement mlt = doc.createElement(QStringLiteral("mlt"));
+    doc.appendChild(mlt);
+    QDomElement playlist = doc.createElement(QStringLiteral("playlist"));
+    playlist.setAttribute(QStringLiteral("id"), QStringLiteral("main"));
+    QStringList resources = m_segments;
+    resources << m_src;
+    int position = 0;
+    for (int i = 0; i < resources.count(); ++i) {
+        const QString id = i < m_segments.count() ? QStringLiteral("segment%1").arg(i) : QStringLiteral("source");
+        QDomElement producer = doc.createElement(QStringLiteral("producer"));
+        producer.setAttribute(QStringLiteral("id"), id);
+        QDomElement property = doc.createElement(QStringLiteral("property"));
+        property.setAttribute(QStringLiteral("name"), QStringLiteral("resource"));
+        property.appendChild(doc.createTextNode(resources.at(i)));
+        producer.appendChild(property);
+        mlt.appendChild(producer);
+
+        QDomElement entry = doc.createElement(QStringLiteral("entry"));
+        entry.setAttribute(QStringLiteral("producer"), id);
+        if (i < m_segments.count()) {
+            const int end = qRound(m_segmentEnds.at(i) * fps);
+            entry.setAttribute(QStringLiteral("in"), 0);
+            entry.setAttribute(QStringLiteral("out"), end - position - 1);
+            position = end;
+        } else {
+            // The original clip plays what is not encoded yet
+            entry.setAttribute(QStringLiteral("in"), position);
+        }
+        playlist.appendChild(entry);
+    }
+    mlt.appendChild(playlist);
+
+    // The previous playlist may be in use
+    QSaveFile file(progressivePlaylist(m_dest));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(doc.toByteArray());
+    return file.commit();
+}
+
+bool ProxyJob::joinSegments()
+{
+    // ffmpeg lists the last segment when it exits
+    updateSegments();
+    if (m_segments.isEmpty()) {
+        m_errorMessage.append(i18n("Failed to create proxy clip."));
+        return false;
+    }
+    QFile::remove(m_dest);
+    if (m_segments.count() == 1) {
+        // The partial proxy may still read the segment
+        return QFile::copy(m_segments.first(), m_dest);
+    }
+    const QString listPath = m_dest + QStringLiteral(".parts.txt");
+    QFile list(listPath);
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    foreach (QString segment, m_segments) {
+        segment.replace(QLatin1Char('\''), QLatin1String("'\\''"));
+        list.write(QStringLiteral("file '%1'\n").arg(segment).toUtf8());
+    }
+    list.close();
+
+    QStringList parameters;
+    parameters << QStringLiteral("-y") << QStringLiteral("-f") << QStringLiteral("concat") << QStringLiteral("-safe") << QStringLiteral("0");
+    parameters << QStringLiteral("-i") << listPath << QStringLiteral("-c") << QStringLiteral("copy") << m_dest;
+    QProcess join;
+    join.setProcessChannelMode(QProcess::MergedChannels);
+    join.start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
+    join.waitForStarted();
+    while (join.state() != QProcess::NotRunning) {
+        if (m_jobStatus == JobAborted) {
+            join.close();
+            join.waitForFinished();
+            return false;
+        }
+        join.waitForFinished(400);
+    }
+    QFile::remove(listPath);
+    if (join.exitStatus() != QProcess::NormalExit || join.exitCode() != 0) {
+        m_logDetails.append(QString::fromUtf8(join.readAll()));
+        m_errorMessage.append(i18n("Failed to join proxy segments."));
+        return false;
+    }
+    return true;
+}
+
+// static
+void ProxyJob::removeSegments(const QString &dest)
+{
+    for (int i = 0; QFile::exists(segmentPath(dest, i)); ++i) {
+        QFile::remove(segmentPath(dest, i));
+    }
+    QFile::remove(dest + QStringLiteral(".parts.csv"));
+    QFile::remove(dest + QStringLiteral(".parts.txt"));
+    QFile::remove(progressivePlaylist(dest));
+}
+
+// static
+QString ProxyJob::progressivePlaylist(const QString &dest)
+{
+    return dest + QStringLiteral(".progress.mlt");
+}
+
 void ProxyJob::processLogInfo()
 {
     if (!m_jobProcess || m_jobStatus == JobAborted) {
@@ -339,6 +527,10 @@ QHash<ProjectClip *, AbstractClipJob *> ProxyJob::prepareJob(Bin *bin, const QLi
             item->setJobStatus(AbstractClipJob::PROXYJOB, JobCrashed, -1, i18n("Failed to create proxy, empty path."));
             continue;
         }
+        if (path.endsWith(progressivePlaylist(QString()))) {
+            // The project was saved while the proxy was encoded
+            path.chop(progressivePlaylist(QString()).length());
+        }
         // Reset proxy path until it is really created
         item->setProducerProperty(QStringLiteral("_proxy"), path.toUtf8().constData());
         item->setProducerProperty(QStringLiteral("kdenlive:proxy"), QString());
@@ -23,10 +23,22 @@
 
 #include "abstractclipjob.h"
 
+#include <QStringList>
+#include <QTime>
+
 class QTemporaryFile;
 class Bin;
 class ProjectClip;
 
+/**
+ * @class ProxyJob
+ * @brief Creates the proxy of a clip.
+ *
+ * Video clips are encoded in segments. While encoding, the finished segments
+ * are published as a playlist that continues with the original clip, so that
+ * the clip can be edited with its proxy before the encoding is done. The
+ * segments are joined into the proxy file at the end.
+ */
 class ProxyJob : public AbstractClipJob
 {
     Q_OBJECT
@@ -41,6 +53,10 @@ public:
     void processLogInfo() Q_DECL_OVERRIDE;
     static QList<ProjectClip *> filterClips(const QList<ProjectClip *> &clips);
     static QHash<ProjectClip *, AbstractClipJob *> prepareJob(Bin *bin, const QList<ProjectClip *> &clips);
+    /** @brief Returns the playlist used as proxy while the proxy dest is encoded. */
+    static QString progressivePlaylist(const QString &dest);
+    /** @brief Deletes the segments of the proxy dest and their lists. */
+    static void removeSegments(const QString &dest);
 
 private:
     QString m_dest;
@@ -52,6 +68,30 @@ private:
     int m_jobDuration;
     bool m_isFfmpegJob;
     QTemporaryFile *m_playlist;
+    /** @brief True when the proxy is encoded in segments. */
+    bool m_progressive;
+    /** @brief ffmpeg file name pattern of the segments. */
+    QString m_segmentPattern;
+    /** @brief CSV list of the finished segments, written by ffmpeg. */
+    QString m_segmentList;
+    /** @brief Finished segments with their end time, in seconds. */
+    QStringList m_segments;
+    QList<double> m_segmentEnds;
+    /** @brief Number of segments in the last published playlist. */
+    int m_publishedSegments;
+    QTime m_lastPublish;
+    /** @brief Returns the path of a segment file. */
+    static QString segmentPath(const QString &dest, int index);
+    /** @brief Reads the finished segments, and publishes them from time to time. */
+    void updateSegments();
+    /** @brief Writes the playlist of the finished segments followed by the original clip. */
+    bool writeProgressivePlaylist();
+    /** @brief Joins the segments into the proxy file. */
+    bool joinSegments();
+
+signals:
+    /** @brief The clip can use path as proxy until the job is done, "-" if it must go back to the original clip. */
+    void gotPartialProxy(const QString &id, const QString &path);
 };
 
 #endif
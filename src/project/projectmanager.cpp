@@ -317,6 +317,8 @@ bool ProjectManager::saveFileAs(const QString &outputFileName)
     saveRecentFiles();
     m_fileRevert->setEnabled(true);
     pCore->window()->m_undoView->stack()->setClean();
+    // Drop the undo data of discarded commands from disk
+    m_project->commandStack()->compactSpillFile();
 
     return true;
 }
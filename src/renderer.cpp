@@ -32,6 +32,8 @@
 #include "bin/projectclip.h"
 #include "timeline/clip.h"
 #include "monitor/glwidget.h"
+#include "monitor/scopes/sharedframe.h"
+#include "monitor/framecache.h"
 #include "mltcontroller/clipcontroller.h"
 #include "timeline/transitionhandler.h"
 #include "core.h"
@@ -51,6 +53,9 @@
 #include <QPushButton>
 
 #define SEEK_INACTIVE (-1)
+// Smooth preview quality checks (500ms each) before trying a better quality
+static const int MinQualityProbeDelay = 10;
+static const int MaxQualityProbeDelay = 120;
 
 Render::Render(Kdenlive::MonitorId rendererName, BinController *binController, GLWidget *qmlView, QWidget *parent) :
     AbstractRender(rendererName, parent),
@@ -69,7 +74,16 @@ Render::Render(Kdenlive::MonitorId rendererName, BinController *binController, G
     m_isLoopMode(false),
     m_blackClip(nullptr),
     m_isActive(false),
-    m_isRefreshing(false)
+    m_isRefreshing(false),
+    m_frameCache(nullptr),
+    m_cachedSeekPosition(SEEK_INACTIVE),
+    m_cacheSamplePosition(-1),
+    m_previewDrops(0),
+    m_playingChecks(0),
+    m_lateChecks(0),
+    m_smoothChecks(0),
+    m_qualityProbeDelay(MinQualityProbeDelay),
+    m_qualityProbing(false)
 {
     qRegisterMetaType<stringMap> ("stringMap");
     analyseAudio = KdenliveSettings::monitor_audio();
@@ -90,11 +104,23 @@ Render::Render(Kdenlive::MonitorId rendererName, BinController *binController, G
     m_refreshTimer.setInterval(50);
     connect(&m_refreshTimer, &QTimer::timeout, this, &Render::refresh);
     connect(this, &Render::checkSeeking, this, &Render::slotCheckSeeking);
+    if (m_name == Kdenlive::ClipMonitor && m_qmlView && !KdenliveSettings::gpu_accel()) {
+        // Movit frames are GPU textures that cannot be kept
+        m_frameCache = new FrameCache(this);
+        connect(m_qmlView, &GLWidget::frameDisplayed, m_frameCache, &FrameCache::store);
+        connect(m_qmlView, &GLWidget::frameDisplayed, this, &Render::slotReadAheadReverse);
+    }
     if (m_name == Kdenlive::ProjectMonitor) {
         connect(m_binController, &BinController::prepareTimelineReplacement, this, &Render::prepareTimelineReplacement, Qt::DirectConnection);
         connect(m_binController, &BinController::replaceTimelineProducer, this, &Render::replaceTimelineProducer, Qt::DirectConnection);
         connect(m_binController, &BinController::updateTimelineProducer, this, &Render::updateTimelineProducer);
         connect(m_binController, &BinController::setDocumentNotes, this, &Render::setDocumentNotes);
+        if (m_qmlView) {
+            connect(m_qmlView, &GLWidget::frameDisplayed, this, &Render::slotSampleCache);
+            m_previewQualityTimer.setInterval(500);
+            connect(&m_previewQualityTimer, &QTimer::timeout, this, &Render::slotCheckPreviewQuality);
+            setAdaptivePreview(KdenliveSettings::adaptivepreview());
+        }
     }
 }
 
@@ -158,6 +184,17 @@ void Render::seek(int time)
 {
     resetZoneMode();
     time = qBound(0, time, m_mltProducer->get_length() - 1);
+    if (m_frameCache && requestedSeekPosition == SEEK_INACTIVE && m_mltProducer->get_speed() == 0 && !externalConsumer && !m_mltConsumer->is_stopped()) {
+        const int direction = time - seekFramePosition();
+        SharedFrame frame = m_frameCache->frame(time);
+        m_frameCache->readAhead(time, direction);
+        if (frame.is_valid() && m_qmlView->showCachedFrame(frame)) {
+            // Seeking the producer would make the consumer decode the frame again
+            m_cachedSeekPosition = time;
+            return;
+        }
+    }
+    m_cachedSeekPosition = SEEK_INACTIVE;
     if (requestedSeekPosition == SEEK_INACTIVE) {
         requestedSeekPosition = time;
         if (m_mltProducer->get_speed() != 0) {
@@ -176,6 +213,14 @@ void Render::seek(int time)
     }
 }
 
+void Render::applyCachedSeek()
+{
+    if (m_cachedSeekPosition != SEEK_INACTIVE && m_mltProducer) {
+        m_mltProducer->seek(m_cachedSeekPosition);
+    }
+    m_cachedSeekPosition = SEEK_INACTIVE;
+}
+
 int Render::frameRenderWidth() const
 {
     return m_qmlView->profile()->width();
@@ -212,6 +257,7 @@ QImage Render::extractFrame(int frame_position, const QString &path, int width,
         pix.fill(Qt::black);
         return pix;
     }
+    applyCachedSeek();
     Mlt::Frame *frame = nullptr;
     QImage img;
     bool profileFromSource = m_mltProducer->get_int("meta.media.width") > width;
@@ -350,6 +396,10 @@ bool Render::updateProducer(Mlt::Producer *producer)
     }
     m_fps = producer->get_fps();
     m_mltProducer = producer;
+    m_cachedSeekPosition = SEEK_INACTIVE;
+    if (m_frameCache) {
+        m_frameCache->setProducer(m_mltProducer);
+    }
     if (m_qmlView) {
         m_qmlView->setProducer(producer);
         m_mltConsumer = m_qmlView->consumer();
@@ -361,6 +411,7 @@ bool Render::setProducer(Mlt::Producer *producer, int position, bool isActive)
 {
     m_refreshTimer.stop();
     requestedSeekPosition = SEEK_INACTIVE;
+    m_cachedSeekPosition = SEEK_INACTIVE;
     QMutexLocker locker(&m_mutex);
     QString currentId;
     int consumerPosition = 0;
@@ -405,6 +456,9 @@ bool Render::setProducer(Mlt::Producer *producer, int position, bool isActive)
     blockSignals(false);
     m_mltProducer = producer;
     m_mltProducer->set_speed(0);
+    if (m_frameCache) {
+        m_frameCache->setProducer(m_mltProducer);
+    }
     if (m_qmlView) {
         m_qmlView->setProducer(producer);
         m_mltConsumer = m_qmlView->consumer();
@@ -494,6 +548,8 @@ int Render::setSceneList(QString playlist, int position)
         error = -1;
     }
     m_mltProducer->set("eof", "pause");
+    m_cacheMonitor.reset();
+    m_cacheSamplePosition = -1;
     checkMaxThreads();
     m_mltProducer->optimise();
 
@@ -572,13 +628,74 @@ void Render::checkMaxThreads()
     }
     Mlt::Tractor tractor(service);
     int mltMaxThreads = mlt_service_cache_get_size(service.get_service(), "producer_avformat");
+    if (m_cacheMonitor.cacheSize() == 0) {
+        m_cacheMonitor.setCacheSize(mltMaxThreads);
+    }
+    // Decoders used at the same time by the tracks and threads
     int requestedThreads = tractor.count() + m_qmlView->realTime() + 2;
-    if (requestedThreads > mltMaxThreads) {
-        mlt_service_cache_set_size(service.get_service(), "producer_avformat", requestedThreads);
-        //qCDebug(KDENLIVE_LOG)<<"// MLT threads updated to: "<<mlt_service_cache_get_size(service.get_service(), "producer_avformat");
+    // Rough memory use of an open decoder: a few decoded reference frames and the codec state
+    Mlt::Profile *profile = m_qmlView->profile();
+    qint64 decoderMemory = (qint64) profile->width() * profile->height() * 3 / 2 * 6 + 4 * 1024 * 1024;
+    int budgetThreads = (int) qMin((qint64) 1000, (qint64) KdenliveSettings::decodercachememory() * 1024 * 1024 / decoderMemory);
+    // Hold the measured working set of the project, within the memory budget
+    int cacheSize = m_cacheMonitor.recommendedSize(requestedThreads, budgetThreads);
+    if (cacheSize != mltMaxThreads) {
+        mlt_service_cache_set_size(service.get_service(), "producer_avformat", cacheSize);
+        qCDebug(KDENLIVE_LOG) << "// MLT decoder cache resized from" << mltMaxThreads << "to" << cacheSize << "-" << m_cacheMonitor.summary();
+    }
+    m_cacheMonitor.setCacheSize(cacheSize);
+}
+
+void Render::slotReadAheadReverse(const SharedFrame &frame)
+{
+    // Reverse shuttling makes the decoder seek back to a keyframe for every frame,
+    // fill the cache backwards so that the next frames are read from memory
+    if (m_mltProducer && m_mltProducer->get_speed() < 0) {
+        m_frameCache->readAhead(frame.get_position(), -1);
+    }
+}
+
+void Render::slotSampleCache(const SharedFrame &frame)
+{
+    if (!m_mltProducer || frame.get_position() == m_cacheSamplePosition) {
+        return;
+    }
+    m_cacheSamplePosition = frame.get_position();
+    Mlt::Service service(m_mltProducer->parent().get_service());
+    if (service.type() != tractor_type) {
+        return;
+    }
+    Mlt::Tractor tractor(service);
+    QVector<quint64> producers;
+    for (int i = 0; i < tractor.count(); ++i) {
+        QScopedPointer<Mlt::Producer> track(tractor.track(i));
+        Mlt::Playlist playlist(*track);
+        if (!playlist.is_valid()) {
+            continue;
+        }
+        int ix = playlist.get_clip_index_at(m_cacheSamplePosition);
+        if (ix < 0 || ix >= playlist.count() || playlist.is_blank(ix)) {
+            continue;
+        }
+        QScopedPointer<Mlt::Producer> clip(playlist.get_clip(ix));
+        Mlt::Producer parent(clip->parent());
+        const QString serviceName = QString::fromLatin1(parent.get("mlt_service"));
+        if (serviceName.startsWith(QLatin1String("avformat")) || serviceName == QLatin1String("timewarp")) {
+            producers << m_cacheMonitor.producerKey(parent);
+        }
+    }
+    m_cacheMonitor.access(producers);
+    // Adapt the cache size every 10 seconds of playback
+    if (m_cacheMonitor.samples() % qMax(1, (int)(m_fps * 10)) == 0) {
+        checkMaxThreads();
     }
 }
 
+QString Render::cacheStatistics() const
+{
+    return m_cacheMonitor.summary();
+}
+
 const QString Render::sceneList(const QString &root)
 {
     QString playlist;
@@ -686,6 +803,7 @@ void Render::stop()
     requestedSeekPosition = SEEK_INACTIVE;
     m_refreshTimer.stop();
     QMutexLocker locker(&m_mutex);
+    applyCachedSeek();
     m_isActive = false;
     if (m_mltProducer) {
         if (m_isZoneMode) {
@@ -712,6 +830,7 @@ void Render::stop(const GenTime &startTime)
         if (m_isZoneMode) {
             resetZoneMode();
         }
+        m_cachedSeekPosition = SEEK_INACTIVE;
         m_mltProducer->set_speed(0.0);
         m_mltProducer->seek((int) startTime.frames(m_fps));
     }
@@ -749,6 +868,7 @@ void Render::switchPlay(bool play, double speed)
     if (m_isZoneMode) {
         resetZoneMode();
     }
+    applyCachedSeek();
     if (play) {
         double currentSpeed = m_mltProducer->get_speed();
         if (m_name == Kdenlive::ClipMonitor && m_mltConsumer->position() == m_mltProducer->get_out() && speed > 0) {
@@ -779,6 +899,7 @@ void Render::play(double speed)
     if (m_isZoneMode) {
         resetZoneMode();
     }
+    applyCachedSeek();
     if (speed != 0 && m_mltConsumer->get_int("real_time") != m_qmlView->realTime()) {
         m_mltConsumer->set("real_time", m_qmlView->realTime());
         m_mltConsumer->set("buffer", 25);
@@ -802,6 +923,7 @@ void Render::play(const GenTime &startTime)
     if (!m_mltProducer || !m_mltConsumer || !m_isActive) {
         return;
     }
+    m_cachedSeekPosition = SEEK_INACTIVE;
     m_mltProducer->seek((int)(startTime.frames(m_fps)));
     m_mltProducer->set_speed(1.0);
     m_isRefreshing = true;
@@ -826,6 +948,7 @@ bool Render::playZone(const GenTime &startTime, const GenTime &stopTime)
     if (!m_mltProducer || !m_mltConsumer || !m_isActive) {
         return false;
     }
+    m_cachedSeekPosition = SEEK_INACTIVE;
     m_mltProducer->seek((int)(startTime.frames(m_fps)));
     m_mltProducer->set_speed(0);
     m_mltConsumer->purge();
@@ -893,6 +1016,11 @@ void Render::refresh()
         return;
     }
     QMutexLocker locker(&m_mutex);
+    applyCachedSeek();
+    if (m_frameCache) {
+        // Clip properties or effects changed
+        m_frameCache->clear();
+    }
     if (m_mltConsumer) {
         m_isRefreshing = true;
         if (m_mltConsumer->is_stopped()) {
@@ -920,6 +1048,83 @@ void Render::setDropFrames(bool drop)
     }
 }
 
+void Render::setAdaptivePreview(bool enable)
+{
+    if (!m_qmlView || m_name != Kdenlive::ProjectMonitor) {
+        return;
+    }
+    m_playingChecks = 0;
+    m_lateChecks = 0;
+    m_smoothChecks = 0;
+    m_qualityProbeDelay = MinQualityProbeDelay;
+    m_qualityProbing = false;
+    m_previewDrops = m_qmlView->playbackStats()->droppedFrames();
+    if (enable) {
+        m_previewQualityTimer.start();
+    } else {
+        m_previewQualityTimer.stop();
+        if (m_qmlView->previewLevel() > 0) {
+            m_qmlView->setPreviewLevel(0);
+            refresh();
+        }
+    }
+}
+
+void Render::slotCheckPreviewQuality()
+{
+    if (!m_mltProducer || !m_isActive) {
+        return;
+    }
+    PlaybackStats *stats = m_qmlView->playbackStats();
+    const int drops = stats->droppedFrames();
+    const int newDrops = drops - m_previewDrops;
+    m_previewDrops = drops;
+    const int level = m_qmlView->previewLevel();
+    if (m_mltProducer->get_speed() == 0) {
+        // Paused, show the current frame in full quality
+        m_playingChecks = 0;
+        m_lateChecks = 0;
+        m_smoothChecks = 0;
+        m_qualityProbeDelay = MinQualityProbeDelay;
+        m_qualityProbing = false;
+        if (level > 0) {
+            m_qmlView->setPreviewLevel(0);
+            refresh();
+        }
+        return;
+    }
+    if (++m_playingChecks < 3) {
+        // Let the consumer fill its buffers before measuring
+        return;
+    }
+    if (newDrops > 0 || stats->fps() < m_fps * 0.9) {
+        m_smoothChecks = 0;
+        if (++m_lateChecks >= 2 && level < GLWidget::MaxPreviewLevel) {
+            if (m_qualityProbing) {
+                // The better quality could not be sustained, wait longer before the next try
+                m_qualityProbeDelay = qMin(m_qualityProbeDelay * 2, MaxQualityProbeDelay);
+            }
+            m_qualityProbing = false;
+            m_lateChecks = 0;
+            m_qmlView->setPreviewLevel(level + 1);
+            // Measure the new level once the consumer refilled its buffers
+            m_playingChecks = 0;
+            m_previewDrops = stats->droppedFrames();
+            qCDebug(KDENLIVE_LOG) << "// Playback is late, lowering preview quality to level" << level + 1;
+        }
+    } else {
+        m_lateChecks = 0;
+        if (level > 0 && ++m_smoothChecks >= m_qualityProbeDelay) {
+            m_smoothChecks = 0;
+            m_qualityProbing = true;
+            m_qmlView->setPreviewLevel(level - 1);
+            m_playingChecks = 0;
+            m_previewDrops = stats->droppedFrames();
+            qCDebug(KDENLIVE_LOG) << "// Playback is smooth, raising preview quality to level" << level - 1;
+        }
+    }
+}
+
 void Render::setConsumerProperty(const QString &name, const QString &value)
 {
     QMutexLocker locker(&m_mutex);
@@ -960,6 +1165,9 @@ GenTime Render::seekPosition() const
 
 int Render::seekFramePosition() const
 {
+    if (m_cachedSeekPosition != SEEK_INACTIVE) {
+        return m_cachedSeekPosition;
+    }
     if (m_mltProducer && m_mltProducer->get_speed() == 0) {
         return (int) m_mltProducer->position();
     }
@@ -992,6 +1200,9 @@ int Render::getCurrentSeekPosition() const
     if (requestedSeekPosition != SEEK_INACTIVE) {
         return requestedSeekPosition;
     }
+    if (m_cachedSeekPosition != SEEK_INACTIVE) {
+        return m_cachedSeekPosition;
+    }
     return (int) m_mltConsumer->position();
 }
 
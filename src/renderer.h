@@ -38,6 +38,7 @@
 #include "definitions.h"
 #include "monitor/abstractmonitor.h"
 #include "mltcontroller/effectscontroller.h"
+#include "mltcontroller/producercachemonitor.h"
 #include <mlt/framework/mlt_types.h>
 
 #include <QUrl>
@@ -55,6 +56,8 @@ class KComboBox;
 class BinController;
 class ClipController;
 class GLWidget;
+class SharedFrame;
+class FrameCache;
 
 namespace Mlt
 {
@@ -154,6 +157,8 @@ Q_OBJECT public:
 
     /** @brief Return true if we are currently playing */
     bool isPlaying() const;
+    /** @brief Returns the avformat decoder cache size and usage counters */
+    QString cacheStatistics() const;
 
     /** @brief Returns the speed at which the renderer is currently playing.
      *
@@ -195,6 +200,8 @@ Q_OBJECT public:
 
     //const QList<Mlt::Producer *> producersList();
     void setDropFrames(bool show);
+    /** @brief Enables or disables the automatic preview quality reduction during playback */
+    void setAdaptivePreview(bool enable);
     /** @brief Sets an MLT consumer property. */
     void setConsumerProperty(const QString &name, const QString &value);
 
@@ -295,6 +302,28 @@ private:
     /** @brief Restore normal mode */
     void resetZoneMode();
     void fillSlowMotionProducers();
+    /** @brief Decoded frames around the clip monitor position */
+    FrameCache *m_frameCache;
+    /** @brief Position of the last frame shown from the cache, the producer is only moved there when needed, or SEEK_INACTIVE */
+    int m_cachedSeekPosition;
+    /** @brief Moves the producer to the position of the frame shown from the cache */
+    void applyCachedSeek();
+    /** @brief Usage of the MLT avformat producer cache, used to size it */
+    ProducerCacheMonitor m_cacheMonitor;
+    /** @brief Frame position of the last cache usage sample */
+    int m_cacheSamplePosition;
+    /** @brief Checks the project monitor playback rate to adapt the preview quality */
+    QTimer m_previewQualityTimer;
+    /** @brief Dropped frame counter at the last preview quality check */
+    int m_previewDrops;
+    /** @brief Number of consecutive checks during playback, late or smooth */
+    int m_playingChecks;
+    int m_lateChecks;
+    int m_smoothChecks;
+    /** @brief Number of smooth checks required before trying a better quality */
+    int m_qualityProbeDelay;
+    /** @brief True if the last preview level change was a quality increase */
+    bool m_qualityProbing;
     /** @brief Make sure we inform MLT if we need a lot of threads for avformat producer */
     void checkMaxThreads();
     /** @brief Clone serialisable properties only */
@@ -307,6 +336,12 @@ private slots:
     /** @brief Refreshes the monitor display. */
     void refresh();
     void slotCheckSeeking();
+    /** @brief Records the producers used for a displayed frame and adapts the decoder cache size */
+    void slotSampleCache(const SharedFrame &frame);
+    /** @brief Keeps decoding the frames behind the playhead into the frame cache while playing backwards */
+    void slotReadAheadReverse(const SharedFrame &frame);
+    /** @brief Lowers the preview quality on sustained frame drops, restores it on pause or when playback is smooth */
+    void slotCheckPreviewQuality();
 
 signals:
     /** @brief The renderer stopped, either playing or rendering. */
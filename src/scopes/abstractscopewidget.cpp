@@ -13,7 +13,7 @@
 #include "renderer.h"
 #include "monitor/monitor.h"
 
-#include <QtConcurrent>
+#include "scopethreadpool.h"
 #include <QColor>
 #include <QMenu>
 #include <QMouseEvent>
@@ -158,7 +158,10 @@ void AbstractScopeWidget::prodHUDThread()
 
             m_newHUDFrames.fetchAndStoreRelaxed(0);
             m_newHUDUpdates.fetchAndStoreRelaxed(0);
-            m_threadHUD = QtConcurrent::run(this, &AbstractScopeWidget::renderHUD, m_accelFactorHUD);
+            const uint accel = m_accelFactorHUD;
+            m_threadHUD = ScopeThreadPool::run([this, accel]() {
+                return renderHUD(accel);
+            });
 #ifdef DEBUG_ASW
             qCDebug(KDENLIVE_LOG) << "HUD thread started in " << m_widgetName;
 #endif
@@ -192,9 +195,10 @@ void AbstractScopeWidget::prodScopeThread()
 
             Q_ASSERT(m_accelFactorScope > 0);
 
-            // See http://doc.qt.nokia.com/latest/qtconcurrentrun.html#run about
-            // running member functions in a thread
-            m_threadScope = QtConcurrent::run(this, &AbstractScopeWidget::renderScope, m_accelFactorScope);
+            const uint accel = m_accelFactorScope;
+            m_threadScope = ScopeThreadPool::run([this, accel]() {
+                return renderScope(accel);
+            });
             m_requestForcedUpdate = false;
 
 #ifdef DEBUG_ASW
@@ -220,7 +224,10 @@ void AbstractScopeWidget::prodBackgroundThread()
 
             m_newBackgroundFrames.fetchAndStoreRelaxed(0);
             m_newBackgroundUpdates.fetchAndStoreRelaxed(0);
-            m_threadBackground = QtConcurrent::run(this, &AbstractScopeWidget::renderBackground, m_accelFactorBackground);
+            const uint accel = m_accelFactorBackground;
+            m_threadBackground = ScopeThreadPool::run([this, accel]() {
+                return renderBackground(accel);
+            });
 
 #ifdef DEBUG_ASW
             qCDebug(KDENLIVE_LOG) << "Background thread started in " << m_widgetName;
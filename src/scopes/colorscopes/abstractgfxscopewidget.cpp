@@ -30,7 +30,7 @@ AbstractGfxScopeWidget::~AbstractGfxScopeWidget() { }
 QImage AbstractGfxScopeWidget::renderScope(uint accelerationFactor)
 {
     QMutexLocker lock(&m_mutex);
-    return renderGfxScope(accelerationFactor, m_scopeImage);
+    return renderGfxScope(accelerationFactor, m_analysis);
 }
 
 void AbstractGfxScopeWidget::mouseReleaseEvent(QMouseEvent *event)
@@ -41,10 +41,10 @@ void AbstractGfxScopeWidget::mouseReleaseEvent(QMouseEvent *event)
 
 ///// Slots /////
 
-void AbstractGfxScopeWidget::slotRenderZoneUpdated(const QImage &frame)
+void AbstractGfxScopeWidget::slotRenderZoneUpdated(const ScopeAnalysis &analysis)
 {
     QMutexLocker lock(&m_mutex);
-    m_scopeImage = frame;
+    m_analysis = analysis;
     AbstractScopeWidget::slotRenderZoneUpdated();
 }
 
@@ -16,6 +16,7 @@
 #include <QWidget>
 
 #include "../abstractscopewidget.h"
+#include "scopeanalysis.h"
 
 /**
 \brief Abstract class for scopes analyzing image frames.
@@ -28,27 +29,32 @@ public:
     explicit AbstractGfxScopeWidget(bool trackMouse = false, QWidget *parent = nullptr);
     virtual ~AbstractGfxScopeWidget(); // Must be virtual because of inheritance, to avoid memory leaks
 
+    /** @brief Accumulators the scope needs to render the next frame with its current settings.
+        Called from the GUI thread, so that all scopes can share one analysis of the frame. */
+    virtual ScopeAnalysis::Request analysisRequest() = 0;
+
 protected:
     ///// Variables /////
 
     /** @brief Scope renderer. Must emit signalScopeRenderingFinished()
         when calculation has finished, to allow multi-threading.
-        accelerationFactor hints how much faster than usual the calculation should be accomplished, if possible. */
-    virtual QImage renderGfxScope(uint accelerationFactor, const QImage &) = 0;
+        accelerationFactor hints how much faster than usual the calculation should be accomplished, if possible.
+        The scope gets its accumulators from the analysis with ScopeAnalysis::result(). */
+    virtual QImage renderGfxScope(uint accelerationFactor, const ScopeAnalysis &) = 0;
 
     QImage renderScope(uint accelerationFactor) Q_DECL_OVERRIDE;
 
     void mouseReleaseEvent(QMouseEvent *) Q_DECL_OVERRIDE;
 
 private:
-    QImage m_scopeImage;
+    ScopeAnalysis m_analysis;
     QMutex m_mutex;
 
 public slots:
-    /** @brief Must be called when the active monitor has shown a new frame.
+    /** @brief Must be called when the active monitor has shown a new frame, once it was analyzed.
       This slot must be connected in the implementing class, it is *not*
       done in this abstract class. */
-    void slotRenderZoneUpdated(const QImage &);
+    void slotRenderZoneUpdated(const ScopeAnalysis &);
 
 protected slots:
     virtual void slotAutoRefreshToggled(bool autoRefresh);
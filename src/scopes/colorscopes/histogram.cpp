@@ -121,22 +121,35 @@ QImage Histogram::renderHUD(uint)
     emit signalHUDRenderingFinished(0, 1);
     return QImage();
 }
-QImage Histogram::renderGfxScope(uint accelFactor, const QImage &qimage)
+int Histogram::componentFlags() const
+{
+    return (ui->cbY->isChecked() ? 1 : 0) * HistogramGenerator::ComponentY
+           | (ui->cbS->isChecked() ? 1 : 0) * HistogramGenerator::ComponentSum
+           | (ui->cbR->isChecked() ? 1 : 0) * HistogramGenerator::ComponentR
+           | (ui->cbG->isChecked() ? 1 : 0) * HistogramGenerator::ComponentG
+           | (ui->cbB->isChecked() ? 1 : 0) * HistogramGenerator::ComponentB;
+}
+
+ScopeAnalysis::Request Histogram::analysisRequest()
+{
+    HistogramGenerator::Rec rec = m_aRec601->isChecked() ? HistogramGenerator::Rec_601 : HistogramGenerator::Rec_709;
+    return HistogramGenerator::analysisRequest(componentFlags(), rec, m_accelFactorScope);
+}
+
+QImage Histogram::renderGfxScope(uint accelFactor, const ScopeAnalysis &analysis)
 {
     QTime start = QTime::currentTime();
     start.start();
-    const int componentFlags = (ui->cbY->isChecked() ? 1 : 0) * HistogramGenerator::ComponentY
-                               | (ui->cbS->isChecked() ? 1 : 0) * HistogramGenerator::ComponentSum
-                               | (ui->cbR->isChecked() ? 1 : 0) * HistogramGenerator::ComponentR
-                               | (ui->cbG->isChecked() ? 1 : 0) * HistogramGenerator::ComponentG
-                               | (ui->cbB->isChecked() ? 1 : 0) * HistogramGenerator::ComponentB;
+    const int components = componentFlags();
 
     HistogramGenerator::Rec rec = m_aRec601->isChecked() ? HistogramGenerator::Rec_601 : HistogramGenerator::Rec_709;
 
-    QImage histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), qimage, componentFlags,
-                       rec, m_aUnscaled->isChecked(), accelFactor);
+    const ScopeAnalysis::Request request = HistogramGenerator::analysisRequest(components, rec, accelFactor);
+    QImage histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), analysis.result(request), components,
+                       m_aUnscaled->isChecked());
 
-    emit signalScopeRenderingFinished(start.elapsed(), accelFactor);
+    // Reading the frame is part of the scope cost
+    emit signalScopeRenderingFinished(start.elapsed() + analysis.elapsed(), accelFactor);
     return histogram;
 }
 QImage Histogram::renderBackground(uint)
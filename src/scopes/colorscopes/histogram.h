@@ -27,6 +27,7 @@ public:
     explicit Histogram(QWidget *parent = nullptr);
     ~Histogram();
     QString widgetName() const Q_DECL_OVERRIDE;
+    ScopeAnalysis::Request analysisRequest() Q_DECL_OVERRIDE;
 
 protected:
     void readConfig() Q_DECL_OVERRIDE;
@@ -39,12 +40,14 @@ private:
     QAction *m_aRec709;
     QActionGroup *m_agRec;
 
+    /** @brief OR-ed HistogramGenerator::Components to paint */
+    int componentFlags() const;
     QRect scopeRect() Q_DECL_OVERRIDE;
     bool isHUDDependingOnInput() const Q_DECL_OVERRIDE;
     bool isScopeDependingOnInput() const Q_DECL_OVERRIDE;
     bool isBackgroundDependingOnInput() const Q_DECL_OVERRIDE;
     QImage renderHUD(uint accelerationFactor) Q_DECL_OVERRIDE;
-    QImage renderGfxScope(uint accelerationFactor, const QImage &) Q_DECL_OVERRIDE;
+    QImage renderGfxScope(uint accelerationFactor, const ScopeAnalysis &) Q_DECL_OVERRIDE;
     QImage renderBackground(uint accelerationFactor) Q_DECL_OVERRIDE;
     Ui::Histogram_UI *ui;
 
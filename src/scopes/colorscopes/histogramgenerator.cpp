@@ -20,10 +20,32 @@ HistogramGenerator::HistogramGenerator()
 {
 }
 
-QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QImage &image, const int &components,
+ScopeAnalysis::Request HistogramGenerator::analysisRequest(const int &components, HistogramGenerator::Rec rec, uint accelFactor)
+{
+    ScopeAnalysis::Request request;
+    if (components & HistogramGenerator::ComponentY) {
+        request.accumulators |= ScopeAnalysis::LumaHistogram;
+        request.rec709 = rec == HistogramGenerator::Rec_709;
+    }
+    if (components & (HistogramGenerator::ComponentR | HistogramGenerator::ComponentG | HistogramGenerator::ComponentB | HistogramGenerator::ComponentSum)) {
+        request.accumulators |= ScopeAnalysis::RgbHistogram;
+    }
+    request.accelFactor = accelFactor;
+    return request;
+}
+
+QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const ScopeFrame &image, const int &components,
         HistogramGenerator::Rec rec, bool unscaled, uint accelFactor) const
 {
-    if (paradeSize.height() <= 0 || paradeSize.width() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    const ScopeAnalysis::Request request = analysisRequest(components, rec, accelFactor);
+    const ScopeAnalysis analysis(image, QVector<ScopeAnalysis::Request>() << request);
+    return calculateHistogram(paradeSize, analysis.result(request), components, unscaled);
+}
+
+QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const ScopeAnalysis::Result &levels, const int &components,
+        bool unscaled) const
+{
+    if (paradeSize.height() <= 0 || paradeSize.width() <= 0 || levels.histogram.count() != 4 * 256) {
         return QImage();
     }
 
@@ -33,41 +55,23 @@ QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QIm
     bool drawB = (components & HistogramGenerator::ComponentB) != 0;
     bool drawSum = (components & HistogramGenerator::ComponentSum) != 0;
 
-    int r[256], g[256], b[256], y[256], s[766];
-    // Initialize the values to zero
-    std::fill(r, r + 256, 0);
-    std::fill(g, g + 256, 0);
-    std::fill(b, b + 256, 0);
-    std::fill(y, y + 256, 0);
-    std::fill(s, s + 766, 0);
-
-    const uint iw = image.bytesPerLine();
-    const uint ih = image.height();
+    const uint iw = levels.frameSize.width();
+    const uint ih = levels.frameSize.height();
     const uint ww = paradeSize.width();
     const uint wh = paradeSize.height();
-    const uint byteCount = iw * ih;
-
-    // Read the stats from the input image
-    for (int Y = 0; Y < image.height(); ++Y) {
-        for (int X = 0; X < image.width(); X += accelFactor) {
-            QRgb col = image.pixel(X, Y);
-            r[qRed(col)]++;
-            g[qGreen(col)]++;
-            b[qBlue(col)]++;
-            if (drawY) {
-                // Use if branch to avoid expensive multiplication if Y disabled
-                if (rec == HistogramGenerator::Rec_601) {
-                    y[(int)floor(.299 * qRed(col) + .587 * qGreen(col) + .114 * qBlue(col))]++;
-                } else {
-                    y[(int)floor(.2125 * qRed(col) + .7154 * qGreen(col) + .0721 * qBlue(col))]++;
-                }
-            }
-            if (drawSum) {
-                // Use an if branch here because the sum takes more operations than rgb
-                s[qRed(col)]++;
-                s[qGreen(col)]++;
-                s[qBlue(col)]++;
-            }
+    // Scaling is computed as for 32 bit images
+    const uint byteCount = 4 * iw * ih;
+
+    const int *y = levels.histogram.constData();
+    const int *r = y + 256;
+    const int *g = y + 512;
+    const int *b = y + 768;
+    // Every pixel adds its red, green and blue values to the sum
+    int s[766];
+    std::fill(s, s + 766, 0);
+    if (drawSum) {
+        for (int i = 0; i < 256; ++i) {
+            s[i] = r[i] + g[i] + b[i];
         }
     }
 
@@ -131,7 +135,10 @@ QImage HistogramGenerator::drawComponent(const int *y, const QSize &size, const
     Q_ASSERT(scaling != INFINITY);
 
     const int partH = size.height();
+    const QRgb rgba = color.rgba();
 
+    // First painted row of each column
+    QVector<int> top(max);
     for (uint x = 0; x < max; ++x) {
         // Calculate the height of the curve at position x
         int partY = scaling * y[x];
@@ -140,10 +147,14 @@ QImage HistogramGenerator::drawComponent(const int *y, const QSize &size, const
         if (partY > partH - 1) {
             partY = partH - 1;
         }
-        partY = partH - 1 - partY;
-
-        for (int k = partH - 1; k >= partY; --k) {
-            component.setPixel(x, k, color.rgba());
+        top[x] = partH - 1 - partY;
+    }
+    for (int k = 0; k < partH; ++k) {
+        QRgb *line = reinterpret_cast<QRgb *>(component.scanLine(k));
+        for (uint x = 0; x < max; ++x) {
+            if (k >= top.at(x)) {
+                line[x] = rgba;
+            }
         }
     }
     if (unscaled && size.width() >= component.width()) {
@@ -11,6 +11,8 @@
 #ifndef HISTOGRAMGENERATOR_H
 #define HISTOGRAMGENERATOR_H
 
+#include "scopeanalysis.h"
+
 #include <QObject>
 
 class QColor;
@@ -29,11 +31,17 @@ public:
         See http://www.poynton.com/ColorFAQ.html for details. */
     enum Rec { Rec_601, Rec_709 };
 
+    /** @brief Accumulators needed to paint the given components */
+    static ScopeAnalysis::Request analysisRequest(const int &components, const HistogramGenerator::Rec rec, uint accelFactor = 1);
+
+    /** @brief Paints the histogram from the luma and RGB levels */
+    QImage calculateHistogram(const QSize &paradeSize, const ScopeAnalysis::Result &levels, const int &components, bool unscaled) const;
+
     /**
         Calculates a histogram display from the input image.
         components are OR-ed HistogramGenerator::Components flags and decide with components (Y, R, G, B) to paint.
         unscaled = true leaves the width at 256 if the widget is wider (to avoid scaling). */
-    QImage calculateHistogram(const QSize &paradeSize, const QImage &image, const int &components, const HistogramGenerator::Rec rec,
+    QImage calculateHistogram(const QSize &paradeSize, const ScopeFrame &image, const int &components, const HistogramGenerator::Rec rec,
                               bool unscaled, uint accelFactor = 1) const;
 
     QImage drawComponent(const int *y, const QSize &size, const float &scaling, const QColor &color, bool unscaled, uint max) const;
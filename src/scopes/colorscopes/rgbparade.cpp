@@ -125,15 +125,22 @@ QImage RGBParade::renderHUD(uint)
     return hud;
 }
 
-QImage RGBParade::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+ScopeAnalysis::Request RGBParade::analysisRequest()
+{
+    return RGBParadeGenerator::analysisRequest(m_scopeRect.size(), m_accelFactorScope);
+}
+
+QImage RGBParade::renderGfxScope(uint accelerationFactor, const ScopeAnalysis &analysis)
 {
     QTime start = QTime::currentTime();
     start.start();
 
     int paintmode = ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
-    QImage parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), qimage, (RGBParadeGenerator::PaintMode) paintmode,
-                    m_aAxis->isChecked(), m_aGradRef->isChecked(), accelerationFactor);
-    emit signalScopeRenderingFinished(start.elapsed(), accelerationFactor);
+    const ScopeAnalysis::Request request = RGBParadeGenerator::analysisRequest(m_scopeRect.size(), accelerationFactor);
+    QImage parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), analysis.result(request), (RGBParadeGenerator::PaintMode) paintmode,
+                    m_aAxis->isChecked(), m_aGradRef->isChecked());
+    // Reading the frame is part of the scope cost
+    emit signalScopeRenderingFinished(start.elapsed() + analysis.elapsed(), accelerationFactor);
     return parade;
 }
 
@@ -28,6 +28,7 @@ public:
     explicit RGBParade(QWidget *parent = nullptr);
     ~RGBParade();
     QString widgetName() const Q_DECL_OVERRIDE;
+    ScopeAnalysis::Request analysisRequest() Q_DECL_OVERRIDE;
 
 protected:
     void readConfig() Q_DECL_OVERRIDE;
@@ -46,7 +47,7 @@ private:
     bool isBackgroundDependingOnInput() const Q_DECL_OVERRIDE;
 
     QImage renderHUD(uint accelerationFactor) Q_DECL_OVERRIDE;
-    QImage renderGfxScope(uint accelerationFactor, const QImage &) Q_DECL_OVERRIDE;
+    QImage renderGfxScope(uint accelerationFactor, const ScopeAnalysis &) Q_DECL_OVERRIDE;
     QImage renderBackground(uint accelerationFactor) Q_DECL_OVERRIDE;
 };
 
@@ -23,23 +23,40 @@ const QColor RGBParadeGenerator::colSoft(150, 150, 150, 255);
 const uchar RGBParadeGenerator::distRight(40);
 const uchar RGBParadeGenerator::distBottom(40);
 
-struct StructRGB {
-    uint r;
-    uint g;
-    uint b;
-};
+// Distance between the parts
+static const uchar offset = 10;
 
 RGBParadeGenerator::RGBParadeGenerator()
 {
 }
 
-QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QImage &image,
+ScopeAnalysis::Request RGBParadeGenerator::analysisRequest(const QSize &paradeSize, uint accelFactor)
+{
+    ScopeAnalysis::Request request;
+    request.accumulators = ScopeAnalysis::RgbColumns;
+    request.accelFactor = accelFactor;
+    request.columns = qMax(0, (paradeSize.width() - 2 * offset - distRight) / 3);
+    return request;
+}
+
+QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const ScopeFrame &image,
         const RGBParadeGenerator::PaintMode paintMode, bool drawAxis,
         bool drawGradientRef, uint accelFactor)
 {
+    const ScopeAnalysis::Request request = analysisRequest(paradeSize, accelFactor);
+    const ScopeAnalysis analysis(image, QVector<ScopeAnalysis::Request>() << request);
+    return calculateRGBParade(paradeSize, analysis.result(request), paintMode, drawAxis, drawGradientRef);
+}
+
+QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const ScopeAnalysis::Result &levels,
+        const RGBParadeGenerator::PaintMode paintMode, bool drawAxis,
+        bool drawGradientRef)
+{
+    const uint accelFactor = levels.request.accelFactor;
     Q_ASSERT(accelFactor >= 1);
 
-    if (paradeSize.width() <= 0 || paradeSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    const int partSize = levels.request.columns * 256;
+    if (paradeSize.width() <= 0 || paradeSize.height() <= 0 || partSize == 0 || levels.rgbColumns.count() != 3 * partSize) {
         return QImage();
 
     } else {
@@ -50,97 +67,63 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QIm
 
         const uint ww = paradeSize.width();
         const uint wh = paradeSize.height();
-        const uint iw = image.bytesPerLine();
-        const uint ih = image.height();
-        const uint byteCount = iw * ih; // Note that 1 px = 4 B
+        const uint iw = levels.frameSize.width();
+        const uint ih = levels.frameSize.height();
 
-        const uchar offset = 10;
-        const uint partW = (ww - 2 * offset - distRight) / 3;
+        const uint partW = levels.request.columns;
         const uint partH = wh - distBottom;
 
         // Statistics
-        uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0, r, g, b;
+        uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0;
 
         // Number of input pixels that will fall on one scope pixel.
         // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-        const float pixelDepth = (float)((byteCount >> 2) / accelFactor) / (partW * 255);
+        const float pixelDepth = (float)((iw * ih) / accelFactor) / (partW * 255);
         const float gain = 255 / (8 * pixelDepth);
 //        qCDebug(KDENLIVE_LOG) << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
 
         QImage unscaled(ww - distRight, 256, QImage::Format_ARGB32);
         unscaled.fill(qRgba(0, 0, 0, 0));
 
-        const float wPrediv = (float)(partW - 1) / (iw - 1);
-
-        StructRGB paradeVals[partW][256];
-        for (uint i = 0; i < partW; ++i) {
-            for (uint j = 0; j < 256; ++j) {
-                paradeVals[i][j].r = 0;
-                paradeVals[i][j].g = 0;
-                paradeVals[i][j].b = 0;
-            }
-        }
-
-        const uchar *bits = image.bits();
-        const uint stepsize = image.depth() / 8 * accelFactor;
+        const uint *paradeR = levels.rgbColumns.constData();
+        const uint *paradeG = paradeR + partSize;
+        const uint *paradeB = paradeG + partSize;
 
-        for (uint i = 0, x = 0; i < byteCount; i += stepsize) {
-            QRgb *col = (QRgb *)bits;
-            r = qRed(*col);
-            g = qGreen(*col);
-            b = qBlue(*col);
-
-            double dx = x * wPrediv;
-
-            paradeVals[(int)dx][r].r++;
-            paradeVals[(int)dx][g].g++;
-            paradeVals[(int)dx][b].b++;
-
-            if (r < minR) {
-                minR = r;
-            }
-            if (g < minG) {
-                minG = g;
-            }
-            if (b < minB) {
-                minB = b;
+        // Levels used by any column
+        for (uint j = 0; j < 256; ++j) {
+            bool usedR = false, usedG = false, usedB = false;
+            for (uint i = 0; i < partW; ++i) {
+                usedR = usedR || paradeR[i * 256 + j] > 0;
+                usedG = usedG || paradeG[i * 256 + j] > 0;
+                usedB = usedB || paradeB[i * 256 + j] > 0;
             }
-            if (r > maxR) {
-                maxR = r;
+            if (usedR) {
+                minR = qMin(minR, (uchar) j);
+                maxR = (uchar) j;
             }
-            if (g > maxG) {
-                maxG = g;
+            if (usedG) {
+                minG = qMin(minG, (uchar) j);
+                maxG = (uchar) j;
             }
-            if (b > maxB) {
-                maxB = b;
+            if (usedB) {
+                minB = qMin(minB, (uchar) j);
+                maxB = (uchar) j;
             }
-
-            bits += stepsize;
-            x += stepsize;
-            x %= iw; // Modulo image width, to represent the current x position in the image
         }
 
         const uint offset1 = partW + offset;
         const uint offset2 = 2 * partW + 2 * offset;
-        switch (paintMode) {
-        case PaintMode_RGB:
+        const bool white = paintMode != PaintMode_RGB;
+        const QRgb colorR = white ? qRgba(255, 255, 255, 0) : qRgba(255, 10, 10, 0);
+        const QRgb colorG = white ? qRgba(255, 255, 255, 0) : qRgba(10, 255, 10, 0);
+        const QRgb colorB = white ? qRgba(255, 255, 255, 0) : qRgba(10, 10, 255, 0);
+        for (uint j = 0; j < 256; ++j) {
+            QRgb *line = reinterpret_cast<QRgb *>(unscaled.scanLine(j));
             for (uint i = 0; i < partW; ++i) {
-                for (uint j = 0; j < 256; ++j) {
-                    unscaled.setPixel(i,         j, qRgba(255, 10, 10, CHOP255(gain * paradeVals[i][j].r)));
-                    unscaled.setPixel(i + offset1, j, qRgba(10, 255, 10, CHOP255(gain * paradeVals[i][j].g)));
-                    unscaled.setPixel(i + offset2, j, qRgba(10, 10, 255, CHOP255(gain * paradeVals[i][j].b)));
-                }
-            }
-            break;
-        default:
-            for (uint i = 0; i < partW; ++i) {
-                for (uint j = 0; j < 256; ++j) {
-                    unscaled.setPixel(i,         j, qRgba(255, 255, 255, CHOP255(gain * paradeVals[i][j].r)));
-                    unscaled.setPixel(i + offset1, j, qRgba(255, 255, 255, CHOP255(gain * paradeVals[i][j].g)));
-                    unscaled.setPixel(i + offset2, j, qRgba(255, 255, 255, CHOP255(gain * paradeVals[i][j].b)));
-                }
+                line[i] = colorR | ((uint) CHOP255(gain * paradeR[i * 256 + j]) << 24);
+                line[i + offset1] = colorG | ((uint) CHOP255(gain * paradeG[i * 256 + j]) << 24);
+                line[i + offset2] = colorB | ((uint) CHOP255(gain * paradeB[i * 256 + j]) << 24);
             }
-            break;
         }
 
         // Scale the image to the target height. Scaling is not accomplished before because
@@ -152,10 +135,11 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QIm
             QRgb opx;
             for (uint i = 0; i <= 10; ++i) {
                 double dy = (float)i / 10 * (partH - 1);
+                QRgb *line = reinterpret_cast<QRgb *>(parade.scanLine(dy));
                 for (uint x = 0; x < ww - distRight; ++x) {
-                    opx = parade.pixel(x, dy);
-                    parade.setPixel(x, dy, qRgba(CHOP255(150 + qRed(opx)), 255,
-                                                 CHOP255(200 + qBlue(opx)), CHOP255(32 + qAlpha(opx))));
+                    opx = line[x];
+                    line[x] = qRgba(CHOP255(150 + qRed(opx)), 255,
+                                    CHOP255(200 + qBlue(opx)), CHOP255(32 + qAlpha(opx)));
                 }
             }
         }
@@ -11,6 +11,8 @@
 #ifndef RGBPARADEGENERATOR_H
 #define RGBPARADEGENERATOR_H
 
+#include "scopeanalysis.h"
+
 #include <QObject>
 
 class QColor;
@@ -23,7 +25,13 @@ public:
     enum PaintMode { PaintMode_RGB, PaintMode_White };
 
     RGBParadeGenerator();
-    QImage calculateRGBParade(const QSize &paradeSize, const QImage &image, const RGBParadeGenerator::PaintMode paintMode,
+    /** @brief Accumulators needed to paint a parade */
+    static ScopeAnalysis::Request analysisRequest(const QSize &paradeSize, uint accelFactor = 1);
+    /** @brief Paints the parade from the RGB levels of each column */
+    QImage calculateRGBParade(const QSize &paradeSize, const ScopeAnalysis::Result &levels, const RGBParadeGenerator::PaintMode paintMode,
+                              bool drawAxis, bool drawGradientRef);
+    /** @brief Reads the frame and paints its parade */
+    QImage calculateRGBParade(const QSize &paradeSize, const ScopeFrame &image, const RGBParadeGenerator::PaintMode paintMode,
                               bool drawAxis, bool drawGradientRef, uint accelFactor = 1);
 
     static const QColor colHighlight;
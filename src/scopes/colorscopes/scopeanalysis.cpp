@@ -0,0 +1,365 @@
+/*
+ * Kdenlive color scopes shared frame analysis
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "scopeanalysis.h"
+#include "scopekernels.h"
+
+#include <QElapsedTimer>
+
+namespace {
+// U and V of a YUV frame sample. Cb and Cr are Pb and Pr once normalized.
+inline void yuvChroma(int cb, int cr, bool ypbpr, double &u, double &v)
+{
+    const double pb = ScopeFrame::normalizedChroma(cb);
+    const double pr = ScopeFrame::normalizedChroma(cr);
+    if (ypbpr) {
+        u = pb;
+        v = pr;
+    } else {
+        u = 0.8736 * pb;
+        v = 1.2296 * pr;
+    }
+}
+
+// U and V of a RGB pixel, see the VectorscopeGenerator matrices
+inline void rgbChroma(int r, int g, int b, bool ypbpr, double &u, double &v)
+{
+    if (ypbpr) {
+        u = (double) - 0.0006671 * r - 0.001299 * g + 0.0019608 * b;
+        v = (double)  0.001961 * r - 0.001642 * g - 0.0003189 * b;
+    } else {
+        u = (double) - 0.0005781 * r - 0.001135 * g + 0.001713 * b;
+        v = (double)  0.002411 * r - 0.002019 * g - 0.0003921 * b;
+    }
+}
+
+template <typename T> void add(QVector<T> &values, const QVector<T> &other)
+{
+    T *data = values.data();
+    const T *otherData = other.constData();
+    for (int i = 0; i < values.count(); ++i) {
+        data[i] += otherData[i];
+    }
+}
+
+int chromaSide(const ScopeAnalysis::Request &request)
+{
+    return qMax(0, qMin(request.chromaSize.width(), request.chromaSize.height()));
+}
+
+// Raw pointers to the accumulators of a result, for the row loops
+struct Target {
+    Target() :
+        histogram(nullptr),
+        lumaColumns(nullptr),
+        rgbColumns(nullptr),
+        chromaHits(nullptr),
+        chromaColors(nullptr)
+    {
+    }
+    explicit Target(ScopeAnalysis::Result &result)
+    {
+        const ScopeAnalysis::Request &request = result.request;
+        const int side = chromaSide(request);
+        if (request.accumulators & (ScopeAnalysis::LumaHistogram | ScopeAnalysis::RgbHistogram)) {
+            result.histogram.fill(0, 4 * 256);
+        }
+        if (request.accumulators & ScopeAnalysis::LumaColumns) {
+            result.lumaColumns.fill(0, request.columns * 256);
+        }
+        if (request.accumulators & ScopeAnalysis::RgbColumns) {
+            result.rgbColumns.fill(0, 3 * request.columns * 256);
+        }
+        if (request.accumulators & (ScopeAnalysis::ChromaHits | ScopeAnalysis::ChromaColors)) {
+            result.chromaHits.fill(0, side * side);
+        }
+        if (request.accumulators & ScopeAnalysis::ChromaColors) {
+            result.chromaColors.fill(0, side * side);
+        }
+        // Accumulators that were not requested stay null
+        histogram = result.histogram.isEmpty() ? nullptr : result.histogram.data();
+        lumaColumns = result.lumaColumns.isEmpty() ? nullptr : result.lumaColumns.data();
+        rgbColumns = result.rgbColumns.isEmpty() ? nullptr : result.rgbColumns.data();
+        chromaHits = result.chromaHits.isEmpty() ? nullptr : result.chromaHits.data();
+        chromaColors = result.chromaColors.isEmpty() ? nullptr : result.chromaColors.data();
+    }
+    int *histogram;
+    uint *lumaColumns;
+    uint *rgbColumns;
+    uint *chromaHits;
+    QRgb *chromaColors;
+};
+}
+
+ScopeAnalysis::Request::Request() :
+    accumulators(0),
+    accelFactor(1),
+    rec709(false),
+    columns(0),
+    chromaGain(1),
+    chromaYPbPr(false)
+{
+}
+
+bool ScopeAnalysis::Request::operator==(const Request &other) const
+{
+    return accumulators == other.accumulators && accelFactor == other.accelFactor && rec709 == other.rec709
+           && columns == other.columns && chromaSize == other.chromaSize && chromaGain == other.chromaGain
+           && chromaYPbPr == other.chromaYPbPr;
+}
+
+ScopeAnalysis::ScopeAnalysis() :
+    m_elapsed(0)
+{
+}
+
+ScopeAnalysis::ScopeAnalysis(const ScopeFrame &frame, const QVector<Request> &requests) :
+    m_frame(frame),
+    m_elapsed(0)
+{
+    for (int i = 0; i < requests.count(); ++i) {
+        const Request &request = requests.at(i);
+        if (request.accumulators == 0) {
+            continue;
+        }
+        bool known = false;
+        for (int j = 0; j < m_results.count() && !known; ++j) {
+            known = m_results.at(j).request == request;
+        }
+        if (!known) {
+            Result result;
+            result.request = request;
+            m_results << result;
+        }
+    }
+    if (!m_frame.isNull() && !m_results.isEmpty()) {
+        QElapsedTimer timer;
+        timer.start();
+        accumulate();
+        m_elapsed = timer.elapsed();
+    }
+}
+
+const ScopeFrame &ScopeAnalysis::frame() const
+{
+    return m_frame;
+}
+
+int ScopeAnalysis::elapsed() const
+{
+    return m_elapsed;
+}
+
+ScopeAnalysis::Result ScopeAnalysis::result(const Request &request) const
+{
+    for (int i = 0; i < m_results.count(); ++i) {
+        if (m_results.at(i).request == request) {
+            return m_results.at(i);
+        }
+    }
+    if (request.accumulators != 0 && !m_frame.isNull()) {
+        // The scope settings changed since the analysis was started
+        const ScopeAnalysis analysis(m_frame, QVector<Request>() << request);
+        return analysis.m_results.first();
+    }
+    Result empty;
+    empty.request = request;
+    return empty;
+}
+
+void ScopeAnalysis::accumulate()
+{
+    const int width = m_frame.width();
+    const int height = m_frame.height();
+    const int count = m_results.count();
+
+    // What each request reads from a row
+    QVector<int> flags(count);
+    QVector<uint> accelFactors(count);
+    QVector<bool> rgbNeeded(count);
+    QVector<QVector<int> > columnMaps(count);
+    for (int i = 0; i < count; ++i) {
+        const Request &request = m_results.at(i).request;
+        flags[i] = request.accumulators;
+        if (request.columns <= 0) {
+            // No room for the scope columns
+            flags[i] &= ~(LumaColumns | RgbColumns);
+        }
+        if (chromaSide(request) == 0) {
+            flags[i] &= ~(ChromaHits | ChromaColors);
+        }
+        accelFactors[i] = qMax(1u, request.accelFactor);
+        rgbNeeded[i] = (flags.at(i) & (RgbHistogram | RgbColumns | ChromaColors)) != 0
+                       || ((flags.at(i) & ChromaHits) && !m_frame.isYuv());
+        if (flags.at(i) & (LumaColumns | RgbColumns)) {
+            // Subtract 1 from sizes because we start counting from 0
+            const float wPrediv = width > 1 ? (float)(request.columns - 1) / (width - 1) : 0;
+            columnMaps[i].resize(width);
+            for (int x = 0; x < width; ++x) {
+                columnMaps[i][x] = (int)(x * wPrediv);
+            }
+        }
+    }
+
+    // Each band of rows fills its own copy of the accumulators, which are summed afterwards
+    const int bands = ScopeKernels::bandCount(height);
+    QVector<QVector<Result> > bandResults(bands);
+    QVector<Result> *bandData = bandResults.data();
+    ScopeKernels::forEachBand(height, bands, [&](int band, int first, int end) {
+        QVector<Result> &results = bandData[band];
+        results = m_results;
+        QVector<Target> targets;
+        targets.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            targets << Target(results[i]);
+        }
+        QVector<uchar> lines(5 * width);
+        uchar *red = lines.data();
+        uchar *green = red + width;
+        uchar *blue = green + width;
+        uchar *luma601 = blue + width;
+        uchar *luma709 = luma601 + width;
+        QVector<bool> active(count);
+        for (int y = first; y < end; ++y) {
+            bool readRgb = false;
+            bool read601 = false;
+            bool read709 = false;
+            bool readAny = false;
+            for (int i = 0; i < count; ++i) {
+                active[i] = y % accelFactors.at(i) == 0;
+                if (!active.at(i)) {
+                    continue;
+                }
+                const Request &request = results.at(i).request;
+                readAny = true;
+                readRgb = readRgb || rgbNeeded.at(i);
+                if (flags.at(i) & (LumaHistogram | LumaColumns)) {
+                    read601 = read601 || !request.rec709;
+                    read709 = read709 || request.rec709;
+                }
+            }
+            if (!readAny) {
+                continue;
+            }
+            if (readRgb) {
+                ScopeKernels::rgbRow(m_frame, y, red, green, blue);
+            }
+            if (read601) {
+                ScopeKernels::lumaRow(m_frame, y, false, luma601);
+            }
+            if (read709) {
+                ScopeKernels::lumaRow(m_frame, y, true, luma709);
+            }
+            const uchar *cb = m_frame.isYuv() ? m_frame.cbLine(y) : nullptr;
+            const uchar *cr = m_frame.isYuv() ? m_frame.crLine(y) : nullptr;
+
+            for (int i = 0; i < count; ++i) {
+                if (!active.at(i)) {
+                    continue;
+                }
+                const Request &request = results.at(i).request;
+                const Target &target = targets.at(i);
+                const int accumulators = flags.at(i);
+                const uchar *luma = request.rec709 ? luma709 : luma601;
+                const int *columns = columnMaps.at(i).constData();
+                if (accumulators & LumaHistogram) {
+                    int *levels = target.histogram;
+                    for (int x = 0; x < width; ++x) {
+                        levels[luma[x]]++;
+                    }
+                }
+                if (accumulators & RgbHistogram) {
+                    int *r = target.histogram + 256;
+                    int *g = target.histogram + 512;
+                    int *b = target.histogram + 768;
+                    for (int x = 0; x < width; ++x) {
+                        r[red[x]]++;
+                        g[green[x]]++;
+                        b[blue[x]]++;
+                    }
+                }
+                if (accumulators & LumaColumns) {
+                    uint *levels = target.lumaColumns;
+                    for (int x = 0; x < width; ++x) {
+                        levels[columns[x] * 256 + luma[x]]++;
+                    }
+                }
+                if (accumulators & RgbColumns) {
+                    const int partSize = request.columns * 256;
+                    uint *r = target.rgbColumns;
+                    uint *g = r + partSize;
+                    uint *b = g + partSize;
+                    for (int x = 0; x < width; ++x) {
+                        const int column = columns[x] * 256;
+                        r[column + red[x]]++;
+                        g[column + green[x]]++;
+                        b[column + blue[x]]++;
+                    }
+                }
+                if (accumulators & (ChromaHits | ChromaColors)) {
+                    const int side = chromaSide(request);
+                    const bool ypbpr = request.chromaYPbPr;
+                    const double gain = request.chromaGain;
+                    double u, v;
+                    int px, py;
+                    for (int x = 0; x < width; ++x) {
+                        if (cb) {
+                            yuvChroma(cb[x >> 1], cr[x >> 1], ypbpr, u, v);
+                        } else {
+                            rgbChroma(red[x], green[x], blue[x], ypbpr, u, v);
+                        }
+                        mapChroma(request.chromaSize, gain * u, gain * v, px, py);
+                        if (px < 0 || px >= side || py < 0 || py >= side) {
+                            // Point lies outside (because of scaling)
+                            continue;
+                        }
+                        target.chromaHits[py * side + px]++;
+                        if (target.chromaColors) {
+                            target.chromaColors[py * side + px] = qRgb(red[x], green[x], blue[x]);
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    // Sum the bands in the first one. Later bands hold later rows, their colors win.
+    m_results.swap(bandResults[0]);
+    for (int i = 0; i < count; ++i) {
+        Result &result = m_results[i];
+        result.frameSize = QSize(width, height);
+        for (int band = 1; band < bands; ++band) {
+            const Result &other = bandResults.at(band).at(i);
+            add(result.histogram, other.histogram);
+            add(result.lumaColumns, other.lumaColumns);
+            add(result.rgbColumns, other.rgbColumns);
+            add(result.chromaHits, other.chromaHits);
+            QRgb *colors = result.chromaColors.data();
+            for (int j = 0; j < result.chromaColors.count(); ++j) {
+                if (other.chromaHits.at(j) > 0) {
+                    colors[j] = other.chromaColors.at(j);
+                }
+            }
+        }
+    }
+}
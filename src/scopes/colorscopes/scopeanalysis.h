@@ -0,0 +1,123 @@
+/*
+ * Kdenlive color scopes shared frame analysis
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SCOPEANALYSIS_H
+#define SCOPEANALYSIS_H
+
+#include "scopeframe.h"
+
+#include <QSize>
+#include <QVector>
+
+/**
+  \brief Statistics of a frame, accumulated for all open color scopes in one pass.
+
+  Each scope describes the accumulators it needs with a Request. The frame is
+  then read once, row by row, and every row read is added to the accumulators
+  of all the requests sampling it. The scopes only turn their accumulators into
+  an image afterwards.
+  Requests are built by the generators (see WaveformGenerator::analysisRequest()
+  for example), so that equal settings lead to equal requests that share their
+  result.
+  */
+class ScopeAnalysis
+{
+public:
+    enum Accumulator {
+        /** Number of pixels for each luma level */
+        LumaHistogram = 1 << 0,
+        /** Number of pixels for each red, green and blue level */
+        RgbHistogram = 1 << 1,
+        /** Number of pixels for each luma level in each scope column */
+        LumaColumns = 1 << 2,
+        /** Number of pixels for each red, green and blue level in each scope column */
+        RgbColumns = 1 << 3,
+        /** Number of pixels falling on each point of the vectorscope */
+        ChromaHits = 1 << 4,
+        /** Color of the last pixel falling on each point of the vectorscope */
+        ChromaColors = 1 << 5
+    };
+
+    /** @brief Accumulators needed by a scope and the settings they depend on */
+    struct Request {
+        Request();
+        bool operator==(const Request &other) const;
+        /** OR-ed ScopeAnalysis::Accumulator flags */
+        int accumulators;
+        /** Only every accelFactor-th row of the frame is read */
+        uint accelFactor;
+        /** Luma matrix, true for BT.709 and false for BT.601 */
+        bool rec709;
+        /** Number of scope columns the frame columns are mapped to */
+        int columns;
+        /** Size of the vectorscope, the chroma plane is mapped to it as in VectorscopeGenerator::mapToCircle() */
+        QSize chromaSize;
+        /** Factor applied to the chroma values before mapping them */
+        float chromaGain;
+        /** True to plot Pb and Pr, false for U and V */
+        bool chromaYPbPr;
+    };
+
+    /** @brief Accumulators filled for a request */
+    struct Result {
+        Request request;
+        /** Size of the analyzed frame */
+        QSize frameSize;
+        /** 256 luma levels followed by 256 levels for each of red, green and blue */
+        QVector<int> histogram;
+        /** 256 luma levels of each column */
+        QVector<uint> lumaColumns;
+        /** 256 red levels of each column, followed by the green and blue ones */
+        QVector<uint> rgbColumns;
+        /** Rows of the square vectorscope, which is as wide as the smallest dimension of chromaSize */
+        QVector<uint> chromaHits;
+        QVector<QRgb> chromaColors;
+    };
+
+    ScopeAnalysis();
+    /** @brief Reads the frame once, filling the accumulators of all requests */
+    ScopeAnalysis(const ScopeFrame &frame, const QVector<Request> &requests);
+
+    const ScopeFrame &frame() const;
+    /** @brief Time spent reading the frame, in milliseconds */
+    int elapsed() const;
+    /** @brief Returns the result of a request
+     * If the request was not part of the analysis, for example because the scope
+     * settings changed since then, the frame is read again for this request only. */
+    Result result(const Request &request) const;
+
+    /** @brief Maps a chroma value on [-1, 1]² to a point of the vectorscope, as VectorscopeGenerator::mapToCircle() */
+    static inline void mapChroma(const QSize &size, double u, double v, int &x, int &y)
+    {
+        x = (size.width() - 1) * (u + 1) / 2;
+        y = (size.height() - 1) * (1 - (v + 1) / 2);
+    }
+
+private:
+    ScopeFrame m_frame;
+    QVector<Result> m_results;
+    int m_elapsed;
+    void accumulate();
+};
+
+#endif // SCOPEANALYSIS_H
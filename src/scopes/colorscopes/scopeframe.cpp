@@ -0,0 +1,101 @@
+/*
+ * Kdenlive color scopes frame access
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "scopeframe.h"
+
+ScopeFrame::ScopeFrame() :
+    m_width(0),
+    m_height(0),
+    m_yuv(false),
+    m_rec709(false)
+{
+    m_planes[0] = m_planes[1] = m_planes[2] = nullptr;
+    m_strides[0] = m_strides[1] = m_strides[2] = 0;
+}
+
+ScopeFrame::ScopeFrame(const QImage &image) :
+    m_width(image.width()),
+    m_height(image.height()),
+    m_yuv(false),
+    m_rec709(false)
+{
+    m_planes[0] = m_planes[1] = m_planes[2] = nullptr;
+    m_strides[0] = m_strides[1] = m_strides[2] = 0;
+    // Scopes read 4 bytes per pixel
+    if (image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32 || image.format() == QImage::Format_ARGB32_Premultiplied) {
+        m_image = image;
+    } else {
+        m_image = image.convertToFormat(QImage::Format_RGB32);
+    }
+}
+
+ScopeFrame::ScopeFrame(const SharedFrame &frame) :
+    m_frame(frame),
+    m_width(0),
+    m_height(0),
+    m_yuv(false),
+    m_rec709(false)
+{
+    m_planes[0] = m_planes[1] = m_planes[2] = nullptr;
+    m_strides[0] = m_strides[1] = m_strides[2] = 0;
+    if (!frame.is_valid() || frame.get_image_format() != mlt_image_yuv420p || frame.get_image() == nullptr) {
+        return;
+    }
+    m_width = frame.get_image_width();
+    m_height = frame.get_image_height();
+    m_yuv = true;
+    m_rec709 = frame.get_int("colorspace") == 709;
+    // Same plane layout as the monitor textures
+    const int chromaWidth = m_width / 2;
+    const int chromaHeight = m_height / 2;
+    m_planes[0] = frame.get_image();
+    m_planes[1] = m_planes[0] + m_width * m_height;
+    m_planes[2] = m_planes[1] + chromaWidth * chromaHeight;
+    m_strides[0] = m_width;
+    m_strides[1] = chromaWidth;
+    m_strides[2] = chromaWidth;
+}
+
+bool ScopeFrame::isNull() const
+{
+    return m_width <= 0 || m_height <= 0;
+}
+
+int ScopeFrame::width() const
+{
+    return m_width;
+}
+
+int ScopeFrame::height() const
+{
+    return m_height;
+}
+
+bool ScopeFrame::isYuv() const
+{
+    return m_yuv;
+}
+
+bool ScopeFrame::isRec709() const
+{
+    return m_rec709;
+}
@@ -0,0 +1,124 @@
+/*
+ * Kdenlive color scopes frame access
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCOPEFRAME_H
+#define SCOPEFRAME_H
+
+#include "monitor/scopes/sharedframe.h"
+
+#include <QImage>
+
+/**
+  \brief Read only view on the image analyzed by the color scopes.
+
+  Frames displayed by the monitors are yuv420p MLT frames. Their luma and
+  chroma planes are read in place, so that the scopes do not need a RGB copy
+  of the frame. Images coming from other sources (capture, explicit frame
+  requests) are read as RGB32 QImages.
+  Luma and chroma values of YUV frames are video range (16-235, 16-240),
+  the accessors below expand them to the full 0-255 range used by the scopes.
+  */
+class ScopeFrame
+{
+public:
+    ScopeFrame();
+    explicit ScopeFrame(const QImage &image);
+    explicit ScopeFrame(const SharedFrame &frame);
+
+    bool isNull() const;
+    int width() const;
+    int height() const;
+    /** @brief True if the YUV planes of a frame are read, false for a RGB image */
+    bool isYuv() const;
+    /** @brief True if the YUV frame uses the BT.709 matrix */
+    bool isRec709() const;
+
+    /** @brief Row of RGB pixels, only for RGB images */
+    inline const QRgb *rgbLine(int y) const
+    {
+        return reinterpret_cast<const QRgb *>(m_image.constScanLine(y));
+    }
+    /** @brief Rows of the luma and chroma planes, only for YUV frames. Chroma rows are half the frame width. */
+    inline const uchar *lumaLine(int y) const
+    {
+        return m_planes[0] + y * m_strides[0];
+    }
+    inline const uchar *cbLine(int y) const
+    {
+        return m_planes[1] + (y >> 1) * m_strides[1];
+    }
+    inline const uchar *crLine(int y) const
+    {
+        return m_planes[2] + (y >> 1) * m_strides[2];
+    }
+
+    /** @brief Full range luma of a YUV sample */
+    static inline int expandLuma(int y)
+    {
+        return qBound(0, ((y - 16) * 255 + 109) / 219, 255);
+    }
+    /** @brief Chroma of a YUV sample on [-0.5, 0.5] */
+    static inline double normalizedChroma(int c)
+    {
+        return (c - 128) / 224.;
+    }
+    /** @brief Full range RGB value of a YUV sample */
+    inline void yuvToRgb(int y, int cb, int cr, int &r, int &g, int &b) const
+    {
+        const int c = 298 * (y - 16) + 128;
+        const int d = cb - 128;
+        const int e = cr - 128;
+        if (m_rec709) {
+            r = qBound(0, (c + 459 * e) >> 8, 255);
+            g = qBound(0, (c - 55 * d - 136 * e) >> 8, 255);
+            b = qBound(0, (c + 541 * d) >> 8, 255);
+        } else {
+            r = qBound(0, (c + 409 * e) >> 8, 255);
+            g = qBound(0, (c - 100 * d - 208 * e) >> 8, 255);
+            b = qBound(0, (c + 516 * d) >> 8, 255);
+        }
+    }
+    /** @brief RGB value of a pixel, for both frame kinds */
+    inline void rgb(int x, int y, int &r, int &g, int &b) const
+    {
+        if (m_yuv) {
+            yuvToRgb(lumaLine(y)[x], cbLine(y)[x >> 1], crLine(y)[x >> 1], r, g, b);
+        } else {
+            const QRgb px = rgbLine(y)[x];
+            r = qRed(px);
+            g = qGreen(px);
+            b = qBlue(px);
+        }
+    }
+
+private:
+    QImage m_image;
+    SharedFrame m_frame;
+    const uchar *m_planes[3];
+    int m_strides[3];
+    int m_width;
+    int m_height;
+    bool m_yuv;
+    bool m_rec709;
+};
+
+#endif // SCOPEFRAME_H
@@ -0,0 +1,338 @@
+/*
+ * Kdenlive color scopes pixel kernels
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "scopekernels.h"
+#include "scopeframe.h"
+#include "scopes/scopethreadpool.h"
+
+#include <QRunnable>
+#include <QSemaphore>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCOPES_SSE2
+#endif
+#if defined(SCOPES_SSE2) && defined(__GNUC__)
+#include <immintrin.h>
+#define SCOPES_AVX2
+#endif
+
+namespace {
+// Luma weights scaled to 256, their sum is 256 so that white stays at 255
+const int Weights601[3] = { 77, 150, 29 };
+const int Weights709[3] = { 54, 183, 19 };
+
+// Bands smaller than this are not worth a thread
+const int MinBandRows = 64;
+const int MaxBands = 8;
+
+typedef void (*LumaFunction)(const QRgb *, int, const int *, uchar *);
+typedef void (*RgbFunction)(const QRgb *, int, uchar *, uchar *, uchar *);
+
+void lumaScalar(const QRgb *line, int count, const int *weights, uchar *luma)
+{
+    for (int x = 0; x < count; ++x) {
+        const QRgb px = line[x];
+        luma[x] = (uchar)((weights[0] * qRed(px) + weights[1] * qGreen(px) + weights[2] * qBlue(px) + 128) >> 8);
+    }
+}
+
+void rgbScalar(const QRgb *line, int count, uchar *red, uchar *green, uchar *blue)
+{
+    for (int x = 0; x < count; ++x) {
+        const QRgb px = line[x];
+        red[x] = (uchar) qRed(px);
+        green[x] = (uchar) qGreen(px);
+        blue[x] = (uchar) qBlue(px);
+    }
+}
+
+#ifdef SCOPES_SSE2
+// Splits 8 pixels into 16 bit red, green and blue lanes
+inline void splitSse2(const QRgb *line, __m128i &r, __m128i &g, __m128i &b)
+{
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line));
+    const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + 4));
+    b = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+    g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask), _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+    r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask), _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+}
+
+// Weighted sum of 8 pixels, the result fits in 16 unsigned bits
+inline __m128i lumaSse2(const QRgb *line, const __m128i &wr, const __m128i &wg, const __m128i &wb)
+{
+    __m128i r, g, b;
+    splitSse2(line, r, g, b);
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(r, wr), _mm_mullo_epi16(g, wg));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, wb));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+}
+
+void lumaSse2(const QRgb *line, int count, const int *weights, uchar *luma)
+{
+    const __m128i wr = _mm_set1_epi16(weights[0]);
+    const __m128i wg = _mm_set1_epi16(weights[1]);
+    const __m128i wb = _mm_set1_epi16(weights[2]);
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i l = _mm_packus_epi16(lumaSse2(line + x, wr, wg, wb), lumaSse2(line + x + 8, wr, wg, wb));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(luma + x), l);
+    }
+    lumaScalar(line + x, count - x, weights, luma + x);
+}
+
+void rgbSse2(const QRgb *line, int count, uchar *red, uchar *green, uchar *blue)
+{
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m128i r0, g0, b0, r1, g1, b1;
+        splitSse2(line + x, r0, g0, b0);
+        splitSse2(line + x + 8, r1, g1, b1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(red + x), _mm_packus_epi16(r0, r1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(green + x), _mm_packus_epi16(g0, g1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(blue + x), _mm_packus_epi16(b0, b1));
+    }
+    rgbScalar(line + x, count - x, red + x, green + x, blue + x);
+}
+#endif
+
+#ifdef SCOPES_AVX2
+// Same as the SSE2 kernels on 32 pixels. The AVX2 packs work on 128 bit lanes,
+// so the packed bytes are put back in pixel order with a final permutation.
+__attribute__((target("avx2"))) inline void splitAvx2(const QRgb *line, __m256i &r, __m256i &g, __m256i &b)
+{
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    const __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(line));
+    const __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(line + 8));
+    b = _mm256_packs_epi32(_mm256_and_si256(p0, mask), _mm256_and_si256(p1, mask));
+    g = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(p0, 8), mask), _mm256_and_si256(_mm256_srli_epi32(p1, 8), mask));
+    r = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(p0, 16), mask), _mm256_and_si256(_mm256_srli_epi32(p1, 16), mask));
+}
+
+__attribute__((target("avx2"))) inline __m256i lumaAvx2(const QRgb *line, const __m256i &wr, const __m256i &wg, const __m256i &wb)
+{
+    __m256i r, g, b;
+    splitAvx2(line, r, g, b);
+    __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(r, wr), _mm256_mullo_epi16(g, wg));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(b, wb));
+    return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(128)), 8);
+}
+
+__attribute__((target("avx2"))) inline __m256i packAvx2(const __m256i &a, const __m256i &b)
+{
+    return _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a, b), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+__attribute__((target("avx2"))) void lumaAvx2(const QRgb *line, int count, const int *weights, uchar *luma)
+{
+    const __m256i wr = _mm256_set1_epi16(weights[0]);
+    const __m256i wg = _mm256_set1_epi16(weights[1]);
+    const __m256i wb = _mm256_set1_epi16(weights[2]);
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        const __m256i l = packAvx2(lumaAvx2(line + x, wr, wg, wb), lumaAvx2(line + x + 16, wr, wg, wb));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(luma + x), l);
+    }
+    lumaSse2(line + x, count - x, weights, luma + x);
+}
+
+__attribute__((target("avx2"))) void rgbAvx2(const QRgb *line, int count, uchar *red, uchar *green, uchar *blue)
+{
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        __m256i r0, g0, b0, r1, g1, b1;
+        splitAvx2(line + x, r0, g0, b0);
+        splitAvx2(line + x + 16, r1, g1, b1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(red + x), packAvx2(r0, r1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(green + x), packAvx2(g0, g1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(blue + x), packAvx2(b0, b1));
+    }
+    rgbSse2(line + x, count - x, red + x, green + x, blue + x);
+}
+
+bool hasAvx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+#endif
+
+LumaFunction lumaFunction()
+{
+#ifdef SCOPES_AVX2
+    if (hasAvx2()) {
+        return &lumaAvx2;
+    }
+#endif
+#ifdef SCOPES_SSE2
+    return &lumaSse2;
+#else
+    return &lumaScalar;
+#endif
+}
+
+RgbFunction rgbFunction()
+{
+#ifdef SCOPES_AVX2
+    if (hasAvx2()) {
+        return &rgbAvx2;
+    }
+#endif
+#ifdef SCOPES_SSE2
+    return &rgbSse2;
+#else
+    return &rgbScalar;
+#endif
+}
+
+// Video range luma to full range
+struct LumaTable {
+    LumaTable()
+    {
+        for (int i = 0; i < 256; ++i) {
+            values[i] = (uchar) ScopeFrame::expandLuma(i);
+        }
+    }
+    uchar values[256];
+};
+
+const uchar *expandedLuma()
+{
+    static const LumaTable table;
+    return table.values;
+}
+
+// One band of ScopeKernels::forEachBand() run by another scope thread
+class BandRunnable : public QRunnable
+{
+public:
+    BandRunnable(const std::function<void ()> &function, QSemaphore *done) :
+        m_function(function),
+        m_done(done)
+    {
+    }
+    void run() Q_DECL_OVERRIDE
+    {
+        ScopeThreadPool::lowerPriority();
+        m_function();
+        m_done->release();
+    }
+
+private:
+    std::function<void ()> m_function;
+    QSemaphore *m_done;
+};
+}
+
+int ScopeKernels::bandCount(int rows)
+{
+    return qBound(1, qMin(ScopeThreadPool::maxThreadCount(), rows / MinBandRows), MaxBands);
+}
+
+void ScopeKernels::forEachBand(int rows, int bands, const std::function<void (int, int, int)> &function)
+{
+    if (bands <= 1) {
+        function(0, 0, rows);
+        return;
+    }
+    // Bands only go to idle scope threads, the others are processed here.
+    // Waiting for queued bands could dead lock when all scope threads wait.
+    QSemaphore done;
+    int started = 0;
+    for (int band = 1; band < bands; ++band) {
+        const int first = (qint64) rows * band / bands;
+        const int end = (qint64) rows * (band + 1) / bands;
+        BandRunnable *runnable = new BandRunnable([&function, band, first, end]() {
+            function(band, first, end);
+        }, &done);
+        if (ScopeThreadPool::pool()->tryStart(runnable)) {
+            ++started;
+        } else {
+            delete runnable;
+            function(band, first, end);
+        }
+    }
+    function(0, 0, (qint64) rows / bands);
+    done.acquire(started);
+}
+
+void ScopeKernels::lumaRow(const ScopeFrame &frame, int y, bool rec709, uchar *luma)
+{
+    const int width = frame.width();
+    const int *weights = rec709 ? Weights709 : Weights601;
+    if (!frame.isYuv()) {
+        static const LumaFunction kernel = lumaFunction();
+        kernel(frame.rgbLine(y), width, weights, luma);
+        return;
+    }
+    const uchar *line = frame.lumaLine(y);
+    if (frame.isRec709() == rec709) {
+        // The luma plane was encoded with the requested matrix
+        const uchar *table = expandedLuma();
+        for (int x = 0; x < width; ++x) {
+            luma[x] = table[line[x]];
+        }
+        return;
+    }
+    const uchar *cb = frame.cbLine(y);
+    const uchar *cr = frame.crLine(y);
+    int r, g, b;
+    for (int x = 0; x < width; ++x) {
+        frame.yuvToRgb(line[x], cb[x >> 1], cr[x >> 1], r, g, b);
+        luma[x] = (uchar)((weights[0] * r + weights[1] * g + weights[2] * b + 128) >> 8);
+    }
+}
+
+void ScopeKernels::rgbRow(const ScopeFrame &frame, int y, uchar *red, uchar *green, uchar *blue)
+{
+    const int width = frame.width();
+    if (!frame.isYuv()) {
+        static const RgbFunction kernel = rgbFunction();
+        kernel(frame.rgbLine(y), width, red, green, blue);
+        return;
+    }
+    const uchar *line = frame.lumaLine(y);
+    const uchar *cb = frame.cbLine(y);
+    const uchar *cr = frame.crLine(y);
+    int r, g, b;
+    for (int x = 0; x < width; ++x) {
+        frame.yuvToRgb(line[x], cb[x >> 1], cr[x >> 1], r, g, b);
+        red[x] = (uchar) r;
+        green[x] = (uchar) g;
+        blue[x] = (uchar) b;
+    }
+}
+
+const char *ScopeKernels::instructionSet()
+{
+#ifdef SCOPES_AVX2
+    if (hasAvx2()) {
+        return "AVX2";
+    }
+#endif
+#ifdef SCOPES_SSE2
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
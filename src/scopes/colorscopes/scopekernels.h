@@ -0,0 +1,56 @@
+/*
+ * Kdenlive color scopes pixel kernels
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SCOPEKERNELS_H
+#define SCOPEKERNELS_H
+
+#include <QtGlobal>
+#include <functional>
+
+class ScopeFrame;
+
+/**
+  \brief Row kernels and row partitioning shared by the color scope generators.
+
+  The generators accumulate their statistics over bands of rows processed in
+  parallel, each band filling its own buffers which are summed afterwards.
+  Pixels of RGB images are converted with SSE2 or AVX2 depending on the CPU,
+  with a scalar fallback for other architectures and for YUV frames.
+  */
+namespace ScopeKernels
+{
+/** @brief Number of bands used to process the given number of rows */
+int bandCount(int rows);
+/** @brief Calls function(band, firstRow, endRow) for each of the bands, in parallel
+ * Rows are split in bands of equal size, endRow is excluded. Bands run on idle ScopeThreadPool threads
+ * or in the calling thread. The call returns once all bands are processed. */
+void forEachBand(int rows, int bands, const std::function<void (int, int, int)> &function);
+/** @brief Writes the full range luma of the pixels of row y to luma, which must hold width() values */
+void lumaRow(const ScopeFrame &frame, int y, bool rec709, uchar *luma);
+/** @brief Writes the RGB components of the pixels of row y to red, green and blue, which must hold width() values */
+void rgbRow(const ScopeFrame &frame, int y, uchar *red, uchar *green, uchar *blue);
+/** @brief Name of the instruction set used for RGB images, for benchmarks and debug output */
+const char *instructionSet();
+}
+
+#endif // SCOPEKERNELS_H
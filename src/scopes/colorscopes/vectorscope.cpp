@@ -261,7 +261,19 @@ QImage Vectorscope::renderHUD(uint)
     return hud;
 }
 
-QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+ScopeAnalysis::Request Vectorscope::analysisRequest()
+{
+    if (cw <= 0) {
+        // Scope size not known yet
+        return ScopeAnalysis::Request();
+    }
+    VectorscopeGenerator::ColorSpace colorSpace = m_aColorSpace_YPbPr->isChecked() ?
+            VectorscopeGenerator::ColorSpace_YPbPr : VectorscopeGenerator::ColorSpace_YUV;
+    VectorscopeGenerator::PaintMode paintMode = (VectorscopeGenerator::PaintMode) ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
+    return VectorscopeGenerator::analysisRequest(m_scopeRect.size(), m_gain, paintMode, colorSpace, m_accelFactorScope);
+}
+
+QImage Vectorscope::renderGfxScope(uint accelerationFactor, const ScopeAnalysis &analysis)
 {
     QTime start = QTime::currentTime();
     QImage scope;
@@ -273,14 +285,16 @@ QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage
         VectorscopeGenerator::ColorSpace colorSpace = m_aColorSpace_YPbPr->isChecked() ?
                 VectorscopeGenerator::ColorSpace_YPbPr : VectorscopeGenerator::ColorSpace_YUV;
         VectorscopeGenerator::PaintMode paintMode = (VectorscopeGenerator::PaintMode) ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
+        const ScopeAnalysis::Request request = VectorscopeGenerator::analysisRequest(m_scopeRect.size(), m_gain, paintMode, colorSpace,
+                                               accelerationFactor);
         scope = m_vectorscopeGenerator->calculateVectorscope(m_scopeRect.size(),
-                qimage,
-                m_gain, paintMode, colorSpace,
-                m_aAxisEnabled->isChecked(), accelerationFactor);
+                analysis.result(request), paintMode,
+                m_aAxisEnabled->isChecked());
 
     }
 
-    unsigned int mseconds = start.msecsTo(QTime::currentTime());
+    // Reading the frame is part of the scope cost
+    unsigned int mseconds = start.msecsTo(QTime::currentTime()) + analysis.elapsed();
     emit signalScopeRenderingFinished(mseconds, accelerationFactor);
     return scope;
 }
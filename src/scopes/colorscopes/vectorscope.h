@@ -35,12 +35,13 @@ public:
     ~Vectorscope();
 
     QString widgetName() const Q_DECL_OVERRIDE;
+    ScopeAnalysis::Request analysisRequest() Q_DECL_OVERRIDE;
 
 protected:
     ///// Implemented methods /////
     QRect scopeRect() Q_DECL_OVERRIDE;
     QImage renderHUD(uint accelerationFactor) Q_DECL_OVERRIDE;
-    QImage renderGfxScope(uint accelerationFactor, const QImage &) Q_DECL_OVERRIDE;
+    QImage renderGfxScope(uint accelerationFactor, const ScopeAnalysis &) Q_DECL_OVERRIDE;
     QImage renderBackground(uint accelerationFactor) Q_DECL_OVERRIDE;
     bool isHUDDependingOnInput() const Q_DECL_OVERRIDE;
     bool isScopeDependingOnInput() const Q_DECL_OVERRIDE;
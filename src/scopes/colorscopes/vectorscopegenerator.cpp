@@ -73,6 +73,24 @@ const float SCALING = 1 / .7;
 
 const float VectorscopeGenerator::scaling = 1 / .7;
 
+namespace {
+// Scope pixel after one more image pixel fell on it, for the paint modes only depending on the number of hits
+inline QRgb accumulate(QRgb px, VectorscopeGenerator::PaintMode paintMode, double avgPxPerPx)
+{
+    switch (paintMode) {
+    case VectorscopeGenerator::PaintMode_Green:
+        return qRgba(qRed(px) + (255 - qRed(px)) / (3 * avgPxPerPx), qGreen(px) + 20 * (255 - qGreen(px)) / (avgPxPerPx),
+                     qBlue(px) + (255 - qBlue(px)) / (avgPxPerPx), qAlpha(px) + (255 - qAlpha(px)) / (avgPxPerPx));
+    case VectorscopeGenerator::PaintMode_Green2:
+        return qRgba(qRed(px) + ceil((255 - (float)qRed(px)) / (4 * avgPxPerPx)), 255,
+                     qBlue(px) + ceil((255 - (float)qBlue(px)) / (avgPxPerPx)), qAlpha(px) + ceil((255 - (float)qAlpha(px)) / (avgPxPerPx)));
+    case VectorscopeGenerator::PaintMode_Black:
+    default:
+        return qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20);
+    }
+}
+}
+
 /**
   Input point is on [-1,1]², 0 being at the center,
   and positive directions are →top/→right.
@@ -109,108 +127,75 @@ QPoint VectorscopeGenerator::mapToCircle(const QSize &targetSize, const QPointF
                   (targetSize.height() - 1) * (1 - (point.y() + 1) / 2));
 }
 
-QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, const QImage &image, const float &gain,
+ScopeAnalysis::Request VectorscopeGenerator::analysisRequest(const QSize &vectorscopeSize, const float &gain,
+        const VectorscopeGenerator::PaintMode &paintMode,
+        const VectorscopeGenerator::ColorSpace &colorSpace, uint accelFactor)
+{
+    ScopeAnalysis::Request request;
+    request.accumulators = ScopeAnalysis::ChromaHits;
+    if (paintMode == PaintMode_Original) {
+        request.accumulators |= ScopeAnalysis::ChromaColors;
+    }
+    request.accelFactor = accelFactor;
+    request.chromaSize = vectorscopeSize;
+    request.chromaGain = SCALING * gain;
+    request.chromaYPbPr = colorSpace == VectorscopeGenerator::ColorSpace_YPbPr;
+    return request;
+}
+
+QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, const ScopeFrame &image, const float &gain,
         const VectorscopeGenerator::PaintMode &paintMode,
         const VectorscopeGenerator::ColorSpace &colorSpace,
-        bool, uint accelFactor) const
+        bool drawAxis, uint accelFactor) const
 {
-    if (vectorscopeSize.width() <= 0 || vectorscopeSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    const ScopeAnalysis::Request request = analysisRequest(vectorscopeSize, gain, paintMode, colorSpace, accelFactor);
+    const ScopeAnalysis analysis(image, QVector<ScopeAnalysis::Request>() << request);
+    return calculateVectorscope(vectorscopeSize, analysis.result(request), paintMode, drawAxis);
+}
+
+QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, const ScopeAnalysis::Result &hitData,
+        const VectorscopeGenerator::PaintMode &paintMode, bool) const
+{
+    // Prepare the vectorscope data
+    const int cw = (vectorscopeSize.width() < vectorscopeSize.height()) ? vectorscopeSize.width() : vectorscopeSize.height();
+    if (vectorscopeSize.width() <= 0 || vectorscopeSize.height() <= 0 || hitData.chromaHits.count() != cw * cw) {
         // Invalid size
         return QImage();
     }
 
-    // Prepare the vectorscope data
-    const int cw = (vectorscopeSize.width() < vectorscopeSize.height()) ? vectorscopeSize.width() : vectorscopeSize.height();
     QImage scope = QImage(cw, cw, QImage::Format_ARGB32);
     scope.fill(qRgba(0, 0, 0, 0));
 
-    const uchar *bits = image.bits();
-
     double dy, dr, dg, db, dmax;
     double /*y,*/ u, v;
-    QPoint pt;
-    QRgb px;
 
-    const int stepsize = image.depth() / 8 * accelFactor;
+    const int iw = hitData.frameSize.width();
+    const int ih = hitData.frameSize.height();
+    const uint accelFactor = hitData.request.accelFactor;
+    const VectorscopeGenerator::ColorSpace colorSpace = hitData.request.chromaYPbPr ? ColorSpace_YPbPr : ColorSpace_YUV;
+    const uint *hits = hitData.chromaHits.constData();
 
     // Just an average for the number of image pixels per scope pixel.
-    // NOTE: byteCount() has to be replaced by (img.bytesPerLine()*img.height()) for Qt 4.5 to compile, see: http://doc.trolltech.org/4.6/qimage.html#bytesPerLine
-    double avgPxPerPx = (double) image.depth() / 8 * (image.bytesPerLine() * image.height()) / scope.size().width() / scope.size().height() / accelFactor;
-
-    for (int i = 0; i < (image.bytesPerLine()*image.height()); i += stepsize) {
-        QRgb *col = (QRgb *) bits;
-
-        int r = qRed(*col);
-        int g = qGreen(*col);
-        int b = qBlue(*col);
-
-        switch (colorSpace) {
-        case VectorscopeGenerator::ColorSpace_YUV:
-//             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double) - 0.0005781 * r - 0.001135 * g + 0.001713 * b;
-            v = (double)  0.002411 * r - 0.002019 * g - 0.0003921 * b;
-            break;
-        case VectorscopeGenerator::ColorSpace_YPbPr:
-        default:
-//             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double) - 0.0006671 * r - 0.001299 * g + 0.0019608 * b;
-            v = (double)  0.001961 * r - 0.001642 * g - 0.0003189 * b;
-            break;
-        }
-
-        pt = mapToCircle(vectorscopeSize, QPointF(SCALING * gain * u, SCALING * gain * v));
-
-        if (pt.x() >= scope.width() || pt.x() < 0
-                || pt.y() >= scope.height() || pt.y() < 0) {
-            // Point lies outside (because of scaling), don't plot it
-
-        } else {
+    // Keeps the scaling used when the scope was fed 32 bit images only.
+    double avgPxPerPx = (double) 16 * iw * ih / scope.size().width() / scope.size().height() / accelFactor;
+
+    for (int j = 0; j < cw; ++j) {
+        QRgb *line = reinterpret_cast<QRgb *>(scope.scanLine(j));
+        for (int i = 0; i < cw; ++i) {
+            const uint n = hits[j * cw + i];
+            if (n == 0) {
+                continue;
+            }
 
             // Draw the pixel using the chosen draw mode.
             switch (paintMode) {
             case PaintMode_YUV:
-                // see yuvColorWheel
-                dy = 128; // Default Y value. Lower = darker.
-
-                // Calculate the RGB values from YUV/YPbPr
-                switch (colorSpace) {
-                case VectorscopeGenerator::ColorSpace_YUV:
-                    dr = dy + 290.8 * v;
-                    dg = dy - 100.6 * u - 148 * v;
-                    db = dy + 517.2 * u;
-                    break;
-                case VectorscopeGenerator::ColorSpace_YPbPr:
-                default:
-                    dr = dy + 357.5 * v;
-                    dg = dy - 87.75 * u - 182 * v;
-                    db = dy + 451.9 * u;
-                    break;
-                }
-
-                if (dr < 0) {
-                    dr = 0;
-                }
-                if (dg < 0) {
-                    dg = 0;
-                }
-                if (db < 0) {
-                    db = 0;
-                }
-                if (dr > 255) {
-                    dr = 255;
-                }
-                if (dg > 255) {
-                    dg = 255;
-                }
-                if (db > 255) {
-                    db = 255;
-                }
-
-                scope.setPixel(pt, qRgba(dr, dg, db, 255));
-                break;
-
             case PaintMode_Chroma:
-                dy = 200; // Default Y value. Lower = darker.
+                // Chroma at the center of the scope pixel, reverting mapToCircle()
+                u = (2 * (i + .5) / qMax(1, vectorscopeSize.width() - 1) - 1) / hitData.request.chromaGain;
+                v = (1 - 2 * (j + .5) / qMax(1, vectorscopeSize.height() - 1)) / hitData.request.chromaGain;
+                // see yuvColorWheel
+                dy = paintMode == PaintMode_YUV ? 128 : 200; // Default Y value. Lower = darker.
 
                 // Calculate the RGB values from YUV/YPbPr
                 switch (colorSpace) {
@@ -227,44 +212,47 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                     break;
                 }
 
-                // Scale the RGB values back to max 255
-                dmax = dr;
-                if (dg > dmax) {
-                    dmax = dg;
-                }
-                if (db > dmax) {
-                    dmax = db;
+                if (paintMode == PaintMode_YUV) {
+                    dr = qBound(0., dr, 255.);
+                    dg = qBound(0., dg, 255.);
+                    db = qBound(0., db, 255.);
+                } else {
+                    // Scale the RGB values back to max 255
+                    dmax = dr;
+                    if (dg > dmax) {
+                        dmax = dg;
+                    }
+                    if (db > dmax) {
+                        dmax = db;
+                    }
+                    dmax = 255 / dmax;
+
+                    dr *= dmax;
+                    dg *= dmax;
+                    db *= dmax;
                 }
-                dmax = 255 / dmax;
 
-                dr *= dmax;
-                dg *= dmax;
-                db *= dmax;
-
-                scope.setPixel(pt, qRgba(dr, dg, db, 255));
+                line[i] = qRgba(dr, dg, db, 255);
                 break;
             case PaintMode_Original:
-                scope.setPixel(pt, *col);
-                break;
-            case PaintMode_Green:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px) + (255 - qRed(px)) / (3 * avgPxPerPx), qGreen(px) + 20 * (255 - qGreen(px)) / (avgPxPerPx),
-                                         qBlue(px) + (255 - qBlue(px)) / (avgPxPerPx), qAlpha(px) + (255 - qAlpha(px)) / (avgPxPerPx)));
+                line[i] = hitData.chromaColors.count() == cw * cw ? hitData.chromaColors.at(j * cw + i) : qRgb(255, 255, 255);
                 break;
-            case PaintMode_Green2:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px) + ceil((255 - (float)qRed(px)) / (4 * avgPxPerPx)), 255,
-                                         qBlue(px) + ceil((255 - (float)qBlue(px)) / (avgPxPerPx)), qAlpha(px) + ceil((255 - (float)qAlpha(px)) / (avgPxPerPx))));
-                break;
-            case PaintMode_Black:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20));
+            default: {
+                // The color only depends on the number of image pixels falling on the scope pixel.
+                // Apply them one after the other, which stops changing the pixel once it is saturated.
+                QRgb px = line[i];
+                for (uint k = 0; k < n; ++k) {
+                    const QRgb next = accumulate(px, paintMode, avgPxPerPx);
+                    if (next == px) {
+                        break;
+                    }
+                    px = next;
+                }
+                line[i] = px;
                 break;
             }
+            }
         }
-
-        bits += stepsize;
     }
     return scope;
 }
-
@@ -11,6 +11,8 @@
 #ifndef VECTORSCOPEGENERATOR_H
 #define VECTORSCOPEGENERATOR_H
 
+#include "scopeanalysis.h"
+
 #include <QObject>
 #include <QImage>
 
@@ -27,7 +29,15 @@ public:
     enum ColorSpace { ColorSpace_YUV, ColorSpace_YPbPr };
     enum PaintMode { PaintMode_Green, PaintMode_Green2, PaintMode_Original, PaintMode_Chroma, PaintMode_YUV, PaintMode_Black };
 
-    QImage calculateVectorscope(const QSize &vectorscopeSize, const QImage &image, const float &gain,
+    /** @brief Accumulators needed to paint a vectorscope */
+    static ScopeAnalysis::Request analysisRequest(const QSize &vectorscopeSize, const float &gain,
+            const VectorscopeGenerator::PaintMode &paintMode,
+            const VectorscopeGenerator::ColorSpace &colorSpace, uint accelFactor = 1);
+    /** @brief Paints the vectorscope from the number of pixels falling on each of its points */
+    QImage calculateVectorscope(const QSize &vectorscopeSize, const ScopeAnalysis::Result &hits,
+                                const VectorscopeGenerator::PaintMode &paintMode, bool) const;
+    /** @brief Reads the frame and paints its vectorscope */
+    QImage calculateVectorscope(const QSize &vectorscopeSize, const ScopeFrame &image, const float &gain,
                                 const VectorscopeGenerator::PaintMode &paintMode,
                                 const VectorscopeGenerator::ColorSpace &colorSpace,
                                 bool, uint accelFactor = 1) const;
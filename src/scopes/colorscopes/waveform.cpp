@@ -178,17 +178,25 @@ QImage Waveform::renderHUD(uint)
     return hud;
 }
 
-QImage Waveform::renderGfxScope(uint accelFactor, const QImage &qimage)
+ScopeAnalysis::Request Waveform::analysisRequest()
+{
+    WaveformGenerator::Rec rec = m_aRec601->isChecked() ? WaveformGenerator::Rec_601 : WaveformGenerator::Rec_709;
+    return WaveformGenerator::analysisRequest(scopeRect().size() - m_textWidth - QSize(0, m_paddingBottom), rec, m_accelFactorScope);
+}
+
+QImage Waveform::renderGfxScope(uint accelFactor, const ScopeAnalysis &analysis)
 {
     QTime start = QTime::currentTime();
     start.start();
 
     const int paintmode = ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
     WaveformGenerator::Rec rec = m_aRec601->isChecked() ? WaveformGenerator::Rec_601 : WaveformGenerator::Rec_709;
-    QImage wave = m_waveformGenerator->calculateWaveform(scopeRect().size() - m_textWidth - QSize(0, m_paddingBottom), qimage,
-                  (WaveformGenerator::PaintMode) paintmode, true, rec, accelFactor);
+    const QSize size = scopeRect().size() - m_textWidth - QSize(0, m_paddingBottom);
+    const ScopeAnalysis::Request request = WaveformGenerator::analysisRequest(size, rec, accelFactor);
+    QImage wave = m_waveformGenerator->calculateWaveform(size, analysis.result(request), (WaveformGenerator::PaintMode) paintmode, true);
 
-    emit signalScopeRenderingFinished(start.elapsed(), 1);
+    // Reading the frame is part of the scope cost
+    emit signalScopeRenderingFinished(start.elapsed() + analysis.elapsed(), 1);
     return wave;
 }
 
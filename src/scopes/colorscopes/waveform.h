@@ -32,6 +32,7 @@ public:
     ~Waveform();
 
     QString widgetName() const Q_DECL_OVERRIDE;
+    ScopeAnalysis::Request analysisRequest() Q_DECL_OVERRIDE;
 
 protected:
     void readConfig() Q_DECL_OVERRIDE;
@@ -53,7 +54,7 @@ private:
     /// Implemented methods ///
     QRect scopeRect() Q_DECL_OVERRIDE;
     QImage renderHUD(uint) Q_DECL_OVERRIDE;
-    QImage renderGfxScope(uint, const QImage &) Q_DECL_OVERRIDE;
+    QImage renderGfxScope(uint, const ScopeAnalysis &) Q_DECL_OVERRIDE;
     QImage renderBackground(uint) Q_DECL_OVERRIDE;
     bool isHUDDependingOnInput() const Q_DECL_OVERRIDE;
     bool isScopeDependingOnInput() const Q_DECL_OVERRIDE;
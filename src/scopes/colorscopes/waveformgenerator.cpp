@@ -27,9 +27,28 @@ WaveformGenerator::~WaveformGenerator()
 {
 }
 
-QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QImage &image, WaveformGenerator::PaintMode paintMode,
+ScopeAnalysis::Request WaveformGenerator::analysisRequest(const QSize &waveformSize, WaveformGenerator::Rec rec, uint accelFactor)
+{
+    ScopeAnalysis::Request request;
+    request.accumulators = ScopeAnalysis::LumaColumns;
+    request.accelFactor = accelFactor;
+    request.rec709 = rec == WaveformGenerator::Rec_709;
+    request.columns = waveformSize.width();
+    return request;
+}
+
+QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const ScopeFrame &image, WaveformGenerator::PaintMode paintMode,
         bool drawAxis, WaveformGenerator::Rec rec, uint accelFactor)
 {
+    const ScopeAnalysis::Request request = analysisRequest(waveformSize, rec, accelFactor);
+    const ScopeAnalysis analysis(image, QVector<ScopeAnalysis::Request>() << request);
+    return calculateWaveform(waveformSize, analysis.result(request), paintMode, drawAxis);
+}
+
+QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const ScopeAnalysis::Result &levelData, WaveformGenerator::PaintMode paintMode,
+        bool drawAxis)
+{
+    const uint accelFactor = levelData.request.accelFactor;
     Q_ASSERT(accelFactor >= 1);
 
     //QTime time;
@@ -37,7 +56,7 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
 
     QImage wave(waveformSize, QImage::Format_ARGB32);
 
-    if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || levelData.lumaColumns.count() != waveformSize.width() * 256) {
         return QImage();
 
     } else {
@@ -47,88 +66,54 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
 
         const uint ww = waveformSize.width();
         const uint wh = waveformSize.height();
-        const uint iw = image.bytesPerLine();
-        const uint ih = image.height();
-        const uint byteCount = iw * ih;
-
-        uint waveValues[waveformSize.width()][waveformSize.height()];
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                waveValues[i][j] = 0;
-            }
-        }
+        const uint iw = levelData.frameSize.width();
+        const uint ih = levelData.frameSize.height();
 
         // Number of input pixels that will fall on one scope pixel.
         // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-        const float pixelDepth = (float)((byteCount >> 2) / accelFactor) / (ww * wh);
+        const float pixelDepth = (float)((iw * ih) / accelFactor) / (ww * wh);
         const float gain = 255 / (8 * pixelDepth);
         //qCDebug(KDENLIVE_LOG) << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
 
         // Subtract 1 from sizes because we start counting from 0.
         // Not doing it would result in attempts to paint outside of the image.
         const float hPrediv = (float)(wh - 1) / 255;
-        const float wPrediv = (float)(ww - 1) / (iw - 1);
-
-        const uchar *bits = image.bits();
-        const int bpp = image.depth() / 8;
-
-        for (uint i = 0, x = 0; i < byteCount; i += bpp) {
-
-            Q_ASSERT(bits < image.bits() + byteCount);
-
-            double dY, dx, dy;
-            QRgb *col = (QRgb *)bits;
-
-            if (rec == WaveformGenerator::Rec_601) {
-                // CIE 601 Luminance
-                dY = .299 * qRed(*col) + .587 * qGreen(*col) + .114 * qBlue(*col);
-            } else {
-                // CIE 709 Luminance
-                dY = .2125 * qRed(*col) + .7154 * qGreen(*col) + .0721 * qBlue(*col);
-            }
-            // dY is on [0,255] now.
-
-            dy = dY * hPrediv;
-            dx = x * wPrediv;
-            waveValues[(int)dx][(int)dy]++;
-
-            bits += bpp;
-            x += bpp;
-            if (x > iw) {
-                x -= iw;
-                if (accelFactor > 1) {
-                    bits += bpp * iw * (accelFactor - 1);
-                    i += bpp * iw * (accelFactor - 1);
-                }
+        const uint *levels = levelData.lumaColumns.constData();
+
+        // Map the 256 levels to the scope height
+        m_waveValues.fill(0, ww * wh);
+        uint *waveValues = m_waveValues.data();
+        for (uint i = 0; i < ww; ++i) {
+            const uint *columnLevels = levels + i * 256;
+            for (int level = 0; level < 256; ++level) {
+                waveValues[(int)(level * hPrediv) * ww + i] += columnLevels[level];
             }
         }
 
-        switch (paintMode) {
-        case PaintMode_Green:
-            for (int i = 0; i < waveformSize.width(); ++i) {
-                for (int j = 0; j < waveformSize.height(); ++j) {
-                    // Logarithmic scale. Needs fine tuning by hand, but looks great.
-                    wave.setPixel(i, waveformSize.height() - j - 1, qRgba(CHOP255(52 * log(0.1 * gain * waveValues[i][j])),
-                                  CHOP255(52 * log(gain * waveValues[i][j])),
-                                  CHOP255(52 * log(.25 * gain * waveValues[i][j])),
-                                  CHOP255(64 * log(gain * waveValues[i][j]))));
-                }
-            }
-            break;
-        case PaintMode_Yellow:
-            for (int i = 0; i < waveformSize.width(); ++i) {
-                for (int j = 0; j < waveformSize.height(); ++j) {
-                    wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 242, 0,   CHOP255(gain * waveValues[i][j])));
+        for (uint j = 0; j < wh; ++j) {
+            QRgb *line = reinterpret_cast<QRgb *>(wave.scanLine(wh - j - 1));
+            const uint *values = waveValues + j * ww;
+            for (uint i = 0; i < ww; ++i) {
+                if (values[i] == 0) {
+                    // Keep the transparent background
+                    continue;
                 }
-            }
-            break;
-        default:
-            for (int i = 0; i < waveformSize.width(); ++i) {
-                for (int j = 0; j < waveformSize.height(); ++j) {
-                    wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 255, 255, CHOP255(2 * gain * waveValues[i][j])));
+                switch (paintMode) {
+                case PaintMode_Green:
+                    // Logarithmic scale. Needs fine tuning by hand, but looks great.
+                    line[i] = qRgba(CHOP255(52 * log(0.1 * gain * values[i])),
+                                    CHOP255(52 * log(gain * values[i])),
+                                    CHOP255(52 * log(.25 * gain * values[i])),
+                                    CHOP255(64 * log(gain * values[i])));
+                    break;
+                case PaintMode_Yellow:
+                    line[i] = qRgba(255, 242, 0, CHOP255(gain * values[i]));
+                    break;
+                default:
+                    line[i] = qRgba(255, 255, 255, CHOP255(2 * gain * values[i]));
+                    break;
                 }
             }
-            break;
         }
 
         if (drawAxis) {
@@ -138,10 +123,11 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
             davinci.setCompositionMode(QPainter::CompositionMode_Overlay);
             for (uint i = 0; i <= 10; ++i) {
                 float dy = (float)i / 10 * (wh - 1);
+                QRgb *line = reinterpret_cast<QRgb *>(wave.scanLine(dy));
                 for (uint x = 0; x < ww; ++x) {
-                    opx = wave.pixel(x, dy);
-                    wave.setPixel(x, dy, qRgba(CHOP255(150 + qRed(opx)), 255,
-                                               CHOP255(200 + qBlue(opx)), CHOP255(32 + qAlpha(opx))));
+                    opx = line[x];
+                    line[x] = qRgba(CHOP255(150 + qRed(opx)), 255,
+                                    CHOP255(200 + qBlue(opx)), CHOP255(32 + qAlpha(opx)));
                 }
             }
         }
@@ -11,7 +11,10 @@
 #ifndef WAVEFORMGENERATOR_H
 #define WAVEFORMGENERATOR_H
 
+#include "scopeanalysis.h"
+
 #include <QObject>
+#include <QVector>
 class QImage;
 class QSize;
 
@@ -26,8 +29,18 @@ public:
     WaveformGenerator();
     ~WaveformGenerator();
 
-    QImage calculateWaveform(const QSize &waveformSize, const QImage &image, WaveformGenerator::PaintMode paintMode,
+    /** @brief Accumulators needed to paint a waveform */
+    static ScopeAnalysis::Request analysisRequest(const QSize &waveformSize, const WaveformGenerator::Rec rec, uint accelFactor = 1);
+    /** @brief Paints the waveform from the luma levels of each column */
+    QImage calculateWaveform(const QSize &waveformSize, const ScopeAnalysis::Result &levels, WaveformGenerator::PaintMode paintMode,
+                             bool drawAxis);
+    /** @brief Reads the frame and paints its waveform */
+    QImage calculateWaveform(const QSize &waveformSize, const ScopeFrame &image, WaveformGenerator::PaintMode paintMode,
                              bool drawAxis, const WaveformGenerator::Rec rec, uint accelFactor = 1);
+
+private:
+    /** Counts of each scope pixel, row by row */
+    QVector<uint> m_waveValues;
 };
 
 #endif // WAVEFORMGENERATOR_H
@@ -21,6 +21,7 @@
 #include "audioscopes/audiosignal.h"
 #include "audioscopes/audiospectrum.h"
 #include "audioscopes/spectrogram.h"
+#include "scopethreadpool.h"
 
 #include <QDockWidget>
 #include "klocalizedstring.h"
@@ -40,6 +41,7 @@ ScopeManager::ScopeManager(QObject *parent) :
     connect(pCore->monitorManager(), &MonitorManager::clearScopes, this, &ScopeManager::slotClearColorScopes);
     connect(pCore->monitorManager(), &MonitorManager::checkScopes, this, &ScopeManager::slotCheckActiveScopes);
     connect(m_signalMapper, SIGNAL(mapped(QString)), SLOT(slotRequestFrame(QString)));
+    connect(&m_analysisWatcher, &QFutureWatcherBase::finished, this, &ScopeManager::slotAnalysisFinished);
 
     slotUpdateActiveRenderer();
 
@@ -131,32 +133,91 @@ void ScopeManager::slotDistributeAudio(const audioShortVector &sampleData, int f
     }
 }
 void ScopeManager::slotDistributeFrame(const QImage &image)
+{
+    distributeFrame(ScopeFrame(image));
+}
+
+void ScopeManager::slotDistributeSharedFrame(const SharedFrame &frame)
+{
+    distributeFrame(ScopeFrame(frame));
+}
+
+void ScopeManager::distributeFrame(const ScopeFrame &image)
 {
 #ifdef DEBUG_SM
     qCDebug(KDENLIVE_LOG) << "ScopeManager: Starting to distribute frame.";
 #endif
+    // A frame still waiting for analysis is replaced, but its forced updates are kept
+    m_pendingScopes.clear();
     for (int i = 0; i < m_colorScopes.size(); ++i) {
         if (!m_colorScopes[i].scope->visibleRegion().isEmpty()) {
             if (m_colorScopes[i].scope->autoRefreshEnabled()) {
-                m_colorScopes[i].scope->slotRenderZoneUpdated(image);
+                m_pendingScopes << i;
 #ifdef DEBUG_SM
-                qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributed frame to " << m_colorScopes[i].scope->widgetName();
+                qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributing frame to " << m_colorScopes[i].scope->widgetName();
 #endif
-            } else if (m_colorScopes[i].singleFrameRequested) {
+            } else if (m_colorScopes[i].singleFrameRequested || m_pendingForced.contains(i)) {
                 // Special case: Auto refresh is disabled, but user requested an update (e.g. by clicking).
                 // Force the scope to update.
                 m_colorScopes[i].singleFrameRequested = false;
-                m_colorScopes[i].scope->slotRenderZoneUpdated(image);
-                m_colorScopes[i].scope->forceUpdateScope();
+                m_pendingScopes << i;
+                if (!m_pendingForced.contains(i)) {
+                    m_pendingForced << i;
+                }
 #ifdef DEBUG_SM
-                qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributed forced frame to " << m_colorScopes[i].scope->widgetName();
+                qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributing forced frame to " << m_colorScopes[i].scope->widgetName();
 #endif
             }
         }
     }
+    if (m_pendingScopes.isEmpty()) {
+        m_pendingFrame = ScopeFrame();
+        m_pendingForced.clear();
+        return;
+    }
+    m_pendingFrame = image;
+    if (!m_analysisWatcher.isRunning()) {
+        startAnalysis();
+    }
     //checkActiveColourScopes();
 }
 
+void ScopeManager::startAnalysis()
+{
+    if (m_pendingScopes.isEmpty()) {
+        return;
+    }
+    m_analysisScopes = m_pendingScopes;
+    m_analysisForced = m_pendingForced;
+    m_pendingScopes.clear();
+    m_pendingForced.clear();
+    // Requests depend on the scope settings, so they are collected here in the GUI thread
+    QVector<ScopeAnalysis::Request> requests;
+    for (int i = 0; i < m_analysisScopes.count(); ++i) {
+        requests << m_colorScopes.at(m_analysisScopes.at(i)).scope->analysisRequest();
+    }
+    const ScopeFrame frame = m_pendingFrame;
+    m_pendingFrame = ScopeFrame();
+    m_analysisWatcher.setFuture(ScopeThreadPool::run([frame, requests]() {
+        return ScopeAnalysis(frame, requests);
+    }));
+}
+
+void ScopeManager::slotAnalysisFinished()
+{
+    const ScopeAnalysis analysis = m_analysisWatcher.result();
+    for (int i = 0; i < m_analysisScopes.count(); ++i) {
+        AbstractGfxScopeWidget *scope = m_colorScopes.at(m_analysisScopes.at(i)).scope;
+        scope->slotRenderZoneUpdated(analysis);
+        if (m_analysisForced.contains(m_analysisScopes.at(i))) {
+            scope->forceUpdateScope();
+        }
+    }
+    m_analysisScopes.clear();
+    m_analysisForced.clear();
+    startAnalysis();
+}
+
 void ScopeManager::slotScopeReady()
 {
     if (m_lastConnectedRenderer) {
@@ -214,6 +275,8 @@ void ScopeManager::slotUpdateActiveRenderer()
     if (m_lastConnectedRenderer != nullptr) {
         connect(m_lastConnectedRenderer, &AbstractRender::frameUpdated,
                 this, &ScopeManager::slotDistributeFrame, Qt::UniqueConnection);
+        connect(m_lastConnectedRenderer, &AbstractRender::sharedFrameUpdated,
+                this, &ScopeManager::slotDistributeSharedFrame, Qt::UniqueConnection);
         connect(m_lastConnectedRenderer, &AbstractRender::audioSamplesSignal,
                 this, &ScopeManager::slotDistributeAudio, Qt::UniqueConnection);
 
@@ -14,7 +14,9 @@
 #include "audioscopes/abstractaudioscopewidget.h"
 #include "colorscopes/abstractgfxscopewidget.h"
 
+#include <QFutureWatcher>
 #include <QList>
+#include <QVector>
 
 class QDockWidget;
 class AbstractRender;
@@ -73,6 +75,16 @@ private:
 
     QSignalMapper *m_signalMapper;
 
+    /** Analysis of the frame shared by all color scopes, running in a separate thread */
+    QFutureWatcher<ScopeAnalysis> m_analysisWatcher;
+    /** Indexes in m_colorScopes of the scopes receiving the running analysis, and of those to force an update for */
+    QVector<int> m_analysisScopes;
+    QVector<int> m_analysisForced;
+    /** Latest frame received while an analysis was running, older ones are dropped */
+    ScopeFrame m_pendingFrame;
+    QVector<int> m_pendingScopes;
+    QVector<int> m_pendingForced;
+
     /**
       Checks whether there is any scope accepting audio data, or if all of them are hidden
       or if auto refresh is disabled.
@@ -97,6 +109,15 @@ private:
      */
     template <class T> void createScopeDock(T *scopeWidget, const QString &title, const QString &name);
 
+    /**
+      Passes a frame to the visible color scopes that want it.
+      */
+    void distributeFrame(const ScopeFrame &image);
+    /**
+      Starts the analysis of the pending frame for the requests of its scopes.
+      */
+    void startAnalysis();
+
 public slots:
     void slotCheckActiveScopes();
 
@@ -126,12 +147,17 @@ private slots:
     void checkActiveColourScopes();
 
     void slotDistributeFrame(const QImage &image);
+    void slotDistributeSharedFrame(const SharedFrame &frame);
     void slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
     /**
       Allows a scope to explicitly request a new frame, even if the scope's autoRefresh is disabled.
       */
     void slotRequestFrame(const QString &widgetName);
     void slotScopeReady();
+    /**
+      Passes the finished frame analysis to the scopes that were waiting for it.
+      */
+    void slotAnalysisFinished();
 };
 
 #endif // SCOPEMANAGER_H
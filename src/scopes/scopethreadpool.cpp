@@ -0,0 +1,58 @@
+/*
+ * Kdenlive scopes thread pool
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "scopethreadpool.h"
+
+#include <QThread>
+
+namespace {
+class ScopePool : public QThreadPool
+{
+public:
+    ScopePool()
+    {
+        // Leave the other cores to playback
+        setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+    }
+};
+
+Q_GLOBAL_STATIC(ScopePool, scopePool)
+}
+
+QThreadPool *ScopeThreadPool::pool()
+{
+    return scopePool();
+}
+
+int ScopeThreadPool::maxThreadCount()
+{
+    return pool()->maxThreadCount();
+}
+
+void ScopeThreadPool::lowerPriority()
+{
+    QThread *thread = QThread::currentThread();
+    if (thread->priority() != QThread::IdlePriority) {
+        thread->setPriority(QThread::IdlePriority);
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * Kdenlive scopes thread pool
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SCOPETHREADPOOL_H
+#define SCOPETHREADPOOL_H
+
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+/**
+  \brief Threads shared by all scopes.
+
+  Scopes used to start their rendering on the global thread pool, where it
+  competed with MLT and the thumbnail jobs during playback. All scope work now
+  runs on this pool instead. It has at most half of the cores and its threads
+  run with idle priority, so that scopes only get the CPU time playback does
+  not need: under load they refresh less often rather than slowing playback
+  down.
+  Scopes must not queue more than one task of a kind at a time and should
+  render the latest frame once it finishes, dropping the frames received in
+  between.
+  */
+class ScopeThreadPool
+{
+public:
+    /** @brief The thread pool of the scopes */
+    static QThreadPool *pool();
+    /** @brief Number of threads of the pool */
+    static int maxThreadCount();
+    /** @brief Gives the calling thread the priority of the scope threads */
+    static void lowerPriority();
+
+    /** @brief Runs function in the scope pool, as QtConcurrent::run() */
+    template <typename Function> static auto run(Function function) -> QFuture<decltype(function())>
+    {
+        return QtConcurrent::run(pool(), [function]() {
+            lowerPriority();
+            return function();
+        });
+    }
+};
+
+#endif // SCOPETHREADPOOL_H
@@ -54,6 +54,10 @@ AbstractClipItem::AbstractClipItem(const ItemInfo &info, const QRectF &rect, dou
 
 AbstractClipItem::~AbstractClipItem()
 {
+    // QGraphicsItem does not notify subclasses of scene removal while being destroyed
+    if (projectScene()) {
+        projectScene()->removeItemIndex(this);
+    }
 }
 
 void AbstractClipItem::doUpdate(const QRectF &r)
@@ -168,6 +172,13 @@ GenTime AbstractClipItem::cropDuration() const
     return m_info.cropDuration;
 }
 
+QVector<int> AbstractClipItem::snapPoints() const
+{
+    QVector<int> points;
+    points << (int) startPos().frames(m_fps) << (int) endPos().frames(m_fps);
+    return points;
+}
+
 void AbstractClipItem::setCropStart(const GenTime &pos)
 {
     m_info.cropStart = pos;
@@ -180,11 +191,20 @@ void AbstractClipItem::updateItem(int track)
     if (m_info.cropDuration > GenTime()) {
         m_info.endPos = m_info.startPos + m_info.cropDuration;
     }
+    updateIndex();
 }
 
 void AbstractClipItem::updateRectGeometry()
 {
     setRect(0, 0, cropDuration().frames(m_fps) - 0.02, rect().height());
+    updateIndex();
+}
+
+void AbstractClipItem::updateIndex()
+{
+    if (projectScene()) {
+        projectScene()->updateItemIndex(this);
+    }
 }
 
 void AbstractClipItem::resizeStart(int posx, bool hasSizeLimit, bool /*emitChange*/)
@@ -227,6 +247,7 @@ void AbstractClipItem::resizeStart(int posx, bool hasSizeLimit, bool /*emitChang
     if (negCropStart) {
         m_info.cropStart = GenTime();
     }
+    updateIndex();
 }
 
 void AbstractClipItem::resizeEnd(int posx, bool /*emitChange*/)
@@ -263,6 +284,7 @@ void AbstractClipItem::resizeEnd(int posx, bool /*emitChange*/)
             setRect(0, 0, cropDuration().frames(m_fps) - 0.02, rect().height());
         }
     }
+    updateIndex();
 }
 
 GenTime AbstractClipItem::startPos() const
@@ -345,6 +367,24 @@ void AbstractClipItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
     }
 }
 
+QVariant AbstractClipItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    switch (change) {
+    case ItemSceneChange:
+        if (projectScene()) {
+            projectScene()->removeItemIndex(this);
+        }
+        break;
+    case ItemSceneHasChanged:
+    case ItemPositionHasChanged:
+        updateIndex();
+        break;
+    default:
+        break;
+    }
+    return QGraphicsItem::itemChange(change, value);
+}
+
 void AbstractClipItem::slotSelectItem()
 {
     emit selectItem(this);
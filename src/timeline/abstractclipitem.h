@@ -60,6 +60,8 @@ public:
     virtual int track() const;
     virtual GenTime cropStart() const;
     virtual GenTime cropDuration() const;
+    /** @brief Returns the timeline positions (in frames) other items can snap to */
+    virtual QVector<int> snapPoints() const;
     /** @brief Return the current item's height */
     static int itemHeight();
     /** @brief Return the current item's vertical offset
@@ -117,6 +119,9 @@ protected:
     void mousePressEvent(QGraphicsSceneMouseEvent *event) Q_DECL_OVERRIDE;
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) Q_DECL_OVERRIDE;
     void mouseMoveEvent(QGraphicsSceneMouseEvent *event) Q_DECL_OVERRIDE;
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value) Q_DECL_OVERRIDE;
+    /** @brief Updates this item's entry in the scene's track index after a position or length change. */
+    void updateIndex();
     int trackForPos(int position);
     int posForTrack(int track);
     bool resizeGeometries(QDomElement effect, int width, int height, int previousDuration, int start, int duration, int cropstart);
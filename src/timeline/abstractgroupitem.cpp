@@ -30,6 +30,7 @@
 #include <QDomDocument>
 #include <QGraphicsSceneMouseEvent>
 #include <QMimeData>
+#include <QSet>
 
 AbstractGroupItem::AbstractGroupItem(double /* fps */) :
     QObject(),
@@ -154,6 +155,56 @@ QPainterPath AbstractGroupItem::spacerGroupShape(GraphicsRectItem type, const QP
     return path;
 }
 
+bool AbstractGroupItem::indexedCollision(GraphicsRectItem type, const QPointF &offset, int *overlap)
+{
+    QList<AbstractClipItem *> members;
+    QList<QGraphicsItem *> children = childItems();
+    for (int i = 0; i < children.count(); ++i) {
+        if (children.at(i)->type() == GroupWidget) {
+            QList<QGraphicsItem *> subchildren = children.at(i)->childItems();
+            for (int j = 0; j < subchildren.count(); ++j) {
+                if (subchildren.at(j)->type() == AVWidget || subchildren.at(j)->type() == TransitionWidget) {
+                    members << static_cast <AbstractClipItem *>(subchildren.at(j));
+                }
+            }
+        } else if (children.at(i)->type() == AVWidget || children.at(i)->type() == TransitionWidget) {
+            members << static_cast <AbstractClipItem *>(children.at(i));
+        }
+    }
+    const QSet<AbstractClipItem *> memberSet = members.toSet();
+    CustomTrackScene *scene = projectScene();
+    bool collision = false;
+    if (overlap) {
+        *overlap = 0;
+    }
+    for (int i = 0; i < members.count(); ++i) {
+        AbstractClipItem *member = members.at(i);
+        if (member->type() != (int) type) {
+            continue;
+        }
+        // Children positions are only written back to their info when the move ends
+        const QRectF rect = member->sceneBoundingRect().translated(offset);
+        int start = (int)(rect.left() + 0.5);
+        int end = start + (int) member->cropDuration().frames(member->fps());
+        int track = trackForPos((int) rect.center().y());
+        QList<AbstractClipItem *> colliding = scene->indexedItems(type, track, start, end);
+        for (int j = 0; j < colliding.count(); ++j) {
+            AbstractClipItem *item = colliding.at(j);
+            if (!item->isEnabled() || memberSet.contains(item)) {
+                continue;
+            }
+            collision = true;
+            if (!overlap) {
+                return true;
+            }
+            int itemStart = (int) item->startPos().frames(item->fps());
+            int itemEnd = (int) item->endPos().frames(item->fps());
+            *overlap = qMax(*overlap, qMin(itemEnd, end) - qMax(itemStart, start));
+        }
+    }
+    return collision;
+}
+
 void AbstractGroupItem::addItem(QGraphicsItem *item)
 {
     addToGroup(item);
@@ -321,116 +372,43 @@ QVariant AbstractGroupItem::itemChange(GraphicsItemChange change, const QVariant
             return QPointF(pos().x() - start.x(), pos().y());
         }*/
 
-        QList<QGraphicsItem *> collidingItems;
-        QPainterPath shape;
-        if (projectScene()->editMode() == TimelineMode::NormalEdit) {
-            shape = clipGroupShape(newPos - pos());
-            collidingItems = scene->items(shape, Qt::IntersectsItemShape);
-            collidingItems.removeAll(this);
-            for (int i = 0; i < children.count(); ++i) {
-                if (children.at(i)->type() == GroupWidget) {
-                    QList<QGraphicsItem *> subchildren = children.at(i)->childItems();
-                    for (int j = 0; j < subchildren.count(); ++j) {
-                        collidingItems.removeAll(subchildren.at(j));
-                    }
-                }
-                collidingItems.removeAll(children.at(i));
-            }
+        if (projectScene()->editMode() != TimelineMode::NormalEdit) {
+            return newPos;
         }
-        if (!collidingItems.isEmpty()) {
-            bool forwardMove = xpos > start.x();
-            int cur_offset = 0;
-            for (int i = 0; i < collidingItems.count(); ++i) {
-                QGraphicsItem *collision = collidingItems.at(i);
-                if (collision->type() == AVWidget) {
-                    // Collision
-                    if (newPos.y() != pos().y()) {
-                        // Track change results in collision, restore original position
-                        newPos.setY(pos().y());
-                    } else {
-                        AbstractClipItem *item = static_cast <AbstractClipItem *>(collision);
-                        // Determine best pos
-                        QPainterPath clipPath;
-                        clipPath.addRect(item->sceneBoundingRect());
-                        QPainterPath res = shape.intersected(clipPath);
-                        cur_offset = qMax(cur_offset, (int)(res.boundingRect().width() + 0.5));
-                    }
-                    break;
-                }
+        const bool forwardMove = xpos > start.x();
+        int overlap = 0;
+        if (indexedCollision(AVWidget, newPos - pos(), &overlap)) {
+            if (newPos.y() != pos().y()) {
+                // Track change results in collision, restore original position
+                newPos.setY(pos().y());
+                overlap = 0;
             }
             if (forwardMove) {
-                newPos.setX(newPos.x() - cur_offset);
+                newPos.setX(newPos.x() - overlap);
             } else {
-                newPos.setX(newPos.x() + cur_offset);
+                newPos.setX(newPos.x() + overlap);
             }
             // If there is still a collision after our position adjust, restore original pos
-            collidingItems = scene->items(clipGroupShape(newPos - pos()), Qt::IntersectsItemShape);
-            collidingItems.removeAll(this);
-            for (int i = 0; i < children.count(); ++i) {
-                if (children.at(i)->type() == GroupWidget) {
-                    QList<QGraphicsItem *> subchildren = children.at(i)->childItems();
-                    for (int j = 0; j < subchildren.count(); ++j) {
-                        collidingItems.removeAll(subchildren.at(j));
-                    }
-                }
-                collidingItems.removeAll(children.at(i));
+            if (indexedCollision(AVWidget, newPos - pos())) {
+                return pos();
             }
-            for (int i = 0; i < collidingItems.count(); ++i)
-                if (collidingItems.at(i)->type() == AVWidget) {
-                    return pos();
-                }
         }
 
-        if (projectScene()->editMode() == TimelineMode::NormalEdit) {
-            shape = transitionGroupShape(newPos - pos());
-            collidingItems = scene->items(shape, Qt::IntersectsItemShape);
-            collidingItems.removeAll(this);
-            for (int i = 0; i < children.count(); ++i) {
-                if (children.at(i)->type() == GroupWidget) {
-                    QList<QGraphicsItem *> subchildren = children.at(i)->childItems();
-                    for (int j = 0; j < subchildren.count(); ++j) {
-                        collidingItems.removeAll(subchildren.at(j));
-                    }
-                }
-                collidingItems.removeAll(children.at(i));
-            }
-        }
-        if (collidingItems.isEmpty()) {
-            return newPos;
-        } else {
-            bool forwardMove = xpos > start.x();
-            int cur_offset = 0;
-            for (int i = 0; i < collidingItems.count(); ++i) {
-                QGraphicsItem *collision = collidingItems.at(i);
-                if (collision->type() == TransitionWidget) {
-                    // Collision
-                    if (newPos.y() != pos().y()) {
-                        // Track change results in collision, restore original position
-                        return pos();
-                    }
-                    AbstractClipItem *item = static_cast <AbstractClipItem *>(collision);
-                    // Determine best pos
-                    QPainterPath clipPath;
-                    clipPath.addRect(item->sceneBoundingRect());
-                    QPainterPath res = shape.intersected(clipPath);
-                    cur_offset = qMax(cur_offset, (int)(res.boundingRect().width() + 0.5));
-                }
+        if (indexedCollision(TransitionWidget, newPos - pos(), &overlap)) {
+            if (newPos.y() != pos().y()) {
+                // Track change results in collision, restore original position
+                return pos();
             }
-            if (cur_offset > 0) {
+            if (overlap > 0) {
                 if (forwardMove) {
-                    newPos.setX(newPos.x() - cur_offset);
+                    newPos.setX(newPos.x() - overlap);
                 } else {
-                    newPos.setX(newPos.x() + cur_offset);
+                    newPos.setX(newPos.x() + overlap);
                 }
                 // If there is still a collision after our position adjust, restore original pos
-                collidingItems = scene->items(transitionGroupShape(newPos - pos()), Qt::IntersectsItemShape);
-                for (int i = 0; i < children.count(); ++i) {
-                    collidingItems.removeAll(children.at(i));
+                if (indexedCollision(TransitionWidget, newPos - pos())) {
+                    return pos();
                 }
-                for (int i = 0; i < collidingItems.count(); ++i)
-                    if (collidingItems.at(i)->type() == TransitionWidget) {
-                        return pos();
-                    }
             }
         }
         return newPos;
@@ -76,6 +76,10 @@ protected:
 private:
     QPainterPath groupShape(GraphicsRectItem type, const QPointF &offset) const;
     QPainterPath spacerGroupShape(GraphicsRectItem type, const QPointF &offset) const;
+    /** @brief Checks the track index for items of type colliding with the group children moved by offset.
+     *  @param overlap if not null, is set to the largest overlap (in frames) with a colliding item
+     *  @return true if an item collides */
+    bool indexedCollision(GraphicsRectItem type, const QPointF &offset, int *overlap = nullptr);
 };
 
 #endif
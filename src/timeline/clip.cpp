@@ -25,6 +25,9 @@
 #include <mlt++/Mlt.h>
 #include <QDomDocument>
 #include <QDebug>
+#include <QScopedPointer>
+
+#include <cstring>
 
 Clip::Clip(Mlt::Producer &producer) : QObject(),
     m_producer(producer)
@@ -184,6 +187,81 @@ const QByteArray Clip::xml()
 }
 
 Mlt::Producer *Clip::clone()
+{
+    Mlt::Producer *clone = nativeClone();
+    if (clone == nullptr) {
+        clone = xmlClone();
+    }
+    return clone;
+}
+
+bool Clip::hasNativeClone(const QString &service)
+{
+    // Services that are fully described by their resource and properties
+    return service == QLatin1String("avformat") || service == QLatin1String("avformat-novalidate")
+           || service == QLatin1String("color") || service == QLatin1String("colour")
+           || service == QLatin1String("qimage") || service == QLatin1String("pixbuf")
+           || service == QLatin1String("kdenlivetitle") || service == QLatin1String("qtext")
+           || service == QLatin1String("timewarp") || service == QLatin1String("framebuffer");
+}
+
+bool Clip::isClonedProperty(const char *name)
+{
+    // Same filtering as the xml consumer used by xmlClone: no private, meta or factory properties
+    return name != nullptr && name[0] != '_' && strncmp(name, "meta.", 5) != 0
+           && strcmp(name, "mlt_type") != 0 && strcmp(name, "mlt_service") != 0 && strcmp(name, "resource") != 0;
+}
+
+Mlt::Producer *Clip::nativeClone()
+{
+    const char *service = m_producer.get("mlt_service");
+    if (service == nullptr || !hasNativeClone(QString::fromLatin1(service))) {
+        return nullptr;
+    }
+    Mlt::Producer *clone = new Mlt::Producer(*m_producer.profile(), service, m_producer.get("resource"));
+    if (!clone->is_valid()) {
+        delete clone;
+        return nullptr;
+    }
+    // Length must be known before in and out are applied
+    if (m_producer.get("length")) {
+        clone->set("length", m_producer.get("length"));
+    }
+    for (int i = 0; i < m_producer.count(); ++i) {
+        const char *name = m_producer.get_name(i);
+        const char *value = m_producer.get(i);
+        if (value != nullptr && isClonedProperty(name)) {
+            clone->set(name, value);
+        }
+    }
+    clone->set_in_and_out(m_producer.get_in(), m_producer.get_out());
+    Mlt::Service source(m_producer.get_service());
+    for (int ix = 0; ix < source.filter_count(); ++ix) {
+        QScopedPointer<Mlt::Filter> filter(source.filter(ix));
+        // Normalizers attached by the loader are not part of the clip
+        if (!filter->is_valid() || filter->get_int("_loader") == 1) {
+            continue;
+        }
+        Mlt::Filter copy(*m_producer.profile(), filter->get("mlt_service"));
+        if (!copy.is_valid()) {
+            // Unknown filter, let the xml producer deal with it
+            delete clone;
+            return nullptr;
+        }
+        for (int i = 0; i < filter->count(); ++i) {
+            const char *name = filter->get_name(i);
+            const char *value = filter->get(i);
+            if (value != nullptr && isClonedProperty(name)) {
+                copy.set(name, value);
+            }
+        }
+        copy.set_in_and_out(filter->get_in(), filter->get_out());
+        clone->attach(copy);
+    }
+    return clone;
+}
+
+Mlt::Producer *Clip::xmlClone()
 {
     QByteArray prodXml = xml();
     //HACK: currently the MLT xml producer, when parsing a <profile>, does change the global profile accordingly.
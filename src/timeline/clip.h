@@ -39,7 +39,10 @@ public:
     ~Clip();
     Clip &operator=(Clip &other);
     const QByteArray xml();
-    /** @brief: Clone a producer (creates a completely independent copy). */
+    /** @brief: Clone a producer (creates a completely independent copy).
+     *          Common services are instantiated directly and get a copy of the producer properties and filters,
+     *          other services go through an xml round trip.
+     */
     Mlt::Producer *clone();
     /** @brief: Clone a producer without using xml-string producer.
      *          When Movit is used, we must use this because xml-string crashes (probably attaches some normalizers)
@@ -59,6 +62,12 @@ public Q_SLOTS:
 
 private:
     Mlt::Producer m_producer;
+    /** @brief: Clone through the MLT API, returns nullptr if the producer or one of its filters cannot be copied this way. */
+    Mlt::Producer *nativeClone();
+    /** @brief: Clone by serializing the producer to xml and loading it with the xml-string producer. */
+    Mlt::Producer *xmlClone();
+    static bool hasNativeClone(const QString &service);
+    static bool isClonedProperty(const char *name);
 };
 
 #endif // CLIP_H
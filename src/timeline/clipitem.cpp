@@ -51,6 +51,8 @@ ClipItem::ClipItem(ProjectClip *clip, const ItemInfo &info, double fps, double s
     m_startPix(QPixmap()),
     m_endPix(QPixmap()),
     m_hasThumbs(false),
+    m_thumbnailsLoaded(false),
+    m_thumbnailsQueued(false),
     m_timeLine(nullptr),
     m_startThumbRequested(false),
     m_endThumbRequested(false),
@@ -93,7 +95,8 @@ ClipItem::ClipItem(ProjectClip *clip, const ItemInfo &info, double fps, double s
             connect(&m_endThumbTimer, &QTimer::timeout, this, &ClipItem::slotGetEndThumb);
             connect(m_binClip, SIGNAL(thumbReady(int, QImage)), this, SLOT(slotThumbReady(int, QImage)));
             if (generateThumbs && KdenliveSettings::videothumbnails()) {
-                QTimer::singleShot(0, this, &ClipItem::slotFetchThumbs);
+                m_thumbnailsQueued = true;
+                QTimer::singleShot(0, this, &ClipItem::loadThumbnails);
             }
         }
     } else if (m_clipType == Color) {
@@ -351,7 +354,48 @@ void ClipItem::resetThumbs(bool clearExistingThumbs)
         m_endPix = QPixmap();
         m_audioThumbCachePic.clear();
     }
-    slotFetchThumbs();
+    if (m_thumbnailsLoaded) {
+        slotFetchThumbs();
+    }
+}
+
+bool ClipItem::hasLoadedThumbnails() const
+{
+    return m_thumbnailsLoaded;
+}
+
+void ClipItem::loadThumbnails()
+{
+    m_thumbnailsQueued = false;
+    if (m_thumbnailsLoaded || scene() == nullptr) {
+        return;
+    }
+    m_thumbnailsLoaded = true;
+    projectScene()->setItemHoldsThumbnails(this, true);
+    if (m_hasThumbs && KdenliveSettings::videothumbnails()) {
+        slotFetchThumbs();
+    }
+}
+
+void ClipItem::releaseThumbnails()
+{
+    if (!m_thumbnailsLoaded) {
+        return;
+    }
+    m_thumbnailsLoaded = false;
+    if (scene()) {
+        projectScene()->setItemHoldsThumbnails(this, false);
+    }
+    if (m_hasThumbs) {
+        // Image and title thumbnails come from the bin clip and are cheap, only drop video frames
+        m_startThumbTimer.stop();
+        m_endThumbTimer.stop();
+        m_startPix = QPixmap();
+        m_endPix = QPixmap();
+        m_startThumbRequested = false;
+        m_endThumbRequested = false;
+    }
+    m_audioThumbCachePic.clear();
 }
 
 void ClipItem::refreshClip(bool checkDuration, bool forceResetThumbs)
@@ -577,6 +621,11 @@ void ClipItem::paint(QPainter *painter,
                      const QStyleOptionGraphicsItem *option,
                      QWidget *)
 {
+    if (!m_thumbnailsLoaded && !m_thumbnailsQueued) {
+        // First time this clip is visible, fetch its thumbnails
+        m_thumbnailsQueued = true;
+        QTimer::singleShot(0, this, &ClipItem::loadThumbnails);
+    }
     QPalette palette = scene()->palette();
     QColor paintColor = m_paintColor;
     QColor textColor;
@@ -1095,6 +1144,16 @@ QList<CommentedTime> ClipItem::commentedSnapMarkers() const
     return snaps;
 }
 
+QVector<int> ClipItem::snapPoints() const
+{
+    QVector<int> points = AbstractClipItem::snapPoints();
+    const QList<CommentedTime> markers = commentedSnapMarkers();
+    for (int i = 0; i < markers.size(); ++i) {
+        points << (int) markers.at(i).time().frames(m_fps);
+    }
+    return points;
+}
+
 int ClipItem::fadeIn() const
 {
     return m_startFade;
@@ -1270,11 +1329,10 @@ QVariant ClipItem::itemChange(GraphicsItemChange change, const QVariant &value)
         newTrack = qMax(newTrack, 1);
         newPos.setY(posForTrack(newTrack));
         // Only one clip is moving
-        QRectF sceneShape = rect();
-        sceneShape.translate(newPos);
-        QList<QGraphicsItem *> items;
+        const int length = (int) cropDuration().frames(m_fps);
+        QList<AbstractClipItem *> items;
         if (scene->editMode() == TimelineMode::NormalEdit) {
-            items = scene->items(sceneShape, Qt::IntersectsItemShape);
+            items = scene->indexedItems(type(), newTrack, (int) newPos.x(), (int) newPos.x() + length);
         }
         items.removeAll(this);
         bool forwardMove = newPos.x() > pos().x();
@@ -1283,45 +1341,37 @@ QVariant ClipItem::itemChange(GraphicsItemChange change, const QVariant &value)
                 if (!items.at(i)->isEnabled()) {
                     continue;
                 }
-                if (items.at(i)->type() == type()) {
-                    int offset = 0;
-                    // Collision!
-                    QPointF otherPos = items.at(i)->pos();
-                    if ((int) otherPos.y() != (int) pos().y()) {
-                        return pos();
-                    }
+                int offset = 0;
+                // Collision!
+                if (newTrack != track()) {
+                    return pos();
+                }
+                if (forwardMove) {
+                    offset = qMax(offset, (int)(newPos.x() - (items.at(i)->startPos() - cropDuration()).frames(m_fps)));
+                } else {
+                    offset = qMax(offset, (int)(items.at(i)->endPos().frames(m_fps) - newPos.x()));
+                }
+                if (offset > 0) {
                     if (forwardMove) {
-                        offset = qMax(offset, (int)(newPos.x() - (static_cast < AbstractClipItem * >(items.at(i))->startPos() - cropDuration()).frames(m_fps)));
+                        newPos.setX(newPos.x() - offset);
                     } else {
-                        offset = qMax(offset, (int)((static_cast < AbstractClipItem * >(items.at(i))->endPos().frames(m_fps)) - newPos.x()));
+                        newPos.setX(newPos.x() + offset);
                     }
-                    if (offset > 0) {
-                        if (forwardMove) {
-                            sceneShape.translate(QPointF(-offset, 0));
-                            newPos.setX(newPos.x() - offset);
-                        } else {
-                            sceneShape.translate(QPointF(offset, 0));
-                            newPos.setX(newPos.x() + offset);
-                        }
-                        QList<QGraphicsItem *> subitems = scene->items(sceneShape, Qt::IntersectsItemShape);
-                        subitems.removeAll(this);
-                        for (int j = 0; j < subitems.count(); ++j) {
-                            if (!subitems.at(j)->isEnabled()) {
-                                continue;
-                            }
-                            if (subitems.at(j)->type() == type()) {
-                                // move was not successful, revert to previous pos
-                                m_info.startPos = GenTime((int) pos().x(), m_fps);
-                                return pos();
-                            }
+                    QList<AbstractClipItem *> subitems = scene->indexedItems(type(), newTrack, (int) newPos.x(), (int) newPos.x() + length);
+                    subitems.removeAll(this);
+                    for (int j = 0; j < subitems.count(); ++j) {
+                        if (subitems.at(j)->isEnabled()) {
+                            // move was not successful, revert to previous pos
+                            m_info.startPos = GenTime((int) pos().x(), m_fps);
+                            return pos();
                         }
                     }
+                }
 
-                    m_info.track = newTrack;
-                    m_info.startPos = GenTime((int) newPos.x(), m_fps);
+                m_info.track = newTrack;
+                m_info.startPos = GenTime((int) newPos.x(), m_fps);
 
-                    return newPos;
-                }
+                return newPos;
             }
         }
         m_info.track = newTrack;
@@ -1336,7 +1386,7 @@ QVariant ClipItem::itemChange(GraphicsItemChange change, const QVariant &value)
             m_paintColor = m_baseColor;
         }
     }
-    return QGraphicsItem::itemChange(change, value);
+    return AbstractClipItem::itemChange(change, value);
 }
 
 int ClipItem::effectsCounter()
@@ -1674,6 +1724,7 @@ void ClipItem::setSpeed(const double speed, const int strobe)
     m_strobe = strobe;
     m_info.cropStart = GenTime((int)(m_speedIndependantInfo.cropStart.frames(m_fps) / qAbs(m_speed) + 0.5), m_fps);
     m_info.cropDuration = GenTime((int)(m_speedIndependantInfo.cropDuration.frames(m_fps) / qAbs(m_speed) + 0.5), m_fps);
+    updateIndex();
     //update();
 }
 
@@ -2038,6 +2089,8 @@ bool ClipItem::updateNormalKeyframes(QDomElement parameter, const ItemInfo &oldI
 
 void ClipItem::slotRefreshClip()
 {
+    // Markers may have changed
+    updateIndex();
     update();
 }
 
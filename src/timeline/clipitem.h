@@ -118,6 +118,12 @@ public:
     * @param clearExistingThumbs true = regenerate all thumbs, false = only create missing thumbs. */
     void resetThumbs(bool clearExistingThumbs);
 
+    /** @brief Returns true if the clip currently holds its thumbnails. */
+    bool hasLoadedThumbnails() const;
+    /** @brief Drops the thumbnail pixmaps of this clip to save memory while it is far from the visible area.
+     * They are fetched again when the clip is painted or comes close to the viewport. */
+    void releaseThumbnails();
+
     /** @brief Updates clip properties from base clip.
     * @param checkDuration whether or not to check for a valid duration.
     * @param resetThumbs whether or not to recreate the image thumbnails. */
@@ -127,6 +133,7 @@ public:
     * @return A list of the times. */
     QList<GenTime> snapMarkers(const QList<GenTime> &markers) const;
     QList<CommentedTime> commentedSnapMarkers() const;
+    QVector<int> snapPoints() const Q_DECL_OVERRIDE;
 
     /** @brief Gets the position of the fade in effect. */
     int fadeIn() const;
@@ -221,6 +228,10 @@ private:
     QPixmap m_endPix;
 
     bool m_hasThumbs;
+    /** True when the thumbnails of the clip were requested (clip visible or close to the viewport) */
+    bool m_thumbnailsLoaded;
+    /** True while a call to loadThumbnails() is queued, so that repaints do not queue more */
+    bool m_thumbnailsQueued;
     QTimer m_startThumbTimer;
     QTimer m_endThumbTimer;
 
@@ -252,6 +263,8 @@ private slots:
 
 public slots:
     void slotFetchThumbs();
+    /** @brief Requests the clip thumbnails if they are not held yet. */
+    void loadThumbnails();
     void slotSetStartThumb(const QPixmap &pix);
     void slotSetEndThumb(const QPixmap &pix);
     void slotUpdateRange();
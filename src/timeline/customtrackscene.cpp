@@ -19,6 +19,7 @@
 
 #include "customtrackscene.h"
 #include "timeline.h"
+#include "abstractclipitem.h"
 
 CustomTrackScene::CustomTrackScene(Timeline *timeline, QObject *parent) :
     QGraphicsScene(parent),
@@ -31,6 +32,8 @@ CustomTrackScene::CustomTrackScene(Timeline *timeline, QObject *parent) :
 
 CustomTrackScene::~CustomTrackScene()
 {
+    // Delete items while our indexes are still alive, since items unregister on deletion
+    clear();
 }
 
 double CustomTrackScene::getSnapPointForPos(double pos, bool doSnap)
@@ -42,44 +45,41 @@ double CustomTrackScene::getSnapPointForPos(double pos, bool doSnap)
         } else {
             maximumOffset = 6 / m_scale.x();
         }
-        for (int i = 0; i < m_snapPoints.size(); ++i) {
-            if (qAbs((int)(pos - m_snapPoints.at(i).frames(m_timeline->fps()))) < maximumOffset) {
-                return m_snapPoints.at(i).frames(m_timeline->fps());
-            }
-            if (m_snapPoints.at(i).frames(m_timeline->fps()) > pos) {
-                break;
-            }
+        int snapped = m_snapIndex.snap(qRound(pos), maximumOffset);
+        if (snapped >= 0) {
+            return snapped;
         }
     }
     return GenTime(pos, m_timeline->fps()).frames(m_timeline->fps());
 }
 
-void CustomTrackScene::setSnapList(const QList<GenTime> &snaps)
+void CustomTrackScene::setSnapPoints(const void *source, const QVector<int> &points)
 {
-    m_snapPoints = snaps;
+    m_snapIndex.setPoints(source, points);
+}
+
+void CustomTrackScene::setSnapContext(const QVector<int> &offsets, const QList<const void *> &excludedSources)
+{
+    m_snapIndex.setOffsets(offsets);
+    m_snapIndex.setExcludedSources(excludedSources);
 }
 
 GenTime CustomTrackScene::previousSnapPoint(const GenTime &pos) const
 {
-    for (int i = 0; i < m_snapPoints.size(); ++i) {
-        if (m_snapPoints.at(i) >= pos) {
-            if (i == 0) {
-                return GenTime();
-            }
-            return m_snapPoints.at(i - 1);
-        }
+    int previous = m_snapIndex.previous(pos.frame(m_timeline->fps()));
+    if (previous < 0) {
+        return GenTime();
     }
-    return GenTime();
+    return GenTime(previous, m_timeline->fps());
 }
 
 GenTime CustomTrackScene::nextSnapPoint(const GenTime &pos) const
 {
-    foreach (const GenTime &seekPoint, m_snapPoints) {
-        if (seekPoint > pos) {
-            return seekPoint;
-        }
+    int next = m_snapIndex.next(pos.frame(m_timeline->fps()));
+    if (next < 0) {
+        return pos;
     }
-    return pos;
+    return GenTime(next, m_timeline->fps());
 }
 
 void CustomTrackScene::setScale(double scale, double vscale)
@@ -114,3 +114,100 @@ TimelineMode::EditMode CustomTrackScene::editMode() const
     return m_editMode;
 }
 
+
+QHash<int, TrackItemIndex> &CustomTrackScene::indexForType(int type)
+{
+    return type == TransitionWidget ? m_transitionIndex : m_clipIndex;
+}
+
+const QHash<int, TrackItemIndex> &CustomTrackScene::indexForType(int type) const
+{
+    return type == TransitionWidget ? m_transitionIndex : m_clipIndex;
+}
+
+void CustomTrackScene::updateItemIndex(AbstractClipItem *item)
+{
+    int type = item->type();
+    if (type != AVWidget && type != TransitionWidget) {
+        return;
+    }
+    m_snapIndex.setPoints(item, item->snapPoints());
+    int track = item->track();
+    int start = item->startPos().frame(item->fps());
+    int end = item->endPos().frame(item->fps());
+    if (m_indexedItems.contains(item)) {
+        const IndexKey key = m_indexedItems.value(item);
+        if (key.track == track && key.start == start) {
+            // Only the length may have changed
+            TrackItemIndex &index = indexForType(type)[track];
+            index.remove(item, start);
+            index.insert(item, start, end);
+            return;
+        }
+        indexForType(key.type)[key.track].remove(item, key.start);
+    }
+    indexForType(type)[track].insert(item, start, end);
+    IndexKey key;
+    key.type = type;
+    key.track = track;
+    key.start = start;
+    m_indexedItems.insert(item, key);
+}
+
+void CustomTrackScene::removeItemIndex(AbstractClipItem *item)
+{
+    m_snapIndex.removeSource(item);
+    m_thumbnailItems.remove(item);
+    if (!m_indexedItems.contains(item)) {
+        return;
+    }
+    const IndexKey key = m_indexedItems.take(item);
+    indexForType(key.type)[key.track].remove(item, key.start);
+}
+
+QList<AbstractClipItem *> CustomTrackScene::indexedItems(int type, int track, int start, int end) const
+{
+    const QHash<int, TrackItemIndex> &index = indexForType(type);
+    QHash<int, TrackItemIndex>::const_iterator it = index.constFind(track);
+    if (it == index.constEnd()) {
+        return QList<AbstractClipItem *>();
+    }
+    return it.value().items(start, end);
+}
+
+AbstractClipItem *CustomTrackScene::indexedItemAt(int type, int track, int frame) const
+{
+    const QHash<int, TrackItemIndex> &index = indexForType(type);
+    QHash<int, TrackItemIndex>::const_iterator it = index.constFind(track);
+    if (it == index.constEnd()) {
+        return nullptr;
+    }
+    return it.value().itemAt(frame);
+}
+
+void CustomTrackScene::indexedFreeSpace(int type, int track, int frame, const AbstractClipItem *item, int &minimum, int &maximum) const
+{
+    const QHash<int, TrackItemIndex> &index = indexForType(type);
+    QHash<int, TrackItemIndex>::const_iterator it = index.constFind(track);
+    if (it == index.constEnd()) {
+        minimum = 0;
+        maximum = -1;
+        return;
+    }
+    minimum = it.value().previousEnd(frame, item);
+    maximum = it.value().nextStart(frame, item);
+}
+
+void CustomTrackScene::setItemHoldsThumbnails(AbstractClipItem *item, bool holdsThumbnails)
+{
+    if (holdsThumbnails) {
+        m_thumbnailItems.insert(item);
+    } else {
+        m_thumbnailItems.remove(item);
+    }
+}
+
+QList<AbstractClipItem *> CustomTrackScene::thumbnailItems() const
+{
+    return m_thumbnailItems.toList();
+}
@@ -27,13 +27,18 @@
 #define CUSTOMTRACKSCENE_H
 
 #include <QList>
+#include <QHash>
+#include <QSet>
 #include <QGraphicsScene>
 
 #include "gentime.h"
 #include "definitions.h"
+#include "trackitemindex.h"
+#include "snapindex.h"
 
 class Timeline;
 class MltVideoProfile;
+class AbstractClipItem;
 
 class CustomTrackScene : public QGraphicsScene
 {
@@ -42,7 +47,10 @@ class CustomTrackScene : public QGraphicsScene
 public:
     explicit CustomTrackScene(Timeline *timeline, QObject *parent = nullptr);
     ~CustomTrackScene();
-    void setSnapList(const QList<GenTime> &snaps);
+    /** @brief Replaces the snap points (in frames) registered by source. Clips and transitions register themselves. */
+    void setSnapPoints(const void *source, const QVector<int> &points);
+    /** @brief Sets the offsets tried when snapping and the sources whose points are ignored, for the next drag operation. */
+    void setSnapContext(const QVector<int> &offsets, const QList<const void *> &excludedSources);
     GenTime previousSnapPoint(const GenTime &pos) const;
     GenTime nextSnapPoint(const GenTime &pos) const;
     double getSnapPointForPos(double pos, bool doSnap = true);
@@ -52,13 +60,44 @@ public:
     MltVideoProfile profile() const;
     void setEditMode(TimelineMode::EditMode mode);
     TimelineMode::EditMode editMode() const;
+    /** @brief Registers an item in its track index, or updates its position if already indexed. */
+    void updateItemIndex(AbstractClipItem *item);
+    /** @brief Removes an item from the track indexes. */
+    void removeItemIndex(AbstractClipItem *item);
+    /** @brief Returns the clips or transitions (depending on type) of a track intersecting frames [start, end[. */
+    QList<AbstractClipItem *> indexedItems(int type, int track, int start, int end) const;
+    /** @brief Returns the clip or transition (depending on type) covering frame on a track. */
+    AbstractClipItem *indexedItemAt(int type, int track, int frame) const;
+    /** @brief Returns the free space around frame on a track, ignoring item.
+     *  @param minimum is set to the end of the previous item
+     *  @param maximum is set to the start of the next item, or -1 if there is none */
+    void indexedFreeSpace(int type, int track, int frame, const AbstractClipItem *item, int &minimum, int &maximum) const;
+    /** @brief Records whether an item currently holds its thumbnails, so that they can be released once it is scrolled far away. */
+    void setItemHoldsThumbnails(AbstractClipItem *item, bool holdsThumbnails);
+    /** @brief Returns the items currently holding thumbnails. */
+    QList<AbstractClipItem *> thumbnailItems() const;
     bool isZooming;
 
 private:
     Timeline *m_timeline;
     QPointF m_scale;
     TimelineMode::EditMode m_editMode;
-    QList<GenTime> m_snapPoints;
+    SnapIndex m_snapIndex;
+    struct IndexKey {
+        int type;
+        int track;
+        int start;
+    };
+    /** Per track index of clip items */
+    QHash<int, TrackItemIndex> m_clipIndex;
+    /** Per track index of transition items */
+    QHash<int, TrackItemIndex> m_transitionIndex;
+    /** Position under which each item is currently indexed */
+    QHash<AbstractClipItem *, IndexKey> m_indexedItems;
+    /** Items holding thumbnails */
+    QSet<AbstractClipItem *> m_thumbnailItems;
+    QHash<int, TrackItemIndex> &indexForType(int type);
+    const QHash<int, TrackItemIndex> &indexForType(int type) const;
 };
 
 #endif
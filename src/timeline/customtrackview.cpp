@@ -66,6 +66,7 @@
 #include <QScrollBar>
 #include <QApplication>
 #include <QMimeData>
+#include <QSet>
 
 #include <QGraphicsDropShadowEffect>
 
@@ -152,6 +153,10 @@ CustomTrackView::CustomTrackView(KdenliveDoc *doc, Timeline *timeline, CustomTra
     verticalScrollBar()->setTracking(true);
     // repaint guides when using vertical scroll
     connect(verticalScrollBar(), &QAbstractSlider::valueChanged, this, &CustomTrackView::slotRefreshGuides);
+    m_thumbnailTimer.setSingleShot(true);
+    m_thumbnailTimer.setInterval(200);
+    connect(&m_thumbnailTimer, &QTimer::timeout, this, &CustomTrackView::slotUpdateVisibleThumbnails);
+    connect(horizontalScrollBar(), &QAbstractSlider::valueChanged, &m_thumbnailTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
 
     m_cursorLine = projectscene->addLine(0, 0, 0, m_tracksHeight);
     m_cursorLine->setZValue(1000);
@@ -508,109 +513,72 @@ int CustomTrackView::getMousePos() const
     return qMax((int)(mapToScene(mapFromGlobal(QCursor::pos())).x() + 0.5), 0);
 }
 
-void CustomTrackView::spaceToolMoveToSnapPos(double snappedPos)
+bool CustomTrackView::selectionGroupCollides(int type, int offset, bool untilEnd, int *overlap) const
 {
-    // Make sure there is no collision
+    QList<AbstractClipItem *> members;
     QList<QGraphicsItem *> children = m_selectionGroup->childItems();
-    QPainterPath shape = m_selectionGroup->clipGroupSpacerShape(QPointF(snappedPos - m_selectionGroup->sceneBoundingRect().left(), 0));
-    QList<QGraphicsItem *> collidingItems = scene()->items(shape, Qt::IntersectsItemShape);
-    collidingItems.removeAll(m_selectionGroup);
     for (int i = 0; i < children.count(); ++i) {
         if (children.at(i)->type() == GroupWidget) {
             QList<QGraphicsItem *> subchildren = children.at(i)->childItems();
             for (int j = 0; j < subchildren.count(); ++j) {
-                collidingItems.removeAll(subchildren.at(j));
+                if (subchildren.at(j)->type() == AVWidget || subchildren.at(j)->type() == TransitionWidget) {
+                    members << static_cast <AbstractClipItem *>(subchildren.at(j));
+                }
             }
+        } else if (children.at(i)->type() == AVWidget || children.at(i)->type() == TransitionWidget) {
+            members << static_cast <AbstractClipItem *>(children.at(i));
         }
-        collidingItems.removeAll(children.at(i));
     }
+    const QSet<AbstractClipItem *> memberSet = members.toSet();
     bool collision = false;
-    int offset = 0;
-    for (int i = 0; i < collidingItems.count(); ++i) {
-        if (!collidingItems.at(i)->isEnabled()) {
+    if (overlap) {
+        *overlap = 0;
+    }
+    for (int i = 0; i < members.count(); ++i) {
+        AbstractClipItem *member = members.at(i);
+        if (member->type() != type) {
             continue;
         }
-        if (collidingItems.at(i)->type() == AVWidget && snappedPos < m_selectionGroup->sceneBoundingRect().left()) {
-            AbstractClipItem *item = static_cast <AbstractClipItem *>(collidingItems.at(i));
-            // Moving backward, determine best pos
-            QPainterPath clipPath;
-            clipPath.addRect(item->sceneBoundingRect());
-            QPainterPath res = shape.intersected(clipPath);
-            offset = qMax(offset, (int)(res.boundingRect().width() + 0.5));
-        }
-    }
-    snappedPos += offset;
-    // make sure we have no collision
-    shape = m_selectionGroup->clipGroupSpacerShape(QPointF(snappedPos - m_selectionGroup->sceneBoundingRect().left(), 0));
-    collidingItems = scene()->items(shape, Qt::IntersectsItemShape);
-    collidingItems.removeAll(m_selectionGroup);
-    for (int i = 0; i < children.count(); ++i) {
-        if (children.at(i)->type() == GroupWidget) {
-            QList<QGraphicsItem *> subchildren = children.at(i)->childItems();
-            for (int j = 0; j < subchildren.count(); ++j) {
-                collidingItems.removeAll(subchildren.at(j));
+        int start = (int)(member->sceneBoundingRect().left() + 0.5) + offset;
+        int end = untilEnd ? (int) sceneRect().width() : start + member->cropDuration().frame(m_document->fps());
+        QList<AbstractClipItem *> colliding = m_scene->indexedItems(type, member->track(), start, end);
+        for (int j = 0; j < colliding.count(); ++j) {
+            AbstractClipItem *item = colliding.at(j);
+            if (!item->isEnabled() || memberSet.contains(item)) {
+                continue;
             }
+            collision = true;
+            if (!overlap) {
+                return true;
+            }
+            int itemEnd = item->endPos().frame(m_document->fps());
+            int itemStart = item->startPos().frame(m_document->fps());
+            *overlap = qMax(*overlap, qMin(itemEnd, end) - qMax(itemStart, start));
         }
-        collidingItems.removeAll(children.at(i));
     }
+    return collision;
+}
 
-    for (int i = 0; i < collidingItems.count(); ++i) {
-        if (!collidingItems.at(i)->isEnabled()) {
-            continue;
-        }
-        if (collidingItems.at(i)->type() == AVWidget) {
-            collision = true;
-            break;
-        }
+void CustomTrackView::spaceToolMoveToSnapPos(double snappedPos)
+{
+    // Make sure there is no collision
+    int groupStart = (int)(m_selectionGroup->sceneBoundingRect().left() + 0.5);
+    int offset = 0;
+    if (snappedPos < m_selectionGroup->sceneBoundingRect().left()) {
+        // Moving backward, determine best pos
+        selectionGroupCollides(AVWidget, (int) snappedPos - groupStart, true, &offset);
     }
+    snappedPos += offset;
+    bool collision = selectionGroupCollides(AVWidget, (int) snappedPos - groupStart, true);
 
     if (!collision) {
         // Check transitions
-        shape = m_selectionGroup->transitionGroupShape(QPointF(snappedPos - m_selectionGroup->sceneBoundingRect().left(), 0));
-        collidingItems = scene()->items(shape, Qt::IntersectsItemShape);
-        collidingItems.removeAll(m_selectionGroup);
-        for (int i = 0; i < children.count(); ++i) {
-            if (children.at(i)->type() == GroupWidget) {
-                QList<QGraphicsItem *> subchildren = children.at(i)->childItems();
-                for (int j = 0; j < subchildren.count(); ++j) {
-                    collidingItems.removeAll(subchildren.at(j));
-                }
-            }
-            collidingItems.removeAll(children.at(i));
-        }
         offset = 0;
-
-        for (int i = 0; i < collidingItems.count(); ++i) {
-            if (collidingItems.at(i)->type() == TransitionWidget && snappedPos < m_selectionGroup->sceneBoundingRect().left()) {
-                AbstractClipItem *item = static_cast <AbstractClipItem *>(collidingItems.at(i));
-                // Moving backward, determine best pos
-                QPainterPath clipPath;
-                clipPath.addRect(item->sceneBoundingRect());
-                QPainterPath res = shape.intersected(clipPath);
-                offset = qMax(offset, (int)(res.boundingRect().width() + 0.5));
-            }
+        if (snappedPos < m_selectionGroup->sceneBoundingRect().left()) {
+            selectionGroupCollides(TransitionWidget, (int) snappedPos - groupStart, false, &offset);
         }
-
         snappedPos += offset;
-        // make sure we have no collision
-        shape = m_selectionGroup->transitionGroupShape(QPointF(snappedPos - m_selectionGroup->sceneBoundingRect().left(), 0));
-        collidingItems = scene()->items(shape, Qt::IntersectsItemShape);
-        collidingItems.removeAll(m_selectionGroup);
-        for (int i = 0; i < children.count(); ++i) {
-            if (children.at(i)->type() == GroupWidget) {
-                QList<QGraphicsItem *> subchildren = children.at(i)->childItems();
-                for (int j = 0; j < subchildren.count(); ++j) {
-                    collidingItems.removeAll(subchildren.at(j));
-                }
-            }
-            collidingItems.removeAll(children.at(i));
-        }
-        for (int i = 0; i < collidingItems.count(); ++i) {
-            if (collidingItems.at(i)->type() == TransitionWidget) {
-                collision = true;
-                break;
-            }
-        }
+        collision = selectionGroupCollides(TransitionWidget, (int) snappedPos - groupStart, false);
     }
 
     if (!collision) {
@@ -1269,7 +1237,7 @@ void CustomTrackView::mousePressEvent(QMouseEvent *event)
 
 void CustomTrackView::rebuildGroup(int childTrack, const GenTime &childPos)
 {
-    const QPointF p((int)childPos.frames(m_document->fps()), getPositionFromTrack(childTrack) + m_tracksHeight / 2);
+    const QPointF p(childPos.frame(m_document->fps()), getPositionFromTrack(childTrack) + m_tracksHeight / 2);
     QList<QGraphicsItem *> list = scene()->items(p);
     AbstractGroupItem *group = nullptr;
     for (int i = 0; i < list.size(); ++i) {
@@ -1697,7 +1665,7 @@ void CustomTrackView::displayContextMenu(QPoint pos, AbstractClipItem *clip)
                 int offset = (item->startPos() - item->cropStart()).frames(m_document->fps());
                 if (!markers.isEmpty()) {
                     for (int i = 0; i < markers.count(); ++i) {
-                        int frame = (int) markers.at(i).time().frames(m_document->timecode().fps());
+                        int frame = markers.at(i).time().frame(m_document->timecode().fps());
                         QString position = m_document->timecode().getTimecode(markers.at(i).time()) + QLatin1Char(' ') + markers.at(i).comment();
                         QAction *go = m_markerMenu->addAction(position);
                         go->setData(frame + offset);
@@ -1853,6 +1821,8 @@ bool CustomTrackView::insertDropClips(const QMimeData *mimeData, const QPoint &p
         QList<GenTime> offsetList;
         offsetList.append(info.endPos);
         updateSnapPoints(nullptr, offsetList);
+        // The dropped clip must not snap to its own edges
+        m_scene->setSnapContext(QVector<int>() << info.endPos.frame(m_document->fps()), QList<const void *>() << item);
 
         m_selectionGroup->setProperty("locked_tracks", QVariant::fromValue(lockedTracks));
         m_selectionGroup->setPos(framePos);
@@ -1963,6 +1933,20 @@ bool CustomTrackView::insertDropClips(const QMimeData *mimeData, const QPoint &p
         }
 
         updateSnapPoints(nullptr, offsetList);
+        // The dropped clips must not snap to their own edges
+        QVector<int> offsets;
+        for (int i = 0; i < offsetList.count(); ++i) {
+            offsets << offsetList.at(i).frame(m_document->fps());
+        }
+        QList<const void *> dropItems;
+        if (m_selectionGroup) {
+            foreach (QGraphicsItem *child, m_selectionGroup->childItems()) {
+                dropItems << static_cast<AbstractClipItem *>(child);
+            }
+        } else if (m_dragItem) {
+            dropItems << m_dragItem;
+        }
+        m_scene->setSnapContext(offsets, dropItems);
 
         if (m_selectionGroup) {
             m_selectionGroup->setProperty("locked_tracks", QVariant::fromValue(lockedTracks));
@@ -1995,35 +1979,22 @@ void CustomTrackView::dragEnterEvent(QDragEnterEvent *event)
 
 bool CustomTrackView::itemCollision(AbstractClipItem *item, const ItemInfo &newPos)
 {
-    QRectF shape = QRectF(newPos.startPos.frames(m_document->fps()), getPositionFromTrack(newPos.track) + 1, (newPos.endPos - newPos.startPos).frames(m_document->fps()) - 0.02, m_tracksHeight - 1);
-    QList<QGraphicsItem *> collindingItems = scene()->items(shape, Qt::IntersectsItemShape);
+    QList<AbstractClipItem *> collindingItems = m_scene->indexedItems(item->type(), newPos.track, newPos.startPos.frames(m_document->fps()), newPos.endPos.frames(m_document->fps()));
     collindingItems.removeAll(item);
-    if (collindingItems.isEmpty()) {
-        return false;
-    } else {
-        for (int i = 0; i < collindingItems.count(); ++i) {
-            QGraphicsItem *collision = collindingItems.at(i);
-            if (collision->type() == item->type()) {
-                // Collision
-                //qCDebug(KDENLIVE_LOG) << "// COLLISIION DETECTED";
-                return true;
-            }
-        }
-        return false;
-    }
+    return !collindingItems.isEmpty();
 }
 
 void CustomTrackView::slotRefreshEffects(ClipItem *clip)
 {
     int track = clip->track();
     GenTime pos = clip->startPos();
-    if (!m_timeline->track(track)->removeEffect(pos.seconds(), -1, false)) {
+    if (!m_timeline->track(track)->removeEffect(pos.frame(m_document->fps()), -1, false)) {
         emit displayMessage(i18n("Problem deleting effect"), ErrorMessage);
         return;
     }
     bool success = true;
     for (int i = 0; i < clip->effectsCount(); ++i) {
-        if (!m_timeline->track(track)->addEffect(pos.seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), clip->effect(i)))) {
+        if (!m_timeline->track(track)->addEffect(pos.frame(m_document->fps()), EffectsController::getEffectArgs(m_document->getProfileInfo(), clip->effect(i)))) {
             success = false;
         }
     }
@@ -2072,7 +2043,7 @@ void CustomTrackView::addEffect(int track, GenTime pos, const QDomElement &effec
             return;
         }
         EffectsParameterList params = clip->addEffect(m_document->getProfileInfo(), effect);
-        if (!m_timeline->track(track)->addEffect(pos.seconds(), params)) {
+        if (!m_timeline->track(track)->addEffect(pos.frame(m_document->fps()), params)) {
             emit displayMessage(i18n("Problem adding effect to clip"), ErrorMessage);
             clip->deleteEffect(params.paramValue(QStringLiteral("kdenlive_ix")).toInt());
         } else {
@@ -2115,7 +2086,7 @@ void CustomTrackView::deleteEffect(int track, const GenTime &pos, const QDomElem
             return;
         }
     }
-    if (!m_timeline->track(track)->removeEffect(pos.seconds(), index, true)) {
+    if (!m_timeline->track(track)->removeEffect(pos.frame(m_document->fps()), index, true)) {
         //qCDebug(KDENLIVE_LOG) << "// ERROR REMOV EFFECT: " << index << ", DISABLE: " << effect.attribute("disable");
         emit displayMessage(i18n("Problem deleting effect"), ErrorMessage);
         return;
@@ -2543,7 +2514,7 @@ void CustomTrackView::updateEffect(int track, GenTime pos, const QDomElement &in
             clip->setSelectedEffect(clip->selectedEffectIndex());
         }
 
-        bool success = m_timeline->track(clip->track())->editEffect(clip->startPos().seconds(), effectParams, replaceEffect);
+        bool success = m_timeline->track(clip->track())->editEffect(clip->startPos().frame(m_document->fps()), effectParams, replaceEffect);
         if (success) {
             clip->updateEffect(effect);
             if (updateClip && refreshMonitor && clip->hasVisibleVideo() && effect.attribute(QStringLiteral("type")) != QLatin1String("audio")) {
@@ -2582,7 +2553,7 @@ void CustomTrackView::updateEffectState(int track, GenTime pos, const QList<int>
     // editing a clip effect
     ClipItem *clip = getClipItemAtStart(pos, track);
     if (clip) {
-        bool success = m_timeline->track(clip->track())->enableEffects(clip->startPos().seconds(), effectIndexes, disable);
+        bool success = m_timeline->track(clip->track())->enableEffects(clip->startPos().frame(m_document->fps()), effectIndexes, disable);
         if (success) {
             if (clip->enableEffects(effectIndexes, disable) && clip->hasVisibleVideo()) {
                 monitorRefresh(clip->info(), true);
@@ -2660,7 +2631,7 @@ void CustomTrackView::moveEffect(int track, const GenTime &pos, const QList<int>
                 new_position--;
             }
             // special case: speed effect, which is a pseudo-effect, not appearing in MLT's effects
-            m_timeline->track(track)->moveEffect(pos.seconds(), old_position, new_position);
+            m_timeline->track(track)->moveEffect(pos.frame(m_document->fps()), old_position, new_position);
             if (clip->hasVisibleVideo() && before.attribute(QStringLiteral("type")) != QLatin1String("audio")) {
                 monitorRefresh(clip->info(), true);
             }
@@ -2751,7 +2722,7 @@ void CustomTrackView::cutClip(const ItemInfo &info, const GenTime &cutTime, bool
             return;
         }
         if (execute) {
-            if (!m_timeline->track(info.track)->cut(cutTime.seconds())) {
+            if (!m_timeline->track(info.track)->cut(cutTime.frame(m_document->fps()))) {
                 // Error cutting clip in playlist
                 qCDebug(KDENLIVE_LOG) << "/// ERROR CUTTING CLIP PLAYLIST!!";
                 return;
@@ -2835,12 +2806,12 @@ void CustomTrackView::cutClip(const ItemInfo &info, const GenTime &cutTime, bool
             emit displayMessage(i18n("Cannot find clip to uncut"), ErrorMessage);
             return;
         }
-        if (!m_timeline->track(info.track)->del(cutTime.seconds())) {
+        if (!m_timeline->track(info.track)->del(cutTime.frame(m_document->fps()))) {
             emit displayMessage(i18n("Error removing clip at %1 on track %2", m_document->timecode().getTimecodeFromFrames(cutTime.frames(m_document->fps())), m_timeline->getTrackInfo(info.track).trackName), ErrorMessage);
             return;
         }
         dup->binClip()->removeRef();
-        m_timeline->track(info.track)->resize(info.startPos.seconds(), (info.endPos - cutTime).seconds(), true);
+        m_timeline->track(info.track)->resize(info.startPos.frame(m_document->fps()), (info.endPos - cutTime).frame(m_document->fps()), true);
         m_timeline->reloadTrack(info.track, info.startPos.frames(m_document->fps()), info.endPos.frames(m_document->fps()));
         item = getClipItemAtStart(info.startPos, info.track);
         // Restore original effects
@@ -2876,7 +2847,7 @@ Transition *CustomTrackView::cutTransition(const ItemInfo &info, const GenTime &
                 success = m_timeline->transitionHandler->addTransition(item->transitionTag(), item->transitionEndTrack(), info.track, cutTime, info.endPos, item->toXML());
             }
         }
-        int cutPos = (int) cutTime.frames(m_document->fps());
+        int cutPos = cutTime.frame(m_document->fps());
         ItemInfo newPos;
         newPos.startPos = cutTime;
         newPos.endPos = info.endPos;
@@ -2934,7 +2905,7 @@ Transition *CustomTrackView::cutTransition(const ItemInfo &info, const GenTime &
         bool success = m_timeline->transitionHandler->moveTransition(item->transitionTag(), clipinfo.track, clipinfo.track, item->transitionEndTrack(), clipinfo.startPos, clipinfo.endPos, clipinfo.startPos, transitionInfo.endPos);
 
         if (success) {
-            item->resizeEnd((int) info.endPos.frames(m_document->fps()));
+            item->resizeEnd(info.endPos.frame(m_document->fps()));
             item->setTransitionParameters(oldStack);
             m_timeline->transitionHandler->updateTransitionParams(item->transitionTag(), item->transitionEndTrack(), info.track, info.startPos, info.endPos, oldStack);
         } else {
@@ -3212,6 +3183,7 @@ void CustomTrackView::dragLeaveEvent(QDragLeaveEvent *event)
         }
         m_selectionGroup = nullptr;
         m_dragItem = nullptr;
+        m_scene->setSnapContext(QVector<int>(), QList<const void *>());
         event->accept();
     } else {
         QGraphicsView::dragLeaveEvent(event);
@@ -3250,6 +3222,7 @@ void CustomTrackView::dropEvent(QDropEvent *event)
         resetSelectionGroup();
         m_dragItem = nullptr;
         m_scene->clearSelection();
+        m_scene->setSnapContext(QVector<int>(), QList<const void *>());
         QUndoCommand *addCommand = new QUndoCommand();
         addCommand->setText(i18n("Add timeline clip"));
         QList<ClipItem *> brokenClips;
@@ -4206,6 +4179,7 @@ void CustomTrackView::insertSpace(const QList<ItemInfo> &clipsToMove, const QLis
         rebuildGroup(grp);
     }
     m_document->renderer()->mltInsertSpace(trackClipStartList, trackTransitionStartList, track, duration, offset);
+    m_timeline->checkSharedProducers();
 }
 
 void CustomTrackView::deleteClip(const QString &clipId, QUndoCommand *deleteCommand)
@@ -4380,6 +4354,7 @@ void CustomTrackView::completeSpaceOperation(int track, GenTime &timeOffset, boo
             m_commandStack->push(command);
             if (!fromStart) {
                 m_document->renderer()->mltInsertSpace(trackClipStartList, trackTransitionStartList, track, timeOffset, GenTime());
+                m_timeline->checkSharedProducers();
             }
         }
     }
@@ -4405,6 +4380,8 @@ void CustomTrackView::mouseReleaseEvent(QMouseEvent *event)
 
     QGraphicsView::mouseReleaseEvent(event);
     setDragMode(QGraphicsView::NoDrag);
+    // Dragged items snap points are indexed again
+    m_scene->setSnapContext(QVector<int>(), QList<const void *>());
 
     if (m_moveOpMode == Seek || m_moveOpMode == ScrollTimeline || m_moveOpMode == ZoomTimeline) {
         m_moveOpMode = None;
@@ -4436,7 +4413,7 @@ void CustomTrackView::deleteClip(const ItemInfo &info, bool refresh)
         return;
     }
     //m_document->renderer()->saveSceneList(QString("/tmp/error%1.mlt").arg(m_ct), QDomElement());
-    if (!m_timeline->track(info.track)->del(info.startPos.seconds())) {
+    if (!m_timeline->track(info.track)->del(info.startPos.frame(m_document->fps()))) {
         qCDebug(KDENLIVE_LOG) << " / / /CANNOT DELETE CLIP AT: " << info.startPos.frames(25);
         emit displayMessage(i18n("Error removing clip at %1 on track %2", m_document->timecode().getTimecodeFromFrames(info.startPos.frames(m_document->fps())), m_timeline->getTrackInfo(info.track).trackName), ErrorMessage);
         return;
@@ -4561,7 +4538,7 @@ void CustomTrackView::doChangeClipSpeed(const ItemInfo &info, const ItemInfo &sp
         item->setSpeed(speed, strobe);
         item->updateRectGeometry();
         if (item->cropDuration().frames(m_document->fps()) != endPos - 1) {
-            item->resizeEnd((int) info.startPos.frames(m_document->fps()) + endPos);
+            item->resizeEnd(info.startPos.frame(m_document->fps()) + endPos);
         }
         updatePositionEffects(item, info, false);
     } else {
@@ -4928,10 +4905,10 @@ void CustomTrackView::addClip(const QString &clipId, const  ItemInfo &info, cons
         prod = m_document->renderer()->getBinProducer(clipId);
     }
     binClip->addRef();
-    m_timeline->track(info.track)->add(info.startPos.seconds(), prod, info.cropStart.seconds(), (info.cropStart + info.cropDuration).seconds(), state, duplicate, TimelineMode::NormalEdit); // m_scene->editMode());
+    m_timeline->track(info.track)->add(info.startPos.frame(m_document->fps()), prod, info.cropStart.frame(m_document->fps()), (info.cropStart + info.cropDuration).frame(m_document->fps()), state, duplicate, TimelineMode::NormalEdit); // m_scene->editMode());
 
     for (int i = 0; i < item->effectsCount(); ++i) {
-        m_timeline->track(info.track)->addEffect(info.startPos.seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), item->effect(i)));
+        m_timeline->track(info.track)->addEffect(info.startPos.frame(m_document->fps()), EffectsController::getEffectArgs(m_document->getProfileInfo(), item->effect(i)));
     }
     if (refresh && item->hasVisibleVideo()) {
         monitorRefresh(info, true);
@@ -4974,47 +4951,40 @@ void CustomTrackView::slotUpdateClip(const QString &clipId, bool reload)
 
 ClipItem *CustomTrackView::getClipItemAtEnd(GenTime pos, int track)
 {
-    int framepos = (int)(pos.frames(m_document->fps()));
-    QList<QGraphicsItem *> list = scene()->items(QPointF(framepos - 1, getPositionFromTrack(track) + m_tracksHeight / 2));
+    int framepos = pos.frame(m_document->fps());
+    QList<AbstractClipItem *> list = m_scene->indexedItems(AVWidget, track, framepos - 1, framepos);
     ClipItem *clip = nullptr;
     for (int i = 0; i < list.size(); ++i) {
         if (!list.at(i)->isEnabled()) {
             continue;
         }
-        if (list.at(i)->type() == AVWidget) {
-            ClipItem *test = static_cast <ClipItem *>(list.at(i));
-            if (test->endPos() == pos) {
-                clip = test;
-            }
-            break;
+        ClipItem *test = static_cast <ClipItem *>(list.at(i));
+        if (test->endPos() == pos) {
+            clip = test;
         }
+        break;
     }
     return clip;
 }
 
 ClipItem *CustomTrackView::getClipItemAtStart(GenTime pos, int track, GenTime end)
 {
-    QList<QGraphicsItem *> list = scene()->items(QPointF(pos.frames(m_document->fps()), getPositionFromTrack(track) + m_tracksHeight / 2));
+    int framepos = pos.frame(m_document->fps());
+    QList<AbstractClipItem *> list = m_scene->indexedItems(AVWidget, track, framepos, framepos + 1);
     ClipItem *clip = nullptr;
     for (int i = 0; i < list.size(); ++i) {
         if (!list.at(i)->isEnabled()) {
-            /*ClipItem *test = static_cast <ClipItem *>(list.at(i));
-            qCDebug(KDENLIVE_LOG)<<" * * *DISABLED CLIP: "<<i<<", "<<test->startPos().frames(25);*/
             continue;
         }
-        if (list.at(i)->type() == AVWidget) {
-            ClipItem *test = static_cast <ClipItem *>(list.at(i));
-            //qCDebug(KDENLIVE_LOG)<<" * * *ENABLED CLIP: "<<i<<", "<<test->startPos().frames(25)<<" = "<<pos.frames(25);
-            if (test->startPos() == pos) {
-                if (end > GenTime()) {
-                    if (test->endPos() != end) {
-                        //qCDebug(KDENLIVE_LOG)<<" - - - -- - -NO END MATCH: "<<test->endPos().frames(25)<<" = "<< end.frames(25);
-                        continue;
-                    }
+        ClipItem *test = static_cast <ClipItem *>(list.at(i));
+        if (test->startPos() == pos) {
+            if (end > GenTime()) {
+                if (test->endPos() != end) {
+                    continue;
                 }
-                clip = test;
-                break;
             }
+            clip = test;
+            break;
         }
     }
     return clip;
@@ -5022,37 +4992,33 @@ ClipItem *CustomTrackView::getClipItemAtStart(GenTime pos, int track, GenTime en
 
 ClipItem *CustomTrackView::getMovedClipItem(const ItemInfo &info, GenTime offset, int trackOffset)
 {
-    QList<QGraphicsItem *> list = scene()->items(QPointF((info.startPos + offset).frames(m_document->fps()), getPositionFromTrack(info.track + trackOffset) + m_tracksHeight / 2));
+    int framepos = (info.startPos + offset).frame(m_document->fps());
+    QList<AbstractClipItem *> list = m_scene->indexedItems(AVWidget, info.track + trackOffset, framepos, framepos + 1);
     ClipItem *clip = nullptr;
     for (int i = 0; i < list.size(); ++i) {
         //if (!list.at(i)->isEnabled()) continue;
-        if (list.at(i)->type() == AVWidget) {
-            ClipItem *test = static_cast <ClipItem *>(list.at(i));
-            if (test->startPos() == info.startPos) {
-                if (test->endPos() != info.endPos) {
-                    continue;
-                }
+        ClipItem *test = static_cast <ClipItem *>(list.at(i));
+        if (test->startPos() == info.startPos) {
+            if (test->endPos() != info.endPos) {
+                continue;
             }
-            clip = test;
-            break;
         }
+        clip = test;
+        break;
     }
     return clip;
 }
 
 ClipItem *CustomTrackView::getClipItemAtMiddlePoint(int pos, int track)
 {
-    const QPointF p(pos, getPositionFromTrack(track) + m_tracksHeight / 2);
-    QList<QGraphicsItem *> list = scene()->items(p);
+    QList<AbstractClipItem *> list = m_scene->indexedItems(AVWidget, track, pos, pos + 1);
     ClipItem *clip = nullptr;
     for (int i = 0; i < list.size(); ++i) {
         if (!list.at(i)->isEnabled()) {
             continue;
         }
-        if (list.at(i)->type() == AVWidget) {
-            clip = static_cast <ClipItem *>(list.at(i));
-            break;
-        }
+        clip = static_cast <ClipItem *>(list.at(i));
+        break;
     }
     return clip;
 }
@@ -5071,17 +5037,14 @@ ClipItem *CustomTrackView::getUpperClipItemAt(int pos)
 
 Transition *CustomTrackView::getTransitionItemAt(int pos, int track, bool alreadyMoved)
 {
-    const QPointF p(pos, getPositionFromTrack(track) + Transition::itemOffset() + 1);
-    QList<QGraphicsItem *> list = scene()->items(p);
+    QList<AbstractClipItem *> list = m_scene->indexedItems(TransitionWidget, track, pos, pos + 1);
     Transition *clip = nullptr;
     for (int i = 0; i < list.size(); ++i) {
         if (!alreadyMoved && !list.at(i)->isEnabled()) {
             continue;
         }
-        if (list.at(i)->type() == TransitionWidget) {
-            clip = static_cast <Transition *>(list.at(i));
-            break;
-        }
+        clip = static_cast <Transition *>(list.at(i));
+        break;
     }
     return clip;
 }
@@ -5093,41 +5056,36 @@ Transition *CustomTrackView::getTransitionItemAt(GenTime pos, int track, bool al
 
 Transition *CustomTrackView::getTransitionItemAtEnd(GenTime pos, int track)
 {
-    int framepos = (int)(pos.frames(m_document->fps()));
-    const QPointF p(framepos - 1, getPositionFromTrack(track) + Transition::itemOffset() + 1);
-    QList<QGraphicsItem *> list = scene()->items(p);
+    int framepos = pos.frame(m_document->fps());
+    QList<AbstractClipItem *> list = m_scene->indexedItems(TransitionWidget, track, framepos - 1, framepos);
     Transition *clip = nullptr;
     for (int i = 0; i < list.size(); ++i) {
         if (!list.at(i)->isEnabled()) {
             continue;
         }
-        if (list.at(i)->type() == TransitionWidget) {
-            Transition *test = static_cast <Transition *>(list.at(i));
-            if (test->endPos() == pos) {
-                clip = test;
-            }
-            break;
+        Transition *test = static_cast <Transition *>(list.at(i));
+        if (test->endPos() == pos) {
+            clip = test;
         }
+        break;
     }
     return clip;
 }
 
 Transition *CustomTrackView::getTransitionItemAtStart(GenTime pos, int track)
 {
-    const QPointF p(pos.frames(m_document->fps()), getPositionFromTrack(track) + Transition::itemOffset() + 1);
-    QList<QGraphicsItem *> list = scene()->items(p);
+    int framepos = pos.frame(m_document->fps());
+    QList<AbstractClipItem *> list = m_scene->indexedItems(TransitionWidget, track, framepos, framepos + 1);
     Transition *clip = nullptr;
     for (int i = 0; i < list.size(); ++i) {
         if (!list.at(i)->isEnabled()) {
             continue;
         }
-        if (list.at(i)->type() == TransitionWidget) {
-            Transition *test = static_cast <Transition *>(list.at(i));
-            if (test->startPos() == pos) {
-                clip = test;
-            }
-            break;
+        Transition *test = static_cast <Transition *>(list.at(i));
+        if (test->startPos() == pos) {
+            clip = test;
         }
+        break;
     }
     return clip;
 }
@@ -5155,7 +5113,7 @@ bool CustomTrackView::moveClip(const ItemInfo &start, const ItemInfo &end, bool
     qCDebug(KDENLIVE_LOG) << start;
     qCDebug(KDENLIVE_LOG) << end;
 #endif
-    bool success = m_timeline->moveClip(start.track, start.startPos.seconds(), end.track, end.startPos.seconds(), item->clipState(), m_scene->editMode(), item->needsDuplicate());
+    bool success = m_timeline->moveClip(start.track, start.startPos.frame(m_document->fps()), end.track, end.startPos.frame(m_document->fps()), item->clipState(), m_scene->editMode(), item->needsDuplicate());
     QList<ItemInfo> range;
     if (item->hasVisibleVideo()) {
         range << start << end;
@@ -5168,7 +5126,7 @@ bool CustomTrackView::moveClip(const ItemInfo &start, const ItemInfo &end, bool
     } else if (!alreadyMoved) {
         bool snap = KdenliveSettings::snaptopoints();
         KdenliveSettings::setSnaptopoints(false);
-        item->setPos((int) end.startPos.frames(m_document->fps()), getPositionFromTrack(end.track) + 1);
+        item->setPos(end.startPos.frame(m_document->fps()), getPositionFromTrack(end.track) + 1);
 
         bool isLocked = m_timeline->getTrackInfo(end.track).isLocked;
         m_scene->clearSelection();
@@ -5188,7 +5146,7 @@ bool CustomTrackView::moveClip(const ItemInfo &start, const ItemInfo &end, bool
             if (tr && tr->isAutomatic()) {
                 tr->updateTransitionEndTrack(getPreviousVideoTrack(end.track));
                 m_document->renderer()->mltMoveTransition(tr->transitionTag(), m_timeline->tracksCount() - start.track, m_timeline->tracksCount() - end.track, tr->transitionEndTrack(), start.startPos, start.endPos, end.startPos, end.endPos);
-                tr->setPos((int) end.startPos.frames(m_document->fps()), (int)(end.track * m_tracksHeight + 1));
+                tr->setPos(end.startPos.frame(m_document->fps()), (int)(end.track * m_tracksHeight + 1));
             }
         }*/
         KdenliveSettings::setSnaptopoints(snap);
@@ -5217,6 +5175,8 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
     m_selectionGroup = new AbstractGroupItem(m_document->fps());
     scene()->addItem(m_selectionGroup);
     QList<ItemInfo> range;
+    // Apply all playlist edits in one pass per track
+    m_timeline->beginEditTransaction();
     m_document->renderer()->blockSignals(true);
     for (int i = 0; i < startClip.count(); ++i) {
         if (reverseMove) {
@@ -5249,7 +5209,7 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
                     clip->setEnabled(false);
                 }
             }
-            m_timeline->track(startClip.at(i).track)->del(startClip.at(i).startPos.seconds(), false);
+            m_timeline->track(startClip.at(i).track)->del(startClip.at(i).startPos.frame(m_document->fps()), false);
         } else {
             qCDebug(KDENLIVE_LOG) << "//MISSING CLIP AT: " << startClip.at(i).startPos.frames(25) << " / track: " << startClip.at(i).track << " / OFFSET: " << trackOffset;
         }
@@ -5343,10 +5303,10 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
                 } else {
                     prod = m_document->renderer()->getBinProducer(clip->getBinId());
                 }
-                m_timeline->track(info.track)->add(info.startPos.seconds(), prod, info.cropStart.seconds(), (info.cropStart + info.cropDuration).seconds(), clip->clipState(), true, m_scene->editMode());
+                m_timeline->track(info.track)->add(info.startPos.frame(m_document->fps()), prod, info.cropStart.frame(m_document->fps()), (info.cropStart + info.cropDuration).frame(m_document->fps()), clip->clipState(), true, m_scene->editMode());
 
                 for (int j = 0; j < clip->effectsCount(); ++j) {
-                    m_timeline->track(info.track)->addEffect(info.startPos.seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), clip->effect(j)));
+                    m_timeline->track(info.track)->addEffect(info.startPos.frame(m_document->fps()), EffectsController::getEffectArgs(m_document->getProfileInfo(), clip->effect(j)));
                 }
             } else if (item->type() == TransitionWidget) {
                 Transition *tr = static_cast <Transition *>(item);
@@ -5369,12 +5329,13 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
             rebuildGroup(groupList.at(i));
         }
         groupSelectedItems(children, false);
-        m_timeline->checkDuration();
+        m_timeline->endEditTransaction();
         //clearSelection();
         KdenliveSettings::setSnaptopoints(snap);
         //TODO: calculate affected ranges and invalidate previews
         monitorRefresh(range, true);
     } else {
+        m_timeline->endEditTransaction();
         qCDebug(KDENLIVE_LOG) << "///////// WARNING; NO GROUP TO MOVE";
     }
 }
@@ -5393,19 +5354,19 @@ void CustomTrackView::moveTransition(const ItemInfo &start, const ItemInfo &end,
 
     if (end.endPos - end.startPos == start.endPos - start.startPos) {
         // Transition was moved
-        item->setPos((int) end.startPos.frames(m_document->fps()), getPositionFromTrack(end.track) + 1);
+        item->setPos(end.startPos.frame(m_document->fps()), getPositionFromTrack(end.track) + 1);
     } else if (end.endPos == start.endPos) {
         // Transition start resize
-        item->resizeStart((int) end.startPos.frames(m_document->fps()));
+        item->resizeStart(end.startPos.frame(m_document->fps()));
     } else if (end.startPos == start.startPos) {
         // Transition end resize;
         //qCDebug(KDENLIVE_LOG) << "// resize END: " << end.endPos.frames(m_document->fps());
-        item->resizeEnd((int) end.endPos.frames(m_document->fps()));
+        item->resizeEnd(end.endPos.frame(m_document->fps()));
     } else {
         // Move & resize
-        item->setPos((int) end.startPos.frames(m_document->fps()), getPositionFromTrack(end.track) + 1);
-        item->resizeStart((int) end.startPos.frames(m_document->fps()));
-        item->resizeEnd((int) end.endPos.frames(m_document->fps()));
+        item->setPos(end.startPos.frame(m_document->fps()), getPositionFromTrack(end.track) + 1);
+        item->resizeStart(end.startPos.frame(m_document->fps()));
+        item->resizeEnd(end.endPos.frame(m_document->fps()));
     }
     //item->transitionHandler->moveTransition(GenTime((int) (endPos.x() - startPos.x()), m_document->fps()));
     KdenliveSettings::setSnaptopoints(snap);
@@ -5452,14 +5413,14 @@ void CustomTrackView::resizeClip(const ItemInfo &start, const ItemInfo &end, boo
     KdenliveSettings::setSnaptopoints(false);
 
     if (resizeClipStart) {
-        if (m_timeline->track(start.track)->resize(start.startPos.seconds(), (end.startPos - start.startPos).seconds(), false)) {
-            item->resizeStart((int) end.startPos.frames(m_document->fps()));
+        if (m_timeline->track(start.track)->resize(start.startPos.frame(m_document->fps()), (end.startPos - start.startPos).frame(m_document->fps()), false)) {
+            item->resizeStart(end.startPos.frame(m_document->fps()));
         } else {
             emit displayMessage(i18n("Resizing clip start failed!!"), ErrorMessage);
         }
     } else {
-        if (m_timeline->track(start.track)->resize(start.startPos.seconds(), (end.endPos - start.endPos).seconds(), true)) {
-            item->resizeEnd((int) end.endPos.frames(m_document->fps()));
+        if (m_timeline->track(start.track)->resize(start.startPos.frame(m_document->fps()), (end.endPos - start.endPos).frame(m_document->fps()), true)) {
+            item->resizeEnd(end.endPos.frame(m_document->fps()));
         } else {
             emit displayMessage(i18n("Resizing clip end failed!!"), ErrorMessage);
         }
@@ -5535,7 +5496,7 @@ void CustomTrackView::prepareResizeClipStart(AbstractClipItem *item, const ItemI
     }
     ItemInfo info = item->info();
     if (item->type() == AVWidget) {
-        bool success = m_timeline->track(oldInfo.track)->resize(oldInfo.startPos.seconds(), (item->startPos() - oldInfo.startPos).seconds(), false);
+        bool success = m_timeline->track(oldInfo.track)->resize(oldInfo.startPos.frame(m_document->fps()), (item->startPos() - oldInfo.startPos).frame(m_document->fps()), false);
         if (success) {
             // Check if there is an automatic transition on that clip (lower track)
             Transition *transition = getTransitionItemAtStart(oldInfo.startPos, oldInfo.track);
@@ -5585,7 +5546,7 @@ void CustomTrackView::prepareResizeClipStart(AbstractClipItem *item, const ItemI
             adjustEffects(clip, oldInfo, command);
         } else {
             KdenliveSettings::setSnaptopoints(false);
-            item->resizeStart((int) oldInfo.startPos.frames(m_document->fps()));
+            item->resizeStart(oldInfo.startPos.frame(m_document->fps()));
             KdenliveSettings::setSnaptopoints(snap);
             emit displayMessage(i18n("Error when resizing clip"), ErrorMessage);
         }
@@ -5594,7 +5555,7 @@ void CustomTrackView::prepareResizeClipStart(AbstractClipItem *item, const ItemI
         if (!m_timeline->transitionHandler->moveTransition(transition->transitionTag(), oldInfo.track, oldInfo.track, transition->transitionEndTrack(), oldInfo.startPos, oldInfo.endPos, info.startPos, info.endPos)) {
             // Cannot resize transition
             KdenliveSettings::setSnaptopoints(false);
-            transition->resizeStart((int) oldInfo.startPos.frames(m_document->fps()));
+            transition->resizeStart(oldInfo.startPos.frame(m_document->fps()));
             KdenliveSettings::setSnaptopoints(snap);
             emit displayMessage(i18n("Cannot resize transition"), ErrorMessage);
         } else {
@@ -5652,7 +5613,7 @@ void CustomTrackView::prepareResizeClipEnd(AbstractClipItem *item, const ItemInf
         if (!hasParentCommand) {
             command->setText(i18n("Resize clip end"));
         }
-        bool success = m_timeline->track(info.track)->resize(oldInfo.startPos.seconds(), (info.endPos - oldInfo.endPos).seconds(), true);
+        bool success = m_timeline->track(info.track)->resize(oldInfo.startPos.frame(m_document->fps()), (info.endPos - oldInfo.endPos).frame(m_document->fps()), true);
         if (success) {
             // Check if there is an automatic transition on that clip (lower track)
             Transition *tr = getTransitionItemAtEnd(oldInfo.endPos, oldInfo.track);
@@ -5704,7 +5665,7 @@ void CustomTrackView::prepareResizeClipEnd(AbstractClipItem *item, const ItemInf
             adjustEffects(clip, oldInfo, command);
         } else {
             KdenliveSettings::setSnaptopoints(false);
-            item->resizeEnd((int) oldInfo.endPos.frames(m_document->fps()));
+            item->resizeEnd(oldInfo.endPos.frame(m_document->fps()));
             KdenliveSettings::setSnaptopoints(true);
             emit displayMessage(i18n("Error when resizing clip"), ErrorMessage);
         }
@@ -5716,7 +5677,7 @@ void CustomTrackView::prepareResizeClipEnd(AbstractClipItem *item, const ItemInf
         if (!m_timeline->transitionHandler->moveTransition(transition->transitionTag(), oldInfo.track, oldInfo.track, transition->transitionEndTrack(), oldInfo.startPos, oldInfo.endPos, info.startPos, info.endPos)) {
             // Cannot resize transition
             KdenliveSettings::setSnaptopoints(false);
-            transition->resizeEnd((int) oldInfo.endPos.frames(m_document->fps()));
+            transition->resizeEnd(oldInfo.endPos.frame(m_document->fps()));
             KdenliveSettings::setSnaptopoints(true);
             emit displayMessage(i18n("Cannot resize transition"), ErrorMessage);
         } else {
@@ -5757,7 +5718,7 @@ void CustomTrackView::updatePositionEffects(ClipItem *item, const ItemInfo &info
         duration += start;
         EffectsList::setParameter(effect, QStringLiteral("in"), QString::number(start));
         EffectsList::setParameter(effect, QStringLiteral("out"), QString::number(duration));
-        if (!m_timeline->track(item->track())->editEffect(item->startPos().seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
+        if (!m_timeline->track(item->track())->editEffect(item->startPos().frame(m_document->fps()), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
             emit displayMessage(i18n("Problem editing effect"), ErrorMessage);
         }
         // if fade effect is displayed, update the effect edit widget with new clip duration
@@ -5778,7 +5739,7 @@ void CustomTrackView::updatePositionEffects(ClipItem *item, const ItemInfo &info
         duration += start;
         EffectsList::setParameter(effect, QStringLiteral("in"), QString::number(start));
         EffectsList::setParameter(effect, QStringLiteral("out"), QString::number(duration));
-        if (!m_timeline->track(item->track())->editEffect(item->startPos().seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
+        if (!m_timeline->track(item->track())->editEffect(item->startPos().frame(m_document->fps()), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
             emit displayMessage(i18n("Problem editing effect"), ErrorMessage);
         }
         // if fade effect is displayed, update the effect edit widget with new clip duration
@@ -5801,7 +5762,7 @@ void CustomTrackView::updatePositionEffects(ClipItem *item, const ItemInfo &info
         int start = end - duration;
         EffectsList::setParameter(effect, QStringLiteral("in"), QString::number(start));
         EffectsList::setParameter(effect, QStringLiteral("out"), QString::number(end));
-        if (!m_timeline->track(item->track())->editEffect(item->startPos().seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
+        if (!m_timeline->track(item->track())->editEffect(item->startPos().frame(m_document->fps()), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
             emit displayMessage(i18n("Problem editing effect"), ErrorMessage);
         }
         // if fade effect is displayed, update the effect edit widget with new clip duration
@@ -5823,7 +5784,7 @@ void CustomTrackView::updatePositionEffects(ClipItem *item, const ItemInfo &info
         int start = end - duration;
         EffectsList::setParameter(effect, QStringLiteral("in"), QString::number(start));
         EffectsList::setParameter(effect, QStringLiteral("out"), QString::number(end));
-        if (!m_timeline->track(item->track())->editEffect(item->startPos().seconds(), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
+        if (!m_timeline->track(item->track())->editEffect(item->startPos().frame(m_document->fps()), EffectsController::getEffectArgs(m_document->getProfileInfo(), effect), false)) {
             emit displayMessage(i18n("Problem editing effect"), ErrorMessage);
         }
         // if fade effect is displayed, update the effect edit widget with new clip duration
@@ -5854,155 +5815,60 @@ double CustomTrackView::getSnapPointForPos(double pos)
 
 void CustomTrackView::updateSnapPoints(AbstractClipItem *selected, QList<GenTime> offsetList, bool skipSelectedItems)
 {
-    QList<GenTime> snaps;
     if (selected && offsetList.isEmpty()) {
         offsetList.append(selected->cropDuration());
     }
-    QList<QGraphicsItem *> itemList = items();
-    for (int i = 0; i < itemList.count(); ++i) {
-        if (itemList.at(i) == selected) {
-            continue;
-        }
-        if (skipSelectedItems && itemList.at(i)->isSelected()) {
-            continue;
-        }
-        if (itemList.at(i)->type() == AVWidget) {
-            ClipItem *item = static_cast <ClipItem *>(itemList.at(i));
-            if (!item) {
-                continue;
-            }
-            GenTime start = item->startPos();
-            GenTime end = item->endPos();
-            if (!snaps.contains(start)) {
-                snaps.append(start);
-            }
-            if (!snaps.contains(end)) {
-                snaps.append(end);
-            }
-            if (!offsetList.isEmpty()) {
-                for (int j = 0; j < offsetList.size(); ++j) {
-                    GenTime offset = end - offsetList.at(j);
-                    if (offset > GenTime()) {
-                        if (!snaps.contains(offset)) {
-                            snaps.append(offset);
-                        }
-                        offset = start - offsetList.at(j);
-                        if (offset > GenTime() && !snaps.contains(offset)) {
-                            snaps.append(offset);
-                        }
-                    }
-                }
-            }
-            // Add clip markers
-            QList<GenTime> markers;
-            ClipController *controller = m_document->getClipController(item->getBinId());
-            if (controller) {
-                markers = item->snapMarkers(controller->snapMarkers());
-            } else {
-                qWarning("No controller!");
-            }
-            for (int j = 0; j < markers.size(); ++j) {
-                GenTime t = markers.at(j);
-                if (!snaps.contains(t)) {
-                    snaps.append(t);
-                }
-                if (!offsetList.isEmpty()) {
-                    for (int k = 0; k < offsetList.size(); ++k) {
-                        GenTime offset = t - offsetList.at(k);
-                        if (offset > GenTime() && !snaps.contains(offset)) {
-                            snaps.append(offset);
-                        }
-                    }
-                }
-            }
-        } else if (itemList.at(i)->type() == TransitionWidget) {
-            Transition *transition = static_cast <Transition *>(itemList.at(i));
-            if (!transition) {
-                continue;
-            }
-            GenTime start = transition->startPos();
-            GenTime end = transition->endPos();
-            if (!snaps.contains(start)) {
-                snaps.append(start);
-            }
-            if (!snaps.contains(end)) {
-                snaps.append(end);
-            }
-            if (!offsetList.isEmpty()) {
-                for (int j = 0; j < offsetList.size(); ++j) {
-                    GenTime offset = end - offsetList.at(j);
-                    if (offset > GenTime()) {
-                        if (!snaps.contains(offset)) {
-                            snaps.append(offset);
-                        }
-                        offset = start - offsetList.at(j);
-                        if (offset > GenTime() && !snaps.contains(offset)) {
-                            snaps.append(offset);
-                        }
-                    }
-                }
-            }
-        }
+    // Clips and transitions keep their own snap points up to date in the scene,
+    // we only refresh cursor, guides and render zone
+    QVector<int> points;
+    points << m_cursorPos;
+    for (int i = 0; i < m_guides.count(); ++i) {
+        points << m_guides.at(i)->position().frame(m_document->fps());
     }
+    QPoint z = m_document->zone();
+    points << z.x() << z.y();
+    m_scene->setSnapPoints(this, points);
 
-    // add cursor position
-    GenTime pos = GenTime(m_cursorPos, m_document->fps());
-    if (!snaps.contains(pos)) {
-        snaps.append(pos);
+    QVector<int> offsets;
+    for (int i = 0; i < offsetList.count(); ++i) {
+        offsets << offsetList.at(i).frame(m_document->fps());
     }
-    if (!offsetList.isEmpty()) {
-        for (int j = 0; j < offsetList.size(); ++j) {
-            GenTime offset = pos - offsetList.at(j);
-            if (!snaps.contains(offset)) {
-                snaps.append(offset);
-            }
-        }
+    QList<const void *> excluded;
+    if (selected) {
+        excluded << selected;
     }
-
-    // add guides
-    for (int i = 0; i < m_guides.count(); ++i) {
-        GenTime cur_pos = m_guides.at(i)->position();
-        if (!snaps.contains(cur_pos)) {
-            snaps.append(cur_pos);
+    if (skipSelectedItems) {
+        QList<QGraphicsItem *> selection = scene()->selectedItems();
+        if (m_selectionGroup) {
+            // Children of the dragged group keep their points out of the index until the drag ends
+            selection << m_selectionGroup->childItems();
         }
-        if (!offsetList.isEmpty()) {
-            for (int j = 0; j < offsetList.size(); ++j) {
-                GenTime offset = cur_pos - offsetList.at(j);
-                if (!snaps.contains(offset)) {
-                    snaps.append(offset);
+        for (int i = 0; i < selection.count(); ++i) {
+            if (selection.at(i)->type() == AVWidget || selection.at(i)->type() == TransitionWidget) {
+                excluded << static_cast <AbstractClipItem *>(selection.at(i));
+            } else if (selection.at(i)->type() == GroupWidget) {
+                foreach (QGraphicsItem *child, selection.at(i)->childItems()) {
+                    if (child->type() == AVWidget || child->type() == TransitionWidget) {
+                        excluded << static_cast <AbstractClipItem *>(child);
+                    }
                 }
             }
         }
     }
-
-    // add render zone
-    QPoint z = m_document->zone();
-    pos = GenTime(z.x(), m_document->fps());
-    if (!snaps.contains(pos)) {
-        snaps.append(pos);
-    }
-    pos = GenTime(z.y(), m_document->fps());
-    if (!snaps.contains(pos)) {
-        snaps.append(pos);
-    }
-
-    qSort(snaps);
-    m_scene->setSnapList(snaps);
-    //for (int i = 0; i < m_snapPoints.size(); ++i)
-    //    //qCDebug(KDENLIVE_LOG) << "SNAP POINT: " << m_snapPoints.at(i).frames(25);
+    m_scene->setSnapContext(offsets, excluded);
 }
 
 void CustomTrackView::slotSeekToPreviousSnap()
 {
     updateSnapPoints(nullptr);
-    seekCursorPos((int) m_scene->previousSnapPoint(GenTime(m_cursorPos, m_document->fps())).frames(m_document->fps()));
+    seekCursorPos(m_scene->previousSnapPoint(GenTime(m_cursorPos, m_document->fps())).frame(m_document->fps()));
     checkScrolling();
 }
 
 void CustomTrackView::slotSeekToNextSnap()
 {
     updateSnapPoints(nullptr);
-    seekCursorPos((int) m_scene->nextSnapPoint(GenTime(m_cursorPos, m_document->fps())).frames(m_document->fps()));
+    seekCursorPos(m_scene->nextSnapPoint(GenTime(m_cursorPos, m_document->fps())).frame(m_document->fps()));
     checkScrolling();
 }
 
@@ -6013,7 +5879,7 @@ void CustomTrackView::clipStart()
         item = m_dragItem;
     }
     if (item != nullptr) {
-        seekCursorPos((int) item->startPos().frames(m_document->fps()));
+        seekCursorPos(item->startPos().frame(m_document->fps()));
         checkScrolling();
     }
 }
@@ -6025,7 +5891,7 @@ void CustomTrackView::clipEnd()
         item = m_dragItem;
     }
     if (item != nullptr) {
-        seekCursorPos((int) item->endPos().frames(m_document->fps()) - 1);
+        seekCursorPos(item->endPos().frame(m_document->fps()) - 1);
         checkScrolling();
     }
 }
@@ -6310,6 +6176,37 @@ void CustomTrackView::setScale(double scaleFactor, double verticalScale, bool zo
     }
     m_currentToolManager->updateTimelineItems();
     m_scene->isZooming = false;
+    m_thumbnailTimer.start();
+}
+
+void CustomTrackView::slotUpdateVisibleThumbnails()
+{
+    const QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+    const int visibleWidth = qMax(1, (int) visible.width());
+    // Prefetch one screen on each side, keep thumbnails up to two screens away
+    const int prefetchStart = (int) visible.left() - visibleWidth;
+    const int prefetchEnd = (int) visible.right() + visibleWidth;
+    const int keepStart = (int) visible.left() - 2 * visibleWidth;
+    const int keepEnd = (int) visible.right() + 2 * visibleWidth;
+
+    const QList<AbstractClipItem *> loaded = m_scene->thumbnailItems();
+    for (int i = 0; i < loaded.count(); ++i) {
+        AbstractClipItem *item = loaded.at(i);
+        if (item->type() != AVWidget) {
+            continue;
+        }
+        const int start = item->startPos().frames(m_document->fps());
+        const int end = item->endPos().frames(m_document->fps());
+        if (end < keepStart || start > keepEnd) {
+            static_cast<ClipItem *>(item)->releaseThumbnails();
+        }
+    }
+    for (int track = 1; track < m_timeline->tracksCount(); ++track) {
+        const QList<AbstractClipItem *> items = m_scene->indexedItems(AVWidget, track, prefetchStart, prefetchEnd);
+        for (int i = 0; i < items.count(); ++i) {
+            static_cast<ClipItem *>(items.at(i))->loadThumbnails();
+        }
+    }
 }
 
 void CustomTrackView::slotRefreshGuides()
@@ -6478,19 +6375,9 @@ bool CustomTrackView::canBePastedTo(const ItemInfo &info, int type, const QList<
         // If we are in overwrite mode, always allow the move
         return true;
     }
-    int height = m_tracksHeight - 2;
-    int offset = 0;
-    if (type == TransitionWidget) {
-        height = Transition::itemHeight();
-        offset = Transition::itemOffset();
-    } else if (type == AVWidget) {
-        height = ClipItem::itemHeight();
-        offset = ClipItem::itemOffset();
-    }
-    QRectF rect((double) info.startPos.frames(m_document->fps()), (double)(getPositionFromTrack(info.track) + 1 + offset), (double)(info.endPos - info.startPos).frames(m_document->fps()), (double) height);
-    QList<QGraphicsItem *> collisions = scene()->items(rect, Qt::IntersectsItemBoundingRect);
+    QList<AbstractClipItem *> collisions = m_scene->indexedItems(type, info.track, info.startPos.frames(m_document->fps()), info.endPos.frames(m_document->fps()));
     for (int i = 0; i < collisions.count(); ++i) {
-        if (collisions.at(i)->type() == type && !excluded.contains((AbstractClipItem *)collisions.at(i))) {
+        if (!excluded.contains(collisions.at(i))) {
             return false;
         }
     }
@@ -6499,14 +6386,9 @@ bool CustomTrackView::canBePastedTo(const ItemInfo &info, int type, const QList<
 
 bool CustomTrackView::canBePastedTo(const QList<ItemInfo> &infoList, int type) const
 {
-    QPainterPath path;
     for (int i = 0; i < infoList.count(); ++i) {
-        const QRectF rect((double) infoList.at(i).startPos.frames(m_document->fps()), (double)(getPositionFromTrack(infoList.at(i).track) + 1), (double)(infoList.at(i).endPos - infoList.at(i).startPos).frames(m_document->fps()), (double)(m_tracksHeight - 1));
-        path.addRect(rect);
-    }
-    QList<QGraphicsItem *> collisions = scene()->items(path);
-    for (int i = 0; i < collisions.count(); ++i) {
-        if (collisions.at(i)->type() == type) {
+        const ItemInfo &info = infoList.at(i);
+        if (!m_scene->indexedItems(type, info.track, info.startPos.frames(m_document->fps()), info.endPos.frames(m_document->fps())).isEmpty()) {
             return false;
         }
     }
@@ -6968,8 +6850,8 @@ void CustomTrackView::slotUpdateAllThumbs()
                 } else {
                     QString startThumb = thumbsFolder.absoluteFilePath(item->getBinHash() + QLatin1Char('#'));
                     QString endThumb = startThumb;
-                    startThumb.append(QString::number((int) item->speedIndependantCropStart().frames(m_document->fps())) + QStringLiteral(".png"));
-                    endThumb.append(QString::number((int)(item->speedIndependantCropStart() + item->speedIndependantCropDuration()).frames(m_document->fps()) - 1) + QStringLiteral(".png"));
+                    startThumb.append(QString::number(item->speedIndependantCropStart().frame(m_document->fps())) + QStringLiteral(".png"));
+                    endThumb.append(QString::number((item->speedIndependantCropStart() + item->speedIndependantCropDuration()).frame(m_document->fps()) - 1) + QStringLiteral(".png"));
                     if (QFile::exists(startThumb)) {
                         QPixmap pix(startThumb);
                         if (pix.isNull()) {
@@ -7011,8 +6893,8 @@ void CustomTrackView::saveThumbnails()
                 } else {
                     QString startThumb = thumbsFolder.absoluteFilePath(item->getBinHash() + QLatin1Char('#'));
                     QString endThumb = startThumb;
-                    startThumb.append(QString::number((int) item->speedIndependantCropStart().frames(m_document->fps())) + QStringLiteral(".png"));
-                    endThumb.append(QString::number((int)(item->speedIndependantCropStart() + item->speedIndependantCropDuration()).frames(m_document->fps()) - 1) + QStringLiteral(".png"));
+                    startThumb.append(QString::number(item->speedIndependantCropStart().frame(m_document->fps())) + QStringLiteral(".png"));
+                    endThumb.append(QString::number((item->speedIndependantCropStart() + item->speedIndependantCropDuration()).frame(m_document->fps()) - 1) + QStringLiteral(".png"));
                     if (!QFile::exists(startThumb)) {
                         item->startThumb().save(startThumb);
                     }
@@ -7216,42 +7098,20 @@ void CustomTrackView::clipNameChanged(const QString &id)
 
 void CustomTrackView::getClipAvailableSpace(AbstractClipItem *item, GenTime &minimum, GenTime &maximum)
 {
-    minimum = GenTime();
-    maximum = GenTime();
-    QList<QGraphicsItem *> selection;
-    selection = m_scene->items(QRectF(0, getPositionFromTrack(item->track()) + m_tracksHeight / 2, sceneRect().width(), 2));
-    selection.removeAll(item);
-    for (int i = 0; i < selection.count(); ++i) {
-        AbstractClipItem *clip = static_cast <AbstractClipItem *>(selection.at(i));
-        if (clip && clip->type() == AVWidget) {
-            if (clip->endPos() <= item->startPos() && clip->endPos() > minimum) {
-                minimum = clip->endPos();
-            }
-            if (clip->startPos() > item->startPos() && (clip->startPos() < maximum || maximum == GenTime())) {
-                maximum = clip->startPos();
-            }
-        }
-    }
+    int min;
+    int max;
+    m_scene->indexedFreeSpace(AVWidget, item->track(), item->startPos().frames(m_document->fps()), item, min, max);
+    minimum = GenTime(min, m_document->fps());
+    maximum = max < 0 ? GenTime() : GenTime(max, m_document->fps());
 }
 
 void CustomTrackView::getTransitionAvailableSpace(AbstractClipItem *item, GenTime &minimum, GenTime &maximum)
 {
-    minimum = GenTime();
-    maximum = GenTime();
-    QList<QGraphicsItem *> selection;
-    selection = m_scene->items(QRectF(0, getPositionFromTrack(item->track()) + m_tracksHeight, sceneRect().width(), 2));
-    selection.removeAll(item);
-    for (int i = 0; i < selection.count(); ++i) {
-        AbstractClipItem *clip = static_cast <AbstractClipItem *>(selection.at(i));
-        if (clip && clip->type() == TransitionWidget) {
-            if (clip->endPos() <= item->startPos() && clip->endPos() > minimum) {
-                minimum = clip->endPos();
-            }
-            if (clip->startPos() > item->startPos() && (clip->startPos() < maximum || maximum == GenTime())) {
-                maximum = clip->startPos();
-            }
-        }
-    }
+    int min;
+    int max;
+    m_scene->indexedFreeSpace(TransitionWidget, item->track(), item->startPos().frames(m_document->fps()), item, min, max);
+    minimum = GenTime(min, m_document->fps());
+    maximum = max < 0 ? GenTime() : GenTime(max, m_document->fps());
 }
 
 void CustomTrackView::loadGroups(const QDomNodeList &groups)
@@ -7358,8 +7218,11 @@ void CustomTrackView::setAudioAlignReference()
                 return;
             }
             AudioEnvelope *envelope = new AudioEnvelope(clip->binClip()->url(), prod);
+            if (clip->binClip()->audioThumbCreated()) {
+                envelope->setThumbnailLevels(clip->binClip()->audioFrameCache, clip->binClip()->audioChannels());
+            }
             m_audioCorrelator = new AudioCorrelation(envelope);
-            connect(m_audioCorrelator, &AudioCorrelation::gotAudioAlignData, this, &CustomTrackView::slotAlignClip);
+            connect(m_audioCorrelator, &AudioCorrelation::gotAudioAlignBatch, this, &CustomTrackView::slotAlignClips);
             connect(m_audioCorrelator, &AudioCorrelation::displayMessage, this, &CustomTrackView::displayMessage);
             emit displayMessage(i18n("Processing audio, please wait."), ProcessingJobMessage);
         }
@@ -7386,6 +7249,7 @@ void CustomTrackView::alignAudio()
     }
 
     QList<QGraphicsItem *> selection = scene()->selectedItems();
+    QList<AudioEnvelope *> envelopes;
     foreach (QGraphicsItem *item, selection) {
         if (item->type() == AVWidget) {
 
@@ -7399,28 +7263,68 @@ void CustomTrackView::alignAudio()
                 Mlt::Producer *prod = m_timeline->track(clip->track())->clipProducer(m_document->renderer()->getBinProducer(clip->getBinId()), clip->clipState());
                 if (!prod) {
                     qCWarning(KDENLIVE_LOG) << "couldn't load producer for clip " << clip->getBinId() << " on track " << clip->track();
-                    return;
+                    continue;
                 }
                 AudioEnvelope *envelope = new AudioEnvelope(clip->binClip()->url(), prod,
                         info.cropStart.frames(m_document->fps()),
                         info.cropDuration.frames(m_document->fps()),
                         clip->track(),
                         info.startPos.frames(m_document->fps()));
-                m_audioCorrelator->addChild(envelope);
+                if (clip->binClip()->audioThumbCreated()) {
+                    // No need to decode the clip again
+                    envelope->setThumbnailLevels(clip->binClip()->audioFrameCache, clip->binClip()->audioChannels());
+                }
+                envelopes << envelope;
             }
         }
     }
+    if (envelopes.isEmpty()) {
+        return;
+    }
+    // The reference spectrum is computed once for all selected clips
+    m_audioCorrelator->addChildren(envelopes);
     emit displayMessage(i18n("Processing audio, please wait."), ProcessingJobMessage);
 }
 
-void CustomTrackView::slotAlignClip(int track, int pos, int shift)
+void CustomTrackView::slotAlignClips(const QList<AudioAlignment> &alignments)
+{
+    // One undo entry for the whole batch
+    QUndoCommand *alignCommand = new QUndoCommand();
+    int aligned = 0;
+    int uncertain = 0;
+    foreach (const AudioAlignment &alignment, alignments) {
+        if (!alignClip(alignment.track, alignment.startPos, alignment.shift, alignCommand)) {
+            continue;
+        }
+        ++aligned;
+        if (alignment.confidence < 0.1) {
+            // Second best match almost as good as the best one
+            ++uncertain;
+        }
+    }
+    if (alignCommand->childCount() == 0) {
+        delete alignCommand;
+        return;
+    }
+    alignCommand->setText(i18np("Auto-align clip", "Auto-align %1 clips", aligned));
+    m_commandStack->push(alignCommand);
+    m_document->renderer()->doRefresh();
+    if (aligned == 0) {
+        return;
+    }
+    if (uncertain > 0) {
+        emit displayMessage(i18np("1 clip aligned, %2 with a low confidence.", "%1 clips aligned, %2 with a low confidence.", aligned, uncertain), InformationMessage);
+    } else {
+        emit displayMessage(i18np("Clip aligned.", "%1 clips aligned.", aligned), OperationCompletedMessage);
+    }
+}
+
+bool CustomTrackView::alignClip(int track, int pos, int shift, QUndoCommand *alignCommand)
 {
-    QUndoCommand *moveCommand = new QUndoCommand();
     ClipItem *clip = getClipItemAtStart(GenTime(pos, m_document->fps()), track);
     if (!clip) {
         emit displayMessage(i18n("Cannot find clip to align."), ErrorMessage);
-        delete moveCommand;
-        return;
+        return false;
     }
     GenTime add(shift, m_document->fps());
     ItemInfo start = clip->info();
@@ -7432,31 +7336,32 @@ void CustomTrackView::slotAlignClip(int track, int pos, int shift)
         // Clip would start before 0, so crop it first
         GenTime cropBy = -end.startPos;
         if (cropBy > start.cropDuration) {
-            delete moveCommand;
             emit displayMessage(i18n("Unable to move clip out of timeline."), ErrorMessage);
-            return;
+            return false;
         }
         ItemInfo resized = start;
         resized.startPos += cropBy;
 
         resizeClip(start, resized);
-        new ResizeClipCommand(this, start, resized, false, false, moveCommand);
+        new ResizeClipCommand(this, start, resized, false, false, alignCommand);
 
         start = clip->info();
         end.startPos += cropBy;
     }
 
     if (itemCollision(clip, end)) {
-        delete moveCommand;
         emit displayMessage(i18n("Unable to move clip due to collision."), ErrorMessage);
-        return;
+        return false;
     }
-    emit displayMessage(i18n("Clip aligned."), OperationCompletedMessage);
-    moveCommand->setText(i18n("Auto-align clip"));
-    new MoveClipCommand(this, start, end, false, true, moveCommand);
-    updateTrackDuration(clip->track(), moveCommand);
-    m_commandStack->push(moveCommand);
-
+    // Move now so that the next clips of the batch see it at its new position
+    ItemInfo moved = end;
+    if (!moveClip(start, end, false, false, &moved)) {
+        // moveClip() reported the error
+        return false;
+    }
+    new MoveClipCommand(this, start, moved, false, false, alignCommand);
+    updateTrackDuration(clip->track(), alignCommand);
+    return true;
 }
 
 bool CustomTrackView::doSplitAudio(const GenTime &pos, int track, int destTrack, bool split)
@@ -7511,7 +7416,7 @@ bool CustomTrackView::doSplitAudio(const GenTime &pos, int track, int destTrack,
             clip->setSelected(true);
             ClipItem *audioClip = getClipItemAtStart(pos, info.track);
             if (audioClip) {
-                if (m_timeline->track(track)->replace(pos.seconds(), m_document->renderer()->getBinVideoProducer(clip->getBinId()))) {
+                if (m_timeline->track(track)->replace(pos.frame(m_document->fps()), m_document->renderer()->getBinVideoProducer(clip->getBinId()))) {
                     clip->setState(PlaylistState::VideoOnly);
                 } else {
                     emit displayMessage(i18n("Cannot update clip (time: %1, track: %2)", pos.frames(m_document->fps()), destTrack), ErrorMessage);
@@ -7550,7 +7455,7 @@ bool CustomTrackView::doSplitAudio(const GenTime &pos, int track, int destTrack,
                 ClipItem *clp = static_cast <ClipItem *>(children.at(i));
                 ItemInfo info = clip->info();
                 deleteClip(clp->info());
-                if (!m_timeline->track(info.track)->replace(info.startPos.seconds(), m_document->renderer()->getBinProducer(clip->getBinId()))) {
+                if (!m_timeline->track(info.track)->replace(info.startPos.frame(m_document->fps()), m_document->renderer()->getBinProducer(clip->getBinId()))) {
                     emit displayMessage(i18n("Cannot update clip (time: %1, track: %2)", info.startPos.frames(m_document->fps()), info.track), ErrorMessage);
                     return false;
                 } else {
@@ -7735,7 +7640,7 @@ void CustomTrackView::doChangeClipType(const ItemInfo &info, PlaylistState::Clip
         }
         prod = copy;
     }
-    if (prod && prod->is_valid() && m_timeline->track(info.track)->replace(info.startPos.seconds(), prod, state, previousState)) {
+    if (prod && prod->is_valid() && m_timeline->track(info.track)->replace(info.startPos.frame(m_document->fps()), prod, state, previousState)) {
         clip->setState(state);
         clip->update();
         if (clip->clipType() != Audio && state != PlaylistState::Disabled && previousState != PlaylistState::Disabled && (previousState == PlaylistState::AudioOnly || state == PlaylistState::AudioOnly)) {
@@ -8130,7 +8035,7 @@ int CustomTrackView::insertZone(TimelineMode::EditMode sceneMode, const QString
     if (KdenliveSettings::useTimelineZoneToEdit()) {
         if (clp->hasLimitedDuration()) {
             //Make sure insert duration is not longer than clip length
-            timelineLength = qMin(timelineLength, (int) clp->duration().frames(m_document->fps()) - binZone.x());
+            timelineLength = qMin(timelineLength, clp->duration().frame(m_document->fps()) - binZone.x());
         } else if (timelineLength > clp->duration().frames(m_document->fps())) {
             // Update source clip max length
             clp->setProducerProperty(QStringLiteral("length"), timelineLength + 1);
@@ -8230,18 +8135,14 @@ void CustomTrackView::removeTipAnimation()
 
 bool CustomTrackView::hasAudio(int track) const
 {
-    QRectF rect(0, (double)(getPositionFromTrack(track) + 1), (double) sceneRect().width(), (double)(m_tracksHeight - 1));
-    QList<QGraphicsItem *> collisions = scene()->items(rect, Qt::IntersectsItemBoundingRect);
+    QList<AbstractClipItem *> collisions = m_scene->indexedItems(AVWidget, track, 0, (int) sceneRect().width());
     for (int i = 0; i < collisions.count(); ++i) {
-        QGraphicsItem *item = collisions.at(i);
-        if (!item->isEnabled()) {
+        ClipItem *clip = static_cast <ClipItem *>(collisions.at(i));
+        if (!clip->isEnabled()) {
             continue;
         }
-        if (item->type() == AVWidget) {
-            ClipItem *clip = static_cast <ClipItem *>(item);
-            if (clip->clipState() != PlaylistState::VideoOnly && (clip->clipType() == Audio || clip->clipType() == AV || clip->clipType() == Playlist)) {
-                return true;
-            }
+        if (clip->clipState() != PlaylistState::VideoOnly && (clip->clipType() == Audio || clip->clipType() == AV || clip->clipType() == Playlist)) {
+            return true;
         }
     }
     return false;
@@ -8539,7 +8440,7 @@ void CustomTrackView::exportTimelineSelection(QString path)
         if (item->type() == AVWidget) {
             ClipItem *clip = static_cast<ClipItem *>(item);
             int track = clip->track() - firstTrack;
-            m_timeline->duplicateClipOnPlaylist(clip->track(), clip->startPos().seconds(), startOffest, newTractor->track(track));
+            m_timeline->duplicateClipOnPlaylist(clip->track(), clip->startPos().frame(m_document->fps()), startOffest, newTractor->track(track));
         } else if (item->type() == TransitionWidget) {
             Transition *tr = static_cast<Transition *>(item);
             int a_track = qBound(0, tr->transitionEndTrack() - firstTrack, lastTrack - firstTrack + 1);
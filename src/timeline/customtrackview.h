@@ -25,6 +25,7 @@
 #include <QGraphicsView>
 #include <QGraphicsItemAnimation>
 #include <QTimeLine>
+#include <QTimer>
 #include <QMenu>
 #include <QMutex>
 #include <QWaitCondition>
@@ -42,6 +43,7 @@ class AbstractClipItem;
 class AbstractGroupItem;
 class Transition;
 class AudioCorrelation;
+struct AudioAlignment;
 class KSelectAction;
 
 class CustomTrackView : public QGraphicsView
@@ -405,7 +407,8 @@ public slots:
     void slotAlignPlayheadToMousePos();
 
     void slotInfoProcessingFinished();
-    void slotAlignClip(int, int, int);
+    /** @brief Moves the clips of an audio alignment batch, reporting one message for all clips */
+    void slotAlignClips(const QList<AudioAlignment> &alignments);
     /** @brief Export part of the playlist in an xml file */
     void exportTimelineSelection(QString path = QString());
     /** Remove zone from current track */
@@ -464,6 +467,8 @@ private:
     QColor m_lockedTrackColor;
     QMap<AbstractToolManager::ToolManagerType, AbstractToolManager *> m_toolManagers;
     AbstractToolManager *m_currentToolManager;
+    /** @brief Delays the thumbnail update after scrolling or zooming */
+    QTimer m_thumbnailTimer;
 
     /** @brief Returns a clip from timeline
      *  @param pos a time value that is inside the clip
@@ -520,6 +525,10 @@ private:
     AudioCorrelation *m_audioCorrelator;
     ClipItem *m_audioAlignmentReference;
 
+    /** @brief Moves the clip starting at pos on track by the shift found by the audio alignment
+     * @param alignCommand the batch command receiving the undo commands of the move
+     * @return false if the clip could not be moved, an error message was emitted */
+    bool alignClip(int track, int pos, int shift, QUndoCommand *alignCommand);
     void updatePositionEffects(ClipItem *item, const ItemInfo &info, bool standalone = true);
     bool insertDropClips(const QMimeData *mimeData, const QPoint &pos);
     bool canBePastedTo(const QList<ItemInfo> &infoList, int type) const;
@@ -532,6 +541,10 @@ private:
     void getTransitionAvailableSpace(AbstractClipItem *item, GenTime &minimum, GenTime &maximum);
     /** Whether an item can be moved to a new position without colliding with similar items */
     bool itemCollision(AbstractClipItem *item, const ItemInfo &newPos);
+    /** Whether the selection group items of type, moved by offset frames, collide with other items.
+     *  If untilEnd is true, each item is extended to the end of its track, as done by the spacer tool.
+     *  If overlap is not null, it receives the largest overlap (in frames) with a colliding item */
+    bool selectionGroupCollides(int type, int offset, bool untilEnd, int *overlap = nullptr) const;
     /** Selects all items in the scene rect, and sets ok to false if a group going over several tracks is found in it */
     QList<QGraphicsItem *> checkForGroups(const QRectF &rect, bool *ok);
     /** Adjust keyframes when pasted to another clip */
@@ -560,6 +573,9 @@ private:
 
 private slots:
     void slotRefreshGuides();
+    /** @brief Requests thumbnails for clips around the visible area and releases those of far away clips.
+     * Timeline items themselves are all created when the project is loaded, only their thumbnails follow the viewport. */
+    void slotUpdateVisibleThumbnails();
     void slotEditTimeLineGuide();
     void slotDeleteTimeLineGuide();
     void checkTrackSequence(int track);
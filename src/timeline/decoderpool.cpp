@@ -0,0 +1,332 @@
+/*
+ * Kdenlive timeline shared track producers
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "decoderpool.h"
+#include "timeline.h"
+#include "track.h"
+
+#include "kdenlive_debug.h"
+#include <QScopedPointer>
+#include <QStringList>
+#include <algorithm>
+
+#include <mlt++/MltPlaylist.h>
+#include <mlt++/MltProducer.h>
+
+DecoderPool::DecoderPool(Timeline *timeline) :
+    QObject(timeline),
+    m_timeline(timeline),
+    m_checkAll(false),
+    m_sharedCount(0)
+{
+}
+
+void DecoderPool::setDuplicateInfo(Mlt::Producer &producer, const QString &binId, bool audioOnly, const QString &owner)
+{
+    producer.set("kdenlive:binid", binId.toUtf8().constData());
+    producer.set("kdenlive:clipstate", (int) (audioOnly ? PlaylistState::AudioOnly : PlaylistState::Original));
+    producer.set("kdenlive:duplicate_track", owner.toUtf8().constData());
+}
+
+bool DecoderPool::duplicateInfo(Mlt::Producer &producer, QString &binId, bool &audioOnly)
+{
+    // Producers of disabled clips also carry a bin id, only track duplicates have an owner
+    if (QString(producer.get("kdenlive:duplicate_track")).isEmpty()) {
+        return false;
+    }
+    binId = producer.get("kdenlive:binid");
+    audioOnly = producer.get_int("kdenlive:clipstate") == PlaylistState::AudioOnly;
+    return !binId.isEmpty();
+}
+
+QString DecoderPool::usageKey(const QString &binId, bool audioOnly)
+{
+    return audioOnly ? binId + QStringLiteral("_audio") : binId;
+}
+
+const DecoderPool::TrackUsage &DecoderPool::trackUsage(int track)
+{
+    if (m_usage.contains(track) && !m_dirtyTracks.contains(track)) {
+        return m_usage[track];
+    }
+    m_dirtyTracks.remove(track);
+    TrackUsage &usage = m_usage[track];
+    usage.clear();
+    Track *tk = m_timeline->track(track);
+    if (!tk) {
+        return usage;
+    }
+    Mlt::Playlist &playlist = tk->playlist();
+    for (int j = 0; j < playlist.count(); ++j) {
+        if (playlist.is_blank(j)) {
+            continue;
+        }
+        QScopedPointer<Mlt::Producer> p(playlist.get_clip(j));
+        Usage u;
+        u.id = p->parent().get("id");
+        QString binId;
+        bool audioOnly;
+        // Producers marked with a '#' are being replaced
+        if (u.id.startsWith(QLatin1Char('#')) || !duplicateInfo(p->parent(), binId, audioOnly)) {
+            continue;
+        }
+        u.owner = p->parent().get("kdenlive:duplicate_track");
+        u.track = track;
+        u.start = playlist.clip_start(j);
+        u.end = u.start + playlist.clip_length(j);
+        usage[usageKey(binId, audioOnly)] << u;
+    }
+    return usage;
+}
+
+QVector<DecoderPool::Usage> DecoderPool::allUses(const QString &key)
+{
+    QVector<Usage> uses;
+    for (int i = 1; i < m_timeline->tracksCount(); ++i) {
+        uses += trackUsage(i).value(key);
+    }
+    return uses;
+}
+
+Mlt::Producer *DecoderPool::acquire(const QString &binId, bool audioOnly, int track, int start, int end)
+{
+    const QString key = usageKey(binId, audioOnly);
+    // Candidates must not already overlap between themselves
+    resolveKey(key);
+    const QVector<Usage> uses = allUses(key);
+    QStringList ids;
+    QSet<QString> busy;
+    QString ownCandidate;
+    for (int i = 0; i < uses.count(); ++i) {
+        const Usage &u = uses.at(i);
+        if (!ids.contains(u.id)) {
+            ids << u.id;
+        }
+        if (u.track == track) {
+            ownCandidate = u.id;
+        } else if (u.start < end && u.end > start) {
+            busy.insert(u.id);
+        }
+    }
+    if (!ownCandidate.isEmpty()) {
+        // Prefer a producer already used on this track
+        ids.removeAll(ownCandidate);
+        ids.prepend(ownCandidate);
+    }
+    for (int i = 0; i < ids.count(); ++i) {
+        const QString &id = ids.at(i);
+        if (busy.contains(id)) {
+            continue;
+        }
+        for (int j = 0; j < uses.count(); ++j) {
+            const Usage &u = uses.at(j);
+            if (u.id != id) {
+                continue;
+            }
+            Mlt::Playlist &playlist = m_timeline->track(u.track)->playlist();
+            QScopedPointer<Mlt::Producer> p(playlist.get_clip(playlist.get_clip_index_at(u.start)));
+            if (!p || p->is_blank() || id != p->parent().get("id")) {
+                // Index is out of date, do not share this time
+                qCDebug(KDENLIVE_LOG) << "// Outdated producer sharing index on track" << u.track;
+                invalidateTrack(u.track);
+                return nullptr;
+            }
+            if (id != ownCandidate) {
+                ++m_sharedCount;
+                qCDebug(KDENLIVE_LOG) << "// Sharing producer" << id << "on track" << track << ", decoders saved:" << m_sharedCount;
+            }
+            return new Mlt::Producer(p->parent());
+        }
+    }
+    return nullptr;
+}
+
+bool DecoderPool::isUsedElsewhere(Mlt::Producer &producer, int track, int start, int end)
+{
+    QString binId;
+    bool audioOnly;
+    if (!duplicateInfo(producer, binId, audioOnly)) {
+        return false;
+    }
+    const QString id = producer.get("id");
+    const QVector<Usage> uses = allUses(usageKey(binId, audioOnly));
+    for (int i = 0; i < uses.count(); ++i) {
+        const Usage &u = uses.at(i);
+        if (u.id == id && u.track != track && u.start < end && u.end > start) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DecoderPool::clipAdded(int track, Mlt::Producer &producer, int start, int end)
+{
+    QString binId;
+    bool audioOnly;
+    if (QString(producer.get("id")).startsWith(QLatin1Char('#')) || !duplicateInfo(producer, binId, audioOnly)) {
+        return;
+    }
+    const QString key = usageKey(binId, audioOnly);
+    if (m_usage.contains(track) && !m_dirtyTracks.contains(track)) {
+        Usage u;
+        u.id = producer.get("id");
+        u.owner = producer.get("kdenlive:duplicate_track");
+        u.track = track;
+        u.start = start;
+        u.end = end;
+        m_usage[track][key] << u;
+    }
+    m_pendingKeys.insert(key);
+}
+
+void DecoderPool::clipRemoved(int track, Mlt::Producer &producer, int start)
+{
+    QString binId;
+    bool audioOnly;
+    if (!duplicateInfo(producer, binId, audioOnly) || !m_usage.contains(track) || m_dirtyTracks.contains(track)) {
+        return;
+    }
+    QVector<Usage> &uses = m_usage[track][usageKey(binId, audioOnly)];
+    for (int i = 0; i < uses.count(); ++i) {
+        if (uses.at(i).start == start) {
+            uses.remove(i);
+            return;
+        }
+    }
+    // Removed clip was not indexed
+    invalidateTrack(track);
+}
+
+void DecoderPool::clipsMoved(int track)
+{
+    m_dirtyTracks.insert(track);
+    m_pendingTracks.insert(track);
+}
+
+void DecoderPool::invalidateTrack(int track)
+{
+    m_dirtyTracks.insert(track);
+}
+
+void DecoderPool::invalidateAll()
+{
+    m_usage.clear();
+    m_dirtyTracks.clear();
+    m_checkAll = true;
+}
+
+void DecoderPool::resolveConflicts()
+{
+    QSet<QString> keys = m_pendingKeys;
+    for (int i = 1; i < m_timeline->tracksCount(); ++i) {
+        if (m_checkAll || m_pendingTracks.contains(i)) {
+            keys.unite(trackUsage(i).keys().toSet());
+        }
+    }
+    m_pendingKeys.clear();
+    m_pendingTracks.clear();
+    m_checkAll = false;
+    foreach (const QString &key, keys) {
+        resolveKey(key);
+    }
+}
+
+void DecoderPool::resolveKey(const QString &key)
+{
+    int moved = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        QHash<QString, QVector<Usage> > usage;
+        const QVector<Usage> uses = allUses(key);
+        for (int i = 0; i < uses.count(); ++i) {
+            usage[uses.at(i).id] << uses.at(i);
+        }
+        // Clips to move to their track's own duplicate
+        QVector<Usage> conflicts;
+        QHash<QString, QVector<Usage> >::iterator it = usage.begin();
+        for (; it != usage.end(); ++it) {
+            QVector<Usage> &idUses = it.value();
+            if (idUses.count() < 2) {
+                continue;
+            }
+            // The track that created the duplicate keeps it
+            const QString owner = idUses.first().owner;
+            std::sort(idUses.begin(), idUses.end(), [](const Usage &a, const Usage &b) {
+                return a.start < b.start;
+            });
+            QVector<Usage> active;
+            for (int j = 0; j < idUses.count(); ++j) {
+                const Usage &u = idUses.at(j);
+                bool conflict = false;
+                for (int k = active.count() - 1; k >= 0; --k) {
+                    if (active.at(k).end <= u.start) {
+                        active.remove(k);
+                        continue;
+                    }
+                    if (active.at(k).track != u.track) {
+                        conflict = true;
+                        Track *tk = m_timeline->track(u.track);
+                        if (tk && tk->playlist().get("id") == owner) {
+                            // Keep the owner on the shared producer, move the other use
+                            conflicts << active.at(k);
+                            active.remove(k);
+                            conflict = false;
+                        }
+                        break;
+                    }
+                }
+                if (conflict) {
+                    conflicts << u;
+                } else {
+                    active << u;
+                }
+            }
+        }
+        for (int i = 0; i < conflicts.count(); ++i) {
+            const Usage &u = conflicts.at(i);
+            Track *tk = m_timeline->track(u.track);
+            if (!tk || !tk->useOwnDuplicate(u.start)) {
+                continue;
+            }
+            ++moved;
+            changed = true;
+            if (!m_usage.contains(u.track) || m_dirtyTracks.contains(u.track)) {
+                continue;
+            }
+            // The clip now uses the duplicate owned by its track
+            Mlt::Playlist &playlist = tk->playlist();
+            QScopedPointer<Mlt::Producer> p(playlist.get_clip(playlist.get_clip_index_at(u.start)));
+            QVector<Usage> &trackUses = m_usage[u.track][key];
+            for (int j = 0; j < trackUses.count(); ++j) {
+                if (trackUses.at(j).start == u.start) {
+                    trackUses[j].id = p->parent().get("id");
+                    trackUses[j].owner = p->parent().get("kdenlive:duplicate_track");
+                    break;
+                }
+            }
+        }
+    }
+    if (moved > 0) {
+        qCDebug(KDENLIVE_LOG) << "// Moved" << moved << "clips to track private producers";
+    }
+}
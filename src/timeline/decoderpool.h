@@ -0,0 +1,122 @@
+/*
+ * Kdenlive timeline shared track producers
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DECODERPOOL_H
+#define DECODERPOOL_H
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+namespace Mlt
+{
+class Producer;
+}
+class Timeline;
+
+/** @brief Shares the per track producer duplicates between tracks
+ * MLT cannot read the same avformat producer at two positions in the same
+ * frame, so Kdenlive duplicates a clip producer for each track using it.
+ * A duplicate can however safely be used by several tracks as long as the
+ * uses never overlap in time. The pool hands out such duplicates when a clip
+ * is first added to a track, so that layered or multicam projects do not
+ * open one decoder per track and clip. After edits, uses that ended up
+ * overlapping are moved back to a duplicate owned by their track.
+ *
+ * The pool keeps an index of where each duplicate is used on each track.
+ * Tracks update it when a clip is added or removed. Edits that shift several
+ * clips only mark the track as changed, its part of the index is rebuilt the
+ * next time it is needed. Conflicts are checked once the track playlist is
+ * unlocked, only for the clips that were edited.
+ */
+class DecoderPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DecoderPool(Timeline *timeline);
+
+    /** @brief Records the bin clip, state and owner track of a duplicate created for a track
+     * @param owner the playlist id of the track creating the duplicate */
+    static void setDuplicateInfo(Mlt::Producer &producer, const QString &binId, bool audioOnly, const QString &owner);
+    /** @brief Reads the bin id and audio only state of a track duplicate, returns false if producer is not a duplicate */
+    static bool duplicateInfo(Mlt::Producer &producer, QString &binId, bool &audioOnly);
+    /** @brief Returns an existing duplicate of a bin clip that is not playing during [start, end[ on another track
+     * Overlapping uses of the clip's duplicates are moved to private duplicates first.
+     * @param track the MLT index of the track that will use the producer
+     * @return a new reference to the producer, or nullptr if a new duplicate is needed */
+    Mlt::Producer *acquire(const QString &binId, bool audioOnly, int track, int start, int end);
+    /** @brief Returns true if producer is used on another track than track during [start, end[ */
+    bool isUsedElsewhere(Mlt::Producer &producer, int track, int start, int end);
+    /** @brief Records a clip inserted on a track without moving other clips
+     * @param producer the parent producer of the clip */
+    void clipAdded(int track, Mlt::Producer &producer, int start, int end);
+    /** @brief Records the removal of the clip starting at start on a track, without moving other clips
+     * @param producer the parent producer of the removed clip */
+    void clipRemoved(int track, Mlt::Producer &producer, int start);
+    /** @brief Records an edit that moved or replaced clips on a track, its index is rebuilt when needed */
+    void clipsMoved(int track);
+    /** @brief Drops the index of a track, without checking its clips for conflicts */
+    void invalidateTrack(int track);
+    /** @brief Drops the index of all tracks and checks all their clips on the next resolveConflicts() */
+    void invalidateAll();
+    /** @brief Gives a track private duplicate to the clips recorded since the last call that use a
+     * shared producer at the same time as another track.
+     * Must not be called while a track playlist is locked. */
+    void resolveConflicts();
+
+private:
+    struct Usage {
+        QString id;
+        /** Playlist id of the track that created the duplicate */
+        QString owner;
+        int track;
+        int start;
+        int end;
+    };
+    typedef QHash<QString, QVector<Usage> > TrackUsage;
+    Timeline *m_timeline;
+    /** Uses of the duplicates on each track, keyed by usageKey() */
+    QMap<int, TrackUsage> m_usage;
+    /** Tracks whose index has to be rebuilt */
+    QSet<int> m_dirtyTracks;
+    /** Usage keys of the clips added since the last conflict check */
+    QSet<QString> m_pendingKeys;
+    /** Tracks edited since the last conflict check */
+    QSet<int> m_pendingTracks;
+    /** True if all tracks need a conflict check */
+    bool m_checkAll;
+    /** Number of decoders that were not created thanks to sharing */
+    int m_sharedCount;
+    /** @brief Returns the index of a track, rebuilding it if needed */
+    const TrackUsage &trackUsage(int track);
+    /** @brief Returns the uses of the duplicates of a bin clip on all tracks */
+    QVector<Usage> allUses(const QString &key);
+    /** @brief Moves the uses of a bin clip that overlap another track's use of the same duplicate to a private duplicate */
+    void resolveKey(const QString &key);
+    static QString usageKey(const QString &binId, bool audioOnly);
+};
+
+#endif
@@ -281,7 +281,7 @@ void MoveManager::mouseRelease(QMouseEvent *, GenTime pos)
                 // undo last move and emit error message
                 bool snap = KdenliveSettings::snaptopoints();
                 KdenliveSettings::setSnaptopoints(false);
-                item->setPos((int) m_dragItemInfo.startPos.frames(m_view->fps()), m_view->getPositionFromTrack(m_dragItemInfo.track) + 1);
+                item->setPos(m_dragItemInfo.startPos.frame(m_view->fps()), m_view->getPositionFromTrack(m_dragItemInfo.track) + 1);
                 KdenliveSettings::setSnaptopoints(snap);
                 m_view->displayMessage(i18n("Cannot move clip to position %1", m_view->timecode().getTimecodeFromFrames(info.startPos.frames(m_view->fps()))), ErrorMessage);
             }
@@ -291,7 +291,7 @@ void MoveManager::mouseRelease(QMouseEvent *, GenTime pos)
             if (!m_transitionHandler->moveTransition(transition->transitionTag(), m_dragItemInfo.track, dragItem->track(), transition->transitionEndTrack(), m_dragItemInfo.startPos, m_dragItemInfo.endPos, info.startPos, info.endPos)) {
                 // Moving transition failed, revert to previous position
                 m_view->displayMessage(i18n("Cannot move transition"), ErrorMessage);
-                transition->setPos((int) m_dragItemInfo.startPos.frames(m_view->fps()), m_view->getPositionFromTrack(m_dragItemInfo.track) + 1);
+                transition->setPos(m_dragItemInfo.startPos.frame(m_view->fps()), m_view->getPositionFromTrack(m_dragItemInfo.track) + 1);
             } else {
                 QUndoCommand *moveCommand = new QUndoCommand();
                 moveCommand->setText(i18n("Move transition"));
@@ -0,0 +1,171 @@
+/*
+ * Kdenlive timeline snap points index
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "snapindex.h"
+
+SnapIndex::SnapIndex()
+{
+}
+
+void SnapIndex::addPoint(int point)
+{
+    m_points[point]++;
+}
+
+void SnapIndex::removePoint(int point)
+{
+    QMap<int, int>::iterator it = m_points.find(point);
+    if (it == m_points.end()) {
+        return;
+    }
+    if (--it.value() <= 0) {
+        m_points.erase(it);
+    }
+}
+
+void SnapIndex::setPoints(const void *source, const QVector<int> &points)
+{
+    if (m_excluded.contains(source)) {
+        // Points are added when the exclusion ends
+        m_sources.insert(source, points);
+        return;
+    }
+    QHash<const void *, QVector<int> >::iterator it = m_sources.find(source);
+    if (it != m_sources.end()) {
+        if (it.value() == points) {
+            return;
+        }
+        foreach (int point, it.value()) {
+            removePoint(point);
+        }
+    }
+    foreach (int point, points) {
+        addPoint(point);
+    }
+    m_sources.insert(source, points);
+}
+
+void SnapIndex::removeSource(const void *source)
+{
+    const bool excluded = m_excluded.remove(source);
+    QHash<const void *, QVector<int> >::iterator it = m_sources.find(source);
+    if (it == m_sources.end()) {
+        return;
+    }
+    if (!excluded) {
+        foreach (int point, it.value()) {
+            removePoint(point);
+        }
+    }
+    m_sources.erase(it);
+}
+
+void SnapIndex::clear()
+{
+    m_points.clear();
+    m_sources.clear();
+    m_excluded.clear();
+    m_offsets.clear();
+}
+
+void SnapIndex::setExcludedSources(const QList<const void *> &sources)
+{
+    foreach (const void *source, m_excluded) {
+        foreach (int point, m_sources.value(source)) {
+            addPoint(point);
+        }
+    }
+    m_excluded.clear();
+    foreach (const void *source, sources) {
+        if (m_excluded.contains(source)) {
+            continue;
+        }
+        // Sources that did not register yet are excluded too, for example items dropped from the bin
+        foreach (int point, m_sources.value(source)) {
+            removePoint(point);
+        }
+        m_excluded.insert(source);
+    }
+}
+
+void SnapIndex::setOffsets(const QVector<int> &offsets)
+{
+    m_offsets = offsets;
+}
+
+int SnapIndex::closest(int target, double maxDistance) const
+{
+    int result = -1;
+    int distance = 0;
+    QMap<int, int>::const_iterator it = m_points.lowerBound(target);
+    // look forward
+    if (it != m_points.constEnd() && it.key() - target < maxDistance) {
+        result = it.key();
+        distance = it.key() - target;
+    }
+    // look backward
+    if (it != m_points.constBegin()) {
+        --it;
+        int d = target - it.key();
+        if (d < maxDistance && (result < 0 || d < distance)) {
+            result = it.key();
+        }
+    }
+    return result;
+}
+
+int SnapIndex::snap(int pos, double maxDistance) const
+{
+    int result = closest(pos, maxDistance);
+    int distance = result >= 0 ? qAbs(result - pos) : 0;
+    foreach (int offset, m_offsets) {
+        int point = closest(pos + offset, maxDistance);
+        if (point < 0 || point - offset < 0) {
+            continue;
+        }
+        int d = qAbs(point - pos - offset);
+        if (result < 0 || d < distance) {
+            result = point - offset;
+            distance = d;
+        }
+    }
+    return result;
+}
+
+int SnapIndex::previous(int pos) const
+{
+    QMap<int, int>::const_iterator it = m_points.lowerBound(pos);
+    if (it == m_points.constBegin()) {
+        return -1;
+    }
+    --it;
+    return it.key();
+}
+
+int SnapIndex::next(int pos) const
+{
+    QMap<int, int>::const_iterator it = m_points.upperBound(pos);
+    if (it == m_points.constEnd()) {
+        return -1;
+    }
+    return it.key();
+}
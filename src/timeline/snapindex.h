@@ -0,0 +1,79 @@
+/*
+ * Kdenlive timeline snap points index
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SNAPINDEX_H
+#define SNAPINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QVector>
+
+/** @brief Sorted and deduplicated list of timeline snap positions (in frames)
+ * Each source (a clip, a transition, the guides...) registers its own points,
+ * which are reference counted so that a source can be updated or removed
+ * without rebuilding the whole list.
+ * Snapping with an offset (for example snapping the end of a moved clip) is
+ * computed at query time instead of storing shifted copies of every point.
+ */
+class SnapIndex
+{
+public:
+    SnapIndex();
+
+    /** @brief Replaces the points contributed by source */
+    void setPoints(const void *source, const QVector<int> &points);
+    /** @brief Removes all points contributed by source */
+    void removeSource(const void *source);
+    void clear();
+
+    /** @brief Points of these sources are ignored by the queries (for example the dragged items)
+     * Excluded sources stay out of the index until the exclusion ends, so that
+     * updating their points while they are dragged does not make them visible.
+     * Sources can be excluded before they register their points. */
+    void setExcludedSources(const QList<const void *> &sources);
+    /** @brief Additional offsets tried when snapping, the position + offset is matched against the points */
+    void setOffsets(const QVector<int> &offsets);
+
+    /** @brief Returns the snapped position closest to pos, or -1 if no point is closer than maxDistance */
+    int snap(int pos, double maxDistance) const;
+    /** @brief Returns the closest point strictly before pos, or -1 */
+    int previous(int pos) const;
+    /** @brief Returns the closest point strictly after pos, or -1 */
+    int next(int pos) const;
+
+private:
+    /** Reference count of each snap position */
+    QMap<int, int> m_points;
+    /** Points registered by each source */
+    QHash<const void *, QVector<int> > m_sources;
+    /** Sources whose points are currently not in m_points */
+    QSet<const void *> m_excluded;
+    QVector<int> m_offsets;
+    void addPoint(int point);
+    void removePoint(int point);
+    /** @brief Returns the closest visible point to target within maxDistance, or -1 */
+    int closest(int target, double maxDistance) const;
+};
+
+#endif
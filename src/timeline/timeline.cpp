@@ -20,6 +20,7 @@
 
 #include "timeline.h"
 #include "track.h"
+#include "decoderpool.h"
 #include "clip.h"
 #include "renderer.h"
 #include "headertrack.h"
@@ -93,6 +94,7 @@ Timeline::Timeline(KdenliveDoc *doc, const QList<QAction *> &actions, const QLis
     }
     Mlt::Service s(m_doc->renderer()->getProducer()->parent().get_service());
     m_tractor = new Mlt::Tractor(s);
+    m_decoderPool = new DecoderPool(this);
 
     //TODO: The following lines allow to add an overlay subtitle from an ASS subtitle file
     /*Mlt::Filter f(*(s.profile()), "avfilter.ass");
@@ -325,6 +327,7 @@ int Timeline::getTracks()
         if (!isBackgroundBlackTrack) {
             audio = playlist.get_int("kdenlive:audio_track");
             tk = new Track(i, m_trackActions, playlist, audio == 1 ? AudioTrack : VideoTrack, height, this);
+            tk->setDecoderPool(m_decoderPool);
             m_tracks.append(tk);
             trackduration = loadTrack(i, offset, playlist);
             QFrame *frame = new QFrame(headers_container);
@@ -380,6 +383,33 @@ void Timeline::checkDuration()
     m_doc->renderer()->mltCheckLength(m_tractor);
 }
 
+void Timeline::beginEditTransaction()
+{
+    for (int i = 0; i < m_tracks.count(); ++i) {
+        m_tracks.at(i)->beginTransaction();
+    }
+}
+
+void Timeline::endEditTransaction()
+{
+    bool durationChanged = false;
+    for (int i = 0; i < m_tracks.count(); ++i) {
+        if (m_tracks.at(i)->endTransaction(false)) {
+            durationChanged = true;
+        }
+    }
+    if (durationChanged) {
+        checkDuration();
+    }
+}
+
+void Timeline::checkSharedProducers()
+{
+    // Playlists were edited directly, rebuild the sharing index
+    m_decoderPool->invalidateAll();
+    m_decoderPool->resolveConflicts();
+}
+
 void Timeline::getTransitions()
 {
     int compositeMode = 0;
@@ -690,7 +720,7 @@ bool Timeline::isLastClip(const ItemInfo &info)
     if (tk == nullptr) {
         return true;
     }
-    return tk->isLastClip(info.endPos.seconds());
+    return tk->isLastClip(info.endPos.frame(tk->fps()));
 }
 
 void Timeline::setTrackInfo(int ix, const TrackInfo &info)
@@ -1073,7 +1103,8 @@ int Timeline::loadTrack(int ix, int offset, Mlt::Playlist &playlist, int start,
         clipinfo.cropDuration = GenTime(info->frame_count, fps);
         clipinfo.track = ix;
         //qCDebug(KDENLIVE_LOG)<<"// Loading clip: "<<clipinfo.startPos.frames(25)<<" / "<<clipinfo.endPos.frames(25)<<"\n++++++++++++++++++++++++";
-        ClipItem *item = new ClipItem(binclip, clipinfo, fps, slowInfo.speed, slowInfo.strobe, m_trackview->getFrameWidth(), true);
+        // Thumbnails are only requested once the clip gets close to the visible area
+        ClipItem *item = new ClipItem(binclip, clipinfo, fps, slowInfo.speed, slowInfo.strobe, m_trackview->getFrameWidth(), false);
         connect(item, &AbstractClipItem::selectItem, m_trackview, &CustomTrackView::slotSelectItem);
         item->setPos(clipinfo.startPos.frames(fps), KdenliveSettings::trackheight() * (visibleTracksCount() - clipinfo.track) + 1 + item->itemOffset());
         //qCDebug(KDENLIVE_LOG)<<" * * Loaded clip on tk: "<<clipinfo.track<< ", POS: "<<clipinfo.startPos.frames(fps);
@@ -1403,25 +1434,26 @@ void Timeline::checkTrackHeight(bool force)
     }
 }
 
-bool Timeline::moveClip(int startTrack, qreal startPos, int endTrack, qreal endPos, PlaylistState::ClipState state, TimelineMode::EditMode mode, bool duplicate)
+bool Timeline::moveClip(int startTrack, int startPos, int endTrack, int endPos, PlaylistState::ClipState state, TimelineMode::EditMode mode, bool duplicate)
 {
     if (startTrack == endTrack) {
         return track(startTrack)->move(startPos, endPos, mode);
     }
     Track *sourceTrack = track(startTrack);
-    int pos = sourceTrack->frame(startPos);
-    int clipIndex = sourceTrack->playlist().get_clip_index_at(pos);
-    sourceTrack->playlist().lock();
+    int clipIndex = sourceTrack->playlist().get_clip_index_at(startPos);
+    sourceTrack->lockPlaylist();
+    int clipStart = sourceTrack->playlist().clip_start(clipIndex);
     Mlt::Producer *clipProducer = sourceTrack->playlist().replace_with_blank(clipIndex);
     sourceTrack->playlist().consolidate_blanks();
     if (!clipProducer || clipProducer->is_blank()) {
         qCDebug(KDENLIVE_LOG) << "// Cannot get clip at index: " << clipIndex << " / " << startPos;
-        sourceTrack->playlist().unlock();
+        sourceTrack->unlockPlaylist();
         return false;
     }
-    sourceTrack->playlist().unlock();
+    sourceTrack->unlockPlaylist();
+    m_decoderPool->clipRemoved(startTrack, clipProducer->parent(), clipStart);
     Track *destTrack = track(endTrack);
-    bool success = destTrack->add(endPos, clipProducer, GenTime(clipProducer->get_in(), destTrack->fps()).seconds(), GenTime(clipProducer->get_out() + 1, destTrack->fps()).seconds(), state, duplicate, mode);
+    bool success = destTrack->add(endPos, clipProducer, clipProducer->get_in(), clipProducer->get_out() + 1, state, duplicate, mode);
     delete clipProducer;
     return success;
 }
@@ -1657,10 +1689,9 @@ int Timeline::changeClipSpeed(const ItemInfo &info, const ItemInfo &speedIndepen
     return track(info.track)->changeClipSpeed(info, speedIndependantInfo, state, speed, strobe, prod, id, passProperties);
 }
 
-void Timeline::duplicateClipOnPlaylist(int tk, qreal startPos, int offset, Mlt::Producer *prod)
+void Timeline::duplicateClipOnPlaylist(int tk, int pos, int offset, Mlt::Producer *prod)
 {
     Track *sourceTrack = track(tk);
-    int pos = sourceTrack->frame(startPos);
     int clipIndex = sourceTrack->playlist().get_clip_index_at(pos);
     if (sourceTrack->playlist().is_blank(clipIndex)) {
         qCDebug(KDENLIVE_LOG) << "// ERROR FINDING CLIP on TK: " << tk << ", FRM: " << pos;
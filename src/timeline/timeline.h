@@ -45,6 +45,7 @@ class TransitionHandler;
 class CustomRuler;
 class QUndoCommand;
 class PreviewManager;
+class DecoderPool;
 
 class ScrollEventEater : public QObject
 {
@@ -110,8 +111,8 @@ public:
     void refreshIcons();
     /** @brief Returns a kdenlive effect xml description from an effect tag / id */
     static QDomElement getEffectByTag(const QString &effecttag, const QString &effectid);
-    /** @brief Move a clip between tracks */
-    bool moveClip(int startTrack, qreal startPos, int endTrack, qreal endPos, PlaylistState::ClipState state, TimelineMode::EditMode mode, bool duplicate);
+    /** @brief Move a clip between tracks, positions are in frames */
+    bool moveClip(int startTrack, int startPos, int endTrack, int endPos, PlaylistState::ClipState state, TimelineMode::EditMode mode, bool duplicate);
     void renameTrack(int ix, const QString &name);
     void updateTrackState(int ix, int state);
     /** @brief Returns info about a track.
@@ -141,7 +142,16 @@ public:
     int getTracks();
     void getTransitions();
     void refreshTractor();
-    void duplicateClipOnPlaylist(int tk, qreal startPos, int offset, Mlt::Producer *prod);
+    /** @brief Starts a batch of edits on all track playlists
+     *  Track cleanups of the clip operations issued until endEditTransaction()
+     *  are done once, and the project duration is checked only once. Only use
+     *  it around the Track calls of a single operation, see Track::beginTransaction(). */
+    void beginEditTransaction();
+    /** @brief Applies the deferred track cleanups and updates project duration if needed */
+    void endEditTransaction();
+    /** @brief Checks that producers shared between tracks are never used at the same time, after clips were shifted */
+    void checkSharedProducers();
+    void duplicateClipOnPlaylist(int tk, int startPos, int offset, Mlt::Producer *prod);
     int getSpaceLength(const GenTime &pos, int tk, bool fromBlankStart);
     void blockTrackSignals(bool block);
     /** @brief Load document */
@@ -211,6 +221,8 @@ public slots:
 private:
     Mlt::Tractor *m_tractor;
     QList<Track *> m_tracks;
+    /** @brief Shares producer duplicates between tracks */
+    DecoderPool *m_decoderPool;
     /** @brief number of special overlay tracks to preview effects */
     bool m_hasOverlayTrack;
     Mlt::Producer *m_overlayTrack;
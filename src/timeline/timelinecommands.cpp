@@ -35,7 +35,7 @@ AddEffectCommand::AddEffectCommand(CustomTrackView *view, const int track, const
     m_doIt(doIt)
 {
     QString effectName;
-    QDomElement namenode = m_effect.firstChildElement(QStringLiteral("name"));
+    QDomElement namenode = effect.firstChildElement(QStringLiteral("name"));
     if (!namenode.isNull()) {
         effectName = i18n(namenode.text().toUtf8().constData());
     } else {
@@ -51,21 +51,42 @@ AddEffectCommand::AddEffectCommand(CustomTrackView *view, const int track, const
 void AddEffectCommand::undo()
 {
     if (m_doIt) {
-        m_view->deleteEffect(m_track, m_pos, m_effect);
+        m_view->deleteEffect(m_track, m_pos, m_effect.element());
     } else {
-        m_view->addEffect(m_track, m_pos, m_effect);
+        addEffect();
     }
 }
 // virtual
 void AddEffectCommand::redo()
 {
     if (m_doIt) {
-        m_view->addEffect(m_track, m_pos, m_effect);
+        addEffect();
     } else {
-        m_view->deleteEffect(m_track, m_pos, m_effect);
+        m_view->deleteEffect(m_track, m_pos, m_effect.element());
     }
 }
 
+void AddEffectCommand::addEffect()
+{
+    QDomElement effect = m_effect.element();
+    const QString index = effect.attribute(QStringLiteral("kdenlive_ix"));
+    m_view->addEffect(m_track, m_pos, effect);
+    // The clip sets the real effect index, needed to delete it again
+    if (effect.attribute(QStringLiteral("kdenlive_ix")) != index) {
+        m_effect = UndoPayload(effect);
+    }
+}
+// virtual
+int AddEffectCommand::memoryCost() const
+{
+    return m_effect.memoryCost();
+}
+// virtual
+void AddEffectCommand::spill(UndoSpillFile *file)
+{
+    m_effect.spill(file);
+}
+
 AddTimelineClipCommand::AddTimelineClipCommand(CustomTrackView *view, const QString &clipId, const ItemInfo &info, const EffectsList &effects, PlaylistState::ClipState state, bool doIt, bool doRemove, bool refreshMonitor, QUndoCommand *parent) :
     QUndoCommand(parent),
     m_view(view),
@@ -162,9 +183,9 @@ AddTransitionCommand::AddTransitionCommand(CustomTrackView *view, const ItemInfo
 void AddTransitionCommand::undo()
 {
     if (m_remove) {
-        m_view->addTransition(m_info, m_track, m_params, m_refresh);
+        m_view->addTransition(m_info, m_track, m_params.element(), m_refresh);
     } else {
-        m_view->deleteTransition(m_info, m_track, m_params, m_refresh);
+        m_view->deleteTransition(m_info, m_track, m_params.element(), m_refresh);
     }
 }
 // virtual
@@ -172,13 +193,23 @@ void AddTransitionCommand::redo()
 {
     if (m_doIt) {
         if (m_remove) {
-            m_view->deleteTransition(m_info, m_track, m_params, m_refresh);
+            m_view->deleteTransition(m_info, m_track, m_params.element(), m_refresh);
         } else {
-            m_view->addTransition(m_info, m_track, m_params, m_refresh);
+            m_view->addTransition(m_info, m_track, m_params.element(), m_refresh);
         }
     }
     m_doIt = true;
 }
+// virtual
+int AddTransitionCommand::memoryCost() const
+{
+    return m_params.memoryCost();
+}
+// virtual
+void AddTransitionCommand::spill(UndoSpillFile *file)
+{
+    m_params.spill(file);
+}
 
 ChangeClipTypeCommand::ChangeClipTypeCommand(CustomTrackView *view, const ItemInfo &info, PlaylistState::ClipState state, PlaylistState::ClipState originalState, QUndoCommand *parent) :
     QUndoCommand(parent),
@@ -292,7 +323,7 @@ EditEffectCommand::EditEffectCommand(CustomTrackView *view, const int track, con
     m_view(view),
     m_track(track),
     m_oldeffect(oldeffect),
-    m_effect(effect),
+    m_effect(oldeffect, effect),
     m_pos(pos),
     m_stackPos(stackPos),
     m_doIt(doIt),
@@ -309,7 +340,7 @@ EditEffectCommand::EditEffectCommand(CustomTrackView *view, const int track, con
         effectName = i18n("effect");
     }
     setText(i18n("Edit effect %1", effectName));
-    if (m_effect.attribute(QStringLiteral("id")) == QLatin1String("pan_zoom")) {
+    if (effect.attribute(QStringLiteral("id")) == QLatin1String("pan_zoom")) {
         QString bg = EffectsList::parameter(effect, QStringLiteral("background"));
         QString oldBg = EffectsList::parameter(oldeffect, QStringLiteral("background"));
         if (bg != oldBg) {
@@ -338,23 +369,36 @@ bool EditEffectCommand::mergeWith(const QUndoCommand *other)
     if (m_pos != static_cast<const EditEffectCommand *>(other)->m_pos) {
         return false;
     }
-    m_effect = static_cast<const EditEffectCommand *>(other)->m_effect.cloneNode().toElement();
+    const EditEffectCommand *command = static_cast<const EditEffectCommand *>(other);
+    const QDomElement oldeffect = m_oldeffect.element();
+    m_effect = UndoXmlDelta(oldeffect, command->m_effect.apply(command->m_oldeffect.element()));
     return true;
 }
 // virtual
 void EditEffectCommand::undo()
 {
-    m_view->updateEffect(m_track, m_pos, m_oldeffect, true, m_replaceEffect, m_refreshMonitor, m_updateClip);
+    m_view->updateEffect(m_track, m_pos, m_oldeffect.element(), true, m_replaceEffect, m_refreshMonitor, m_updateClip);
 }
 // virtual
 void EditEffectCommand::redo()
 {
     if (m_doIt) {
-        m_view->updateEffect(m_track, m_pos, m_effect, m_refreshEffectStack, m_replaceEffect, m_refreshMonitor, m_updateClip);
+        m_view->updateEffect(m_track, m_pos, m_effect.apply(m_oldeffect.element()), m_refreshEffectStack, m_replaceEffect, m_refreshMonitor, m_updateClip);
     }
     m_doIt = true;
     m_refreshEffectStack = true;
 }
+// virtual
+int EditEffectCommand::memoryCost() const
+{
+    return m_oldeffect.memoryCost() + m_effect.memoryCost();
+}
+// virtual
+void EditEffectCommand::spill(UndoSpillFile *file)
+{
+    m_oldeffect.spill(file);
+    m_effect.spill(file);
+}
 
 EditGuideCommand::EditGuideCommand(CustomTrackView *view, const GenTime &oldPos, const QString &oldcomment, const GenTime &pos, const QString &comment, bool doIt, QUndoCommand *parent) :
     QUndoCommand(parent),
@@ -394,11 +438,11 @@ EditTransitionCommand::EditTransitionCommand(CustomTrackView *view, const int tr
     QUndoCommand(parent),
     m_view(view),
     m_track(track),
+    m_effect(oldeffect, effect),
     m_oldeffect(oldeffect),
     m_pos(pos),
     m_doIt(doIt)
 {
-    m_effect = effect.cloneNode().toElement();
     QString effectName;
     QDomElement namenode = effect.firstChildElement(QStringLiteral("name"));
     if (!namenode.isNull()) {
@@ -425,20 +469,34 @@ bool EditTransitionCommand::mergeWith(const QUndoCommand *other)
     if (m_pos != static_cast<const EditTransitionCommand *>(other)->m_pos) {
         return false;
     }
-    m_effect = static_cast<const EditTransitionCommand *>(other)->m_effect;
+    const EditTransitionCommand *command = static_cast<const EditTransitionCommand *>(other);
+    m_effect = UndoXmlDelta(m_oldeffect.element(), command->m_effect.apply(command->m_oldeffect.element()));
     return true;
 }
 // virtual
 void EditTransitionCommand::undo()
 {
-    m_view->updateTransition(m_track, m_pos, m_effect, m_oldeffect, m_doIt);
+    const QDomElement oldeffect = m_oldeffect.element();
+    m_view->updateTransition(m_track, m_pos, m_effect.apply(oldeffect), oldeffect, m_doIt);
 }
 // virtual
 void EditTransitionCommand::redo()
 {
-    m_view->updateTransition(m_track, m_pos, m_oldeffect, m_effect, m_doIt);
+    const QDomElement oldeffect = m_oldeffect.element();
+    m_view->updateTransition(m_track, m_pos, oldeffect, m_effect.apply(oldeffect), m_doIt);
     m_doIt = true;
 }
+// virtual
+int EditTransitionCommand::memoryCost() const
+{
+    return m_oldeffect.memoryCost() + m_effect.memoryCost();
+}
+// virtual
+void EditTransitionCommand::spill(UndoSpillFile *file)
+{
+    m_oldeffect.spill(file);
+    m_effect.spill(file);
+}
 
 GroupClipsCommand::GroupClipsCommand(CustomTrackView *view, const QList<ItemInfo> &clipInfos, const QList<ItemInfo> &transitionInfos, bool group, bool doIt, QUndoCommand *parent) :
     QUndoCommand(parent),
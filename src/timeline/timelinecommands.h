@@ -27,22 +27,28 @@
 #include <QDomElement>
 #include "definitions.h"
 #include "effectslist/effectslist.h"
+#include "doc/undopayload.h"
 class GenTime;
 class CustomTrackView;
 class Timeline;
 
-class AddEffectCommand : public QUndoCommand
+class AddEffectCommand : public QUndoCommand, public CompactUndoCommand
 {
 public:
     AddEffectCommand(CustomTrackView *view, const int track, const GenTime &pos, const QDomElement &effect, bool doIt, QUndoCommand *parent = nullptr);
     void undo() Q_DECL_OVERRIDE;
     void redo() Q_DECL_OVERRIDE;
+    int memoryCost() const Q_DECL_OVERRIDE;
+    void spill(UndoSpillFile *file) Q_DECL_OVERRIDE;
 private:
     CustomTrackView *m_view;
     int m_track;
-    QDomElement m_effect;
+    /** Added or deleted effect, compressed */
+    UndoPayload m_effect;
     GenTime m_pos;
     bool m_doIt;
+    /** @brief Adds the effect, and stores the effect index given by the clip */
+    void addEffect();
 };
 
 class AddTimelineClipCommand : public QUndoCommand
@@ -87,16 +93,19 @@ private:
     TrackInfo m_info;
 };
 
-class AddTransitionCommand : public QUndoCommand
+class AddTransitionCommand : public QUndoCommand, public CompactUndoCommand
 {
 public:
     AddTransitionCommand(CustomTrackView *view, const ItemInfo &info, int transitiontrack, const QDomElement &params, bool remove, bool doIt, QUndoCommand *parent = nullptr);
     void undo() Q_DECL_OVERRIDE;
     void redo() Q_DECL_OVERRIDE;
+    int memoryCost() const Q_DECL_OVERRIDE;
+    void spill(UndoSpillFile *file) Q_DECL_OVERRIDE;
 private:
     CustomTrackView *m_view;
     ItemInfo m_info;
-    QDomElement m_params;
+    /** Transition parameters, compressed */
+    UndoPayload m_params;
     int m_track;
     bool m_doIt;
     bool m_remove;
@@ -164,7 +173,7 @@ private:
     int m_newState;
 };
 
-class EditEffectCommand : public QUndoCommand
+class EditEffectCommand : public QUndoCommand, public CompactUndoCommand
 {
 public:
     EditEffectCommand(CustomTrackView *view, const int track, const GenTime &pos, const QDomElement &oldeffect, const QDomElement &effect, int stackPos, bool refreshEffectStack, bool updateClip, bool doIt, bool refreshMonitor, QUndoCommand *parent = nullptr);
@@ -172,11 +181,15 @@ public:
     bool mergeWith(const QUndoCommand *command) Q_DECL_OVERRIDE;
     void undo() Q_DECL_OVERRIDE;
     void redo() Q_DECL_OVERRIDE;
+    int memoryCost() const Q_DECL_OVERRIDE;
+    void spill(UndoSpillFile *file) Q_DECL_OVERRIDE;
 private:
     CustomTrackView *m_view;
     const int m_track;
-    QDomElement m_oldeffect;
-    QDomElement m_effect;
+    /** Effect before the edit, compressed */
+    UndoPayload m_oldeffect;
+    /** Changed parameters of the effect */
+    UndoXmlDelta m_effect;
     const GenTime m_pos;
     int m_stackPos;
     bool m_doIt;
@@ -201,7 +214,7 @@ private:
     bool m_doIt;
 };
 
-class EditTransitionCommand : public QUndoCommand
+class EditTransitionCommand : public QUndoCommand, public CompactUndoCommand
 {
 public:
     EditTransitionCommand(CustomTrackView *view, const int track, const GenTime &pos, const QDomElement &oldeffect, const QDomElement &effect, bool doIt, QUndoCommand *parent = nullptr);
@@ -209,11 +222,15 @@ public:
     bool mergeWith(const QUndoCommand *command) Q_DECL_OVERRIDE;
     void undo() Q_DECL_OVERRIDE;
     void redo() Q_DECL_OVERRIDE;
+    int memoryCost() const Q_DECL_OVERRIDE;
+    void spill(UndoSpillFile *file) Q_DECL_OVERRIDE;
 private:
     CustomTrackView *m_view;
     const int m_track;
-    QDomElement m_effect;
-    QDomElement m_oldeffect;
+    /** Changed parameters of the transition */
+    UndoXmlDelta m_effect;
+    /** Transition before the edit, compressed */
+    UndoPayload m_oldeffect;
     const GenTime m_pos;
     bool m_doIt;
 };
@@ -26,6 +26,7 @@
 #include "kdenlivesettings.h"
 #include "clip.h"
 #include "effectmanager.h"
+#include "decoderpool.h"
 
 #include "kdenlive_debug.h"
 #include <math.h>
@@ -35,7 +36,13 @@ Track::Track(int index, const QList<QAction *> &actions, Mlt::Playlist &playlist
     type(trackType),
     trackHeader(nullptr),
     m_index(index),
-    m_playlist(playlist)
+    m_playlist(playlist),
+    m_pool(nullptr),
+    m_transactionDepth(0),
+    m_transactionPlaytime(0),
+    m_pendingConsolidate(false),
+    m_pendingDuration(false),
+    m_pendingSharingCheck(false)
 {
     QString playlist_name = playlist.get("id");
     if (playlist_name != QLatin1String("black_track")) {
@@ -70,7 +77,7 @@ qreal Track::length() {
 }
 
 // basic clip operations
-bool Track::add(qreal t, Mlt::Producer *parent, qreal tcut, qreal dtcut, PlaylistState::ClipState state, bool duplicate, TimelineMode::EditMode mode)
+bool Track::add(int pos, Mlt::Producer *parent, int in, int out, PlaylistState::ClipState state, bool duplicate, TimelineMode::EditMode mode)
 {
     Mlt::Producer *cut = nullptr;
     if (parent == nullptr || !parent->is_valid()) {
@@ -81,118 +88,141 @@ bool Track::add(qreal t, Mlt::Producer *parent, qreal tcut, qreal dtcut, Playlis
         prodCopy->set("video_index", -1);
         prodCopy->set("audio_index", -1);
         prodCopy->set("kdenlive:binid", parent->get("id"));
-        cut = prodCopy->cut(frame(tcut), frame(dtcut) - 1);
+        cut = prodCopy->cut(in, out - 1);
     } else if (duplicate && state != PlaylistState::VideoOnly) {
-        QScopedPointer<Mlt::Producer> newProd(clipProducer(parent, state));
-        cut = newProd->cut(frame(tcut), frame(dtcut) - 1);
+        QScopedPointer<Mlt::Producer> newProd(clipProducer(parent, state, false, pos, pos + out - in));
+        cut = newProd->cut(in, out - 1);
     }
     else {
-        cut = parent->cut(frame(tcut), frame(dtcut) - 1);
+        cut = parent->cut(in, out - 1);
     }
     if (parent->is_cut()) {
         Clip(*cut).addEffects(*parent);
     }
-    m_playlist.lock();
-    bool result = doAdd(t, cut, mode);
-    m_playlist.unlock();
+    lockPlaylist();
+    bool result = doAdd(pos, cut, mode);
+    unlockPlaylist();
+    checkSharing();
     delete cut;
     return result;
 }
 
-bool Track::doAdd(qreal t, Mlt::Producer *cut, TimelineMode::EditMode mode)
+bool Track::doAdd(int pos, Mlt::Producer *cut, TimelineMode::EditMode mode)
 {
-    int pos = frame(t);
+    int length = cut->get_playtime();
+    // Adding over a blank moves no other clip, so the sharing index can be updated in place
+    bool inPlace = pos >= m_playlist.get_playtime();
+    if (!inPlace && mode != TimelineMode::InsertEdit) {
+        int ix = m_playlist.get_clip_index_at(pos);
+        inPlace = m_playlist.is_blank(ix) && m_playlist.clip_start(ix) + m_playlist.clip_length(ix) >= pos + length;
+    }
     if (pos < m_playlist.get_playtime() && mode == TimelineMode::InsertEdit) {
         m_playlist.split_at(pos);
     }
-    m_playlist.consolidate_blanks();
+    consolidateBlanks();
     if (m_playlist.insert_at(pos, cut, 1) == m_playlist.count() - 1) {
-        emit newTrackDuration(m_playlist.get_playtime());
+        notifyDuration();
+    }
+    if (m_pool) {
+        if (inPlace) {
+            m_pool->clipAdded(m_index, cut->parent(), pos, pos + length);
+        } else {
+            m_pool->clipsMoved(m_index);
+        }
     }
     return true;
 }
 
-bool Track::move(qreal start, qreal end, TimelineMode::EditMode mode)
+bool Track::move(int start, int end, TimelineMode::EditMode mode)
 {
-    int pos = frame(start);
-    m_playlist.lock();
-    int clipIndex = m_playlist.get_clip_index_at(pos);
+    lockPlaylist();
+    int clipIndex = m_playlist.get_clip_index_at(start);
     bool durationChanged = false;
     if (clipIndex == m_playlist.count() - 1) {
 	durationChanged = true;
     }
+    int clipStart = m_playlist.clip_start(clipIndex);
     QScopedPointer <Mlt::Producer> clipProducer(m_playlist.replace_with_blank(clipIndex));
     if (!clipProducer || clipProducer->is_blank()) {
         qCDebug(KDENLIVE_LOG) << "// Cannot get clip at index: "<<clipIndex<<" / "<< start;
-        m_playlist.unlock();
+        unlockPlaylist();
         return false;
     }
-    m_playlist.consolidate_blanks();
+    if (m_pool) {
+        m_pool->clipRemoved(m_index, clipProducer->parent(), clipStart);
+    }
+    consolidateBlanks();
     if (end >= m_playlist.get_playtime()) {
 	// Clip is inserted at the end of track, duration change event handled in doAdd()
 	durationChanged = false;
     }
     bool result = doAdd(end, clipProducer.data(), mode);
-    m_playlist.unlock();
+    unlockPlaylist();
+    checkSharing();
     if (durationChanged) {
-	emit newTrackDuration(m_playlist.get_playtime());
+	notifyDuration();
     }
     return result;
 }
 
-bool Track::isLastClip(qreal t)
+bool Track::isLastClip(int pos)
 {
-    int clipIndex = m_playlist.get_clip_index_at(frame(t));
+    int clipIndex = m_playlist.get_clip_index_at(pos);
     if (clipIndex >= m_playlist.count() - 1) {
 	return true;
     }
     return false;
 }
 
-bool Track::del(qreal t, bool checkDuration)
+bool Track::del(int pos, bool checkDuration)
 {
-    m_playlist.lock();
+    lockPlaylist();
     bool durationChanged = false;
-    int pos = frame(t);
     int ix = m_playlist.get_clip_index_at(pos);
     if (ix == m_playlist.count() - 1) {
 	durationChanged = true;
     }
+    int clipStart = m_playlist.clip_start(ix);
     Mlt::Producer *clip = m_playlist.replace_with_blank(ix);
     if (clip) {
+        if (m_pool) {
+            m_pool->clipRemoved(m_index, clip->parent(), clipStart);
+        }
         delete clip;
     } else {
         qWarning("Error deleting clip at %d, tk: %d", pos, m_index);
-        m_playlist.unlock();
+        unlockPlaylist();
         return false;
     }
-    m_playlist.consolidate_blanks();
-    m_playlist.unlock();
+    consolidateBlanks();
+    unlockPlaylist();
     if (durationChanged && checkDuration) {
-        emit newTrackDuration(m_playlist.get_playtime());
+        notifyDuration();
     }
     return true;
 }
 
-bool Track::del(qreal t, qreal dt)
+bool Track::delRegion(int pos, int length)
 {
-    m_playlist.lock();
-    m_playlist.insert_blank(m_playlist.remove_region(frame(t), frame(dt) + 1), frame(dt));
-    m_playlist.consolidate_blanks();
-    m_playlist.unlock();
+    lockPlaylist();
+    m_playlist.insert_blank(m_playlist.remove_region(pos, length + 1), length);
+    consolidateBlanks();
+    unlockPlaylist();
+    clipsMoved();
     return true;
 }
 
-bool Track::resize(qreal t, qreal dt, bool end)
+bool Track::resize(int pos, int delta, bool end)
 {
-    m_playlist.lock();
-    int startFrame = frame(t);
+    lockPlaylist();
+    flushBlanks();
+    int startFrame = pos;
     int index = m_playlist.get_clip_index_at(startFrame);
-    int length = frame(dt);
+    int length = delta;
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(index));
     if (clip == nullptr || clip->is_blank()) {
-        qWarning("Can't resize clip at %f", t);
-	m_playlist.unlock();
+        qWarning("Can't resize clip at %d", pos);
+	unlockPlaylist();
         return false;
     }
 
@@ -217,7 +247,7 @@ bool Track::resize(qreal t, qreal dt, bool end)
 
     if (m_playlist.resize_clip(index, in, out)) {
         qWarning("MLT resize failed : clip %d from %d to %d", index, in, out);
-        m_playlist.unlock();
+        unlockPlaylist();
         return false;
     }
 
@@ -225,9 +255,10 @@ bool Track::resize(qreal t, qreal dt, bool end)
     if (end) {
         ++index;
         if (index > m_playlist.count() - 1) {
-            m_playlist.unlock();
+            unlockPlaylist();
+            clipsMoved();
             // this is the last clip in track, check tracks length to adjust black track and project duration
-            emit newTrackDuration(m_playlist.get_playtime());
+            notifyDuration();
             return true;
         }
         length = -length;
@@ -251,27 +282,28 @@ bool Track::resize(qreal t, qreal dt, bool end)
         }
     }
 
-    m_playlist.consolidate_blanks();
-    m_playlist.unlock();
+    consolidateBlanks();
+    unlockPlaylist();
+    clipsMoved();
     return true;
 }
 
-bool Track::cut(qreal t)
+bool Track::cut(int pos)
 {
-    int pos = frame(t);
-    m_playlist.lock();
+    lockPlaylist();
     int index = m_playlist.get_clip_index_at(pos);
     if (m_playlist.is_blank(index)) {
 	qCDebug(KDENLIVE_LOG)<<" - - --Warning, clip is blank at: "<<index;
-        m_playlist.unlock();
+        unlockPlaylist();
         return false;
     }
     if (m_playlist.split(index, pos - m_playlist.clip_start(index) - 1)) {
         qWarning("MLT split failed");
-        m_playlist.unlock();
+        unlockPlaylist();
         return false;
     }
-    m_playlist.unlock();
+    unlockPlaylist();
+    clipsMoved();
     QScopedPointer<Mlt::Producer> clip1(m_playlist.get_clip(index));
     QScopedPointer<Mlt::Producer> clip2(m_playlist.get_clip(index + 1));
     qCDebug(KDENLIVE_LOG)<<"CLIP CUT ID: "<<clip1->get("id")<<" / "<<clip1->parent().get("id");
@@ -312,11 +344,18 @@ void Track::replaceId(const QString &id)
         if (m_playlist.is_blank(i)) continue;
         QScopedPointer<Mlt::Producer> p(m_playlist.get_clip(i));
         QString current = p->parent().get("id");
-	if (current == id || current == idForTrack || current == idForAudioTrack || current == idForVideoTrack || current.startsWith("slowmotion:" + id + QLatin1Char(':'))) {
+        QString duplicateBinId;
+        bool audioOnly;
+        // Duplicates shared with other tracks also need replacement
+        bool isDuplicate = DecoderPool::duplicateInfo(p->parent(), duplicateBinId, audioOnly) && duplicateBinId == id;
+	if (current == id || current == idForTrack || current == idForAudioTrack || current == idForVideoTrack || isDuplicate || current.startsWith("slowmotion:" + id + QLatin1Char(':'))) {
         current.prepend(QLatin1Char('#'));
 	    p->parent().set("id", current.toUtf8().constData());
 	}
     }
+    if (m_pool) {
+        m_pool->invalidateTrack(m_index);
+    }
 }
 
 QList<Track::SlowmoInfo> Track::getSlowmotionInfos(const QString &id)
@@ -378,6 +417,14 @@ QList<ItemInfo> Track::replaceAll(const QString &id, Mlt::Producer *original, Ml
 	}
 	current.remove(0, 1);
         Mlt::Producer *cut = nullptr;
+        if (!idForAudioTrack.isEmpty()) {
+            // Map duplicates shared from another track to this track's duplicates
+            QString duplicateBinId;
+            bool audioOnly;
+            if (DecoderPool::duplicateInfo(p->parent(), duplicateBinId, audioOnly) && duplicateBinId == id) {
+                current = audioOnly ? idForAudioTrack : idForTrack;
+            }
+        }
 	if (current.startsWith("slowmotion:" + id + QLatin1Char(':'))) {
 	      // Slowmotion producer, just update resource
           Mlt::Producer *slowProd = newSlowMos.value(current.section(QLatin1Char(':'), 2));
@@ -409,6 +456,7 @@ QList<ItemInfo> Track::replaceAll(const QString &id, Mlt::Producer *original, Ml
                 if (idForTrack.contains(QLatin1Char('_'))) {
                     trackProducer = Clip(*original).clone();
                     trackProducer->set("id", idForTrack.toUtf8().constData());
+                    DecoderPool::setDuplicateInfo(*trackProducer, id, false, m_playlist.get("id"));
                 }
             }
             cut = trackProducer->cut(p->get_in(), p->get_out());
@@ -441,13 +489,14 @@ QList<ItemInfo> Track::replaceAll(const QString &id, Mlt::Producer *original, Ml
     }
     delete trackProducer;
     delete audioTrackProducer;
+    clipsMoved();
     return replaced;
 }
 
 //TODO: cut: checkSlowMotionProducer
-bool Track::replace(qreal t, Mlt::Producer *prod, PlaylistState::ClipState state, PlaylistState::ClipState originalState) {
-    m_playlist.lock();
-    int index = m_playlist.get_clip_index_at(frame(t));
+bool Track::replace(int pos, Mlt::Producer *prod, PlaylistState::ClipState state, PlaylistState::ClipState originalState) {
+    lockPlaylist();
+    int index = m_playlist.get_clip_index_at(pos);
     Mlt::Producer *cut;
     QScopedPointer <Mlt::Producer> orig(m_playlist.replace_with_blank(index));
     QString service = prod->get("mlt_service");
@@ -469,9 +518,10 @@ bool Track::replace(qreal t, Mlt::Producer *prod, PlaylistState::ClipState state
         cut = prod->cut(orig->get_in(), orig->get_out());
     }
     Clip(*cut).addEffects(*orig);
-    bool ok = m_playlist.insert_at(frame(t), cut, 1) >= 0;
+    bool ok = m_playlist.insert_at(pos, cut, 1) >= 0;
     delete cut;
-    m_playlist.unlock();
+    unlockPlaylist();
+    clipsMoved();
     return ok;
 }
 
@@ -536,14 +586,22 @@ const QList<ItemInfo> Track::updateEffects(const QString &id, Mlt::Producer *ori
     return Mlt::0;
 }*/
 
-Mlt::Producer *Track::clipProducer(Mlt::Producer *parent, PlaylistState::ClipState state, bool forceCreation) {
+Mlt::Producer *Track::clipProducer(Mlt::Producer *parent, PlaylistState::ClipState state, bool forceCreation, int start, int end) {
     QString service = parent->parent().get("mlt_service");
     QString originalId = parent->parent().get("id");
     if (!needsDuplicate(service) || state == PlaylistState::VideoOnly || originalId.endsWith(QLatin1String("_video"))) {
         // Don't clone producer for track if it has no audio
         return new Mlt::Producer(*parent);
     }
-    originalId = originalId.section(QLatin1Char('_'), 0, 0);
+    QString duplicateBinId;
+    bool audioOnly;
+    if (DecoderPool::duplicateInfo(parent->parent(), duplicateBinId, audioOnly)) {
+        // Adding a clip taken from another track
+        originalId = duplicateBinId;
+    } else {
+        // Duplicates of projects saved before they stored their bin id
+        originalId = originalId.section(QLatin1Char('_'), 0, 0);
+    }
     QString idForTrack = originalId + QLatin1Char('_') + m_playlist.get("id");
     if (state == PlaylistState::AudioOnly) {
         idForTrack.append(QStringLiteral("_audio"));
@@ -556,15 +614,86 @@ Mlt::Producer *Track::clipProducer(Mlt::Producer *parent, PlaylistState::ClipSta
                 return new Mlt::Producer(p->parent());
             }
         }
+        if (m_pool && start >= 0) {
+            // Try to reuse a duplicate from another track that is not playing at the same time
+            Mlt::Producer *shared = m_pool->acquire(originalId, state == PlaylistState::AudioOnly, m_index, start, end);
+            if (shared && m_pool->isUsedElsewhere(*shared, m_index, start, end)) {
+                // Two tracks must never read the same producer at the same time
+                qCWarning(KDENLIVE_LOG) << "// Refusing shared producer" << shared->get("id") << "already used during" << start << end;
+                delete shared;
+                shared = nullptr;
+            }
+            if (shared) {
+                return shared;
+            }
+        }
     }
     Mlt::Producer *prod = Clip(parent->parent()).clone();
     prod->set("id", idForTrack.toUtf8().constData());
+    DecoderPool::setDuplicateInfo(*prod, originalId, state == PlaylistState::AudioOnly, m_playlist.get("id"));
     if (state == PlaylistState::AudioOnly) {
         prod->set("video_index", -1);
     }
     return prod;
 }
 
+void Track::setDecoderPool(DecoderPool *pool)
+{
+    m_pool = pool;
+    if (m_pool) {
+        m_pool->invalidateTrack(m_index);
+    }
+}
+
+bool Track::useOwnDuplicate(int pos)
+{
+    lockPlaylist();
+    int index = m_playlist.get_clip_index_at(pos);
+    QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(index));
+    if (!clip || clip->is_blank()) {
+        unlockPlaylist();
+        return false;
+    }
+    QString binId;
+    bool audioOnly;
+    if (!DecoderPool::duplicateInfo(clip->parent(), binId, audioOnly)) {
+        unlockPlaylist();
+        return false;
+    }
+    QString idForTrack = binId + QLatin1Char('_') + m_playlist.get("id");
+    if (audioOnly) {
+        idForTrack.append(QStringLiteral("_audio"));
+    }
+    if (idForTrack == clip->parent().get("id")) {
+        unlockPlaylist();
+        return false;
+    }
+    QScopedPointer<Mlt::Producer> prod;
+    for (int i = 0; i < m_playlist.count(); i++) {
+        if (m_playlist.is_blank(i)) continue;
+        QScopedPointer<Mlt::Producer> p(m_playlist.get_clip(i));
+        if (QString(p->parent().get("id")) == idForTrack) {
+            prod.reset(new Mlt::Producer(p->parent()));
+            break;
+        }
+    }
+    if (!prod) {
+        prod.reset(Clip(clip->parent()).clone());
+        prod->set("id", idForTrack.toUtf8().constData());
+        DecoderPool::setDuplicateInfo(*prod, binId, audioOnly, m_playlist.get("id"));
+        if (audioOnly) {
+            prod->set("video_index", -1);
+        }
+    }
+    Mlt::Producer *cut = prod->cut(clip->get_in(), clip->get_out());
+    Clip(*cut).addEffects(*clip);
+    m_playlist.remove(index);
+    m_playlist.insert(*cut, index);
+    delete cut;
+    unlockPlaylist();
+    return true;
+}
+
 bool Track::hasAudio() 
 {
     for (int i = 0; i < m_playlist.count(); i++) {
@@ -712,24 +841,24 @@ int Track::changeClipSpeed(const ItemInfo &info, const ItemInfo &speedIndependan
     int startPos = info.startPos.frames(fps());
     int clipIndex = m_playlist.get_clip_index_at(startPos);
     int clipLength = m_playlist.clip_length(clipIndex);
-    m_playlist.lock();
+    lockPlaylist();
     QScopedPointer<Mlt::Producer> original(m_playlist.get_clip(clipIndex));
     if (original == nullptr) {
         qCDebug(KDENLIVE_LOG)<<"// No clip to apply effect";
-        m_playlist.unlock();
+        unlockPlaylist();
         return -1;
     }
     if (!original->is_valid() || original->is_blank()) {
         // invalid clip
         qCDebug(KDENLIVE_LOG)<<"// Invalid clip to apply effect";
-        m_playlist.unlock();
+        unlockPlaylist();
         return -1;
     }
     Mlt::Producer clipparent = original->parent();
     if (!clipparent.is_valid() || clipparent.is_blank()) {
         // invalid clip
         qCDebug(KDENLIVE_LOG)<<"// Invalid parent to apply effect";
-        m_playlist.unlock();
+        unlockPlaylist();
         return -1;
     }
     QLocale locale;
@@ -753,7 +882,7 @@ int Track::changeClipSpeed(const ItemInfo &info, const ItemInfo &speedIndependan
                 if (prod == nullptr) {
                     // error, abort
                     qCDebug(KDENLIVE_LOG)<<"++++ FAILED TO CREATE SLOWMO PROD";
-                    m_playlist.unlock();
+                    unlockPlaylist();
                     return -1;
                 }
 	    }
@@ -790,17 +919,17 @@ int Track::changeClipSpeed(const ItemInfo &info, const ItemInfo &speedIndependan
                 if (prod == nullptr) {
                     // error, abort
                     qCDebug(KDENLIVE_LOG)<<"++++ FAILED TO CREATE SLOWMO PROD";
-                    m_playlist.unlock();
+                    unlockPlaylist();
                     return -1;
                 }
             }
 
-	    int originalStart = (int)(speedIndependantInfo.cropStart.frames(fps()));
+	    int originalStart = speedIndependantInfo.cropStart.frame(fps());
 	    if (clipIndex + 1 < m_playlist.count() && (info.startPos + speedIndependantInfo.cropDuration).frames(fps()) > blankEnd) {
 		GenTime maxLength = GenTime(blankEnd, fps()) - info.startPos;
 		cut = prod->cut(originalStart, (int)(originalStart + maxLength.frames(fps()) - 1));
 	    } else {
-		cut = prod->cut(originalStart, (int)(originalStart + speedIndependantInfo.cropDuration.frames(fps())) - 1);
+		cut = prod->cut(originalStart, originalStart + speedIndependantInfo.cropDuration.frame(fps()) - 1);
 	    }
 
 	    // move all effects to the correct producer
@@ -816,7 +945,7 @@ int Track::changeClipSpeed(const ItemInfo &info, const ItemInfo &speedIndependan
             if (prod == nullptr) {
                 // error, abort
                 qCDebug(KDENLIVE_LOG)<<"++++ FAILED TO CREATE SLOWMO PROD";
-                m_playlist.unlock();
+                unlockPlaylist();
                 return -1;
             }
         }
@@ -858,7 +987,8 @@ int Track::changeClipSpeed(const ItemInfo &info, const ItemInfo &speedIndependan
             delete prod;
     }
     //Do not delete prod, it is now stored in the slowmotion producers list
-    m_playlist.unlock();
+    unlockPlaylist();
+    clipsMoved();
     if (clipIndex + 1 == m_playlist.count()) {
         // We changed the speed of last clip in playlist, check track length
         emit newTrackDuration(m_playlist.get_playtime());
@@ -871,6 +1001,100 @@ int Track::index() const
     return m_index;
 }
 
+void Track::beginTransaction()
+{
+    if (m_transactionDepth++ == 0) {
+        m_transactionPlaytime = m_playlist.get_playtime();
+        m_pendingConsolidate = false;
+        m_pendingDuration = false;
+    }
+}
+
+bool Track::endTransaction(bool notify)
+{
+    if (m_transactionDepth == 0) {
+        qCDebug(KDENLIVE_LOG) << "// Ending a track transaction that was not started, tk: " << m_index;
+        return false;
+    }
+    if (--m_transactionDepth > 0) {
+        return false;
+    }
+    m_playlist.lock();
+    flushBlanks();
+    m_playlist.unlock();
+    bool durationChanged = m_pendingDuration || m_playlist.get_playtime() != m_transactionPlaytime;
+    m_pendingDuration = false;
+    if (m_pendingSharingCheck) {
+        m_pendingSharingCheck = false;
+        m_pool->resolveConflicts();
+    }
+    if (durationChanged && notify) {
+        emit newTrackDuration(m_playlist.get_playtime());
+    }
+    return durationChanged;
+}
+
+bool Track::inTransaction() const
+{
+    return m_transactionDepth > 0;
+}
+
+void Track::lockPlaylist()
+{
+    m_playlist.lock();
+}
+
+void Track::unlockPlaylist()
+{
+    m_playlist.unlock();
+}
+
+void Track::consolidateBlanks()
+{
+    if (m_transactionDepth > 0) {
+        m_pendingConsolidate = true;
+        return;
+    }
+    m_playlist.consolidate_blanks();
+}
+
+void Track::flushBlanks()
+{
+    if (m_pendingConsolidate) {
+        m_playlist.consolidate_blanks();
+        m_pendingConsolidate = false;
+    }
+}
+
+void Track::clipsMoved()
+{
+    if (m_pool) {
+        m_pool->clipsMoved(m_index);
+        checkSharing();
+    }
+}
+
+void Track::checkSharing()
+{
+    if (!m_pool) {
+        return;
+    }
+    if (m_transactionDepth > 0) {
+        m_pendingSharingCheck = true;
+        return;
+    }
+    m_pool->resolveConflicts();
+}
+
+void Track::notifyDuration()
+{
+    if (m_transactionDepth > 0) {
+        m_pendingDuration = true;
+        return;
+    }
+    emit newTrackDuration(m_playlist.get_playtime());
+}
+
 
 int Track::spaceLength(int pos, bool fromBlankStart)
 {
@@ -899,9 +1123,8 @@ void Track::disableEffects(bool disable)
     }
 }
 
-bool Track::addEffect(double start, const EffectsParameterList &params)
+bool Track::addEffect(int pos, const EffectsParameterList &params)
 {
-    int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
     int duration = m_playlist.clip_length(clipIndex);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
@@ -921,9 +1144,8 @@ bool Track::addTrackEffect(const EffectsParameterList &params)
     return effect.addEffect(params, duration);
 }
 
-bool Track::editEffect(double start, const EffectsParameterList &params, bool replace, bool updateClip)
+bool Track::editEffect(int pos, const EffectsParameterList &params, bool replace, bool updateClip)
 {
-    int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
     int duration = m_playlist.clip_length(clipIndex);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
@@ -942,9 +1164,8 @@ bool Track::editTrackEffect(const EffectsParameterList &params, bool replace)
     return effect.editEffect(params, duration, replace);
 }
 
-bool Track::removeEffect(double start, int effectIndex, bool updateIndex)
+bool Track::removeEffect(int pos, int effectIndex, bool updateIndex)
 {
-    int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
     if (!clip) {
@@ -961,9 +1182,8 @@ bool Track::removeTrackEffect(int effectIndex, bool updateIndex)
     return effect.removeEffect(effectIndex, updateIndex);
 }
 
-bool Track::enableEffects(double start, const QList<int> &effectIndexes, bool disable)
+bool Track::enableEffects(int pos, const QList<int> &effectIndexes, bool disable)
 {
-    int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
     if (!clip) {
@@ -980,9 +1200,8 @@ bool Track::enableTrackEffects(const QList<int> &effectIndexes, bool disable, bo
     return effect.enableEffects(effectIndexes, disable, remember);
 }
 
-bool Track::moveEffect(double start, int oldPos, int newPos)
+bool Track::moveEffect(int pos, int oldPos, int newPos)
 {
-    int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
     if (!clip) {
@@ -1045,6 +1264,7 @@ bool Track::resize_in_out(int pos, int in, int out)
 {
     int ix = m_playlist.get_clip_index_at(pos);
     m_playlist.resize_clip(ix, in, out);
+    clipsMoved();
     return true;
 }
 
@@ -32,6 +32,7 @@
 #include <mlt++/MltProducer.h>
 
 class HeaderTrack;
+class DecoderPool;
 
 /** @brief Kdenlive timeline track, to access MLT playlist operations
  * The track as seen in the video editor is actually a playlist
@@ -98,41 +99,66 @@ public:
     /** @brief Returns MLT's track index */
     int index() const;
 
+    /** @brief Starts a batch of edits on the playlist
+     * Until the matching endTransaction() blank consolidation, track duration
+     * notifications and shared producer checks are deferred so that moving
+     * many clips does a single cleanup pass. Calls can be nested.
+     * The playlist is not kept locked: each edit locks it for its own
+     * duration, see lockPlaylist(). */
+    void beginTransaction();
+    /** @brief Ends a batch of edits, consolidates blanks once
+     * @param notify when true, emits newTrackDuration if the track length changed
+     * @return true if the track length changed during the transaction */
+    bool endTransaction(bool notify = true);
+    /** @brief Returns true if a batch of edits is in progress */
+    bool inTransaction() const;
+    /** @brief Locks the playlist for a direct edit
+     * Lock order: only one timeline service is locked at a time. A playlist lock
+     * is released before locking another playlist, the tractor or the transition
+     * field, so that no order can conflict with the consumer thread. */
+    void lockPlaylist();
+    void unlockPlaylist();
+
     /** @brief add a clip
-     * @param t is the time position to start the cut (in seconds)
+     * @param pos is the frame position to start the cut
      * @param cut is a MLT Producer cut (resource + in/out timecodes)
      * @param duplicate when true, we will create a copy of the clip if necessary
      * @param mode allow insert in non-blanks by replacing (mode=1) or pushing (mode=2) content
      * The playlist must be locked / unlocked before and after calling doAdd
      * @return true if success */
-    bool doAdd(qreal t, Mlt::Producer *cut, TimelineMode::EditMode mode);
-    bool add(qreal t, Mlt::Producer *parent, qreal tcut, qreal dtcut, PlaylistState::ClipState state, bool duplicate, TimelineMode::EditMode mode);
+    bool doAdd(int pos, Mlt::Producer *cut, TimelineMode::EditMode mode);
+    /** @brief add a clip extract
+     * @param pos is the frame position in playlist
+     * @param in is the first frame of the extract in parent
+     * @param out is the frame following the last frame of the extract in parent
+     * @return true if success */
+    bool add(int pos, Mlt::Producer *parent, int in, int out, PlaylistState::ClipState state, bool duplicate, TimelineMode::EditMode mode);
     /** @brief Move a clip in the track
-     * @param start where clip is present (in seconds);
+     * @param start where clip is present (in frames);
      * @param end wher the clip should be moved
      * @param mode allow insert in non-blanks by replacing (mode=1) or pushing (mode=2) content
      * @return true if success */
-    bool move(qreal start, qreal end, TimelineMode::EditMode mode = TimelineMode::NormalEdit);
+    bool move(int start, int end, TimelineMode::EditMode mode = TimelineMode::NormalEdit);
     /** @brief delete a clip
-     * @param time where clip is present (in seconds);
+     * @param pos where clip is present (in frames);
      * @return true if success */
-    bool del(qreal t, bool checkDuration = true);
+    bool del(int pos, bool checkDuration = true);
     /** delete a region
-     * @param t is the start,
-     * @param dt is the duration (in seconds)
+     * @param pos is the start,
+     * @param length is the duration (in frames)
      * @return true if success */
-    bool del(qreal t, qreal dt);
+    bool delRegion(int pos, int length);
     /** @brief change the clip length from start or end
-     * @param told is the current edge position,
-     * @param tnew is the target edge position (in seconds)
+     * @param pos is the clip start position,
+     * @param delta is the edge offset (in frames)
      * @param end precises if we move the end of the left clip (\em true)
      *  or the start of the right clip (\em false)
      * @return true if success */
-    bool resize(qreal told, qreal tnew, bool end);
+    bool resize(int pos, int delta, bool end);
     /** @brief split the clip at given position
-     * @param t is the cut time in playlist
+     * @param pos is the cut frame in playlist
      * @return true if success */
-    bool cut(qreal t);
+    bool cut(int pos);
     /** @brief prepends a dash to the clip's id to prepare for replacement */
     void replaceId(const QString &id);
     /** @brief replace all occurrences of a clip in the track with another resource
@@ -144,10 +170,10 @@ public:
     QList<ItemInfo> replaceAll(const QString &id, Mlt::Producer *original, Mlt::Producer *videoOnlyProducer, const QMap<QString, Mlt::Producer *> &newSlowMos);
     const QList<ItemInfo> updateEffects(const QString &id, Mlt::Producer *original);
     /** @brief replace an instance of a clip with another resource
-     * @param t is the clip time in playlist
+     * @param pos is the clip frame in playlist
      * @param prod is the replacement clip
      * @return true if success */
-    bool replace(qreal t, Mlt::Producer *prod, PlaylistState::ClipState state = PlaylistState::Original, PlaylistState::ClipState originalState = PlaylistState::Original);
+    bool replace(int pos, Mlt::Producer *prod, PlaylistState::ClipState state = PlaylistState::Original, PlaylistState::ClipState originalState = PlaylistState::Original);
     /** @brief look for a clip having a given property value
      * @param name is the property name
      * @param value is the searched value
@@ -159,8 +185,14 @@ public:
      * @param parent is the source media
      * @param state is for Normal, Audio only or Video only
      * @param forceCreation if true, we do not attempt to re-use existing track producer but recreate it
+     * @param start, end the frames where the producer will be used, allows sharing a duplicate with other tracks
      * @return producer cut for this track */
-    Mlt::Producer *clipProducer(Mlt::Producer *parent, PlaylistState::ClipState state, bool forceCreation = false);
+    Mlt::Producer *clipProducer(Mlt::Producer *parent, PlaylistState::ClipState state, bool forceCreation = false, int start = -1, int end = -1);
+    /** @brief Sets the pool used to share producer duplicates with other tracks */
+    void setDecoderPool(DecoderPool *pool);
+    /** @brief Makes the clip at pos use the duplicate producer owned by this track instead of a shared one
+     * @return true if the clip was changed */
+    bool useOwnDuplicate(int pos);
     /** @brief Changes the speed of a clip in MLT's playlist.
     *
     * It creates a new "framebuffer" producer, which must have its "resource"
@@ -195,17 +227,17 @@ public:
     int spaceLength(int pos, bool fromBlankStart);
     /** @brief Dis/enable all effects on this track. */
     void disableEffects(bool disable);
-    /** @brief Returns true if position is on last clip or beyond track length. */
-    bool isLastClip(qreal t);
-    bool addEffect(double start, const EffectsParameterList &params);
+    /** @brief Returns true if frame position is on last clip or beyond track length. */
+    bool isLastClip(int pos);
+    bool addEffect(int pos, const EffectsParameterList &params);
     bool addTrackEffect(const EffectsParameterList &params);
-    bool editEffect(double start, const EffectsParameterList &params, bool replace, bool updateClip = true);
+    bool editEffect(int pos, const EffectsParameterList &params, bool replace, bool updateClip = true);
     bool editTrackEffect(const EffectsParameterList &params, bool replace);
-    bool removeEffect(double start, int effectIndex, bool updateIndex);
+    bool removeEffect(int pos, int effectIndex, bool updateIndex);
     bool removeTrackEffect(int effectIndex, bool updateIndex);
-    bool enableEffects(double start, const QList<int> &effectIndexes, bool disable);
+    bool enableEffects(int pos, const QList<int> &effectIndexes, bool disable);
     bool enableTrackEffects(const QList<int> &effectIndexes, bool disable, bool remember = false);
-    bool moveEffect(double start, int oldPos, int newPos);
+    bool moveEffect(int pos, int oldPos, int newPos);
     bool moveTrackEffect(int oldPos, int newPos);
     QList<QPoint> visibleClips();
     bool resize_in_out(int pos, int in, int out);
@@ -225,6 +257,28 @@ private:
     int m_index;
     /** MLT playlist behind the scene */
     Mlt::Playlist m_playlist;
+    /** Pool sharing producer duplicates between tracks */
+    DecoderPool *m_pool;
+    /** Nesting level of edit transactions, 0 when edits are applied immediately */
+    int m_transactionDepth;
+    /** Playlist length when the outermost transaction started */
+    int m_transactionPlaytime;
+    /** True if a blank consolidation was deferred by a transaction */
+    bool m_pendingConsolidate;
+    /** True if a duration notification was deferred by a transaction */
+    bool m_pendingDuration;
+    /** True if a shared producers check was deferred by a transaction */
+    bool m_pendingSharingCheck;
+    /** @brief Merges adjacent blanks, or defers it until the end of the transaction */
+    void consolidateBlanks();
+    /** @brief Performs a deferred blank consolidation, needed before blank length arithmetic */
+    void flushBlanks();
+    /** @brief Emits newTrackDuration, or defers it until the end of the transaction */
+    void notifyDuration();
+    /** @brief Tells the decoder pool that clips were moved or replaced on this track, then checks the shared producers */
+    void clipsMoved();
+    /** @brief Moves clips that overlap another track's use of their shared producer, or defers it until the end of the transaction */
+    void checkSharing();
     /** @brief Returns true is this MLT service needs duplication to work on multiple tracks */
     bool needsDuplicate(const QString &service) const;
     void checkEffect(const QString effectName, int pos, int duration);
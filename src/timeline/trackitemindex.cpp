@@ -0,0 +1,137 @@
+/*
+ * Kdenlive timeline per track item index
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "trackitemindex.h"
+
+TrackItemIndex::TrackItemIndex() :
+    m_maxLength(0)
+{
+}
+
+int TrackItemIndex::lowerBound(int frame) const
+{
+    int low = 0;
+    int high = m_entries.count();
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (m_entries.at(mid).start < frame) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void TrackItemIndex::insert(AbstractClipItem *item, int start, int end)
+{
+    Entry entry;
+    entry.start = start;
+    entry.end = qMax(start, end);
+    entry.item = item;
+    m_entries.insert(lowerBound(start), entry);
+    m_maxLength = qMax(m_maxLength, entry.end - entry.start);
+}
+
+bool TrackItemIndex::remove(AbstractClipItem *item, int start)
+{
+    for (int i = lowerBound(start); i < m_entries.count() && m_entries.at(i).start == start; ++i) {
+        if (m_entries.at(i).item == item) {
+            m_entries.remove(i);
+            if (m_entries.isEmpty()) {
+                m_maxLength = 0;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void TrackItemIndex::clear()
+{
+    m_entries.clear();
+    m_maxLength = 0;
+}
+
+int TrackItemIndex::count() const
+{
+    return m_entries.count();
+}
+
+QList<AbstractClipItem *> TrackItemIndex::items(int start, int end) const
+{
+    QList<AbstractClipItem *> result;
+    if (end <= start) {
+        end = start + 1;
+    }
+    // Only items starting less than m_maxLength frames before start can reach it
+    for (int i = lowerBound(start - m_maxLength); i < m_entries.count(); ++i) {
+        const Entry &entry = m_entries.at(i);
+        if (entry.start >= end) {
+            break;
+        }
+        if (entry.end > start) {
+            result << entry.item;
+        }
+    }
+    return result;
+}
+
+AbstractClipItem *TrackItemIndex::itemAt(int frame) const
+{
+    for (int i = lowerBound(frame + 1) - 1; i >= 0; --i) {
+        const Entry &entry = m_entries.at(i);
+        if (entry.end > frame) {
+            return entry.item;
+        }
+        if (entry.start + m_maxLength <= frame) {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+int TrackItemIndex::previousEnd(int frame, const AbstractClipItem *exclude) const
+{
+    int best = 0;
+    for (int i = lowerBound(frame + 1) - 1; i >= 0; --i) {
+        const Entry &entry = m_entries.at(i);
+        if (entry.start + m_maxLength <= best) {
+            // No earlier item can end after best
+            break;
+        }
+        if (entry.item != exclude && entry.end <= frame && entry.end > best) {
+            best = entry.end;
+        }
+    }
+    return best;
+}
+
+int TrackItemIndex::nextStart(int frame, const AbstractClipItem *exclude) const
+{
+    for (int i = lowerBound(frame + 1); i < m_entries.count(); ++i) {
+        if (m_entries.at(i).item != exclude) {
+            return m_entries.at(i).start;
+        }
+    }
+    return -1;
+}
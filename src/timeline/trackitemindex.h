@@ -0,0 +1,72 @@
+/*
+ * Kdenlive timeline per track item index
+ * Copyright 2016 Kdenlive team <kdenlive@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TRACKITEMINDEX_H
+#define TRACKITEMINDEX_H
+
+#include <QList>
+#include <QVector>
+
+class AbstractClipItem;
+
+/** @brief Sorted index of the items (clips or transitions) of one timeline track
+ * Items are stored as [start, end[ frame intervals ordered by start position,
+ * so that position and range queries are answered by binary search instead of
+ * asking the graphics scene for colliding shapes.
+ */
+class TrackItemIndex
+{
+public:
+    TrackItemIndex();
+
+    /** @brief Adds an item covering frames [start, end[ */
+    void insert(AbstractClipItem *item, int start, int end);
+    /** @brief Removes an item that was inserted with the given start frame
+     * @return true if the item was found */
+    bool remove(AbstractClipItem *item, int start);
+    void clear();
+    int count() const;
+
+    /** @brief Returns the items intersecting frames [start, end[, ordered by position */
+    QList<AbstractClipItem *> items(int start, int end) const;
+    /** @brief Returns the first item covering frame, or nullptr */
+    AbstractClipItem *itemAt(int frame) const;
+    /** @brief Returns the end of the closest item ending before or at frame (0 if none) */
+    int previousEnd(int frame, const AbstractClipItem *exclude = nullptr) const;
+    /** @brief Returns the start of the closest item starting after frame (-1 if none) */
+    int nextStart(int frame, const AbstractClipItem *exclude = nullptr) const;
+
+private:
+    struct Entry {
+        int start;
+        int end;
+        AbstractClipItem *item;
+    };
+    /** Entries sorted by start frame */
+    QVector<Entry> m_entries;
+    /** Upper bound of the items length, used to bound backward scans when items overlap */
+    int m_maxLength;
+    /** @brief Returns the index of the first entry starting at or after frame */
+    int lowerBound(int frame) const;
+};
+
+#endif
@@ -281,12 +281,10 @@ QVariant Transition::itemChange(GraphicsItemChange change, const QVariant &value
         newPos.setY(posForTrack(newTrack) + itemOffset());
 
         // Only one clip is moving
-        QRectF sceneShape = rect();
-        sceneShape.translate(newPos);
-        QList<QGraphicsItem *> items;
+        const int length = (int) cropDuration().frames(m_fps);
         // TODO: manage transitions in OVERWRITE MODE
         //if (projectScene()->editMode() == NORMALEDIT)
-        items = scene->items(sceneShape, Qt::IntersectsItemShape);
+        QList<AbstractClipItem *> items = scene->indexedItems(type(), newTrack, (int) newPos.x(), (int) newPos.x() + length);
         items.removeAll(this);
 
         bool forwardMove = newPos.x() > pos().x();
@@ -295,46 +293,38 @@ QVariant Transition::itemChange(GraphicsItemChange change, const QVariant &value
                 if (!items.at(i)->isEnabled()) {
                     continue;
                 }
-                if (items.at(i)->type() == type()) {
-                    int offset = 0;
-                    // Collision!
-                    QPointF otherPos = items.at(i)->pos();
-                    if ((int) otherPos.y() != (int) pos().y()) {
-                        return pos();
-                    }
+                int offset = 0;
+                // Collision!
+                if (newTrack != track()) {
+                    return pos();
+                }
+                if (forwardMove) {
+                    offset = qMax(offset, (int)(newPos.x() - (items.at(i)->startPos() - cropDuration()).frames(m_fps)));
+                } else {
+                    offset = qMax(offset, (int)(items.at(i)->endPos().frames(m_fps) - newPos.x()));
+                }
+
+                if (offset > 0) {
                     if (forwardMove) {
-                        offset = qMax(offset, (int)(newPos.x() - (static_cast < AbstractClipItem * >(items.at(i))->startPos() - cropDuration()).frames(m_fps)));
+                        newPos.setX(newPos.x() - offset);
                     } else {
-                        offset = qMax(offset, (int)((static_cast < AbstractClipItem * >(items.at(i))->endPos().frames(m_fps)) - newPos.x()));
+                        newPos.setX(newPos.x() + offset);
                     }
-
-                    if (offset > 0) {
-                        if (forwardMove) {
-                            sceneShape.translate(QPointF(-offset, 0));
-                            newPos.setX(newPos.x() - offset);
-                        } else {
-                            sceneShape.translate(QPointF(offset, 0));
-                            newPos.setX(newPos.x() + offset);
-                        }
-                        QList<QGraphicsItem *> subitems = scene->items(sceneShape, Qt::IntersectsItemShape);
-                        subitems.removeAll(this);
-                        for (int j = 0; j < subitems.count(); ++j) {
-                            if (!subitems.at(j)->isEnabled()) {
-                                continue;
-                            }
-                            if (subitems.at(j)->type() == type()) {
-                                // move was not successful, revert to previous pos
-                                m_info.startPos = GenTime((int) pos().x(), m_fps);
-                                return pos();
-                            }
+                    QList<AbstractClipItem *> subitems = scene->indexedItems(type(), newTrack, (int) newPos.x(), (int) newPos.x() + length);
+                    subitems.removeAll(this);
+                    for (int j = 0; j < subitems.count(); ++j) {
+                        if (subitems.at(j)->isEnabled()) {
+                            // move was not successful, revert to previous pos
+                            m_info.startPos = GenTime((int) pos().x(), m_fps);
+                            return pos();
                         }
                     }
+                }
 
-                    m_info.track = newTrack;
-                    m_info.startPos = GenTime((int) newPos.x(), m_fps);
+                m_info.track = newTrack;
+                m_info.startPos = GenTime((int) newPos.x(), m_fps);
 
-                    return newPos;
-                }
+                return newPos;
             }
         }
 
@@ -343,7 +333,7 @@ QVariant Transition::itemChange(GraphicsItemChange change, const QVariant &value
         ////qCDebug(KDENLIVE_LOG)<<"// ITEM NEW POS: "<<newPos.x()<<", mapped: "<<mapToScene(newPos.x(), 0).x();
         return newPos;
     }
-    return QGraphicsItem::itemChange(change, value);
+    return AbstractClipItem::itemChange(change, value);
 }
 
 OperationType Transition::operationMode(const QPointF &pos, Qt::KeyboardModifiers)
@@ -0,0 +1,183 @@
+/*
+Copyright (C) 2016 Kdenlive team <kdenlive@kde.org>
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+
+#include "../src/lib/audio/fftTools.h"
+
+namespace Legacy {
+// The former FFTTools::fftNormalized(), for comparison
+class FFT
+{
+public:
+    ~FFT()
+    {
+        QHash<QString, kiss_fftr_cfg>::iterator i;
+        for (i = m_fftCfgs.begin(); i != m_fftCfgs.end(); ++i) {
+            free(*i);
+        }
+    }
+
+    void fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum,
+                       const FFTTools::WindowType windowType, const uint windowSize, const float param = 0)
+    {
+        const uint numSamples = audioFrame.size() / numChannels;
+        const QString cfgSig = QStringLiteral("s%1").arg(windowSize);
+        const QString winSig = QStringLiteral("s%1_t%2_p%3").arg(windowSize).arg(windowType).arg(param, 0, 'f', 3);
+        kiss_fftr_cfg myCfg;
+        if (m_fftCfgs.contains(cfgSig)) {
+            myCfg = m_fftCfgs.value(cfgSig);
+        } else {
+            myCfg = kiss_fftr_alloc(windowSize, false, nullptr, nullptr);
+            m_fftCfgs.insert(cfgSig, myCfg);
+        }
+        QVector<float> window;
+        float windowScaleFactor = 1;
+        if (windowType != FFTTools::Window_Rect) {
+            if (m_windowFunctions.contains(winSig)) {
+                window = m_windowFunctions.value(winSig);
+            } else {
+                window = FFTTools::window(windowType, windowSize, 0);
+                m_windowFunctions.insert(winSig, window);
+            }
+            windowScaleFactor = 1.0 / window[windowSize];
+        }
+        // One more bin than the original, which wrote past the end of its array
+        kiss_fft_cpx freqData[windowSize / 2 + 1];
+        float data[windowSize];
+        if (numSamples < windowSize) {
+            std::fill(&data[numSamples], &data[windowSize], 0);
+        }
+        for (uint i = 0; i < numSamples && i < windowSize; ++i) {
+            if (windowType != FFTTools::Window_Rect) {
+                data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f * window[i];
+            } else {
+                data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f;
+            }
+        }
+        kiss_fftr(myCfg, data, freqData);
+        for (uint i = 0; i < windowSize / 2; ++i) {
+            freqSpectrum[i] = 20 * log(pow(pow(fabs(freqData[i].r * windowScaleFactor), 2) + pow(fabs(freqData[i].i * windowScaleFactor), 2), .5) / ((float)windowSize / 2.0f)) / log(10);
+        }
+    }
+
+private:
+    QHash<QString, kiss_fftr_cfg> m_fftCfgs;
+    QHash<QString, QVector<float> > m_windowFunctions;
+};
+}
+
+namespace {
+// A few sines with noise, like music
+audioShortVector testAudio(int samples, int channels)
+{
+    audioShortVector audio(samples * channels);
+    srand(42);
+    for (int i = 0; i < samples; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            const double value = 8000 * sin(i * 0.031 * (c + 1)) + 4000 * sin(i * 0.43) + 2000 * sin(i * 1.7 + c)
+                                 + (rand() % 2001 - 1000);
+            audio[i * channels + c] = (qint16) value;
+        }
+    }
+    return audio;
+}
+
+double measure(int iterations, const std::function<void ()> &function)
+{
+    function();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        function();
+    }
+    return (double) timer.nsecsElapsed() / iterations / 1000;
+}
+
+double maxDifference(const QVector<float> &a, const QVector<float> &b)
+{
+    double difference = 0;
+    for (int i = 0; i < a.count(); ++i) {
+        if (std::isinf(a.at(i)) || std::isinf(b.at(i))) {
+            if (a.at(i) != b.at(i)) {
+                return INFINITY;
+            }
+            continue;
+        }
+        difference = qMax(difference, (double) fabs(a.at(i) - b.at(i)));
+    }
+    return difference;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    args.removeAt(0);
+
+    int iterations = 2000;
+    int channels = 2;
+    foreach (const QString &str, args) {
+        if (str.startsWith(QLatin1String("--iterations="))) {
+            iterations = qMax(1, str.section(QLatin1Char('='), 1).toInt());
+        } else if (str.startsWith(QLatin1String("--channels="))) {
+            channels = qBound(1, str.section(QLatin1Char('='), 1).toInt(), 8);
+        } else {
+            std::cout << "Compares FFTTools with the former implementation of the audio scope FFT" << std::endl << std::endl
+                      << argv[0] << std::endl
+                      << "\t--iterations=<n>\n\t\tNumber of measured calls (default 2000)" << std::endl
+                      << "\t--channels=<n>\n\t\tNumber of interleaved channels (default 2)" << std::endl;
+            return str == "-h" || str == "--help" ? 0 : 1;
+        }
+    }
+
+    const int windowSizes[] = { 256, 1024, 4096, 16384 };
+    const FFTTools::WindowType windowTypes[] = { FFTTools::Window_Rect, FFTTools::Window_Hamming };
+    const audioShortVector audio = testAudio(16384, channels);
+    std::cout << iterations << " iterations, " << channels << " channels, times in µs" << std::endl;
+
+    for (int t = 0; t < 2; ++t) {
+        for (int s = 0; s < 4; ++s) {
+            const FFTTools::WindowType type = windowTypes[t];
+            const int size = windowSizes[s];
+            Legacy::FFT legacy;
+            FFTTools fft;
+            QVector<float> legacySpectra(channels * size / 2);
+            QVector<float> spectra(channels * size / 2);
+
+            const double legacyTime = measure(iterations, [&]() {
+                for (int c = 0; c < channels; ++c) {
+                    legacy.fftNormalized(audio, c, channels, legacySpectra.data() + c * size / 2, type, size);
+                }
+            });
+            const double time = measure(iterations, [&]() {
+                for (int c = 0; c < channels; ++c) {
+                    fft.fftNormalized(audio, c, channels, spectra.data() + c * size / 2, type, size);
+                }
+            });
+            const double difference = maxDifference(legacySpectra, spectra);
+
+            std::cout << (type == FFTTools::Window_Rect ? "Rectangular" : "Hamming") << '\t' << size
+                      << "\tlegacy " << legacyTime << "\tper channel " << time << " (" << legacyTime / time << "x)"
+                      << "\tmax difference " << difference << " dB" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,323 @@
+/*
+Copyright (C) 2016 Kdenlive team <kdenlive@kde.org>
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QImage>
+#include <QStringList>
+#include <QVector>
+#include <mlt++/Mlt.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "../src/scopes/colorscopes/histogramgenerator.h"
+#include "../src/scopes/colorscopes/rgbparadegenerator.h"
+#include "../src/scopes/colorscopes/scopeanalysis.h"
+#include "../src/scopes/colorscopes/scopeframe.h"
+#include "../src/scopes/colorscopes/scopekernels.h"
+#include "../src/scopes/colorscopes/vectorscopegenerator.h"
+#include "../src/scopes/colorscopes/waveformgenerator.h"
+
+#define CHOP255(a) ((255) < (a) ? (255) : (a))
+
+/*
+  Scalar implementations the color scopes used before the row kernels,
+  reading the image with QImage::pixel and painting with QImage::setPixel.
+  Text and axis drawing is left out, it is the same for both versions.
+ */
+namespace Legacy
+{
+QImage waveform(const QSize &size, const QImage &image, uint accelFactor)
+{
+    const uint ww = size.width();
+    const uint wh = size.height();
+    const uint iw = image.width();
+    const uint ih = image.height();
+    QImage wave(size, QImage::Format_ARGB32);
+    wave.fill(qRgba(0, 0, 0, 0));
+    std::vector<uint> waveValues(ww * wh, 0);
+    const float pixelDepth = (float)((iw * ih) / accelFactor) / (ww * wh);
+    const float gain = 255 / (8 * pixelDepth);
+    const float hPrediv = (float)(wh - 1) / 255;
+    const float wPrediv = (float)(ww - 1) / (iw - 1);
+    for (uint y = 0; y < ih; y += accelFactor) {
+        for (uint x = 0; x < iw; ++x) {
+            const QRgb px = image.pixel(x, y);
+            const double dY = .299 * qRed(px) + .587 * qGreen(px) + .114 * qBlue(px);
+            waveValues[(int)(x * wPrediv) * wh + (int)(dY * hPrediv)]++;
+        }
+    }
+    for (uint i = 0; i < ww; ++i) {
+        for (uint j = 0; j < wh; ++j) {
+            wave.setPixel(i, wh - j - 1, qRgba(255, 242, 0, CHOP255(gain * waveValues[i * wh + j])));
+        }
+    }
+    return wave;
+}
+
+QImage histogram(const QSize &size, const QImage &image, uint accelFactor)
+{
+    int r[256], g[256], b[256], y[256];
+    std::fill(r, r + 256, 0);
+    std::fill(g, g + 256, 0);
+    std::fill(b, b + 256, 0);
+    std::fill(y, y + 256, 0);
+    for (int Y = 0; Y < image.height(); ++Y) {
+        for (int X = 0; X < image.width(); X += accelFactor) {
+            const QRgb px = image.pixel(X, Y);
+            r[qRed(px)]++;
+            g[qGreen(px)]++;
+            b[qBlue(px)]++;
+            y[(int)floor(.299 * qRed(px) + .587 * qGreen(px) + .114 * qBlue(px))]++;
+        }
+    }
+    // One component per quarter of the height
+    const int partH = size.height() / 4;
+    const float scaling = (float)partH / ((4 * image.width() * image.height()) >> 7);
+    QImage histogram(256, 4 * partH, QImage::Format_ARGB32);
+    histogram.fill(qRgba(0, 0, 0, 255));
+    const int *components[4] = { y, r, g, b };
+    for (int c = 0; c < 4; ++c) {
+        for (int x = 0; x < 256; ++x) {
+            const int partY = partH - 1 - qMin(partH - 1, (int)(scaling * components[c][x]));
+            for (int k = partH - 1; k >= partY; --k) {
+                histogram.setPixel(x, c * partH + k, qRgba(220, 220, 210, 255));
+            }
+        }
+    }
+    return histogram;
+}
+
+QImage parade(const QSize &size, const QImage &image, uint accelFactor)
+{
+    const uint iw = image.width();
+    const uint ih = image.height();
+    const uint partW = (size.width() - 20 - 40) / 3;
+    QImage unscaled(size.width() - 40, 256, QImage::Format_ARGB32);
+    unscaled.fill(qRgba(0, 0, 0, 0));
+    const float pixelDepth = (float)((iw * ih) / accelFactor) / (partW * 255);
+    const float gain = 255 / (8 * pixelDepth);
+    const float wPrediv = (float)(partW - 1) / (iw - 1);
+    std::vector<uint> values(3 * partW * 256, 0);
+    for (uint x = 0, y = 0; y < ih;) {
+        const QRgb px = image.pixel(x, y);
+        const int dx = x * wPrediv;
+        values[(dx * 256 + qRed(px)) * 3]++;
+        values[(dx * 256 + qGreen(px)) * 3 + 1]++;
+        values[(dx * 256 + qBlue(px)) * 3 + 2]++;
+        x += accelFactor;
+        while (x >= iw) {
+            x -= iw;
+            ++y;
+        }
+    }
+    for (uint i = 0; i < partW; ++i) {
+        for (uint j = 0; j < 256; ++j) {
+            unscaled.setPixel(i, j, qRgba(255, 10, 10, CHOP255(gain * values[(i * 256 + j) * 3])));
+            unscaled.setPixel(i + partW + 10, j, qRgba(10, 255, 10, CHOP255(gain * values[(i * 256 + j) * 3 + 1])));
+            unscaled.setPixel(i + 2 * partW + 20, j, qRgba(10, 10, 255, CHOP255(gain * values[(i * 256 + j) * 3 + 2])));
+        }
+    }
+    return unscaled;
+}
+
+QImage vectorscope(const QSize &size, const QImage &image, uint accelFactor)
+{
+    const int cw = qMin(size.width(), size.height());
+    QImage scope(cw, cw, QImage::Format_ARGB32);
+    scope.fill(qRgba(0, 0, 0, 0));
+    const int iw = image.width();
+    const int ih = image.height();
+    const double avgPxPerPx = (double) 16 * iw * ih / cw / cw / accelFactor;
+    const float scaling = 1 / .7;
+    for (int x = 0, y = 0; y < ih;) {
+        const QRgb px = image.pixel(x, y);
+        const double u = (double) - 0.0006671 * qRed(px) - 0.001299 * qGreen(px) + 0.0019608 * qBlue(px);
+        const double v = (double)  0.001961 * qRed(px) - 0.001642 * qGreen(px) - 0.0003189 * qBlue(px);
+        const QPoint pt((cw - 1) * (scaling * u + 1) / 2, (cw - 1) * (1 - (scaling * v + 1) / 2));
+        if (pt.x() < cw && pt.x() >= 0 && pt.y() < cw && pt.y() >= 0) {
+            const QRgb spx = scope.pixel(pt);
+            scope.setPixel(pt, qRgba(qRed(spx) + (255 - qRed(spx)) / (3 * avgPxPerPx), qGreen(spx) + 20 * (255 - qGreen(spx)) / (avgPxPerPx),
+                                     qBlue(spx) + (255 - qBlue(spx)) / (avgPxPerPx), qAlpha(spx) + (255 - qAlpha(spx)) / (avgPxPerPx)));
+        }
+        x += accelFactor;
+        while (x >= iw) {
+            x -= iw;
+            ++y;
+        }
+    }
+    return scope;
+}
+}
+
+// Smooth gradients with some noise, so that all scopes get a spread of values
+QImage testImage(int width, int height)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            const int noise = rand() % 32;
+            line[x] = qRgb((x * 223 / width + noise) & 0xff, (y * 223 / height + noise) & 0xff, ((x + y) * 111 / height + noise) & 0xff);
+        }
+    }
+    return image;
+}
+
+// yuv420p MLT frame holding the same picture
+Mlt::Frame testFrame(const QImage &image)
+{
+    const int width = image.width();
+    const int height = image.height();
+    const int size = width * height * 3 / 2;
+    uint8_t *data = (uint8_t *) mlt_pool_alloc(size);
+    uint8_t *cb = data + width * height;
+    uint8_t *cr = cb + width * height / 4;
+    for (int y = 0; y < height; ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        for (int x = 0; x < width; ++x) {
+            const int r = qRed(line[x]), g = qGreen(line[x]), b = qBlue(line[x]);
+            data[y * width + x] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+            if ((x & 1) == 0 && (y & 1) == 0) {
+                cb[(y / 2) * (width / 2) + x / 2] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+                cr[(y / 2) * (width / 2) + x / 2] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+            }
+        }
+    }
+    Mlt::Frame frame(mlt_frame_init(nullptr));
+    frame.set("format", mlt_image_yuv420p);
+    frame.set("width", width);
+    frame.set("height", height);
+    frame.set("colorspace", 601);
+    frame.set("image", data, size, mlt_pool_release);
+    return frame;
+}
+
+// Average time of a call in milliseconds
+double measure(int iterations, const std::function<void ()> &function)
+{
+    // Warm up caches and thread pool
+    function();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        function();
+    }
+    return (double) timer.nsecsElapsed() / iterations / 1000000;
+}
+
+void report(const char *name, double legacy, double rgb, double yuv)
+{
+    std::cout << name << "\tlegacy " << legacy << " ms\tRGB " << rgb << " ms (" << legacy / rgb << "x)"
+              << "\tYUV " << yuv << " ms (" << legacy / yuv << "x)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+        // Only needed for text rendering
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QStringList args = app.arguments();
+    args.removeAt(0);
+
+    int iterations = 20;
+    int width = 3840;
+    int height = 2160;
+    uint accelFactor = 1;
+    foreach (const QString &str, args) {
+        if (str.startsWith(QLatin1String("--iterations="))) {
+            iterations = qMax(1, str.section(QLatin1Char('='), 1).toInt());
+        } else if (str.startsWith(QLatin1String("--size="))) {
+            width = str.section(QLatin1Char('='), 1).section(QLatin1Char('x'), 0, 0).toInt();
+            height = str.section(QLatin1Char('='), 1).section(QLatin1Char('x'), 1, 1).toInt();
+        } else if (str.startsWith(QLatin1String("--accel="))) {
+            accelFactor = qMax(1, str.section(QLatin1Char('='), 1).toInt());
+        } else {
+            std::cout << "Compares the color scope generators with their former scalar implementations" << std::endl << std::endl
+                      << argv[0] << std::endl
+                      << "\t--iterations=<n>\n\t\tNumber of measured calls (default 20)" << std::endl
+                      << "\t--size=<width>x<height>\n\t\tSize of the test frame (default 3840x2160)" << std::endl
+                      << "\t--accel=<n>\n\t\tAcceleration factor of the scopes (default 1)" << std::endl;
+            return str == "-h" || str == "--help" ? 0 : 1;
+        }
+    }
+    if (width < 64 || height < 64) {
+        std::cout << "Invalid frame size" << std::endl;
+        return 1;
+    }
+
+    Mlt::Factory::init();
+    const QImage image = testImage(width, height);
+    Mlt::Frame mltFrame = testFrame(image);
+    const ScopeFrame rgbFrame(image);
+    const ScopeFrame yuvFrame((SharedFrame(mltFrame)));
+    const QSize size(720, 400);
+
+    std::cout << "Frame " << width << "x" << height << ", scope " << size.width() << "x" << size.height()
+              << ", " << iterations << " iterations, " << ScopeKernels::bandCount(height / accelFactor)
+              << " bands, " << ScopeKernels::instructionSet() << " kernels" << std::endl;
+
+    WaveformGenerator waveform;
+    report("Waveform",
+           measure(iterations, [&]() { Legacy::waveform(size, image, accelFactor); }),
+           measure(iterations, [&]() { waveform.calculateWaveform(size, rgbFrame, WaveformGenerator::PaintMode_Yellow, false, WaveformGenerator::Rec_601, accelFactor); }),
+           measure(iterations, [&]() { waveform.calculateWaveform(size, yuvFrame, WaveformGenerator::PaintMode_Yellow, false, WaveformGenerator::Rec_601, accelFactor); }));
+
+    HistogramGenerator histogram;
+    const int components = HistogramGenerator::ComponentY | HistogramGenerator::ComponentR | HistogramGenerator::ComponentG | HistogramGenerator::ComponentB;
+    report("Histogram",
+           measure(iterations, [&]() { Legacy::histogram(size, image, accelFactor); }),
+           measure(iterations, [&]() { histogram.calculateHistogram(size, rgbFrame, components, HistogramGenerator::Rec_601, true, accelFactor); }),
+           measure(iterations, [&]() { histogram.calculateHistogram(size, yuvFrame, components, HistogramGenerator::Rec_601, true, accelFactor); }));
+
+    RGBParadeGenerator parade;
+    report("RGB Parade",
+           measure(iterations, [&]() { Legacy::parade(size, image, accelFactor); }),
+           measure(iterations, [&]() { parade.calculateRGBParade(size, rgbFrame, RGBParadeGenerator::PaintMode_RGB, false, false, accelFactor); }),
+           measure(iterations, [&]() { parade.calculateRGBParade(size, yuvFrame, RGBParadeGenerator::PaintMode_RGB, false, false, accelFactor); }));
+
+    VectorscopeGenerator vectorscope;
+    report("Vectorscope",
+           measure(iterations, [&]() { Legacy::vectorscope(size, image, accelFactor); }),
+           measure(iterations, [&]() { vectorscope.calculateVectorscope(size, rgbFrame, 1, VectorscopeGenerator::PaintMode_Green, VectorscopeGenerator::ColorSpace_YPbPr, false, accelFactor); }),
+           measure(iterations, [&]() { vectorscope.calculateVectorscope(size, yuvFrame, 1, VectorscopeGenerator::PaintMode_Green, VectorscopeGenerator::ColorSpace_YPbPr, false, accelFactor); }));
+
+    // All four scopes open: one shared frame analysis, then painting only
+    QVector<ScopeAnalysis::Request> requests;
+    requests << WaveformGenerator::analysisRequest(size, WaveformGenerator::Rec_601, accelFactor)
+             << HistogramGenerator::analysisRequest(components, HistogramGenerator::Rec_601, accelFactor)
+             << RGBParadeGenerator::analysisRequest(size, accelFactor)
+             << VectorscopeGenerator::analysisRequest(size, 1, VectorscopeGenerator::PaintMode_Green, VectorscopeGenerator::ColorSpace_YPbPr, accelFactor);
+    const std::function<void (const ScopeFrame &)> allScopes = [&](const ScopeFrame &frame) {
+        const ScopeAnalysis analysis(frame, requests);
+        waveform.calculateWaveform(size, analysis.result(requests.at(0)), WaveformGenerator::PaintMode_Yellow, false);
+        histogram.calculateHistogram(size, analysis.result(requests.at(1)), components, true);
+        parade.calculateRGBParade(size, analysis.result(requests.at(2)), RGBParadeGenerator::PaintMode_RGB, false, false);
+        vectorscope.calculateVectorscope(size, analysis.result(requests.at(3)), VectorscopeGenerator::PaintMode_Green, false);
+    };
+    report("All scopes",
+           measure(iterations, [&]() {
+               Legacy::waveform(size, image, accelFactor);
+               Legacy::histogram(size, image, accelFactor);
+               Legacy::parade(size, image, accelFactor);
+               Legacy::vectorscope(size, image, accelFactor);
+           }),
+           measure(iterations, [&]() { allScopes(rgbFrame); }),
+           measure(iterations, [&]() { allScopes(yuvFrame); }));
+
+    Mlt::Factory::close();
+    return 0;
+}